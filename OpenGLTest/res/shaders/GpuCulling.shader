@@ -0,0 +1,73 @@
+#shader compute
+#version 430 core
+
+layout(local_size_x = 64) in;
+
+struct Object
+{
+    mat4 modelMatrix;
+    vec4 color;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uint mesh;
+};
+
+struct Mesh
+{
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint padding;
+};
+
+struct DrawElementsIndirectCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 1) readonly buffer Meshes { Mesh meshes[]; };
+layout(std430, binding = 2) writeonly buffer Commands { DrawElementsIndirectCommand commands[]; };
+layout(std430, binding = 3) buffer DrawCount { uint drawCount; };
+
+uniform vec4 u_Planes[6];
+uniform int u_ObjectCount;
+uniform int u_IsCompacting; // 1: visible commands packed at the front (drawn with the count) - 0: one command per object
+
+void main()
+{
+    uint objectIndex = gl_GlobalInvocationID.x;
+    if (objectIndex >= uint(u_ObjectCount))
+        return;
+
+    Object object = objects[objectIndex];
+    vec3 center = (object.boundsMin.xyz + object.boundsMax.xyz) * 0.5;
+    vec3 extent = (object.boundsMax.xyz - object.boundsMin.xyz) * 0.5;
+
+    bool isVisible = true;
+    for (int i = 0; i < 6; i++)
+    {
+        float distance = dot(u_Planes[i].xyz, center) + u_Planes[i].w;
+        float radius = dot(abs(u_Planes[i].xyz), extent);
+        isVisible = isVisible && distance + radius >= 0.0;
+    }
+
+    Mesh mesh = meshes[object.mesh];
+
+    // baseInstance selects the object through the instanced object index attribute
+    if (u_IsCompacting != 0)
+    {
+        if (isVisible)
+            commands[atomicAdd(drawCount, 1u)] = DrawElementsIndirectCommand(mesh.indexCount, 1u, mesh.firstIndex, mesh.baseVertex, objectIndex);
+    }
+    else
+    {
+        if (isVisible)
+            atomicAdd(drawCount, 1u);
+        commands[objectIndex] = DrawElementsIndirectCommand(mesh.indexCount, isVisible ? 1u : 0u, mesh.firstIndex, mesh.baseVertex, objectIndex);
+    }
+}
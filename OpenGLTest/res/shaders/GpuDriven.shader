@@ -0,0 +1,38 @@
+#shader vertex
+#version 430 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in uint aObjectIndex;
+
+struct Object
+{
+    mat4 modelMatrix;
+    vec4 color;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uint mesh;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+
+uniform mat4 u_ViewProjection;
+
+out vec4 v_Color;
+
+void main()
+{
+    gl_Position = u_ViewProjection * objects[aObjectIndex].modelMatrix * vec4(aPos, 1.0);
+    v_Color = objects[aObjectIndex].color;
+}
+
+#shader fragment
+#version 430 core
+
+in vec4 v_Color;
+
+out vec4 color;
+
+void main()
+{
+    color = v_Color;
+}
@@ -0,0 +1,33 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+
+out vec3 v_Normal;
+
+uniform mat4 u_MVP;
+uniform mat4 u_Model;
+
+void main()
+{
+    gl_Position = u_MVP * vec4(aPos, 1.0);
+    v_Normal = mat3(u_Model) * aNormal;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec3 v_Normal;
+
+uniform vec4 u_Color;
+uniform vec3 u_LightDirection;
+
+void main()
+{
+    float diffuse = max(dot(normalize(v_Normal), -u_LightDirection), 0.0);
+    color = vec4(u_Color.rgb * (0.2 + 0.8 * diffuse), u_Color.a);
+}
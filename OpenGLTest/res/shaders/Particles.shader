@@ -0,0 +1,51 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 aCorner; // Per vertex: the shared quad, from -1 to 1
+layout(location = 1) in vec4 aPosition; // Per instance (particle): xyz, w: age
+layout(location = 2) in vec4 aVelocity; // Per instance: xyz, w: lifetime
+
+uniform mat4 u_View;
+uniform mat4 u_Projection;
+uniform float u_Size;
+uniform vec4 u_StartColor;
+uniform vec4 u_EndColor;
+
+out vec2 v_Corner;
+out vec4 v_Color;
+
+void main()
+{
+    float life = aPosition.w / max(aVelocity.w, 0.0001);
+    v_Corner = aCorner;
+    v_Color = mix(u_StartColor, u_EndColor, life);
+
+    /* Dead particles collapse outside the clip volume, so the quad is dropped before rasterization */
+    if (life >= 1.0)
+    {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        return;
+    }
+
+    /* Camera-facing: the corner offset is applied in view space */
+    vec4 viewPosition = u_View * vec4(aPosition.xyz, 1.0);
+    viewPosition.xy += aCorner * u_Size * (1.0 - 0.5 * life);
+    gl_Position = u_Projection * viewPosition;
+}
+
+#shader fragment
+#version 330 core
+
+in vec2 v_Corner;
+in vec4 v_Color;
+
+out vec4 color;
+
+void main()
+{
+    float falloff = 1.0 - dot(v_Corner, v_Corner);
+    if (falloff <= 0.0)
+        discard;
+
+    color = vec4(v_Color.rgb, v_Color.a * falloff);
+}
@@ -0,0 +1,107 @@
+#shader vertex
+#version 330 core
+#feedback v_Position v_Velocity
+
+// One vertex per particle, drawn as GL_POINTS with the rasterizer off: the outputs are captured into the other buffer
+// (the simulation itself is the same as in ParticlesCompute.shader, keep both in sync)
+
+layout(location = 0) in vec4 aPosition; // xyz, w: age (seconds)
+layout(location = 1) in vec4 aVelocity; // xyz, w: lifetime (seconds), dead once the age reaches it
+
+out vec4 v_Position;
+out vec4 v_Velocity;
+
+uniform float u_DeltaTime;
+uniform uint u_Seed;
+uniform uint u_ParticleCount;
+uniform uint u_EmitBegin; // Dead particles in [begin, begin + count) (wrapping around the pool) respawn this step
+uniform uint u_EmitCount;
+
+uniform int u_EmitterShape; // 0: point - 1: sphere - 2: disc - 3: box
+uniform vec3 u_EmitterPosition;
+uniform float u_EmitterSize; // Sphere and disc radius, box half extent
+uniform vec3 u_EmitterDirection; // Normalized
+uniform float u_Spread; // Half-angle of the emission cone (radians)
+uniform float u_Speed;
+uniform vec2 u_Lifetime; // Min, max
+
+uniform vec3 u_Gravity;
+uniform float u_DragFactor; // exp(-drag * deltaTime)
+uniform vec3 u_AttractorPosition;
+uniform float u_AttractorStrength;
+uniform float u_VortexStrength; // Around the vertical axis through the attractor
+
+uint Hash(uint value)
+{
+    // PCG
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float Random(inout uint state)
+{
+    state = Hash(state);
+    return float(state) * (1.0 / 4294967295.0);
+}
+
+void Spawn(uint index, out vec4 position, out vec4 velocity)
+{
+    uint state = Hash(index ^ Hash(u_Seed));
+
+    vec3 offset = vec3(0.0);
+    if (u_EmitterShape == 1)
+    {
+        float z = Random(state) * 2.0 - 1.0;
+        float phi = Random(state) * 6.2831853;
+        float radius = u_EmitterSize * pow(Random(state), 1.0 / 3.0);
+        offset = vec3(sqrt(1.0 - z * z) * cos(phi), z, sqrt(1.0 - z * z) * sin(phi)) * radius;
+    }
+    else if (u_EmitterShape == 2)
+    {
+        float phi = Random(state) * 6.2831853;
+        float radius = u_EmitterSize * sqrt(Random(state));
+        offset = vec3(cos(phi), 0.0, sin(phi)) * radius;
+    }
+    else if (u_EmitterShape == 3)
+    {
+        offset = (vec3(Random(state), Random(state), Random(state)) * 2.0 - 1.0) * u_EmitterSize;
+    }
+
+    /* Uniform over the cone's solid angle */
+    float cosTheta = mix(1.0, cos(u_Spread), Random(state));
+    float sinTheta = sqrt(max(1.0 - cosTheta * cosTheta, 0.0));
+    float phi = Random(state) * 6.2831853;
+    vec3 tangent = normalize(cross(abs(u_EmitterDirection.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0), u_EmitterDirection));
+    vec3 bitangent = cross(u_EmitterDirection, tangent);
+    vec3 direction = (tangent * cos(phi) + bitangent * sin(phi)) * sinTheta + u_EmitterDirection * cosTheta;
+
+    position = vec4(u_EmitterPosition + offset, 0.0);
+    velocity = vec4(direction * u_Speed * (0.75 + 0.5 * Random(state)), mix(u_Lifetime.x, u_Lifetime.y, Random(state)));
+}
+
+void main()
+{
+    uint index = uint(gl_VertexID);
+    v_Position = aPosition;
+    v_Velocity = aVelocity;
+
+    if (aPosition.w >= aVelocity.w)
+    {
+        if ((index + u_ParticleCount - u_EmitBegin) % u_ParticleCount < u_EmitCount)
+            Spawn(index, v_Position, v_Velocity);
+        return;
+    }
+
+    vec3 toAttractor = u_AttractorPosition - aPosition.xyz;
+    float distanceSquared = dot(toAttractor, toAttractor) + 0.25; // Softened, so nothing gets flung out of the center
+    vec3 swirl = vec3(-toAttractor.z, 0.0, toAttractor.x);
+
+    vec3 acceleration = u_Gravity;
+    acceleration += toAttractor * (u_AttractorStrength * inversesqrt(distanceSquared) / distanceSquared);
+    acceleration += swirl * (u_VortexStrength * inversesqrt(dot(swirl, swirl) + 0.25));
+
+    v_Velocity.xyz = (aVelocity.xyz + acceleration * u_DeltaTime) * u_DragFactor;
+    v_Position.xyz = aPosition.xyz + v_Velocity.xyz * u_DeltaTime;
+    v_Position.w = aPosition.w + u_DeltaTime;
+}
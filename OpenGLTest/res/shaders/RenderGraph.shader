@@ -0,0 +1,96 @@
+#shader vertex
+#version 330 core
+
+out vec2 v_TexCoord;
+
+/* A single triangle covering the screen, no vertex buffer needed */
+void main()
+{
+    v_TexCoord = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(v_TexCoord * 2.0 - 1.0, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+in vec2 v_TexCoord;
+
+out vec4 color;
+
+uniform int u_Pass; // 0: scene - 1: bright pass - 2: blur - 3: luminance - 4: composite
+uniform float u_Time;
+uniform float u_Aspect;
+uniform float u_Threshold;
+uniform vec2 u_Direction; // Blur step, in texture coordinates
+uniform float u_BloomStrength;
+uniform int u_HasBloom;
+uniform int u_HasLuminance;
+uniform sampler2D u_Source;
+uniform sampler2D u_Bloom;
+uniform sampler2D u_Luminance;
+
+const float Weights[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+/* Orbiting lights, well above 1 at their core, over a dim gradient */
+vec3 Scene()
+{
+    vec2 position = (v_TexCoord - 0.5) * vec2(u_Aspect, 1.0);
+    vec3 result = mix(vec3(0.02, 0.02, 0.05), vec3(0.05, 0.08, 0.15), v_TexCoord.y);
+    for (int i = 0; i < 6; i++)
+    {
+        float angle = u_Time * (0.3 + 0.1 * i) + float(i) * 1.047;
+        vec2 center = vec2(cos(angle), sin(angle * 1.3)) * (0.15 + 0.05 * i);
+        vec3 hue = 0.5 + 0.5 * cos(vec3(0.0, 2.1, 4.2) + float(i));
+        float lightDistance = length(position - center);
+        result += hue * (0.004 / (lightDistance * lightDistance + 0.001));
+    }
+    return result;
+}
+
+float Luminance(vec3 rgb)
+{
+    return dot(rgb, vec3(0.2126, 0.7152, 0.0722));
+}
+
+void main()
+{
+    if (u_Pass == 0)
+    {
+        color = vec4(Scene(), 1.0);
+    }
+    else if (u_Pass == 1)
+    {
+        vec3 source = texture(u_Source, v_TexCoord).rgb;
+        color = vec4(source * max(Luminance(source) - u_Threshold, 0.0) / max(Luminance(source), 0.0001), 1.0);
+    }
+    else if (u_Pass == 2)
+    {
+        /* Separable gaussian, one axis per pass */
+        vec3 sum = texture(u_Source, v_TexCoord).rgb * Weights[0];
+        for (int i = 1; i < 5; i++)
+        {
+            sum += texture(u_Source, v_TexCoord + u_Direction * float(i)).rgb * Weights[i];
+            sum += texture(u_Source, v_TexCoord - u_Direction * float(i)).rgb * Weights[i];
+        }
+        color = vec4(sum, 1.0);
+    }
+    else if (u_Pass == 3)
+    {
+        /* False color: blue in the dark, red past 1 */
+        float luminance = Luminance(texture(u_Source, v_TexCoord).rgb);
+        color = vec4(clamp(vec3(luminance - 1.0, 1.0 - abs(luminance - 1.0), 1.0 - luminance), 0.0, 1.0), 1.0);
+    }
+    else
+    {
+        vec3 hdr = texture(u_Source, v_TexCoord).rgb;
+        if (u_HasBloom != 0)
+            hdr += texture(u_Bloom, v_TexCoord).rgb * u_BloomStrength;
+
+        /* Reinhard tone mapping */
+        color = vec4(hdr / (1.0 + hdr), 1.0);
+
+        /* Luminance view in the bottom left corner */
+        if (u_HasLuminance != 0 && v_TexCoord.x < 0.25 && v_TexCoord.y < 0.25)
+            color = texture(u_Luminance, v_TexCoord * 4.0);
+    }
+}
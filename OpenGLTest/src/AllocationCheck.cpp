@@ -0,0 +1,63 @@
+#include "AllocationCheck.h"
+#include "AllocationCounter.h"
+#include "GLHandleError.h"
+
+#include <algorithm>
+
+AllocationCheck::AllocationCheck(test::TestMenu& menu, int warmUpFrames, int measuredFrames)
+	: m_Menu(menu), m_WarmUpFrames(warmUpFrames), m_MeasuredFrames(measuredFrames), m_NextTest(0), m_Test(nullptr), m_Frame(0),
+	m_AllocatingFrames(0), m_Allocations(0), m_WorstFrame(0), m_FailedTests(0)
+{
+}
+
+AllocationCheck::~AllocationCheck()
+{
+	delete m_Test;
+}
+
+bool AllocationCheck::OnFrameBoundary(test::Test*& currentTest)
+{
+	if (m_Test && m_Frame >= m_WarmUpFrames)
+	{
+		const uint64_t allocations = AllocationCounter::Get().GetLastFrameCount();
+		if (allocations > 0)
+			m_AllocatingFrames++;
+		m_Allocations += allocations;
+		m_WorstFrame = std::max(m_WorstFrame, allocations);
+	}
+
+	m_Frame++;
+	if (m_Test && m_Frame < m_WarmUpFrames + m_MeasuredFrames)
+		return true;
+
+	if (m_Test)
+	{
+		const std::string& name = m_Menu.GetTestName(m_NextTest - 1);
+		if (m_AllocatingFrames == 0)
+		{
+			Log("Allocation check passed: " + name + " (" + std::to_string(m_MeasuredFrames) + " frames without heap allocations)");
+		}
+		else
+		{
+			Log("Allocation check FAILED: " + name + " allocated in " + std::to_string(m_AllocatingFrames) + " of " + std::to_string(m_MeasuredFrames) +
+				" frames (" + std::to_string(m_Allocations) + " allocations, up to " + std::to_string(m_WorstFrame) + " in a frame)");
+			m_FailedTests++;
+		}
+
+		delete m_Test;
+		m_Test = nullptr;
+		currentTest = &m_Menu;
+	}
+
+	if (m_NextTest == m_Menu.GetTestCount())
+		return false;
+
+	/* Whatever opening the test allocates lands in the warm-up */
+	m_Test = m_Menu.CreateTest(m_NextTest++);
+	currentTest = m_Test;
+	m_Frame = 0;
+	m_AllocatingFrames = 0;
+	m_Allocations = 0;
+	m_WorstFrame = 0;
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "tests/Test.h"
+
+#include <cstdint>
+
+/* `--check-allocations`: opens every registered test in turn, lets it warm up, then expects each of its frames to make no heap allocation */
+class AllocationCheck
+{
+private:
+	test::TestMenu& m_Menu;
+	int m_WarmUpFrames;
+	int m_MeasuredFrames;
+
+	std::size_t m_NextTest;
+	test::Test* m_Test; // The one being checked (owned)
+	int m_Frame;
+	uint64_t m_AllocatingFrames;
+	uint64_t m_Allocations;
+	uint64_t m_WorstFrame;
+	int m_FailedTests;
+
+public:
+	AllocationCheck(test::TestMenu& menu, int warmUpFrames = 60, int measuredFrames = 120);
+	~AllocationCheck();
+
+	AllocationCheck(const AllocationCheck&) = delete;
+	AllocationCheck& operator=(const AllocationCheck&) = delete;
+
+	// Call at the frame boundary (no simulation running), after `AllocationCounter::EndFrame`: moves `currentTest` on to
+	// the next test once the current one has been measured, returns false when every test has been checked
+	bool OnFrameBoundary(test::Test*& currentTest);
+
+	inline int GetFailedCount() const { return m_FailedTests; }
+};
@@ -0,0 +1,113 @@
+#include "AllocationCounter.h"
+#include "FrameArena.h"
+
+#include "imgui/imgui.h"
+
+#include <atomic>
+#include <cfloat>
+#include <cstdlib>
+#include <new>
+
+/* Plain globals: allocations can happen before any constructor runs (and after the destructors) */
+static std::atomic<uint64_t> s_AllocationCount(0);
+static thread_local uint64_t t_AllocationCount = 0;
+
+static void* CountedAllocate(std::size_t size)
+{
+	s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	t_AllocationCount++;
+
+	if (size == 0)
+		size = 1;
+
+	while (true)
+	{
+		if (void* pointer = std::malloc(size))
+			return pointer;
+
+		/* Same contract as the default operator new: give the new handler a chance to free memory, otherwise throw */
+		std::new_handler handler = std::get_new_handler();
+		if (!handler)
+			throw std::bad_alloc();
+		handler();
+	}
+}
+
+void* operator new(std::size_t size) { return CountedAllocate(size); }
+void* operator new[](std::size_t size) { return CountedAllocate(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	try { return CountedAllocate(size); }
+	catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	try { return CountedAllocate(size); }
+	catch (...) { return nullptr; }
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+
+AllocationCounter::AllocationCounter()
+	: m_FrameStartCount(GetTotalCount()), m_FrameStartMainThreadCount(GetThreadCount()), m_LastFrameCount(0), m_LastFrameMainThreadCount(0),
+	m_History(), m_HistoryIndex(0), m_HistoryCount(0), m_FrameCount(0), m_AllocatingFrameCount(0)
+{
+}
+
+AllocationCounter& AllocationCounter::Get()
+{
+	static AllocationCounter instance;
+	return instance;
+}
+
+uint64_t AllocationCounter::GetTotalCount()
+{
+	return s_AllocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::GetThreadCount()
+{
+	return t_AllocationCount;
+}
+
+void AllocationCounter::EndFrame()
+{
+	const uint64_t count = GetTotalCount();
+	const uint64_t mainThreadCount = GetThreadCount();
+
+	m_LastFrameCount = count - m_FrameStartCount;
+	m_LastFrameMainThreadCount = mainThreadCount - m_FrameStartMainThreadCount;
+	m_FrameStartCount = count;
+	m_FrameStartMainThreadCount = mainThreadCount;
+
+	m_FrameCount++;
+	if (m_LastFrameCount > 0)
+		m_AllocatingFrameCount++;
+
+	m_History[m_HistoryIndex] = (float)m_LastFrameCount;
+	m_HistoryIndex = (m_HistoryIndex + 1) % HistorySize;
+	if (m_HistoryCount < HistorySize)
+		m_HistoryCount++;
+}
+
+void AllocationCounter::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("Frame memory"))
+		return;
+
+	ImGui::Text("Heap allocations last frame: %llu (%llu on the main thread)", (unsigned long long)m_LastFrameCount, (unsigned long long)m_LastFrameMainThreadCount);
+	ImGui::Text("Frames that allocated: %llu of %llu", (unsigned long long)m_AllocatingFrameCount, (unsigned long long)m_FrameCount);
+	ImGui::PlotHistogram("##Allocations", m_History, m_HistoryCount, m_HistoryCount == HistorySize ? m_HistoryIndex : 0, "Allocations/frame", 0.0f, FLT_MAX, ImVec2(0, 60));
+
+	const FrameArena& arena = FrameArena::Get();
+	constexpr float KB = 1024.0f;
+	ImGui::Text("Frame arena: %.1f KB last frame, peak %.1f KB of %.0f KB", arena.GetLastFrameBytes() / KB, arena.GetPeakBytes() / KB, arena.GetCapacity() / KB);
+	ImGui::Text("Arena overflows (fell back to the heap): %llu last frame, %llu overall", (unsigned long long)arena.GetLastFrameOverflows(), (unsigned long long)arena.GetTotalOverflows());
+}
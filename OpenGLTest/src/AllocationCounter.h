@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+/* Counts heap allocations (every `operator new`, from any thread) so frames can be checked for allocations they shouldn't make.
+`malloc` isn't hooked, so C code and ImGui (whose allocator calls it) don't show up */
+class AllocationCounter
+{
+private:
+	static constexpr int HistorySize = 240; // Frames
+
+	uint64_t m_FrameStartCount;
+	uint64_t m_FrameStartMainThreadCount;
+	uint64_t m_LastFrameCount; // Every thread
+	uint64_t m_LastFrameMainThreadCount;
+
+	float m_History[HistorySize];
+	int m_HistoryIndex;
+	int m_HistoryCount;
+	uint64_t m_FrameCount;
+	uint64_t m_AllocatingFrameCount;
+
+	AllocationCounter();
+
+public:
+	static AllocationCounter& Get();
+
+	AllocationCounter(const AllocationCounter&) = delete;
+	AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+	// Allocations made so far, by every thread or by the calling one
+	static uint64_t GetTotalCount();
+	static uint64_t GetThreadCount();
+
+	// Closes the frame's counts (on the main thread, at the frame boundary)
+	void EndFrame();
+
+	inline uint64_t GetLastFrameCount() const { return m_LastFrameCount; }
+	inline uint64_t GetLastFrameMainThreadCount() const { return m_LastFrameMainThreadCount; }
+
+	// Heap allocations per frame and the frame arena's usage
+	void OnImGuiRender();
+};
@@ -2,15 +2,44 @@
 #include <GLFW/glfw3.h>
 
 #include <string>
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
+#include <chrono>
+#include <memory>
+#include <filesystem>
 
 #include "AppWindow.h"
 #include "GLHandleError.h"
+#include "ResourceManager.h"
+#include "JobSystem.h"
+#include "SimulationClock.h"
+#include "FramePacer.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
+#include "GpuMemoryTracker.h"
+#include "RenderStats.h"
+#include "FrameArena.h"
+#include "AllocationCounter.h"
+#include "AllocationCheck.h"
+#include "RenderBackend.h"
+#include "SoftwareRasterizer.h"
+#include "TraceReplayer.h"
+
+#include "benchmark/Benchmark.h"
+#include "benchmark/SceneBenchmark.h"
 
 #include "tests/TestClearColor.h"
 #include "tests/TestSquare.h"
 #include "tests/TestSombrero.h"
+#include "tests/TestJobSystem.h"
+#include "tests/TestCulling.h"
+#include "tests/TestGpuDriven.h"
+#include "tests/TestGeometryPool.h"
+#include "tests/TestMeshImport.h"
+#include "tests/TestParticles.h"
+#include "tests/TestRenderGraph.h"
 
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw.h"
@@ -21,23 +50,144 @@
 int WindowWidth = 900;
 int WindowHeight = 900;
 
-int main(void)
+/* Offline packer: `OpenGLTest --pack [output]` bundles every shader and texture under res/ */
+static int PackAssets(const std::string& outputPath)
 {
+    std::vector<std::string> filepaths;
+    for (const auto& file : std::filesystem::recursive_directory_iterator("res"))
+    {
+        if (file.is_regular_file() && file.path().generic_string() != outputPath)
+            filepaths.push_back(file.path().generic_string());
+    }
+
+    return AssetPack::Build(outputPath, filepaths) ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    auto startupStart = std::chrono::steady_clock::now();
+    bool useAssetPack = true;
+    bool isBenchmarkRun = false;
+    benchmark::Options benchmarkOptions;
+    std::string captureDirectory;
+    CaptureFormat captureFormat = CaptureFormat::PNG;
+    int captureFrames = 0;
+    bool isOnDemand = false;
+    std::string gpuMemoryJsonPath;
+    std::string renderStatsCsvPath;
+    bool isAllocationCheck = false;
+    bool isSceneBenchmark = false;
+    benchmark::SceneOptions sceneOptions;
+    std::string tracePath;
+    int traceFrames = 0;
+    ReplayOptions replayOptions;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--pack")
+            return PackAssets(i + 1 < argc ? argv[i + 1] : "res/assets.pack");
+        else if (arg == "--no-pack")
+            useAssetPack = false;
+        else if (arg == "--benchmark")
+        {
+            isBenchmarkRun = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                benchmarkOptions.filter = argv[++i];
+        }
+        else if (arg == "--benchmark-json" && i + 1 < argc)
+            benchmarkOptions.jsonOutputPath = argv[++i];
+        else if (arg == "--benchmark-repetitions" && i + 1 < argc)
+            benchmarkOptions.repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--capture" && i + 1 < argc)
+            captureDirectory = argv[++i];
+        else if (arg == "--capture-format" && i + 1 < argc)
+        {
+            if (!FrameCapture::ParseFormat(argv[++i], captureFormat))
+                std::cout << "Unknown capture format '" << argv[i] << "' (png, raw or y4m), capturing PNG" << std::endl;
+        }
+        else if (arg == "--capture-frames" && i + 1 < argc)
+            captureFrames = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--on-demand")
+            isOnDemand = true;
+        else if (arg == "--gpu-memory-json" && i + 1 < argc)
+            gpuMemoryJsonPath = argv[++i];
+        else if (arg == "--render-stats-csv" && i + 1 < argc)
+            renderStatsCsvPath = argv[++i];
+        else if (arg == "--check-allocations")
+            isAllocationCheck = true;
+        else if (arg == "--backend" && i + 1 < argc)
+        {
+            const std::string backend = argv[++i];
+            if (backend == "software")
+                ActiveRenderBackend = RenderBackend::SOFTWARE;
+            else if (backend != "opengl")
+                std::cout << "Unknown backend '" << backend << "' (opengl or software), using OpenGL" << std::endl;
+        }
+        else if (arg == "--scene-benchmark")
+            isSceneBenchmark = true;
+        else if (arg == "--frames" && i + 1 < argc)
+            sceneOptions.frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (arg == "--trace-frames" && i + 1 < argc)
+            traceFrames = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--replay" && i + 1 < argc)
+            replayOptions.filepath = argv[++i];
+        else if (arg == "--replay-strip-redundant")
+            replayOptions.isRedundantStateStripped = true;
+        else if (arg == "--replay-csv" && i + 1 < argc)
+            replayOptions.csvPath = argv[++i];
+    }
+
+    /* The replayer makes its own window and context, the size of the recorded ones */
+    if (!replayOptions.filepath.empty())
+        return TraceReplayer::Run(replayOptions);
+
+    sceneOptions.width = WindowWidth;
+    sceneOptions.height = WindowHeight;
+    sceneOptions.captureDirectory = captureDirectory;
+
+    /* No window nor GL context at all: the scenes render into the software rasterizer's color buffer */
+    if (IsSoftwareRendering())
+    {
+        JobSystem::Get().Initialize();
+        if (useAssetPack)
+            ResourceManager::Get().MountAssetPack("res/assets.pack");
+        SoftwareRasterizer::Get().Resize(WindowWidth, WindowHeight);
+
+        const int result = benchmark::RunScenes(sceneOptions);
+        JobSystem::Get().Shutdown();
+        ResourceManager::Get().Clear();
+        return result;
+    }
+
     GLFWwindow* window;
 
     /* Initialize the GLFW library */
     if (!glfwInit())
         return -1;
 
-    /* Set version to 3.3.x */
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    /* Ask for 4.3.x first (compute shaders and indirect draws for the GPU-driven path) */
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     /* Set profile to Core */
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    /* Benchmarks only need the context */
+    if (isBenchmarkRun || isSceneBenchmark)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow(WindowWidth, WindowHeight, "OpenGL Test", NULL, NULL);
     if (!window)
+    {
+        /* Fall back to 3.3.x, everything but the GPU-driven path works there */
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(WindowWidth, WindowHeight, "OpenGL Test", NULL, NULL);
+    }
+    if (!window)
     {
         glfwTerminate();
         return -1;
@@ -53,7 +203,13 @@ int main(void)
         return -1;
 
     std::cout << "[OpenGL Version] " << glGetString(GL_VERSION) << std::endl;
+
+    /* Recording from the very first call, so every object the traced frames use gets created in the trace */
+    if (!tracePath.empty())
+        GLTrace::Get().Start(tracePath, traceFrames, WindowWidth, WindowHeight);
 	
+    int exitCode = 0;
+
     /* Wrapping all this in a separate scope since OpenGL (`glGetError`) returns an error if there is no context */
     /* (Since `glfwTerminate` is being called at the end, which destroys the OpenGL context) */
     {
@@ -61,8 +217,53 @@ int main(void)
 		GL_CALL(glEnable(GL_BLEND));
 		GL_CALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 
+		/* Worker threads for CPU-side work (one per core, the main thread included) */
+		JobSystem::Get().Initialize();
+
+		if (isBenchmarkRun)
+		{
+			const int result = benchmark::Registry::Get().Run(benchmarkOptions);
+			JobSystem::Get().Shutdown();
+			glfwTerminate();
+			return result;
+		}
+
+		if (isSceneBenchmark)
+		{
+			if (useAssetPack)
+				ResourceManager::Get().MountAssetPack("res/assets.pack");
+
+			const int result = benchmark::RunScenes(sceneOptions);
+			JobSystem::Get().Shutdown();
+			ResourceManager::Get().Clear();
+			glfwTerminate();
+			return result;
+		}
+
+		/* Prefer the packed assets (if `--pack` was run), falling back to loose files in res/ */
+		if (useAssetPack)
+			ResourceManager::Get().MountAssetPack("res/assets.pack");
+
 		Renderer renderer;
 
+		/* Vsync, frame rate cap and frames in flight (its input callbacks go in before ImGui's, which chain to them) */
+		FramePacer framePacer(window);
+		framePacer.InstallInputCallbacks();
+		framePacer.SetOnDemand(isOnDemand && !isAllocationCheck);
+		if (isAllocationCheck)
+			framePacer.SetVsyncMode(VsyncMode::OFF);
+
+		/* Idle waits for events have to wake up for work handed back to the main thread */
+		JobSystem::Get().SetMainThreadWakeUp(glfwPostEmptyEvent);
+
+		/* Scenes render off-screen, at a resolution scaled to hold a GPU time budget, and get upscaled under ImGui */
+		DynamicResolution dynamicResolution(window);
+
+		/* Frame readback through pixel pack buffers, encoded on its own thread */
+		FrameCapture frameCapture(window);
+		if (!captureDirectory.empty())
+			frameCapture.Start(captureDirectory, captureFormat, captureFrames);
+
 		/* Create and setup ImGui context */
 		const char* glsl_version = "#version 330 core";
 		ImGui::CreateContext();
@@ -84,13 +285,66 @@ int main(void)
 		menu->RegisterTest<test::TestClearColor>("Clear color");
 		menu->RegisterTest<test::TestSquare>("Square");
 		menu->RegisterTest<test::TestSombrero>("Sombrero");
+		menu->RegisterTest<test::TestJobSystem>("Job system");
+		menu->RegisterTest<test::TestCulling>("Frustum culling");
+		menu->RegisterTest<test::TestGpuDriven>("GPU-driven rendering");
+		menu->RegisterTest<test::TestGeometryPool>("Geometry pool");
+		menu->RegisterTest<test::TestMeshImport>("Mesh import");
+		menu->RegisterTest<test::TestParticles>("GPU particles");
+		menu->RegisterTest<test::TestRenderGraph>("Render graph");
+
+		/* Cycles through every test above, expecting steady-state frames not to touch the heap */
+		std::unique_ptr<AllocationCheck> allocationCheck;
+		if (isAllocationCheck)
+			allocationCheck = std::make_unique<AllocationCheck>(*menu);
+
+		SimulationClock simulationClock;
+		JobCounter simulationCounter;
+		bool isSimulatedAhead = false; // Whether this frame's steps already ran on a worker during the last frame
+		float simulationAlpha = 0.0f;
 
 		/* Loop until the user closes the window */
 		while (!glfwWindowShouldClose(window))
 		{
+			/* Render on demand: skip (and sleep through) frames that would come out the same */
+			const bool isSceneChanging = currentTest->IsAnimating() || currentTest->ConsumeDirty() || frameCapture.IsBusy() || JobSystem::Get().HasMainThreadJobs();
+			if (!framePacer.WaitForWork(isSceneChanging))
+				continue;
+
+			framePacer.BeginFrame();
+
 			GL_CALL(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
 			renderer.Clear();
 
+			/* Run whatever the workers handed back to the thread owning the GL context */
+			JobSystem::Get().ProcessMainThreadJobs();
+
+			/* Simulate in fixed steps (or collect the steps simulated ahead), then hand a snapshot to the render side */
+			JobSystem::Get().Wait(simulationCounter);
+
+			/* Frame boundary: nothing runs on the workers, so last frame's transient memory can be taken back */
+			FrameArena::Get().Reset();
+			AllocationCounter::Get().EndFrame();
+
+			if (allocationCheck && !allocationCheck->OnFrameBoundary(currentTest))
+			{
+				exitCode = allocationCheck->GetFailedCount() > 0 ? 1 : 0;
+				break;
+			}
+
+			if (!isSimulatedAhead)
+			{
+				const int steps = simulationClock.Advance(glfwGetTime());
+				for (int i = 0; i < steps; i++)
+					currentTest->OnUpdate(simulationClock.GetFixedStep());
+				simulationAlpha = simulationClock.GetAlpha();
+			}
+
+			isSimulatedAhead = false;
+			currentTest->SetInterpolationAlpha(simulationAlpha);
+			currentTest->OnPublishRenderState();
+			const test::Test* publishedTest = currentTest;
+
 			// Start the Dear ImGui frame
 			ImGui_ImplOpenGL3_NewFrame();
 			ImGui_ImplGlfw_NewFrame();
@@ -98,42 +352,110 @@ int main(void)
 
 			if (currentTest)
 			{
-				currentTest->OnUpdate(0.0f);
-				currentTest->OnRender(renderer);
-				
+				/* ImGui may change (or switch) the test, which is safe as long as no simulation is running */
 				ImGui::Begin("Test");
 
 				if (currentTest != menu)
 				{
-					if (ImGui::Button("<-"))
+					/* The allocation check owns the test it's driving, closing it here would delete it under its feet */
+					if (allocationCheck)
+					{
+						ImGui::TextDisabled("Checking allocations...");
+					}
+					else if (ImGui::Button("<-"))
 					{
 						delete currentTest;
 						currentTest = menu;
+
+						/* Resources the test released stay cached for the next time it's opened, as long as they fit in the budget */
+						ResourceManager::Get().CollectGarbage();
+						GpuMemoryTracker::Get().SetScope("Application");
+						RenderStats::Get().SetScope("Application");
 					}
 
 					ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+					simulationClock.OnImGuiRender();
+					framePacer.OnImGuiRender();
+					dynamicResolution.OnImGuiRender();
+					frameCapture.OnImGuiRender();
+					GpuMemoryTracker::Get().OnImGuiRender();
+					RenderStats::Get().OnImGuiRender();
+					AllocationCounter::Get().OnImGuiRender();
 				}
 
 				currentTest->OnImGuiRender(io);	
 				
 				ImGui::End();
+
+				/* A test opened from ImGui hasn't published anything yet, so it would render from its default state */
+				if (currentTest != publishedTest)
+				{
+					currentTest->SetInterpolationAlpha(simulationAlpha);
+					currentTest->OnPublishRenderState();
+				}
+
+				/* Pipelined: the next frame gets simulated on a worker while this one is submitted from the published snapshot */
+				if (simulationClock.IsPipelined())
+				{
+					const int steps = simulationClock.Advance(glfwGetTime());
+					const float fixedStep = simulationClock.GetFixedStep();
+					test::Test* simulatedTest = currentTest;
+
+					JobSystem::Get().Run([simulatedTest, steps, fixedStep]()
+					{
+						for (int i = 0; i < steps; i++)
+							simulatedTest->OnUpdate(fixedStep);
+					}, &simulationCounter);
+
+					simulationAlpha = simulationClock.GetAlpha();
+					isSimulatedAhead = true;
+				}
+
+				dynamicResolution.BeginScene();
+				currentTest->OnRender(renderer);
+				dynamicResolution.EndScene();
+				frameCapture.OnSceneRendered();
 			}
 
 			/* Render ImGui window */
 			ImGui::Render();
 			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+			frameCapture.OnFrameRendered();
 
 			/* Swap front and back buffers */
-			glfwSwapBuffers(window);
+			framePacer.Present();
+			framePacer.EndFrame();
+			GpuMemoryTracker::Get().EndFrame();
+			RenderStats::Get().EndFrame();
+			GLTrace::Get().OnFrameEnd();
+
+			if (startupStart != std::chrono::steady_clock::time_point())
+			{
+				Log("Startup (until first frame) took " + std::to_string(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startupStart).count()) + " ms");
+				startupStart = std::chrono::steady_clock::time_point();
+			}
 
 			/* Poll for and process events */
 			glfwPollEvents();
 		}
 
 		/* Test Cleanup */
+		JobSystem::Get().Wait(simulationCounter);
 		delete currentTest;
 		if (currentTest != menu)
 			delete menu;
+
+		/* What's still alive here is cached by the resource manager or owned by the application (or leaked) */
+		if (!gpuMemoryJsonPath.empty() && !GpuMemoryTracker::Get().WriteJson(gpuMemoryJsonPath))
+			std::cout << "Failed to write " << gpuMemoryJsonPath << std::endl;
+		if (!renderStatsCsvPath.empty() && !RenderStats::Get().WriteSummaryCsv(renderStatsCsvPath))
+			std::cout << "Failed to write " << renderStatsCsvPath << std::endl;
+
+		/* Pending main thread jobs may still touch GL objects */
+		JobSystem::Get().Shutdown();
+
+		/* Cached resources hold GL objects, so they have to go before the context does */
+		ResourceManager::Get().Clear();
 	}
 
 	/* ImGui Cleanup */
@@ -141,6 +463,7 @@ int main(void)
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
 
+    GLTrace::Get().Stop();
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
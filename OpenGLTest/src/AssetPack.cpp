@@ -0,0 +1,176 @@
+#include "AssetPack.h"
+#include "GLHandleError.h"
+#include "Shader.h"
+#include "stb_image/stb_image.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+AssetPack::AssetPack(const std::string& filepath)
+	: m_File(filepath)
+{
+	if (!m_File.IsOpen() || m_File.GetSize() < sizeof(AssetPackHeader))
+		return;
+
+	const unsigned char* data = m_File.GetData();
+	const AssetPackHeader* header = (const AssetPackHeader*)data;
+
+	if (header->magic != AssetPackMagic || header->version != AssetPackVersion)
+	{
+		Log("Ignoring asset pack " + filepath + " (bad magic or version)");
+		return;
+	}
+
+	const std::size_t entriesOffset = sizeof(AssetPackHeader);
+	const std::size_t namesOffset = entriesOffset + header->entryCount * sizeof(AssetPackEntry);
+	if (namesOffset + header->nameTableSize > m_File.GetSize())
+		return;
+
+	const AssetPackEntry* entries = (const AssetPackEntry*)(data + entriesOffset);
+	const char* names = (const char*)(data + namesOffset);
+
+	for (uint32_t i = 0; i < header->entryCount; i++)
+	{
+		if (entries[i].offset + entries[i].size > m_File.GetSize())
+			continue;
+
+		/* The name has to end within the table */
+		const uint32_t nameOffset = entries[i].nameOffset;
+		if (nameOffset >= header->nameTableSize || !std::memchr(names + nameOffset, '\0', header->nameTableSize - nameOffset))
+			continue;
+
+		m_Index[names + entries[i].nameOffset] = &entries[i];
+	}
+}
+
+static int64_t GetLastWriteTime(const std::string& filepath)
+{
+	std::error_code error;
+	const auto time = std::filesystem::last_write_time(filepath, error);
+	return error ? 0 : (int64_t)time.time_since_epoch().count();
+}
+
+const AssetPackEntry* AssetPack::Find(const std::string& name) const
+{
+	auto it = m_Index.find(name);
+	if (it == m_Index.end())
+		return nullptr;
+
+	/* Loose files without a pack (shipped builds) are fine, edited ones win over their packed copy */
+	const int64_t sourceTime = GetLastWriteTime(name);
+	if (sourceTime != 0 && sourceTime != it->second->sourceTime)
+	{
+		Log("Asset pack entry " + name + " is stale (the file changed since it was packed), loading the file instead. Run --pack to rebuild it");
+		return nullptr;
+	}
+	return it->second;
+}
+
+static bool EndsWith(const std::string& value, const std::string& suffix)
+{
+	return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool AssetPack::Build(const std::string& outputPath, const std::vector<std::string>& filepaths)
+{
+	std::vector<AssetPackEntry> entries;
+	std::vector<std::vector<unsigned char>> blobs;
+	std::string names;
+
+	for (const std::string& filepath : filepaths)
+	{
+		AssetPackEntry entry = {};
+		std::vector<unsigned char> blob;
+
+		if (EndsWith(filepath, ".shader"))
+		{
+			ShaderProgramSource source = Shader::ParseShader(filepath);
+			if (!source.ComputeSource.empty())
+			{
+				Log("Skipping " + filepath + " (compute shaders are loaded from the loose file)");
+				continue;
+			}
+			if (!source.FeedbackVaryings.empty())
+			{
+				Log("Skipping " + filepath + " (transform feedback shaders are loaded from the loose file)");
+				continue;
+			}
+
+			entry.type = AssetType::SHADER;
+			entry.param0 = (uint32_t)source.VertexSource.size();
+			entry.param1 = (uint32_t)source.FragmentSource.size();
+
+			blob.insert(blob.end(), source.VertexSource.begin(), source.VertexSource.end());
+			blob.push_back('\0');
+			blob.insert(blob.end(), source.FragmentSource.begin(), source.FragmentSource.end());
+			blob.push_back('\0');
+		}
+		else if (EndsWith(filepath, ".png") || EndsWith(filepath, ".jpg"))
+		{
+			int width, height, bpp;
+			stbi_set_flip_vertically_on_load(1); // Same orientation `Texture` uploads
+			unsigned char* pixels = stbi_load(filepath.c_str(), &width, &height, &bpp, 4);
+			if (!pixels)
+			{
+				Log("Failed to decode " + filepath);
+				return false;
+			}
+
+			entry.type = AssetType::TEXTURE;
+			entry.param0 = (uint32_t)width;
+			entry.param1 = (uint32_t)height;
+
+			blob.assign(pixels, pixels + (std::size_t)width * height * 4);
+			stbi_image_free(pixels);
+		}
+		else
+		{
+			Log("Skipping " + filepath + " (unknown asset type)");
+			continue;
+		}
+
+		Log("Packing " + filepath + " (" + std::to_string(blob.size() / 1024) + " KB)");
+
+		entry.nameOffset = (uint32_t)names.size();
+		entry.size = blob.size();
+		entry.sourceTime = GetLastWriteTime(filepath);
+		names += filepath;
+		names.push_back('\0');
+
+		entries.push_back(entry);
+		blobs.push_back(std::move(blob));
+	}
+
+	AssetPackHeader header = { AssetPackMagic, AssetPackVersion, (uint32_t)entries.size(), (uint32_t)names.size() };
+
+	/* Lay out the blobs after the index, each one aligned */
+	uint64_t offset = sizeof(AssetPackHeader) + entries.size() * sizeof(AssetPackEntry) + names.size();
+	for (std::size_t i = 0; i < entries.size(); i++)
+	{
+		offset = (offset + AssetPackAlignment - 1) & ~(AssetPackAlignment - 1);
+		entries[i].offset = offset;
+		offset += entries[i].size;
+	}
+
+	std::ofstream stream(outputPath, std::ios::binary | std::ios::trunc);
+	if (!stream)
+	{
+		Log("Failed to open " + outputPath + " for writing");
+		return false;
+	}
+
+	stream.write((const char*)&header, sizeof(header));
+	stream.write((const char*)entries.data(), entries.size() * sizeof(AssetPackEntry));
+	stream.write(names.data(), names.size());
+
+	const char padding[AssetPackAlignment] = {};
+	for (std::size_t i = 0; i < entries.size(); i++)
+	{
+		stream.write(padding, entries[i].offset - (uint64_t)stream.tellp());
+		stream.write((const char*)blobs[i].data(), blobs[i].size());
+	}
+
+	Log("Wrote " + std::to_string(entries.size()) + " assets to " + outputPath + " (" + std::to_string((uint64_t)stream.tellp() / 1024) + " KB)");
+	return (bool)stream;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+
+/*
+ * Asset pack layout (little endian):
+ *   AssetPackHeader
+ *   AssetPackEntry[entryCount]
+ *   Name table (null-terminated paths, as used by the tests, e.g. "res/shaders/Basic.shader")
+ *   Blobs, each one starting on an AssetPackAlignment boundary
+ *
+ * Shader blob: vertex source, '\0', fragment source, '\0' (already split by `Shader::ParseShader`)
+ * Texture blob: RGBA8 pixels, bottom row first (already decoded and flipped for OpenGL)
+ */
+
+constexpr uint32_t AssetPackMagic = 0x50414C47; // "GLAP"
+constexpr uint32_t AssetPackVersion = 2;
+constexpr uint64_t AssetPackAlignment = 64;
+
+enum class AssetType : uint32_t
+{
+	SHADER = 0,
+	TEXTURE = 1
+};
+
+struct AssetPackHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t nameTableSize;
+};
+
+struct AssetPackEntry
+{
+	AssetType type;
+	uint32_t nameOffset; // Into the name table
+	uint64_t offset; // From the start of the file
+	uint64_t size;
+	uint32_t param0; // Shader: vertex source length - Texture: width
+	uint32_t param1; // Shader: fragment source length - Texture: height
+	int64_t sourceTime; // Last write time of the packed file, to tell when it was edited since
+};
+
+class AssetPack
+{
+private:
+	MappedFile m_File;
+	std::unordered_map<std::string, const AssetPackEntry*> m_Index;
+
+public:
+	AssetPack(const std::string& filepath);
+
+	inline bool IsValid() const { return !m_Index.empty(); }
+	inline std::size_t GetSize() const { return m_File.GetSize(); }
+
+	// Null when `name` isn't packed, or when the loose file was edited after packing (it's loaded from disk instead)
+	const AssetPackEntry* Find(const std::string& name) const;
+	inline const unsigned char* GetData(const AssetPackEntry& entry) const { return m_File.GetData() + entry.offset; }
+
+	// Offline packer: parses/decodes every file and writes them to a single pack
+	static bool Build(const std::string& outputPath, const std::vector<std::string>& filepaths);
+};
@@ -0,0 +1,157 @@
+#include "BuddyAllocator.h"
+#include "GLHandleError.h"
+
+#include <algorithm>
+
+static uint32_t RoundUpToPowerOfTwo(uint32_t value)
+{
+	uint32_t result = 1;
+	while (result < value)
+		result <<= 1;
+	return result;
+}
+
+static uint32_t Log2(uint32_t powerOfTwo)
+{
+	uint32_t result = 0;
+	while ((1u << result) < powerOfTwo)
+		result++;
+	return result;
+}
+
+BuddyAllocator::BuddyAllocator(uint32_t capacity, uint32_t minBlockSize)
+	: m_MinBlockSize(RoundUpToPowerOfTwo(minBlockSize)), m_MaxOrder(0), m_AllocatedSize(0), m_RequestedSize(0), m_AllocationCount(0)
+{
+	const uint32_t blockCount = RoundUpToPowerOfTwo((capacity + m_MinBlockSize - 1) / m_MinBlockSize);
+	m_MaxOrder = Log2(blockCount);
+
+	m_Orders.resize(blockCount);
+	m_IsFree.resize(blockCount);
+	m_RequestedSizes.resize(blockCount);
+	m_Next.resize(blockCount);
+	m_Previous.resize(blockCount);
+
+	Clear();
+}
+
+void BuddyAllocator::Clear()
+{
+	/* One free block covering everything */
+	m_FreeLists.assign(m_MaxOrder + 1, NoBlock);
+	std::fill(m_IsFree.begin(), m_IsFree.end(), (uint8_t)0);
+	PushFree(0, m_MaxOrder);
+
+	m_AllocatedSize = 0;
+	m_RequestedSize = 0;
+	m_AllocationCount = 0;
+}
+
+void BuddyAllocator::PushFree(uint32_t block, uint32_t order)
+{
+	m_Orders[block] = (uint8_t)order;
+	m_IsFree[block] = 1;
+	m_Previous[block] = NoBlock;
+	m_Next[block] = m_FreeLists[order];
+
+	if (m_FreeLists[order] != NoBlock)
+		m_Previous[m_FreeLists[order]] = block;
+	m_FreeLists[order] = block;
+}
+
+void BuddyAllocator::RemoveFree(uint32_t block, uint32_t order)
+{
+	if (m_Previous[block] != NoBlock)
+		m_Next[m_Previous[block]] = m_Next[block];
+	else
+		m_FreeLists[order] = m_Next[block];
+
+	if (m_Next[block] != NoBlock)
+		m_Previous[m_Next[block]] = m_Previous[block];
+
+	m_IsFree[block] = 0;
+}
+
+uint32_t BuddyAllocator::Allocate(uint32_t size)
+{
+	if (size == 0 || size > GetCapacity())
+		return InvalidOffset;
+
+	const uint32_t order = Log2(RoundUpToPowerOfTwo((size + m_MinBlockSize - 1) / m_MinBlockSize));
+
+	/* Smallest free block that fits */
+	uint32_t freeOrder = order;
+	while (freeOrder <= m_MaxOrder && m_FreeLists[freeOrder] == NoBlock)
+		freeOrder++;
+
+	if (freeOrder > m_MaxOrder)
+		return InvalidOffset;
+
+	const uint32_t block = m_FreeLists[freeOrder];
+	RemoveFree(block, freeOrder);
+
+	/* Split it down, the upper halves go back to the free lists */
+	while (freeOrder > order)
+	{
+		freeOrder--;
+		PushFree(block + (1u << freeOrder), freeOrder);
+	}
+
+	m_Orders[block] = (uint8_t)order;
+	m_RequestedSizes[block] = size;
+
+	m_AllocatedSize += m_MinBlockSize << order;
+	m_RequestedSize += size;
+	m_AllocationCount++;
+
+	return block * m_MinBlockSize;
+}
+
+void BuddyAllocator::Free(uint32_t offset)
+{
+	uint32_t block = offset / m_MinBlockSize;
+	ASSERT(offset % m_MinBlockSize == 0 && block < m_IsFree.size() && !m_IsFree[block]);
+
+	uint32_t order = m_Orders[block];
+	m_AllocatedSize -= m_MinBlockSize << order;
+	m_RequestedSize -= m_RequestedSizes[block];
+	m_AllocationCount--;
+
+	/* Merge with the buddy for as long as it is free and whole (not split into smaller blocks) */
+	while (order < m_MaxOrder)
+	{
+		const uint32_t buddy = block ^ (1u << order);
+		if (!m_IsFree[buddy] || m_Orders[buddy] != order)
+			break;
+
+		RemoveFree(buddy, order);
+		block = block < buddy ? block : buddy;
+		order++;
+	}
+
+	PushFree(block, order);
+}
+
+uint32_t BuddyAllocator::GetBlockSize(uint32_t offset) const
+{
+	return m_MinBlockSize << m_Orders[offset / m_MinBlockSize];
+}
+
+uint32_t BuddyAllocator::GetLargestFreeBlock() const
+{
+	for (uint32_t order = m_MaxOrder + 1; order-- > 0;)
+	{
+		if (m_FreeLists[order] != NoBlock)
+			return m_MinBlockSize << order;
+	}
+
+	return 0;
+}
+
+float BuddyAllocator::GetExternalFragmentation() const
+{
+	const uint32_t freeSize = GetFreeSize();
+	if (freeSize == 0)
+		return 0.0f;
+
+	return 1.0f - (float)GetLargestFreeBlock() / freeSize;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Buddy allocator over an abstract range of units (vertices, indices...), it never touches the memory it manages
+ * Blocks are power-of-two multiples of the minimum block: freeing merges a block with its buddy whenever both are
+ * free, so the free space coalesces back without any search
+ */
+class BuddyAllocator
+{
+public:
+	static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+private:
+	static constexpr uint32_t NoBlock = UINT32_MAX;
+
+	uint32_t m_MinBlockSize;
+	uint32_t m_MaxOrder; // Capacity is m_MinBlockSize << m_MaxOrder
+
+	/* Per minimum block, only meaningful at the first minimum block of every block */
+	std::vector<uint8_t> m_Orders;
+	std::vector<uint8_t> m_IsFree;
+	std::vector<uint32_t> m_RequestedSizes; // Of allocated blocks
+	std::vector<uint32_t> m_Next; // Free list links (doubly linked, so a buddy can be unlinked in O(1))
+	std::vector<uint32_t> m_Previous;
+
+	std::vector<uint32_t> m_FreeLists; // Per order, first free block or `NoBlock`
+
+	uint32_t m_AllocatedSize; // Sum of the allocated blocks
+	uint32_t m_RequestedSize; // Sum of what was asked for (the rest is internal fragmentation)
+	uint32_t m_AllocationCount;
+
+public:
+	// `capacity` and `minBlockSize` are rounded up to powers of two
+	BuddyAllocator(uint32_t capacity, uint32_t minBlockSize = 64);
+
+	// Offset of a block of at least `size` units, or `InvalidOffset` when no free block is large enough
+	uint32_t Allocate(uint32_t size);
+	void Free(uint32_t offset);
+	void Clear();
+
+	// Size of the block holding an allocation (its requested size rounded up to a power of two)
+	uint32_t GetBlockSize(uint32_t offset) const;
+	// Largest size `Allocate` would currently succeed with
+	uint32_t GetLargestFreeBlock() const;
+	// 0 when all the free space is one block, towards 1 as it splits into small blocks
+	float GetExternalFragmentation() const;
+
+	inline uint32_t GetCapacity() const { return m_MinBlockSize << m_MaxOrder; }
+	inline uint32_t GetAllocatedSize() const { return m_AllocatedSize; }
+	inline uint32_t GetRequestedSize() const { return m_RequestedSize; }
+	inline uint32_t GetFreeSize() const { return GetCapacity() - m_AllocatedSize; }
+	inline uint32_t GetAllocationCount() const { return m_AllocationCount; }
+
+private:
+	void PushFree(uint32_t block, uint32_t order);
+	void RemoveFree(uint32_t block, uint32_t order);
+};
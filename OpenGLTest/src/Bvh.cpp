@@ -0,0 +1,216 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <chrono>
+
+static AABB Union(const AABB& a, const AABB& b)
+{
+	return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+Bvh::Bvh()
+	: m_NeedsRefit(false), m_RefitCount(0)
+{
+}
+
+void Bvh::Build(const std::vector<AABB>& objectBounds, uint32_t maxLeafSize)
+{
+	const uint32_t objectCount = (uint32_t)objectBounds.size();
+	maxLeafSize = std::max(maxLeafSize, 1u);
+
+	m_Nodes.clear();
+	m_SlotObjects.resize(objectCount);
+	m_ObjectSlots.resize(objectCount);
+	m_SlotLeaves.resize(objectCount);
+	m_NeedsRefit = false;
+	m_RefitCount = 0;
+
+	for (uint32_t i = 0; i < objectCount; i++)
+		m_SlotObjects[i] = i;
+
+	if (objectCount == 0)
+	{
+		m_Bounds.Resize(0);
+		m_IsNodeDirty.clear();
+		return;
+	}
+
+	std::vector<glm::vec3> centroids(objectCount);
+	for (uint32_t i = 0; i < objectCount; i++)
+		centroids[i] = (objectBounds[i].min + objectBounds[i].max) * 0.5f;
+
+	m_Nodes.reserve(2 * objectCount / maxLeafSize + 1);
+	m_Nodes.push_back({ {}, 0, 0, 0, objectCount });
+
+	/* Top-down: split each node at the median centroid along its widest axis, until the leaves are small enough */
+	std::vector<uint32_t> stack = { 0 };
+	while (!stack.empty())
+	{
+		const uint32_t nodeIndex = stack.back();
+		stack.pop_back();
+
+		const uint32_t first = m_Nodes[nodeIndex].first;
+		const uint32_t count = m_Nodes[nodeIndex].count;
+
+		AABB bounds = objectBounds[m_SlotObjects[first]];
+		AABB centroidBounds = { centroids[m_SlotObjects[first]], centroids[m_SlotObjects[first]] };
+		for (uint32_t slot = first + 1; slot < first + count; slot++)
+		{
+			bounds = Union(bounds, objectBounds[m_SlotObjects[slot]]);
+			centroidBounds = Union(centroidBounds, { centroids[m_SlotObjects[slot]], centroids[m_SlotObjects[slot]] });
+		}
+		m_Nodes[nodeIndex].bounds = bounds;
+
+		if (count <= maxLeafSize)
+			continue;
+
+		const glm::vec3 size = centroidBounds.max - centroidBounds.min;
+		const int axis = size.x > size.y && size.x > size.z ? 0 : size.y > size.z ? 1 : 2;
+		const uint32_t half = count / 2;
+
+		std::nth_element(m_SlotObjects.begin() + first, m_SlotObjects.begin() + first + half, m_SlotObjects.begin() + first + count,
+			[&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+		const uint32_t left = (uint32_t)m_Nodes.size();
+		m_Nodes[nodeIndex].left = left;
+		m_Nodes.push_back({ {}, 0, nodeIndex, first, half });
+		m_Nodes.push_back({ {}, 0, nodeIndex, first + half, count - half });
+
+		stack.push_back(left + 1);
+		stack.push_back(left);
+	}
+
+	/* Objects are in their final slots now */
+	m_Bounds.Resize(objectCount);
+	for (uint32_t slot = 0; slot < objectCount; slot++)
+	{
+		m_ObjectSlots[m_SlotObjects[slot]] = slot;
+		m_Bounds.Set(slot, objectBounds[m_SlotObjects[slot]]);
+	}
+
+	for (uint32_t nodeIndex = 0; nodeIndex < m_Nodes.size(); nodeIndex++)
+	{
+		const Node& node = m_Nodes[nodeIndex];
+		if (node.left != 0)
+			continue;
+
+		for (uint32_t slot = node.first; slot < node.first + node.count; slot++)
+			m_SlotLeaves[slot] = nodeIndex;
+	}
+
+	m_IsNodeDirty.assign(m_Nodes.size(), 0);
+}
+
+void Bvh::UpdateBounds(uint32_t object, const AABB& bounds)
+{
+	const uint32_t slot = m_ObjectSlots[object];
+	m_Bounds.Set(slot, bounds);
+
+	/* Stop climbing at the first node that's already dirty, everything above it is too */
+	uint32_t nodeIndex = m_SlotLeaves[slot];
+	while (!m_IsNodeDirty[nodeIndex])
+	{
+		m_IsNodeDirty[nodeIndex] = 1;
+		if (nodeIndex == 0)
+			break;
+		nodeIndex = m_Nodes[nodeIndex].parent;
+	}
+
+	m_NeedsRefit = true;
+}
+
+void Bvh::Refit()
+{
+	if (!m_NeedsRefit)
+		return;
+
+	/* Backwards, so children are refit before their parents */
+	for (std::size_t i = m_Nodes.size(); i-- > 0;)
+	{
+		if (!m_IsNodeDirty[i])
+			continue;
+
+		Node& node = m_Nodes[i];
+		if (node.left == 0)
+		{
+			AABB bounds = m_Bounds.Get(node.first);
+			for (uint32_t slot = node.first + 1; slot < node.first + node.count; slot++)
+				bounds = Union(bounds, m_Bounds.Get(slot));
+			node.bounds = bounds;
+		}
+		else
+		{
+			node.bounds = Union(m_Nodes[node.left].bounds, m_Nodes[node.left + 1].bounds);
+		}
+
+		m_IsNodeDirty[i] = 0;
+	}
+
+	m_NeedsRefit = false;
+	m_RefitCount++;
+}
+
+void Bvh::Cull(const Frustum& frustum, std::vector<uint32_t>& visibleObjects, CullingStats& stats) const
+{
+	const auto start = std::chrono::steady_clock::now();
+	const std::size_t initialVisibleCount = visibleObjects.size();
+	stats.nodesVisited = 0;
+
+	if (!m_Nodes.empty())
+	{
+		/* Each entry carries the planes its parent wasn't already fully inside of */
+		struct Entry
+		{
+			uint32_t node;
+			uint32_t planeMask;
+		};
+
+		Entry stack[64];
+		int stackSize = 0;
+		stack[stackSize++] = { 0, 0x3F };
+
+		while (stackSize > 0)
+		{
+			Entry entry = stack[--stackSize];
+			const Node& node = m_Nodes[entry.node];
+			stats.nodesVisited++;
+
+			const Containment containment = frustum.Classify(node.bounds, entry.planeMask);
+			if (containment == Containment::OUTSIDE)
+				continue;
+
+			if (containment == Containment::INSIDE)
+			{
+				for (uint32_t slot = node.first; slot < node.first + node.count; slot++)
+					visibleObjects.push_back(m_SlotObjects[slot]);
+				continue;
+			}
+
+			if (node.left == 0)
+			{
+				m_Bounds.Cull(frustum, node.first, node.first + node.count, m_SlotObjects.data(), visibleObjects);
+				continue;
+			}
+
+			stack[stackSize++] = { node.left + 1, entry.planeMask };
+			stack[stackSize++] = { node.left, entry.planeMask };
+		}
+	}
+
+	stats.visibleCount = visibleObjects.size() - initialVisibleCount;
+	stats.culledCount = GetObjectCount() - stats.visibleCount;
+	stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Bvh::CullFlat(const Frustum& frustum, std::vector<uint32_t>& visibleObjects, CullingStats& stats) const
+{
+	const auto start = std::chrono::steady_clock::now();
+	const std::size_t initialVisibleCount = visibleObjects.size();
+
+	m_Bounds.Cull(frustum, 0, m_Bounds.GetCount(), m_SlotObjects.data(), visibleObjects);
+
+	stats.nodesVisited = 0;
+	stats.visibleCount = visibleObjects.size() - initialVisibleCount;
+	stats.culledCount = GetObjectCount() - stats.visibleCount;
+	stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Frustum.h"
+
+struct CullingStats
+{
+	std::size_t visibleCount = 0;
+	std::size_t culledCount = 0;
+	std::size_t nodesVisited = 0;
+	float milliseconds = 0.0f;
+};
+
+/*
+ * Bounding volume hierarchy over object boxes, for frustum culling
+ * Objects are reordered into slots so every node covers a contiguous slot range: whole subtrees are accepted without
+ * testing their objects, and leaves test theirs four at a time from `PackedBounds`
+ */
+class Bvh
+{
+private:
+	struct Node
+	{
+		AABB bounds;
+		uint32_t left; // Right child is left + 1, 0 for leaves (the root is never a child)
+		uint32_t parent;
+		uint32_t first; // Slot range covered by the node
+		uint32_t count;
+	};
+
+	std::vector<Node> m_Nodes; // Children always come after their parent
+	std::vector<uint32_t> m_SlotObjects; // Slot -> object
+	std::vector<uint32_t> m_ObjectSlots; // Object -> slot
+	std::vector<uint32_t> m_SlotLeaves; // Slot -> leaf node
+	PackedBounds m_Bounds; // Per slot
+	std::vector<uint8_t> m_IsNodeDirty;
+	bool m_NeedsRefit;
+	std::size_t m_RefitCount; // Refits since the last build (the tree gets looser as objects move)
+
+public:
+	Bvh();
+
+	void Build(const std::vector<AABB>& objectBounds, uint32_t maxLeafSize = 8);
+
+	// Moves an object: only its leaf and the nodes above are refit on the next `Refit`
+	void UpdateBounds(uint32_t object, const AABB& bounds);
+	void Refit();
+
+	// Appends the objects that intersect the frustum
+	void Cull(const Frustum& frustum, std::vector<uint32_t>& visibleObjects, CullingStats& stats) const;
+	// Same, testing every object (four at a time) without the hierarchy
+	void CullFlat(const Frustum& frustum, std::vector<uint32_t>& visibleObjects, CullingStats& stats) const;
+
+	inline std::size_t GetObjectCount() const { return m_SlotObjects.size(); }
+	inline std::size_t GetNodeCount() const { return m_Nodes.size(); }
+	inline std::size_t GetRefitCount() const { return m_RefitCount; }
+};
@@ -0,0 +1,158 @@
+#include "DynamicResolution.h"
+#include "GLHandleError.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+DynamicResolution::DynamicResolution(GLFWwindow* window)
+	: m_Window(window), m_IsOffscreen(true), m_IsDynamic(true), m_Samples(1), m_MaxSamples(1), m_IsLinearFilter(true),
+	m_TargetMilliseconds(8.0f), m_MinScale(0.5f), m_Scale(1.0f), m_ScreenWidth(0), m_ScreenHeight(0), m_SceneWidth(0), m_SceneHeight(0),
+	m_Queries(), m_IsQueryPending(), m_QueryIndex(0), m_IsQueryActive(false), m_GpuMilliseconds(0.0f)
+{
+	glfwGetFramebufferSize(m_Window, &m_ScreenWidth, &m_ScreenHeight);
+	m_MaxSamples = Framebuffer::GetMaxSamples();
+
+	FramebufferSpecification specification;
+	specification.width = m_ScreenWidth;
+	specification.height = m_ScreenHeight;
+	specification.samples = m_Samples;
+	m_Framebuffer = std::make_unique<Framebuffer>(specification);
+
+	GL_CALL(glGenQueries(QueryCount, m_Queries));
+}
+
+DynamicResolution::~DynamicResolution()
+{
+	GL_CALL(glDeleteQueries(QueryCount, m_Queries));
+}
+
+void DynamicResolution::BeginScene()
+{
+	ReadBackQueries();
+
+	/* Skip timing this frame rather than wait when the oldest result hasn't come back yet */
+	m_IsQueryActive = !m_IsQueryPending[m_QueryIndex];
+	if (m_IsQueryActive)
+	{
+		GL_CALL(glBeginQuery(GL_TIME_ELAPSED, m_Queries[m_QueryIndex]));
+	}
+
+	if (!m_IsOffscreen)
+		return;
+
+	glfwGetFramebufferSize(m_Window, &m_ScreenWidth, &m_ScreenHeight);
+	if (m_ScreenWidth == 0 || m_ScreenHeight == 0)
+		return; // Minimized
+
+	m_Framebuffer->Resize(m_ScreenWidth, m_ScreenHeight);
+	m_Framebuffer->SetSamples(m_Samples);
+
+	m_SceneWidth = std::max(1, (int)std::lround(m_ScreenWidth * m_Scale));
+	m_SceneHeight = std::max(1, (int)std::lround(m_ScreenHeight * m_Scale));
+
+	/* Scenes draw in normalized device coordinates, so the smaller viewport is all they see of the scale */
+	m_Framebuffer->Bind();
+	GL_CALL(glViewport(0, 0, m_SceneWidth, m_SceneHeight));
+	GL_CALL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
+}
+
+void DynamicResolution::EndScene()
+{
+	if (m_IsOffscreen && m_ScreenWidth > 0 && m_ScreenHeight > 0)
+	{
+		m_Framebuffer->Resolve(m_SceneWidth, m_SceneHeight);
+		m_Framebuffer->BlitToScreen(m_SceneWidth, m_SceneHeight, m_ScreenWidth, m_ScreenHeight, m_IsLinearFilter ? GL_LINEAR : GL_NEAREST);
+		GL_CALL(glViewport(0, 0, m_ScreenWidth, m_ScreenHeight));
+	}
+
+	/* The resolve and the upscale are part of what the scale pays for, so they're timed too */
+	if (m_IsQueryActive)
+	{
+		GL_CALL(glEndQuery(GL_TIME_ELAPSED));
+		m_IsQueryPending[m_QueryIndex] = true;
+		m_QueryIndex = (m_QueryIndex + 1) % QueryCount;
+		m_IsQueryActive = false;
+	}
+}
+
+void DynamicResolution::ReadBackQueries()
+{
+	/* Oldest first, stopping at the first one not ready since they complete in order */
+	for (int i = 0; i < QueryCount; i++)
+	{
+		const int index = (m_QueryIndex + i) % QueryCount;
+		if (!m_IsQueryPending[index])
+			continue;
+
+		int isAvailable = 0;
+		GL_CALL(glGetQueryObjectiv(m_Queries[index], GL_QUERY_RESULT_AVAILABLE, &isAvailable));
+		if (!isAvailable)
+			break;
+
+		GLuint64 nanoseconds = 0;
+		GL_CALL(glGetQueryObjectui64v(m_Queries[index], GL_QUERY_RESULT, &nanoseconds));
+		m_IsQueryPending[index] = false;
+
+		const float milliseconds = nanoseconds / 1000000.0f;
+		m_GpuMilliseconds = m_GpuMilliseconds == 0.0f ? milliseconds : m_GpuMilliseconds * 0.9f + milliseconds * 0.1f;
+		UpdateScale(milliseconds);
+	}
+}
+
+void DynamicResolution::UpdateScale(float gpuMilliseconds)
+{
+	if (!m_IsOffscreen || !m_IsDynamic || gpuMilliseconds <= 0.0f)
+		return;
+
+	/* Within 5% of the target is close enough, which keeps the scale from hunting around it */
+	const float ratio = m_TargetMilliseconds / gpuMilliseconds;
+	if (ratio > 0.95f && ratio < 1.05f)
+		return;
+
+	/* GPU time goes roughly with the pixel count, so the scale that fits is off by the square root of the ratio.
+	Only part of the way there: the measurement is a few frames behind the scale it was taken at */
+	const float fittingScale = m_Scale * std::sqrt(ratio);
+	m_Scale += (fittingScale - m_Scale) * 0.25f;
+	m_Scale = std::clamp(m_Scale, m_MinScale, 1.0f);
+}
+
+void DynamicResolution::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("Render target"))
+		return;
+
+	ImGui::Checkbox("Off-screen target", &m_IsOffscreen);
+	if (!m_IsOffscreen)
+	{
+		ImGui::Text("Scene GPU time %.3f ms", m_GpuMilliseconds);
+		return;
+	}
+
+	static const char* const sampleLabels[] = { "Off", "x2", "x4", "x8" };
+	ImGui::Text("MSAA");
+	for (int i = 0, samples = 1; samples <= std::min(m_MaxSamples, 8); i++, samples *= 2)
+	{
+		ImGui::SameLine();
+		ImGui::RadioButton(sampleLabels[i], &m_Samples, samples);
+	}
+
+	ImGui::Checkbox("Dynamic resolution", &m_IsDynamic);
+	if (m_IsDynamic)
+	{
+		ImGui::SliderFloat("Target GPU time (ms)", &m_TargetMilliseconds, 0.5f, 33.3f);
+		ImGui::SliderFloat("Min scale", &m_MinScale, 0.25f, 1.0f);
+		m_Scale = std::max(m_Scale, m_MinScale);
+	}
+	else
+	{
+		ImGui::SliderFloat("Scale", &m_Scale, 0.25f, 1.0f);
+	}
+	ImGui::Checkbox("Bilinear upscale", &m_IsLinearFilter);
+
+	ImGui::Text("Scene GPU time %.3f ms", m_GpuMilliseconds);
+	ImGui::Text("%d x %d (%.0f%%) upscaled to %d x %d", m_SceneWidth, m_SceneHeight, m_Scale * 100.0f, m_ScreenWidth, m_ScreenHeight);
+	ImGui::Text("Target memory %.1f MB", m_Framebuffer->GetGpuSize() / (1024.0f * 1024.0f));
+}
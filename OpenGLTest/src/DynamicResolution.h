@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Framebuffer.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <memory>
+
+/* Renders the scene into an off-screen target whose resolution follows a GPU time budget, then upscales it to the window */
+class DynamicResolution
+{
+private:
+	// Timer results come back a few frames late, one query per frame in flight avoids stalling on them
+	static constexpr int QueryCount = 4;
+
+	GLFWwindow* m_Window;
+	std::unique_ptr<Framebuffer> m_Framebuffer; // Window-sized, scaling only shrinks the viewport so nothing gets reallocated
+
+	bool m_IsOffscreen;
+	bool m_IsDynamic;
+	int m_Samples;
+	int m_MaxSamples;
+	bool m_IsLinearFilter;
+
+	float m_TargetMilliseconds; // Scene GPU time the scale is adjusted to hold
+	float m_MinScale;
+	float m_Scale; // Per axis, so the pixel count goes with its square
+
+	int m_ScreenWidth;
+	int m_ScreenHeight;
+	int m_SceneWidth;
+	int m_SceneHeight;
+
+	unsigned int m_Queries[QueryCount];
+	bool m_IsQueryPending[QueryCount];
+	int m_QueryIndex;
+	bool m_IsQueryActive;
+	float m_GpuMilliseconds; // Smoothed
+
+public:
+	DynamicResolution(GLFWwindow* window);
+	~DynamicResolution();
+
+	// Call before the scene renders: binds the target at the current scale and clears it
+	void BeginScene();
+	// Call after the scene renders and before ImGui: resolves, upscales to the window and updates the scale
+	void EndScene();
+
+	void OnImGuiRender();
+
+	inline float GetScale() const { return m_Scale; }
+
+private:
+	void ReadBackQueries();
+	void UpdateScale(float gpuMilliseconds);
+};
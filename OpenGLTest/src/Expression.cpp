@@ -0,0 +1,707 @@
+#include "Expression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+	#define EXPRESSION_SSE
+	#include <xmmintrin.h>
+#endif
+
+struct FunctionInfo
+{
+	const char* name;
+	ExpressionOp op;
+	int arity;
+};
+
+static const FunctionInfo Functions[] = {
+	{ "abs", ExpressionOp::ABS, 1 },
+	{ "sqrt", ExpressionOp::SQRT, 1 },
+	{ "floor", ExpressionOp::FLOOR, 1 },
+	{ "sin", ExpressionOp::SIN, 1 },
+	{ "cos", ExpressionOp::COS, 1 },
+	{ "tan", ExpressionOp::TAN, 1 },
+	{ "asin", ExpressionOp::ASIN, 1 },
+	{ "acos", ExpressionOp::ACOS, 1 },
+	{ "atan", ExpressionOp::ATAN, 1 },
+	{ "exp", ExpressionOp::EXP, 1 },
+	{ "log", ExpressionOp::LOG, 1 },
+	{ "sinc", ExpressionOp::SINC, 1 },
+	{ "pow", ExpressionOp::POW, 2 },
+	{ "min", ExpressionOp::MIN, 2 },
+	{ "max", ExpressionOp::MAX, 2 },
+	{ "atan2", ExpressionOp::ATAN2, 2 }
+};
+
+static float Sinc(float v)
+{
+	return std::abs(v) < 1e-4f ? 1.0f : std::sin(v) / v;
+}
+
+/* Reference semantics, used for folding: the batch evaluator and the generated GLSL have to agree with it */
+static float Apply(ExpressionOp op, float a, float b)
+{
+	switch (op)
+	{
+	case ExpressionOp::NEGATE: return -a;
+	case ExpressionOp::ABS: return std::abs(a);
+	case ExpressionOp::SQRT: return std::sqrt(a);
+	case ExpressionOp::FLOOR: return std::floor(a);
+	case ExpressionOp::SIN: return std::sin(a);
+	case ExpressionOp::COS: return std::cos(a);
+	case ExpressionOp::TAN: return std::tan(a);
+	case ExpressionOp::ASIN: return std::asin(a);
+	case ExpressionOp::ACOS: return std::acos(a);
+	case ExpressionOp::ATAN: return std::atan(a);
+	case ExpressionOp::EXP: return std::exp(a);
+	case ExpressionOp::LOG: return std::log(a);
+	case ExpressionOp::SINC: return Sinc(a);
+	case ExpressionOp::ADD: return a + b;
+	case ExpressionOp::SUB: return a - b;
+	case ExpressionOp::MUL: return a * b;
+	case ExpressionOp::DIV: return a / b;
+	case ExpressionOp::POW: return std::pow(a, b);
+	case ExpressionOp::MIN: return a < b ? a : b; // Same as minps: the second operand when either is NaN
+	case ExpressionOp::MAX: return a > b ? a : b;
+	case ExpressionOp::ATAN2: return std::atan2(a, b);
+	default: return 0.0f;
+	}
+}
+
+static int GetArity(ExpressionOp op)
+{
+	if (op <= ExpressionOp::Y)
+		return 0;
+	return op < ExpressionOp::ADD ? 1 : 2;
+}
+
+/* Recursive descent over the grammar below, building (and folding) the AST as it goes:
+	additive       := multiplicative (('+' | '-') multiplicative)*
+	multiplicative := unary (('*' | '/') unary)*
+	unary          := ('-' | '+') unary | power
+	power          := primary ('^' unary)?          (right associative: -x^2 is -(x^2), 2^-x works)
+	primary        := number | x | y | pi | e | function '(' additive (',' additive)* ')' | '(' additive ')' */
+class ExpressionParser
+{
+private:
+	static constexpr int MaxDepth = 200; // Nesting, so a wall of parentheses can't overflow the stack
+
+	const std::string& m_Text;
+	std::size_t m_Position;
+	std::vector<Expression::Node>& m_Nodes;
+	std::size_t m_ParsedNodeCount;
+	int m_Depth;
+	std::string m_Error;
+
+public:
+	ExpressionParser(const std::string& text, std::vector<Expression::Node>& nodes)
+		: m_Text(text), m_Position(0), m_Nodes(nodes), m_ParsedNodeCount(0), m_Depth(0)
+	{
+	}
+
+	// Root node, or -1 (see `GetError`)
+	int Parse()
+	{
+		const int root = ParseAdditive();
+		if (root < 0)
+			return -1;
+
+		SkipSpaces();
+		if (m_Position < m_Text.size())
+			return Fail("Unexpected '" + std::string(1, m_Text[m_Position]) + "'");
+
+		return root;
+	}
+
+	inline const std::string& GetError() const { return m_Error; }
+	inline std::size_t GetParsedNodeCount() const { return m_ParsedNodeCount; }
+
+private:
+	int Add(ExpressionOp op, int a = -1, int b = -1, float value = 0.0f)
+	{
+		m_ParsedNodeCount++;
+		return Expression::AddNode(m_Nodes, op, a, b, value);
+	}
+
+	int Fail(const std::string& message)
+	{
+		if (m_Error.empty())
+			m_Error = message + " at column " + std::to_string(std::min(m_Position, m_Text.size()) + 1);
+		return -1;
+	}
+
+	void SkipSpaces()
+	{
+		while (m_Position < m_Text.size() && std::isspace((unsigned char)m_Text[m_Position]))
+			m_Position++;
+	}
+
+	bool Accept(char c)
+	{
+		SkipSpaces();
+		if (m_Position < m_Text.size() && m_Text[m_Position] == c)
+		{
+			m_Position++;
+			return true;
+		}
+		return false;
+	}
+
+	int ParseAdditive()
+	{
+		if (++m_Depth > MaxDepth)
+			return Fail("Too deeply nested");
+
+		int left = ParseMultiplicative();
+		while (left >= 0)
+		{
+			if (Accept('+'))
+			{
+				const int right = ParseMultiplicative();
+				left = right < 0 ? -1 : Add(ExpressionOp::ADD, left, right);
+			}
+			else if (Accept('-'))
+			{
+				const int right = ParseMultiplicative();
+				left = right < 0 ? -1 : Add(ExpressionOp::SUB, left, right);
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		m_Depth--;
+		return left;
+	}
+
+	int ParseMultiplicative()
+	{
+		int left = ParseUnary();
+		while (left >= 0)
+		{
+			if (Accept('*'))
+			{
+				const int right = ParseUnary();
+				left = right < 0 ? -1 : Add(ExpressionOp::MUL, left, right);
+			}
+			else if (Accept('/'))
+			{
+				const int right = ParseUnary();
+				left = right < 0 ? -1 : Add(ExpressionOp::DIV, left, right);
+			}
+			else
+			{
+				break;
+			}
+		}
+		return left;
+	}
+
+	int ParseUnary()
+	{
+		if (++m_Depth > MaxDepth)
+			return Fail("Too deeply nested");
+
+		int result;
+		if (Accept('-'))
+		{
+			const int operand = ParseUnary();
+			result = operand < 0 ? -1 : Add(ExpressionOp::NEGATE, operand);
+		}
+		else if (Accept('+'))
+		{
+			result = ParseUnary();
+		}
+		else
+		{
+			result = ParsePower();
+		}
+
+		m_Depth--;
+		return result;
+	}
+
+	int ParsePower()
+	{
+		const int base = ParsePrimary();
+		if (base < 0 || !Accept('^'))
+			return base;
+
+		const int exponent = ParseUnary();
+		return exponent < 0 ? -1 : Add(ExpressionOp::POW, base, exponent);
+	}
+
+	int ParsePrimary()
+	{
+		SkipSpaces();
+		if (m_Position >= m_Text.size())
+			return Fail("Unexpected end of the expression");
+
+		const char c = m_Text[m_Position];
+
+		if (std::isdigit((unsigned char)c) || c == '.')
+		{
+			const char* start = m_Text.c_str() + m_Position;
+			char* end = nullptr;
+			const float value = std::strtof(start, &end);
+			if (end == start)
+				return Fail("Malformed number");
+
+			m_Position += end - start;
+			return Add(ExpressionOp::CONSTANT, -1, -1, value);
+		}
+
+		if (std::isalpha((unsigned char)c) || c == '_')
+		{
+			const std::size_t start = m_Position;
+			while (m_Position < m_Text.size() && (std::isalnum((unsigned char)m_Text[m_Position]) || m_Text[m_Position] == '_'))
+				m_Position++;
+			const std::string name = m_Text.substr(start, m_Position - start);
+
+			if (name == "x")
+				return Add(ExpressionOp::X);
+			if (name == "y")
+				return Add(ExpressionOp::Y);
+			if (name == "pi")
+				return Add(ExpressionOp::CONSTANT, -1, -1, 3.14159265358979f);
+			if (name == "e")
+				return Add(ExpressionOp::CONSTANT, -1, -1, 2.71828182845905f);
+
+			for (const FunctionInfo& function : Functions)
+			{
+				if (name != function.name)
+					continue;
+
+				if (!Accept('('))
+					return Fail("Expected '(' after " + name);
+
+				int arguments[2] = { -1, -1 };
+				for (int i = 0; i < function.arity; i++)
+				{
+					if (i > 0 && !Accept(','))
+						return Fail(name + " takes " + std::to_string(function.arity) + " arguments");
+
+					arguments[i] = ParseAdditive();
+					if (arguments[i] < 0)
+						return -1;
+				}
+
+				if (!Accept(')'))
+					return Fail(name + " takes " + std::to_string(function.arity) + (function.arity == 1 ? " argument" : " arguments"));
+
+				return Add(function.op, arguments[0], arguments[1]);
+			}
+
+			m_Position = start;
+			return Fail("Unknown name '" + name + "' (variables are x and y)");
+		}
+
+		if (Accept('('))
+		{
+			const int inner = ParseAdditive();
+			if (inner < 0)
+				return -1;
+			if (!Accept(')'))
+				return Fail("Expected ')'");
+			return inner;
+		}
+
+		return Fail("Unexpected '" + std::string(1, c) + "'");
+	}
+};
+
+Expression::Expression()
+	: m_Root(0), m_ParsedNodeCount(1), m_RegisterCount(1)
+{
+	m_Source = "0";
+	m_Nodes.push_back({ ExpressionOp::CONSTANT, 0.0f, { -1, -1 } });
+	m_Program.push_back({ ExpressionOp::CONSTANT, 0, { 0, 0 }, 0.0f });
+}
+
+Expression::Expression(const std::string& source)
+	: Expression()
+{
+	Compile(source);
+}
+
+bool Expression::Compile(const std::string& source)
+{
+	std::vector<Node> nodes;
+	ExpressionParser parser(source, nodes);
+
+	const int parsedRoot = parser.Parse();
+	if (parsedRoot < 0)
+	{
+		m_Error = parser.GetError();
+		return false;
+	}
+
+	std::vector<Node> compacted;
+	std::vector<int> remap(nodes.size(), -1);
+	const int root = Compact(nodes, parsedRoot, compacted, remap);
+
+	const int registerCount = CountRegisters(compacted, root);
+	if (registerCount > MaxRegisters)
+	{
+		m_Error = "Too complex: needs " + std::to_string(registerCount) + " registers, the evaluator has " + std::to_string(MaxRegisters);
+		return false;
+	}
+
+	std::vector<Instruction> program;
+	Emit(compacted, root, 0, program);
+
+	m_Source = source;
+	m_Nodes = std::move(compacted);
+	m_Root = root;
+	m_ParsedNodeCount = parser.GetParsedNodeCount();
+	m_Program = std::move(program);
+	m_RegisterCount = registerCount;
+	m_Error.clear();
+	return true;
+}
+
+int Expression::AddNode(std::vector<Node>& nodes, ExpressionOp op, int a, int b, float value)
+{
+	const int arity = GetArity(op);
+	auto IsConstant = [](const std::vector<Node>& nodes, int node, float value) { return nodes[node].op == ExpressionOp::CONSTANT && nodes[node].value == value; };
+
+	if (arity > 0)
+	{
+		/* Constant operands: evaluate it now */
+		const bool isAConstant = nodes[a].op == ExpressionOp::CONSTANT;
+		const bool isBConstant = arity < 2 || nodes[b].op == ExpressionOp::CONSTANT;
+		if (isAConstant && isBConstant)
+			return AddNode(nodes, ExpressionOp::CONSTANT, -1, -1, Apply(op, nodes[a].value, arity < 2 ? 0.0f : nodes[b].value));
+
+		/* Identities and cheaper equivalents, matching the unfolded result for every input, NaN and infinity included, except:
+		the sign of a zero result (x + 0 and 0 + x give -0 for x = -0, 0 - x gives -0 for x = 0, x^0.5 gives -0 for x = -0,
+		where pow gives +0) and x^0.5 for x = -inf, NaN instead of pow's +inf. Neither shows on a plot */
+		switch (op)
+		{
+		case ExpressionOp::NEGATE:
+			if (nodes[a].op == ExpressionOp::NEGATE)
+				return nodes[a].operands[0];
+			break;
+		case ExpressionOp::ADD:
+			if (IsConstant(nodes, b, 0.0f))
+				return a;
+			if (IsConstant(nodes, a, 0.0f))
+				return b;
+			break;
+		case ExpressionOp::SUB:
+			if (IsConstant(nodes, b, 0.0f))
+				return a;
+			if (IsConstant(nodes, a, 0.0f))
+				return AddNode(nodes, ExpressionOp::NEGATE, b);
+			break;
+		case ExpressionOp::MUL:
+			if (IsConstant(nodes, b, 1.0f))
+				return a;
+			if (IsConstant(nodes, a, 1.0f))
+				return b;
+			if (IsConstant(nodes, b, -1.0f))
+				return AddNode(nodes, ExpressionOp::NEGATE, a);
+			if (IsConstant(nodes, a, -1.0f))
+				return AddNode(nodes, ExpressionOp::NEGATE, b);
+			break;
+		case ExpressionOp::DIV:
+			if (IsConstant(nodes, b, 1.0f))
+				return a;
+			break;
+		case ExpressionOp::POW:
+			/* Squares are everywhere in plotted functions (x^2 + y^2), and a multiply beats pow by far */
+			if (IsConstant(nodes, b, 1.0f))
+				return a;
+			if (IsConstant(nodes, b, 2.0f))
+				return AddNode(nodes, ExpressionOp::MUL, a, a);
+			if (IsConstant(nodes, b, 0.5f))
+				return AddNode(nodes, ExpressionOp::SQRT, a);
+			if (IsConstant(nodes, b, -1.0f))
+				return AddNode(nodes, ExpressionOp::DIV, AddNode(nodes, ExpressionOp::CONSTANT, -1, -1, 1.0f), a);
+			break;
+		default:
+			break;
+		}
+	}
+
+	nodes.push_back({ op, value, { a, b } });
+	return (int)nodes.size() - 1;
+}
+
+int Expression::Compact(const std::vector<Node>& nodes, int node, std::vector<Node>& output, std::vector<int>& remap)
+{
+	if (remap[node] >= 0)
+		return remap[node]; // Shared (x^2 became x * x)
+
+	Node copy = nodes[node];
+	for (int i = 0; i < GetArity(copy.op); i++)
+		copy.operands[i] = Compact(nodes, copy.operands[i], output, remap);
+
+	output.push_back(copy);
+	remap[node] = (int)output.size() - 1;
+	return remap[node];
+}
+
+int Expression::CountRegisters(const std::vector<Node>& nodes, int node)
+{
+	/* Sethi-Ullman: evaluating the hungrier operand first, the other one only needs what's left plus the held result */
+	const Node& n = nodes[node];
+	const int arity = GetArity(n.op);
+
+	if (arity == 0)
+		return 1;
+	if (arity == 1 || n.operands[0] == n.operands[1])
+		return CountRegisters(nodes, n.operands[0]);
+
+	const int a = CountRegisters(nodes, n.operands[0]);
+	const int b = CountRegisters(nodes, n.operands[1]);
+	return a == b ? a + 1 : std::max(a, b);
+}
+
+void Expression::Emit(const std::vector<Node>& nodes, int node, int destination, std::vector<Instruction>& program)
+{
+	/* The result goes to `destination`, registers above it are free to use */
+	const Node& n = nodes[node];
+	const uint8_t d = (uint8_t)destination;
+
+	switch (GetArity(n.op))
+	{
+	case 0:
+		program.push_back({ n.op, d, { d, d }, n.value });
+		return;
+	case 1:
+		Emit(nodes, n.operands[0], destination, program);
+		program.push_back({ n.op, d, { d, d }, 0.0f });
+		return;
+	}
+
+	if (n.operands[0] == n.operands[1])
+	{
+		Emit(nodes, n.operands[0], destination, program);
+		program.push_back({ n.op, d, { d, d }, 0.0f });
+		return;
+	}
+
+	if (CountRegisters(nodes, n.operands[0]) >= CountRegisters(nodes, n.operands[1]))
+	{
+		Emit(nodes, n.operands[0], destination, program);
+		Emit(nodes, n.operands[1], destination + 1, program);
+		program.push_back({ n.op, d, { d, (uint8_t)(d + 1) }, 0.0f });
+	}
+	else
+	{
+		Emit(nodes, n.operands[1], destination, program);
+		Emit(nodes, n.operands[0], destination + 1, program);
+		program.push_back({ n.op, d, { (uint8_t)(d + 1), d }, 0.0f });
+	}
+}
+
+void Expression::Evaluate(const float* x, const float* y, float* z, std::size_t count) const
+{
+	alignas(16) float registers[MaxRegisters][BatchSize];
+
+	for (std::size_t first = 0; first < count; first += BatchSize)
+	{
+		const std::size_t batchCount = std::min(BatchSize, count - first);
+		const std::size_t width = (batchCount + 3) & ~(std::size_t)3; // Whole SIMD vectors, the padding lanes are zero
+
+		for (const Instruction& instruction : m_Program)
+		{
+			float* d = registers[instruction.destination];
+			const float* a = registers[instruction.operands[0]];
+			const float* b = registers[instruction.operands[1]];
+
+			switch (instruction.op)
+			{
+			case ExpressionOp::CONSTANT:
+				std::fill(d, d + width, instruction.value);
+				break;
+			case ExpressionOp::X:
+				std::copy(x + first, x + first + batchCount, d);
+				std::fill(d + batchCount, d + width, 0.0f);
+				break;
+			case ExpressionOp::Y:
+				std::copy(y + first, y + first + batchCount, d);
+				std::fill(d + batchCount, d + width, 0.0f);
+				break;
+#ifdef EXPRESSION_SSE
+			case ExpressionOp::NEGATE:
+			{
+				const __m128 signMask = _mm_set1_ps(-0.0f);
+				for (std::size_t i = 0; i < width; i += 4)
+					_mm_store_ps(d + i, _mm_xor_ps(_mm_load_ps(a + i), signMask));
+				break;
+			}
+			case ExpressionOp::ABS:
+			{
+				const __m128 signMask = _mm_set1_ps(-0.0f);
+				for (std::size_t i = 0; i < width; i += 4)
+					_mm_store_ps(d + i, _mm_andnot_ps(signMask, _mm_load_ps(a + i)));
+				break;
+			}
+			case ExpressionOp::SQRT:
+				for (std::size_t i = 0; i < width; i += 4)
+					_mm_store_ps(d + i, _mm_sqrt_ps(_mm_load_ps(a + i)));
+				break;
+			case ExpressionOp::ADD:
+				for (std::size_t i = 0; i < width; i += 4)
+					_mm_store_ps(d + i, _mm_add_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+				break;
+			case ExpressionOp::SUB:
+				for (std::size_t i = 0; i < width; i += 4)
+					_mm_store_ps(d + i, _mm_sub_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+				break;
+			case ExpressionOp::MUL:
+				for (std::size_t i = 0; i < width; i += 4)
+					_mm_store_ps(d + i, _mm_mul_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+				break;
+			case ExpressionOp::DIV:
+				for (std::size_t i = 0; i < width; i += 4)
+					_mm_store_ps(d + i, _mm_div_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+				break;
+			case ExpressionOp::MIN:
+				for (std::size_t i = 0; i < width; i += 4)
+					_mm_store_ps(d + i, _mm_min_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+				break;
+			case ExpressionOp::MAX:
+				for (std::size_t i = 0; i < width; i += 4)
+					_mm_store_ps(d + i, _mm_max_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+				break;
+#endif
+			/* Transcendentals: plain loops over the batch, which the compiler can vectorize with its math library */
+			case ExpressionOp::SIN:
+				for (std::size_t i = 0; i < width; i++)
+					d[i] = std::sin(a[i]);
+				break;
+			case ExpressionOp::COS:
+				for (std::size_t i = 0; i < width; i++)
+					d[i] = std::cos(a[i]);
+				break;
+			case ExpressionOp::SINC:
+				for (std::size_t i = 0; i < width; i++)
+					d[i] = Sinc(a[i]);
+				break;
+			default:
+				for (std::size_t i = 0; i < width; i++)
+					d[i] = Apply(instruction.op, a[i], b[i]);
+				break;
+			}
+		}
+
+		std::copy(registers[0], registers[0] + batchCount, z + first);
+	}
+}
+
+float Expression::Evaluate(float x, float y) const
+{
+	float z;
+	Evaluate(&x, &y, &z, 1);
+	return z;
+}
+
+static void AppendConstant(float value, std::string& output)
+{
+	/* GLSL has no literal for these */
+	if (std::isnan(value))
+	{
+		output += "uintBitsToFloat(0x7FC00000u)";
+		return;
+	}
+	if (std::isinf(value))
+	{
+		output += value > 0.0f ? "uintBitsToFloat(0x7F800000u)" : "uintBitsToFloat(0xFF800000u)";
+		return;
+	}
+
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.9g", value); // Round-trips a float
+	if (!std::strpbrk(buffer, ".e"))
+		std::strcat(buffer, ".0");
+
+	if (value < 0.0f)
+		output += "(" + std::string(buffer) + ")";
+	else
+		output += buffer;
+}
+
+void Expression::AppendGlsl(int node, std::string& output) const
+{
+	const Node& n = m_Nodes[node];
+
+	const char* symbol = nullptr;
+	const char* function = nullptr;
+	switch (n.op)
+	{
+	case ExpressionOp::CONSTANT: AppendConstant(n.value, output); return;
+	case ExpressionOp::X: output += "x"; return;
+	case ExpressionOp::Y: output += "y"; return;
+	case ExpressionOp::NEGATE: output += "(-"; AppendGlsl(n.operands[0], output); output += ")"; return;
+	case ExpressionOp::ADD: symbol = " + "; break;
+	case ExpressionOp::SUB: symbol = " - "; break;
+	case ExpressionOp::MUL: symbol = " * "; break;
+	case ExpressionOp::DIV: symbol = " / "; break;
+	case ExpressionOp::ABS: function = "abs"; break;
+	case ExpressionOp::SQRT: function = "sqrt"; break;
+	case ExpressionOp::FLOOR: function = "floor"; break;
+	case ExpressionOp::SIN: function = "sin"; break;
+	case ExpressionOp::COS: function = "cos"; break;
+	case ExpressionOp::TAN: function = "tan"; break;
+	case ExpressionOp::ASIN: function = "asin"; break;
+	case ExpressionOp::ACOS: function = "acos"; break;
+	case ExpressionOp::ATAN: function = "atan"; break;
+	case ExpressionOp::EXP: function = "exp"; break;
+	case ExpressionOp::LOG: function = "log"; break;
+	case ExpressionOp::SINC: function = "plotSinc"; break;
+	case ExpressionOp::POW: function = "plotPow"; break;
+	case ExpressionOp::MIN: function = "plotMin"; break;
+	case ExpressionOp::MAX: function = "plotMax"; break;
+	case ExpressionOp::ATAN2: function = "atan"; break; // atan(y, x) in GLSL
+	}
+
+	if (symbol)
+	{
+		output += "(";
+		AppendGlsl(n.operands[0], output);
+		output += symbol;
+		AppendGlsl(n.operands[1], output);
+		output += ")";
+		return;
+	}
+
+	output += function;
+	output += "(";
+	AppendGlsl(n.operands[0], output);
+	if (GetArity(n.op) == 2)
+	{
+		output += ", ";
+		AppendGlsl(n.operands[1], output);
+	}
+	output += ")";
+}
+
+std::string Expression::GenerateGlsl(const std::string& functionName) const
+{
+	/* Helpers matching the CPU side where GLSL leaves things undefined (pow of a negative base, min/max of NaN) */
+	std::string glsl =
+		"float plotSinc(float v) { return abs(v) < 1e-4 ? 1.0 : sin(v) / v; }\n"
+		"float plotPow(float a, float b)\n"
+		"{\n"
+		"    if (a >= 0.0 || floor(b) != b)\n"
+		"        return pow(a, b);\n"
+		"    float p = pow(-a, b);\n"
+		"    return mod(b, 2.0) == 0.0 ? p : -p;\n"
+		"}\n"
+		"float plotMin(float a, float b) { return a < b ? a : b; }\n"
+		"float plotMax(float a, float b) { return a > b ? a : b; }\n";
+
+	glsl += "float " + functionName + "(float x, float y)\n{\n    return ";
+	AppendGlsl(m_Root, glsl);
+	glsl += ";\n}\n";
+	return glsl;
+}
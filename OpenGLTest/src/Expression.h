@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class ExpressionOp : uint8_t
+{
+	/* Leaves */
+	CONSTANT = 0,
+	X,
+	Y,
+
+	/* Unary */
+	NEGATE,
+	ABS,
+	SQRT,
+	FLOOR,
+	SIN,
+	COS,
+	TAN,
+	ASIN,
+	ACOS,
+	ATAN,
+	EXP,
+	LOG,
+	SINC, // sin(v) / v, 1 around 0
+
+	/* Binary */
+	ADD,
+	SUB,
+	MUL,
+	DIV,
+	POW,
+	MIN,
+	MAX,
+	ATAN2
+};
+
+/* z = f(x, y) typed in at runtime: parsed into a constant-folded AST, compiled to register bytecode that runs over batches
+of points (SSE where there is an instruction for it), and translated to an equivalent GLSL function for the GPU */
+class Expression
+{
+public:
+	static constexpr std::size_t BatchSize = 64; // Points per register, a multiple of the SIMD width
+	static constexpr int MaxRegisters = 16;
+
+private:
+	struct Node
+	{
+		ExpressionOp op;
+		float value; // CONSTANT only
+		int operands[2];
+	};
+
+	struct Instruction
+	{
+		ExpressionOp op;
+		uint8_t destination;
+		uint8_t operands[2];
+		float value; // CONSTANT only (broadcast to the destination)
+	};
+
+	std::string m_Source;
+	std::vector<Node> m_Nodes;
+	int m_Root;
+	std::size_t m_ParsedNodeCount; // Before folding (`m_Nodes` only keeps what's left after)
+	std::vector<Instruction> m_Program;
+	int m_RegisterCount;
+	std::string m_Error;
+
+public:
+	// Starts out as f(x, y) = 0
+	Expression();
+	Expression(const std::string& source);
+
+	// On failure the previous function is kept and `GetError` says what's wrong (and where)
+	bool Compile(const std::string& source);
+
+	// z[i] = f(x[i], y[i])
+	void Evaluate(const float* x, const float* y, float* z, std::size_t count) const;
+	float Evaluate(float x, float y) const;
+
+	// A GLSL function `float functionName(float x, float y)` (plus the helpers it calls) computing the same thing
+	std::string GenerateGlsl(const std::string& functionName = "plotFunction") const;
+
+	inline const std::string& GetSource() const { return m_Source; }
+	inline const std::string& GetError() const { return m_Error; }
+	inline bool IsConstant() const { return m_Nodes[m_Root].op == ExpressionOp::CONSTANT; }
+	inline std::size_t GetParsedNodeCount() const { return m_ParsedNodeCount; }
+	inline std::size_t GetNodeCount() const { return m_Nodes.size(); }
+	inline std::size_t GetInstructionCount() const { return m_Program.size(); }
+	inline int GetRegisterCount() const { return m_RegisterCount; }
+
+private:
+	friend class ExpressionParser;
+
+	// Folds the node away when its operands are constant (or it's a no-op like `v * 1`), returns its index
+	static int AddNode(std::vector<Node>& nodes, ExpressionOp op, int a = -1, int b = -1, float value = 0.0f);
+	// Copies what `node` still refers to into `output`, dropping the nodes folding left behind
+	static int Compact(const std::vector<Node>& nodes, int node, std::vector<Node>& output, std::vector<int>& remap);
+	static int CountRegisters(const std::vector<Node>& nodes, int node);
+	static void Emit(const std::vector<Node>& nodes, int node, int destination, std::vector<Instruction>& program);
+	void AppendGlsl(int node, std::string& output) const;
+};
@@ -0,0 +1,43 @@
+#include "FrameArena.h"
+
+#include <new>
+
+FrameArena::FrameArena()
+	: m_Memory(new unsigned char[DefaultCapacity]), m_Capacity(DefaultCapacity), m_Offset(0), m_OverflowCount(0), m_LastFrameBytes(0), m_PeakBytes(0),
+	m_LastFrameOverflows(0), m_TotalOverflows(0)
+{
+}
+
+FrameArena& FrameArena::Get()
+{
+	static FrameArena instance;
+	return instance;
+}
+
+void* FrameArena::Allocate(std::size_t size)
+{
+	const std::size_t alignedSize = (std::max<std::size_t>(size, 1) + Alignment - 1) & ~(Alignment - 1);
+	const std::size_t offset = m_Offset.fetch_add(alignedSize, std::memory_order_relaxed);
+
+	if (offset + alignedSize <= m_Capacity)
+		return m_Memory.get() + offset;
+
+	m_OverflowCount.fetch_add(1, std::memory_order_relaxed);
+	return ::operator new(size);
+}
+
+void FrameArena::Free(void* pointer)
+{
+	if (pointer && !Owns(pointer))
+		::operator delete(pointer);
+}
+
+void FrameArena::Reset()
+{
+	m_LastFrameBytes = GetUsedBytes();
+	m_PeakBytes = std::max(m_PeakBytes, m_LastFrameBytes);
+	m_LastFrameOverflows = m_OverflowCount.exchange(0, std::memory_order_relaxed);
+	m_TotalOverflows += m_LastFrameOverflows;
+
+	m_Offset.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* Bump allocator for memory that only lives until the end of the frame: allocating is an atomic add, freeing does nothing
+and `Reset` (at the frame boundary, while no job is running) takes everything back at once */
+class FrameArena
+{
+private:
+	static constexpr std::size_t Alignment = 16;
+	static constexpr std::size_t DefaultCapacity = 8 * 1024 * 1024;
+
+	std::unique_ptr<unsigned char[]> m_Memory;
+	std::size_t m_Capacity;
+	std::atomic<std::size_t> m_Offset; // Keeps growing past the capacity once full, so later allocations overflow too
+
+	std::atomic<uint64_t> m_OverflowCount; // Allocations that didn't fit and went to the heap (this frame)
+	std::size_t m_LastFrameBytes;
+	std::size_t m_PeakBytes;
+	uint64_t m_LastFrameOverflows;
+	uint64_t m_TotalOverflows;
+
+	FrameArena();
+
+public:
+	static FrameArena& Get();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	// Never fails: once the arena is full it falls back to the heap (which shows in the overflow count)
+	void* Allocate(std::size_t size);
+	// Only heap fallbacks actually get freed, arena memory waits for `Reset`
+	void Free(void* pointer);
+
+	// Everything allocated since the last reset becomes invalid
+	void Reset();
+
+	inline bool Owns(const void* pointer) const { return pointer >= m_Memory.get() && pointer < m_Memory.get() + m_Capacity; }
+
+	inline std::size_t GetCapacity() const { return m_Capacity; }
+	inline std::size_t GetUsedBytes() const { return std::min(m_Offset.load(std::memory_order_relaxed), m_Capacity); }
+	inline std::size_t GetLastFrameBytes() const { return m_LastFrameBytes; }
+	inline std::size_t GetPeakBytes() const { return m_PeakBytes; }
+	inline uint64_t GetLastFrameOverflows() const { return m_LastFrameOverflows; }
+	inline uint64_t GetTotalOverflows() const { return m_TotalOverflows; }
+};
+
+/* STL allocator over the frame arena, for containers that don't outlive the frame */
+template <typename T>
+class FrameAllocator
+{
+public:
+	using value_type = T;
+
+	FrameAllocator() noexcept = default;
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+	T* allocate(std::size_t count)
+	{
+		static_assert(alignof(T) <= 16, "The frame arena only aligns to 16 bytes");
+		return static_cast<T*>(FrameArena::Get().Allocate(count * sizeof(T)));
+	}
+
+	void deallocate(T* pointer, std::size_t count) noexcept { FrameArena::Get().Free(pointer); }
+
+	template <typename U>
+	bool operator==(const FrameAllocator<U>&) const noexcept { return true; }
+	template <typename U>
+	bool operator!=(const FrameAllocator<U>&) const noexcept { return false; }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
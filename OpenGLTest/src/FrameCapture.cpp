@@ -0,0 +1,610 @@
+#include "FrameCapture.h"
+#include "GLHandleError.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+/* PNG (stored, uncompressed deflate: the encoder has to keep up with the frame rate, not save disk space) */
+
+static uint32_t Crc32(const uint8_t* data, std::size_t size, uint32_t crc = 0)
+{
+	static const auto table = []()
+	{
+		std::vector<uint32_t> table(256);
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t value = i;
+			for (int bit = 0; bit < 8; bit++)
+				value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+			table[i] = value;
+		}
+		return table;
+	}();
+
+	crc = ~crc;
+	for (std::size_t i = 0; i < size; i++)
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static uint32_t Adler32(const uint8_t* data, std::size_t size)
+{
+	/* 5552 is the most bytes that can be summed before the 32-bit sums could overflow */
+	uint32_t a = 1, b = 0;
+	while (size > 0)
+	{
+		const std::size_t count = std::min<std::size_t>(size, 5552);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			a += data[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		data += count;
+		size -= count;
+	}
+	return (b << 16) | a;
+}
+
+static void AppendBigEndian(std::vector<uint8_t>& output, uint32_t value)
+{
+	output.push_back((uint8_t)(value >> 24));
+	output.push_back((uint8_t)(value >> 16));
+	output.push_back((uint8_t)(value >> 8));
+	output.push_back((uint8_t)value);
+}
+
+static void AppendChunk(std::vector<uint8_t>& output, const char* type, const uint8_t* data, std::size_t size)
+{
+	AppendBigEndian(output, (uint32_t)size);
+	const std::size_t typeOffset = output.size();
+	output.insert(output.end(), type, type + 4);
+	output.insert(output.end(), data, data + size);
+	AppendBigEndian(output, Crc32(output.data() + typeOffset, size + 4));
+}
+
+static bool WritePng(const std::string& filepath, const uint8_t* pixels, int width, int height, std::vector<uint8_t>& scanlines, std::vector<uint8_t>& output)
+{
+	/* Top-down RGB rows, each behind a "no filter" byte */
+	const std::size_t rowSize = (std::size_t)width * 3 + 1;
+	scanlines.resize(rowSize * height);
+	for (int y = 0; y < height; y++)
+	{
+		const uint8_t* source = pixels + (std::size_t)(height - 1 - y) * width * 4;
+		uint8_t* destination = scanlines.data() + rowSize * y;
+		*destination++ = 0;
+		for (int x = 0; x < width; x++, source += 4, destination += 3)
+		{
+			destination[0] = source[0];
+			destination[1] = source[1];
+			destination[2] = source[2];
+		}
+	}
+
+	/* zlib stream made of stored deflate blocks (65535 bytes at most each) */
+	std::vector<uint8_t> idat;
+	idat.reserve(scanlines.size() + scanlines.size() / 65535 * 5 + 16);
+	idat.push_back(0x78);
+	idat.push_back(0x01);
+	for (std::size_t offset = 0;;)
+	{
+		const uint16_t length = (uint16_t)std::min<std::size_t>(scanlines.size() - offset, 65535);
+		const bool isFinal = offset + length == scanlines.size();
+		idat.push_back(isFinal ? 1 : 0);
+		idat.push_back((uint8_t)length);
+		idat.push_back((uint8_t)(length >> 8));
+		idat.push_back((uint8_t)~length);
+		idat.push_back((uint8_t)(~length >> 8));
+		idat.insert(idat.end(), scanlines.data() + offset, scanlines.data() + offset + length);
+		offset += length;
+		if (isFinal)
+			break;
+	}
+	AppendBigEndian(idat, Adler32(scanlines.data(), scanlines.size()));
+
+	uint8_t header[13] = {};
+	header[0] = (uint8_t)(width >> 24); header[1] = (uint8_t)(width >> 16); header[2] = (uint8_t)(width >> 8); header[3] = (uint8_t)width;
+	header[4] = (uint8_t)(height >> 24); header[5] = (uint8_t)(height >> 16); header[6] = (uint8_t)(height >> 8); header[7] = (uint8_t)height;
+	header[8] = 8; // Bits per channel
+	header[9] = 2; // RGB
+
+	static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	output.assign(signature, signature + 8);
+	AppendChunk(output, "IHDR", header, sizeof(header));
+	AppendChunk(output, "IDAT", idat.data(), idat.size());
+	AppendChunk(output, "IEND", nullptr, 0);
+
+	std::FILE* file = std::fopen(filepath.c_str(), "wb");
+	if (!file)
+		return false;
+	const bool isWritten = std::fwrite(output.data(), 1, output.size(), file) == output.size();
+	std::fclose(file);
+	return isWritten;
+}
+
+static bool WriteRawFrame(std::FILE* file, const uint8_t* pixels, int width, int height)
+{
+	const std::size_t rowSize = (std::size_t)width * 4;
+	for (int y = height - 1; y >= 0; y--)
+	{
+		if (std::fwrite(pixels + rowSize * y, 1, rowSize, file) != rowSize)
+			return false;
+	}
+	return true;
+}
+
+static bool WriteY4mFrame(std::FILE* file, const uint8_t* pixels, int width, int height, std::vector<uint8_t>& planes)
+{
+	/* Full resolution Y, Cb and Cr planes (BT.601, studio range) */
+	const std::size_t planeSize = (std::size_t)width * height;
+	planes.resize(planeSize * 3);
+	uint8_t* luma = planes.data();
+	uint8_t* blue = luma + planeSize;
+	uint8_t* red = blue + planeSize;
+
+	for (int y = 0; y < height; y++)
+	{
+		const uint8_t* source = pixels + (std::size_t)(height - 1 - y) * width * 4;
+		for (int x = 0; x < width; x++, source += 4)
+		{
+			const int r = source[0], g = source[1], b = source[2];
+			const std::size_t i = (std::size_t)y * width + x;
+			luma[i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+			blue[i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+			red[i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+	}
+
+	return std::fputs("FRAME\n", file) >= 0 && std::fwrite(planes.data(), 1, planes.size(), file) == planes.size();
+}
+
+FrameCapture::FrameCapture(GLFWwindow* window)
+	: m_Window(window), m_OldestReadback(0), m_InFlightCount(0), m_IsRecording(false), m_IsSequenceOpen(false), m_IsUiIncluded(false),
+	m_RemainingFrames(0), m_SequenceFrames(0), m_CapturedFrames(0), m_DroppedFrames(0), m_StalledFrames(0), m_ReadbackMilliseconds(0.0f),
+	m_Format((int)CaptureFormat::PNG), m_FrameCount(0), m_Framerate(60), m_EncodedFrames(0), m_EncodeMilliseconds(0.0f), m_IsShuttingDown(false)
+{
+	for (Readback& readback : m_Readbacks)
+	{
+		GL_CALL(glGenBuffers(1, &readback.buffer));
+	}
+
+	m_Encoder = std::thread(&FrameCapture::EncoderLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+	/* Whatever was captured still gets written */
+	Stop();
+	while (m_InFlightCount > 0)
+		Collect(true);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsShuttingDown = true;
+	}
+	m_Condition.notify_one();
+	m_Encoder.join();
+
+	for (Readback& readback : m_Readbacks)
+	{
+		GL_CALL(glDeleteBuffers(1, &readback.buffer));
+	}
+}
+
+bool FrameCapture::ParseFormat(const std::string& name, CaptureFormat& format)
+{
+	if (name == "png")
+		format = CaptureFormat::PNG;
+	else if (name == "raw")
+		format = CaptureFormat::RAW;
+	else if (name == "y4m")
+		format = CaptureFormat::Y4M;
+	else
+		return false;
+	return true;
+}
+
+bool FrameCapture::SavePng(const std::string& filepath, const uint8_t* pixels, int width, int height)
+{
+	std::vector<uint8_t> scanlines;
+	std::vector<uint8_t> output;
+	return WritePng(filepath, pixels, width, height, scanlines, output);
+}
+
+void FrameCapture::Start(const std::string& directory, CaptureFormat format, int frameCount, int framerate)
+{
+	Stop();
+
+	m_Sequence.directory = directory;
+	m_Sequence.format = format;
+	m_Sequence.framerate = std::max(framerate, 1);
+	m_RemainingFrames = std::max(frameCount, 0);
+	m_SequenceFrames = 0;
+	m_IsRecording = true;
+}
+
+void FrameCapture::Stop()
+{
+	if (!m_IsRecording)
+		return;
+
+	m_IsRecording = false;
+	if (!m_IsSequenceOpen)
+		return;
+
+	/* The end goes to the encoder right behind the last frame, which may still be on its way back from the GPU */
+	if (m_InFlightCount > 0)
+	{
+		m_Readbacks[(m_OldestReadback + m_InFlightCount - 1) % ReadbackCount].isLast = true;
+	}
+	else
+	{
+		CapturedFrame end;
+		end.isEndOfSequence = true;
+		Push(std::move(end));
+	}
+	m_IsSequenceOpen = false;
+}
+
+void FrameCapture::OnSceneRendered()
+{
+	if (m_IsRecording && !m_IsUiIncluded)
+		Capture();
+}
+
+void FrameCapture::OnFrameRendered()
+{
+	if (m_IsRecording && m_IsUiIncluded)
+		Capture();
+	else if (m_InFlightCount > 0)
+		Collect(false);
+}
+
+void FrameCapture::Capture()
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	Collect(false);
+
+	/* Only when the GPU is more than a whole ring of frames behind */
+	if (m_InFlightCount == ReadbackCount)
+	{
+		m_StalledFrames++;
+		Collect(true);
+
+		/* Still full after waiting, so there's no slot to read into */
+		if (m_InFlightCount == ReadbackCount)
+		{
+			m_DroppedFrames++;
+			return;
+		}
+	}
+
+	int width, height;
+	glfwGetFramebufferSize(m_Window, &width, &height);
+	if (width == 0 || height == 0)
+		return; // Minimized
+
+	Readback& readback = m_Readbacks[(m_OldestReadback + m_InFlightCount) % ReadbackCount];
+	const std::size_t size = (std::size_t)width * height * 4;
+
+	GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+	if (readback.capacity < size)
+	{
+		GL_CALL(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+		readback.capacity = size;
+		readback.memory.Track(GpuMemoryCategory::READBACK_BUFFER, size);
+	}
+
+	/* With a pack buffer bound this only queues the copy, nothing waits for it */
+	GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, 0));
+	GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+	GL_CALL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	GL_CALL(readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+	readback.width = width;
+	readback.height = height;
+	readback.index = m_SequenceFrames++;
+	readback.isFirst = !m_IsSequenceOpen;
+	readback.isLast = false;
+	if (readback.isFirst)
+		readback.sequence = m_Sequence;
+	m_IsSequenceOpen = true;
+	m_InFlightCount++;
+	m_CapturedFrames++;
+
+	if (m_RemainingFrames > 0 && --m_RemainingFrames == 0)
+		Stop();
+
+	const float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	m_ReadbackMilliseconds = m_ReadbackMilliseconds * 0.95f + milliseconds * 0.05f;
+}
+
+void FrameCapture::Collect(bool waitForOldest)
+{
+	while (m_InFlightCount > 0)
+	{
+		Readback& readback = m_Readbacks[m_OldestReadback];
+
+		GLenum status;
+		if (waitForOldest)
+		{
+			GL_CALL(status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000)); // 1 s
+			waitForOldest = false;
+		}
+		else
+		{
+			GL_CALL(status = glClientWaitSync(readback.fence, 0, 0));
+		}
+		if (status == GL_TIMEOUT_EXPIRED)
+			break;
+
+		GL_CALL(glDeleteSync(readback.fence));
+		readback.fence = nullptr;
+
+		if (status == GL_WAIT_FAILED)
+		{
+			Log("Waiting for a frame capture readback failed, dropping the frame");
+			m_DroppedFrames++;
+			DropOldestReadback();
+			continue;
+		}
+
+		CapturedFrame frame;
+		frame.width = readback.width;
+		frame.height = readback.height;
+		frame.index = readback.index;
+		frame.isFirst = readback.isFirst;
+		if (frame.isFirst)
+			frame.sequence = std::move(readback.sequence);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!m_FreePixels.empty())
+			{
+				frame.pixels = std::move(m_FreePixels.back());
+				m_FreePixels.pop_back();
+			}
+		}
+
+		/* The copy has landed, so mapping it doesn't wait */
+		const std::size_t size = (std::size_t)readback.width * readback.height * 4;
+		frame.pixels.resize(size);
+		GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+		GL_CALL(const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+		if (mapped)
+		{
+			std::memcpy(frame.pixels.data(), mapped, size);
+		}
+		GL_CALL(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+		GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+		const bool isLast = readback.isLast;
+		m_OldestReadback = (m_OldestReadback + 1) % ReadbackCount;
+		m_InFlightCount--;
+
+		Push(std::move(frame));
+		if (isLast)
+		{
+			CapturedFrame end;
+			end.isEndOfSequence = true;
+			Push(std::move(end));
+		}
+	}
+}
+
+void FrameCapture::DropOldestReadback()
+{
+	Readback& readback = m_Readbacks[m_OldestReadback];
+	m_OldestReadback = (m_OldestReadback + 1) % ReadbackCount;
+	m_InFlightCount--;
+
+	if (!readback.isFirst)
+	{
+		if (readback.isLast)
+		{
+			CapturedFrame end;
+			end.isEndOfSequence = true;
+			Push(std::move(end));
+		}
+		return;
+	}
+
+	/* The sequence starts with whichever of its frames makes it back first (none did when this was also the last) */
+	if (readback.isLast)
+		return;
+
+	if (m_InFlightCount > 0)
+	{
+		Readback& next = m_Readbacks[m_OldestReadback];
+		next.isFirst = true;
+		next.sequence = std::move(readback.sequence);
+	}
+	else
+	{
+		m_IsSequenceOpen = false; // Still the current sequence, the next capture starts it again
+	}
+}
+
+void FrameCapture::Push(CapturedFrame&& frame)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		/* Dropping beats stalling the render loop or piling up memory (the first frame carries the sequence, so it stays) */
+		if (!frame.isEndOfSequence && !frame.isFirst && m_Queue.size() >= MaxQueuedFrames)
+		{
+			m_DroppedFrames++;
+			m_FreePixels.push_back(std::move(frame.pixels));
+			return;
+		}
+
+		m_Queue.push_back(std::move(frame));
+	}
+	m_Condition.notify_one();
+}
+
+void FrameCapture::EncoderLoop()
+{
+	Sequence sequence;
+	std::FILE* file = nullptr;
+	int sequenceWidth = 0, sequenceHeight = 0;
+	uint64_t sequenceFrames = 0;
+	bool isFailed = false;
+	std::vector<uint8_t> scratch, output;
+
+	while (true)
+	{
+		CapturedFrame frame;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return !m_Queue.empty() || m_IsShuttingDown; });
+			if (m_Queue.empty())
+				break;
+
+			frame = std::move(m_Queue.front());
+			m_Queue.pop_front();
+		}
+
+		if (frame.isEndOfSequence)
+		{
+			if (file)
+				std::fclose(file);
+			file = nullptr;
+			Log("Captured " + std::to_string(sequenceFrames) + " frames to " + sequence.directory);
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+
+		if (frame.isFirst)
+		{
+			sequence = frame.sequence;
+			sequenceWidth = frame.width;
+			sequenceHeight = frame.height;
+			sequenceFrames = 0;
+			isFailed = false;
+
+			std::error_code error;
+			std::filesystem::create_directories(sequence.directory, error);
+
+			if (sequence.format != CaptureFormat::PNG)
+			{
+				const std::string filepath = sequence.directory + (sequence.format == CaptureFormat::RAW ? "/capture.rgba" : "/capture.y4m");
+				file = std::fopen(filepath.c_str(), "wb");
+				if (!file)
+				{
+					Log("Failed to open " + filepath + " for writing");
+					isFailed = true;
+				}
+				else if (sequence.format == CaptureFormat::Y4M)
+				{
+					std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", frame.width, frame.height, sequence.framerate);
+				}
+				else
+				{
+					Log("Raw capture is " + std::to_string(frame.width) + " x " + std::to_string(frame.height) + " RGBA8 per frame, top row first");
+				}
+			}
+		}
+
+		/* A stream can't change size midway (PNG files each have their own) */
+		if (!isFailed && sequence.format != CaptureFormat::PNG && (frame.width != sequenceWidth || frame.height != sequenceHeight))
+		{
+			Log("Window resized during capture, the rest of the sequence is skipped");
+			isFailed = true;
+		}
+
+		if (!isFailed)
+		{
+			bool isWritten = false;
+			switch (sequence.format)
+			{
+			case CaptureFormat::PNG:
+			{
+				char filename[32];
+				std::snprintf(filename, sizeof(filename), "/frame_%06llu.png", (unsigned long long)frame.index);
+				isWritten = WritePng(sequence.directory + filename, frame.pixels.data(), frame.width, frame.height, scratch, output);
+				break;
+			}
+			case CaptureFormat::RAW:
+				isWritten = WriteRawFrame(file, frame.pixels.data(), frame.width, frame.height);
+				break;
+			case CaptureFormat::Y4M:
+				isWritten = WriteY4mFrame(file, frame.pixels.data(), frame.width, frame.height, scratch);
+				break;
+			}
+
+			if (isWritten)
+			{
+				sequenceFrames++;
+			}
+			else
+			{
+				Log("Failed to write frame " + std::to_string(frame.index) + " to " + sequence.directory);
+				isFailed = true;
+			}
+		}
+
+		const float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_FreePixels.push_back(std::move(frame.pixels));
+		m_EncodedFrames++;
+		m_EncodeMilliseconds = m_EncodeMilliseconds == 0.0f ? milliseconds : m_EncodeMilliseconds * 0.95f + milliseconds * 0.05f;
+	}
+
+	if (file)
+		std::fclose(file);
+}
+
+void FrameCapture::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("Frame capture"))
+		return;
+
+	ImGui::InputText("Directory", m_Directory, sizeof(m_Directory));
+	ImGui::RadioButton("PNG", &m_Format, (int)CaptureFormat::PNG);
+	ImGui::SameLine();
+	ImGui::RadioButton("Raw RGBA", &m_Format, (int)CaptureFormat::RAW);
+	ImGui::SameLine();
+	ImGui::RadioButton("Y4M", &m_Format, (int)CaptureFormat::Y4M);
+	ImGui::SliderInt("Frames (0: until stopped)", &m_FrameCount, 0, 1000);
+	if (m_Format == (int)CaptureFormat::Y4M)
+		ImGui::SliderInt("Frame rate", &m_Framerate, 1, 240);
+	ImGui::Checkbox("Include ImGui", &m_IsUiIncluded);
+
+	if (!m_IsRecording)
+	{
+		if (ImGui::Button("Record"))
+			Start(m_Directory, (CaptureFormat)m_Format, m_FrameCount, m_Framerate);
+		ImGui::SameLine();
+		if (ImGui::Button("Screenshot"))
+			Start(m_Directory, CaptureFormat::PNG, 1);
+	}
+	else if (ImGui::Button("Stop"))
+	{
+		Stop();
+	}
+
+	std::size_t queued;
+	uint64_t encoded;
+	float encodeMilliseconds;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		queued = m_Queue.size();
+		encoded = m_EncodedFrames;
+		encodeMilliseconds = m_EncodeMilliseconds;
+	}
+
+	ImGui::Text("%llu captured, %llu encoded, %zu queued, %d in flight", (unsigned long long)m_CapturedFrames, (unsigned long long)encoded, queued, m_InFlightCount);
+	ImGui::Text("%llu dropped (encoder behind), %llu stalled (GPU behind)", (unsigned long long)m_DroppedFrames, (unsigned long long)m_StalledFrames);
+	ImGui::Text("Readback %.3f ms/frame - encode %.3f ms/frame", m_ReadbackMilliseconds, encodeMilliseconds);
+}
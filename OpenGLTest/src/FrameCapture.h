@@ -0,0 +1,130 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GpuMemoryTracker.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class CaptureFormat
+{
+	PNG = 0, // One file per frame
+	RAW = 1, // One file, tightly packed top-down RGBA8 frames back to back
+	Y4M = 2 // One YUV4MPEG2 (4:4:4) file, readable by ffmpeg and most players
+};
+
+/* Frame capture without stalls: frames get read into a ring of pixel pack buffers, mapped once their fence signals
+(a frame or two later) and written out by an encoder thread */
+class FrameCapture
+{
+private:
+	static constexpr int ReadbackCount = 3;
+	static constexpr int MaxQueuedFrames = 32; // Past that the encoder is falling behind and frames get dropped
+
+	struct Sequence
+	{
+		std::string directory;
+		CaptureFormat format = CaptureFormat::PNG;
+		int framerate = 60;
+	};
+
+	struct Readback
+	{
+		unsigned int buffer = 0;
+		std::size_t capacity = 0;
+		GpuAllocation memory;
+		GLsync fence = nullptr;
+		int width = 0;
+		int height = 0;
+		uint64_t index = 0; // Within its sequence
+		Sequence sequence; // Only set on the first frame, as captured (a new one may have started by the time it's back)
+		bool isFirst = false;
+		bool isLast = false;
+	};
+
+	struct CapturedFrame
+	{
+		std::vector<uint8_t> pixels; // Bottom-up RGBA8, as OpenGL reads it
+		int width = 0;
+		int height = 0;
+		uint64_t index = 0;
+		Sequence sequence; // Only set on the first frame, which starts it
+		bool isFirst = false;
+		bool isEndOfSequence = false; // No pixels, closes the sequence
+	};
+
+	GLFWwindow* m_Window;
+
+	Readback m_Readbacks[ReadbackCount];
+	int m_OldestReadback;
+	int m_InFlightCount;
+
+	/* Main thread state */
+	Sequence m_Sequence;
+	bool m_IsRecording;
+	bool m_IsSequenceOpen; // Frames went to the encoder (or are in flight) and the end of the sequence hasn't yet
+	bool m_IsUiIncluded;
+	int m_RemainingFrames; // 0 until stopped
+	uint64_t m_SequenceFrames;
+	uint64_t m_CapturedFrames;
+	uint64_t m_DroppedFrames;
+	uint64_t m_StalledFrames; // Had to wait for the GPU because every readback was still in flight
+	float m_ReadbackMilliseconds; // Smoothed CPU cost of issuing and collecting readbacks
+
+	/* ImGui state */
+	char m_Directory[256] = "captures";
+	int m_Format;
+	int m_FrameCount;
+	int m_Framerate;
+
+	/* Shared with the encoder thread */
+	std::thread m_Encoder;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<CapturedFrame> m_Queue;
+	std::vector<std::vector<uint8_t>> m_FreePixels; // Recycled by the encoder so steady-state capture doesn't allocate
+	uint64_t m_EncodedFrames;
+	float m_EncodeMilliseconds;
+	bool m_IsShuttingDown;
+
+public:
+	FrameCapture(GLFWwindow* window);
+	~FrameCapture();
+
+	FrameCapture(const FrameCapture&) = delete;
+	FrameCapture& operator=(const FrameCapture&) = delete;
+
+	// Captures the next `frameCount` frames (0 until `Stop`) into `directory`
+	void Start(const std::string& directory, CaptureFormat format, int frameCount = 0, int framerate = 60);
+	void Stop();
+	inline bool IsRecording() const { return m_IsRecording; }
+	// Recording, or frames still have to come back from the GPU
+	inline bool IsBusy() const { return m_IsRecording || m_InFlightCount > 0; }
+	inline void SetUiIncluded(bool isUiIncluded) { m_IsUiIncluded = isUiIncluded; }
+
+	// Call once the scene is in the back buffer, and again once ImGui is: captures at whichever point is selected
+	void OnSceneRendered();
+	void OnFrameRendered();
+
+	void OnImGuiRender();
+
+	static bool ParseFormat(const std::string& name, CaptureFormat& format);
+	// One RGBA8 image, bottom row first (as read back from GL), written as an RGB PNG
+	static bool SavePng(const std::string& filepath, const uint8_t* pixels, int width, int height);
+
+private:
+	void Capture();
+	// Hands every readback whose fence signaled to the encoder (waiting for the oldest one if asked to)
+	void Collect(bool waitForOldest);
+	// Releases the oldest readback without encoding it, keeping its sequence's start and end
+	void DropOldestReadback();
+	void Push(CapturedFrame&& frame);
+	void EncoderLoop();
+};
@@ -0,0 +1,271 @@
+#include "FramePacer.h"
+#include "GLHandleError.h"
+
+#include "imgui/imgui.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+FramePacer::FramePacer(GLFWwindow* window)
+	: m_Window(window), m_VsyncMode(VsyncMode::ON), m_IsAdaptiveSupported(false), m_TargetFramerate(0), m_SpinThreshold(0.002f), m_MaxFramesInFlight(2),
+	m_FrameStart(-1.0), m_FrameTimes(), m_FrameTimeIndex(0), m_FrameTimeCount(0), m_PendingInputTime(-1.0), m_LastLatency(0.0f), m_AverageLatency(0.0f),
+	m_IsOnDemand(false), m_IdleTimeout(0.5f), m_FramesToRender(SettleFrames), m_IsRefreshRequested(false), m_RenderedFrames(0), m_RepresentedFrames(0), m_IdleWaits(0)
+{
+	m_IsAdaptiveSupported = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+	glfwSetWindowUserPointer(m_Window, this);
+	SetVsyncMode(VsyncMode::ON);
+}
+
+FramePacer::~FramePacer()
+{
+	for (FrameFence& frame : m_Fences)
+	{
+		GL_CALL(glDeleteSync(frame.fence));
+	}
+}
+
+void FramePacer::InstallInputCallbacks()
+{
+	/* Only the timestamp matters, ImGui (installed after) forwards the events to us and handles them */
+	glfwSetKeyCallback(m_Window, [](GLFWwindow* window, int, int, int, int) { ((FramePacer*)glfwGetWindowUserPointer(window))->OnInput(); });
+	glfwSetMouseButtonCallback(m_Window, [](GLFWwindow* window, int, int, int) { ((FramePacer*)glfwGetWindowUserPointer(window))->OnInput(); });
+	glfwSetCursorPosCallback(m_Window, [](GLFWwindow* window, double, double) { ((FramePacer*)glfwGetWindowUserPointer(window))->OnInput(); });
+	glfwSetScrollCallback(m_Window, [](GLFWwindow* window, double, double) { ((FramePacer*)glfwGetWindowUserPointer(window))->OnInput(); });
+	glfwSetCharCallback(m_Window, [](GLFWwindow* window, unsigned int) { ((FramePacer*)glfwGetWindowUserPointer(window))->OnInput(); });
+
+	/* Not input, but still changes to what has to be on screen */
+	glfwSetWindowFocusCallback(m_Window, [](GLFWwindow* window, int) { ((FramePacer*)glfwGetWindowUserPointer(window))->RequestFrames(); });
+	glfwSetFramebufferSizeCallback(m_Window, [](GLFWwindow* window, int, int) { ((FramePacer*)glfwGetWindowUserPointer(window))->RequestFrames(); });
+	glfwSetWindowRefreshCallback(m_Window, [](GLFWwindow* window) { ((FramePacer*)glfwGetWindowUserPointer(window))->m_IsRefreshRequested = true; });
+}
+
+void FramePacer::OnInput()
+{
+	if (m_PendingInputTime < 0.0)
+		m_PendingInputTime = glfwGetTime();
+
+	RequestFrames();
+}
+
+bool FramePacer::WaitForWork(bool isSceneChanging)
+{
+	if (!m_IsOnDemand || isSceneChanging || m_FramesToRender > 0)
+		return true;
+
+	/* The frame would come out the same: sleep until something happens instead */
+	m_IdleWaits++;
+	if (m_IdleTimeout > 0.0f)
+		glfwWaitEventsTimeout(m_IdleTimeout);
+	else
+		glfwWaitEvents();
+
+	/* Time spent idle isn't frame time */
+	m_FrameStart = -1.0;
+
+	if (m_FramesToRender > 0)
+		return true;
+
+	/* Exposed (uncovered, restored, ...) without changes: the copy of the last frame does */
+	if (m_IsRefreshRequested)
+	{
+		m_IsRefreshRequested = false;
+		return !PresentLastFrame();
+	}
+
+	/* Timed out (or woken up by another thread): one frame picks up whatever changed without notice, like readouts */
+	return glfwWindowShouldClose(m_Window) == GLFW_FALSE;
+}
+
+void FramePacer::Present()
+{
+	if (m_IsOnDemand)
+	{
+		int width, height;
+		glfwGetFramebufferSize(m_Window, &width, &height);
+
+		if (!m_LastFrame)
+		{
+			FramebufferSpecification specification;
+			specification.width = width;
+			specification.height = height;
+			specification.hasDepth = false;
+			m_LastFrame = std::make_unique<Framebuffer>(specification);
+		}
+
+		m_LastFrame->Resize(width, height);
+		m_LastFrame->BlitFromScreen(width, height);
+	}
+	else
+	{
+		m_LastFrame.reset();
+	}
+
+	glfwSwapBuffers(m_Window);
+
+	m_IsRefreshRequested = false;
+	m_RenderedFrames++;
+	if (m_FramesToRender > 0)
+		m_FramesToRender--;
+}
+
+bool FramePacer::PresentLastFrame()
+{
+	int width, height;
+	glfwGetFramebufferSize(m_Window, &width, &height);
+	if (!m_LastFrame || m_LastFrame->GetSpecification().width != width || m_LastFrame->GetSpecification().height != height)
+		return false;
+
+	m_LastFrame->BlitToScreen(width, height, width, height, GL_NEAREST);
+	glfwSwapBuffers(m_Window);
+	m_RepresentedFrames++;
+	return true;
+}
+
+void FramePacer::SetVsyncMode(VsyncMode mode)
+{
+	if (mode == VsyncMode::ADAPTIVE && !m_IsAdaptiveSupported)
+		mode = VsyncMode::ON;
+
+	m_VsyncMode = mode;
+
+	switch (mode)
+	{
+	case VsyncMode::OFF:
+		glfwSwapInterval(0);
+		break;
+	case VsyncMode::ON:
+		glfwSwapInterval(1);
+		break;
+	case VsyncMode::ADAPTIVE:
+		glfwSwapInterval(-1); // Negative intervals enable tearing when late
+		break;
+	}
+}
+
+void FramePacer::BeginFrame()
+{
+	const double now = glfwGetTime();
+
+	if (m_FrameStart >= 0.0)
+	{
+		m_FrameTimes[m_FrameTimeIndex] = (float)(now - m_FrameStart);
+		m_FrameTimeIndex = (m_FrameTimeIndex + 1) % FrameTimeHistorySize;
+		if (m_FrameTimeCount < FrameTimeHistorySize)
+			m_FrameTimeCount++;
+	}
+
+	m_FrameStart = now;
+
+	/* Don't let the CPU run more than `m_MaxFramesInFlight` frames ahead of the GPU */
+	RetireSignaledFences(false);
+	while (m_MaxFramesInFlight > 0 && (int)m_Fences.size() >= m_MaxFramesInFlight)
+		RetireSignaledFences(true);
+}
+
+void FramePacer::EndFrame()
+{
+	GL_CALL(GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	m_Fences.push_back({ fence, m_PendingInputTime });
+	m_PendingInputTime = -1.0;
+
+	Limit();
+}
+
+void FramePacer::RetireSignaledFences(bool waitForOldest)
+{
+	while (!m_Fences.empty())
+	{
+		FrameFence& oldest = m_Fences.front();
+
+		/* Flushing makes sure the fence actually reaches the GPU before waiting on it */
+		const GLuint64 timeout = waitForOldest ? 1000000000 : 0;
+		GL_CALL(GLenum result = glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout));
+		if (result == GL_TIMEOUT_EXPIRED)
+			return;
+
+		/* The GPU is done with that frame: input consumed by it has made it to the screen (give or take the scan-out) */
+		if (oldest.inputTime >= 0.0)
+		{
+			m_LastLatency = (float)(glfwGetTime() - oldest.inputTime);
+			m_AverageLatency = m_AverageLatency == 0.0f ? m_LastLatency : m_AverageLatency * 0.9f + m_LastLatency * 0.1f;
+		}
+
+		GL_CALL(glDeleteSync(oldest.fence));
+		m_Fences.erase(m_Fences.begin());
+		waitForOldest = false;
+	}
+}
+
+void FramePacer::Limit()
+{
+	if (m_TargetFramerate <= 0)
+		return;
+
+	const double deadline = m_FrameStart + 1.0 / m_TargetFramerate;
+
+	/* Sleeping is cheap but imprecise, so sleep until close to the deadline and spin the rest */
+	double remaining = deadline - glfwGetTime();
+	if (remaining > m_SpinThreshold)
+		std::this_thread::sleep_for(std::chrono::duration<double>(remaining - m_SpinThreshold));
+
+	while (glfwGetTime() < deadline)
+		std::this_thread::yield();
+}
+
+void FramePacer::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("Frame pacing"))
+		return;
+
+	int vsyncMode = (int)m_VsyncMode;
+	ImGui::Text("Vsync");
+	ImGui::SameLine();
+	bool isChanged = ImGui::RadioButton("Off", &vsyncMode, (int)VsyncMode::OFF);
+	ImGui::SameLine();
+	isChanged |= ImGui::RadioButton("On", &vsyncMode, (int)VsyncMode::ON);
+	if (m_IsAdaptiveSupported)
+	{
+		ImGui::SameLine();
+		isChanged |= ImGui::RadioButton("Adaptive", &vsyncMode, (int)VsyncMode::ADAPTIVE);
+	}
+	if (isChanged)
+		SetVsyncMode((VsyncMode)vsyncMode);
+
+	ImGui::SliderInt("Frame rate cap (0: off)", &m_TargetFramerate, 0, 480);
+	float spinThresholdMs = m_SpinThreshold * 1000.0f;
+	if (ImGui::SliderFloat("Spin threshold (ms)", &spinThresholdMs, 0.0f, 5.0f))
+		m_SpinThreshold = spinThresholdMs / 1000.0f;
+	ImGui::SliderInt("Max frames in flight (0: driver)", &m_MaxFramesInFlight, 0, 3);
+
+	ImGui::Checkbox("Render on demand", &m_IsOnDemand);
+	if (m_IsOnDemand)
+	{
+		ImGui::SliderFloat("Idle redraw after (s, 0: never)", &m_IdleTimeout, 0.0f, 5.0f);
+		ImGui::Text("%llu frames rendered, %llu presented again, %llu idle waits", (unsigned long long)m_RenderedFrames, (unsigned long long)m_RepresentedFrames, (unsigned long long)m_IdleWaits);
+	}
+
+	if (m_FrameTimeCount == 0)
+		return;
+
+	/* Frame time statistics over the history */
+	float mean = 0.0f, minimum = m_FrameTimes[0], maximum = m_FrameTimes[0];
+	for (int i = 0; i < m_FrameTimeCount; i++)
+	{
+		mean += m_FrameTimes[i];
+		minimum = std::fmin(minimum, m_FrameTimes[i]);
+		maximum = std::fmax(maximum, m_FrameTimes[i]);
+	}
+	mean /= m_FrameTimeCount;
+
+	float variance = 0.0f;
+	for (int i = 0; i < m_FrameTimeCount; i++)
+		variance += (m_FrameTimes[i] - mean) * (m_FrameTimes[i] - mean);
+	variance /= m_FrameTimeCount;
+
+	ImGui::Text("Frame time %.3f ms (min %.3f - max %.3f)", mean * 1000.0f, minimum * 1000.0f, maximum * 1000.0f);
+	ImGui::Text("Std. deviation %.3f ms - variance %.4f ms^2", std::sqrt(variance) * 1000.0f, variance * 1000000.0f);
+	ImGui::PlotLines("##FrameTimes", m_FrameTimes, m_FrameTimeCount, m_FrameTimeCount == FrameTimeHistorySize ? m_FrameTimeIndex : 0, "Frame times", 0.0f, maximum * 1.2f, ImVec2(0, 60));
+	ImGui::Text("Input to present latency ~%.1f ms (last %.1f ms)", m_AverageLatency * 1000.0f, m_LastLatency * 1000.0f);
+	ImGui::Text("Frames in flight: %d", (int)m_Fences.size());
+}
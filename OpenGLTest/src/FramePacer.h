@@ -0,0 +1,91 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "Framebuffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class VsyncMode
+{
+	OFF = 0,
+	ON = 1,
+	ADAPTIVE = 2 // Syncs when on time, tears instead of waiting a whole interval when late
+};
+
+/* Presentation control: vsync mode, frame rate limiter, a fence-based cap on the frames the driver may queue
+and on-demand rendering (frames only get rendered when something changes) */
+class FramePacer
+{
+private:
+	struct FrameFence
+	{
+		GLsync fence;
+		double inputTime; // Oldest input consumed by that frame (negative if none)
+	};
+
+	static constexpr int FrameTimeHistorySize = 240;
+	static constexpr int SettleFrames = 3; // Frames rendered after an input, for ImGui to catch up with it (hover, release, ...)
+
+	GLFWwindow* m_Window;
+
+	VsyncMode m_VsyncMode;
+	bool m_IsAdaptiveSupported;
+	int m_TargetFramerate; // 0 means uncapped
+	float m_SpinThreshold; // Seconds before the deadline where the limiter stops sleeping and starts spinning
+	int m_MaxFramesInFlight; // 0 leaves it up to the driver
+
+	std::vector<FrameFence> m_Fences; // Oldest first, only a handful long (a deque would allocate a block per frame)
+
+	double m_FrameStart;
+	float m_FrameTimes[FrameTimeHistorySize];
+	int m_FrameTimeIndex;
+	int m_FrameTimeCount;
+
+	double m_PendingInputTime;
+	float m_LastLatency;
+	float m_AverageLatency;
+
+	/* On-demand rendering */
+	bool m_IsOnDemand;
+	float m_IdleTimeout; // Seconds an idle wait lasts before a frame gets rendered anyway, 0 waits for an event
+	int m_FramesToRender;
+	bool m_IsRefreshRequested; // The window got exposed and has to show the last frame again
+	std::unique_ptr<Framebuffer> m_LastFrame;
+	uint64_t m_RenderedFrames;
+	uint64_t m_RepresentedFrames;
+	uint64_t m_IdleWaits;
+
+public:
+	FramePacer(GLFWwindow* window);
+	~FramePacer();
+
+	// Call before anything else in the loop: in on-demand mode, sleeps while neither the scene (`isSceneChanging`) nor input
+	// would change the frame, and returns whether there's a frame to render (nothing to do otherwise)
+	bool WaitForWork(bool isSceneChanging);
+	// Call at the start of the frame: blocks while too many frames are in flight
+	void BeginFrame();
+	// Swaps buffers, keeping a copy of the frame first in on-demand mode to show it again without rendering it
+	void Present();
+	// Call right after presenting: fences the frame and waits for the frame rate cap
+	void EndFrame();
+
+	void SetVsyncMode(VsyncMode mode);
+	inline void SetOnDemand(bool isOnDemand) { m_IsOnDemand = isOnDemand; }
+	// Renders the next few frames (for changes that aren't input nor animation)
+	inline void RequestFrames() { m_FramesToRender = SettleFrames; }
+
+	void OnImGuiRender();
+
+	// Must be installed before ImGui's callbacks so ImGui chains to them
+	void InstallInputCallbacks();
+
+private:
+	void OnInput();
+	bool PresentLastFrame();
+	void RetireSignaledFences(bool waitForOldest);
+	void Limit();
+};
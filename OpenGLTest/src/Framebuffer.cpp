@@ -0,0 +1,197 @@
+#include "Framebuffer.h"
+#include "GLHandleError.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+
+static unsigned int CreateColorTexture(int width, int height)
+{
+	unsigned int texture;
+	GL_CALL(glGenTextures(1, &texture));
+	GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
+	GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+	RenderStats::Get().ForgetTextureBindings();
+	return texture;
+}
+
+static void CheckStatus(const char* name)
+{
+	GL_CALL(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		Log(std::string(name) + " framebuffer is incomplete (status " + std::to_string(status) + ")");
+}
+
+Framebuffer::Framebuffer(const FramebufferSpecification& specification)
+	: m_RendererID(0), m_ColorAttachment(0), m_DepthAttachment(0), m_ResolveID(0), m_ResolveTexture(0), m_Specification(specification)
+{
+	Invalidate();
+}
+
+Framebuffer::~Framebuffer()
+{
+	Release();
+}
+
+void Framebuffer::Release()
+{
+	if (m_RendererID)
+	{
+		GL_CALL(glDeleteFramebuffers(1, &m_RendererID));
+	}
+	if (m_ResolveID)
+	{
+		GL_CALL(glDeleteFramebuffers(1, &m_ResolveID));
+		GL_CALL(glDeleteTextures(1, &m_ResolveTexture));
+	}
+	if (m_ColorAttachment)
+	{
+		if (m_Specification.samples > 1)
+		{
+			GL_CALL(glDeleteRenderbuffers(1, &m_ColorAttachment));
+		}
+		else
+		{
+			GL_CALL(glDeleteTextures(1, &m_ColorAttachment));
+		}
+	}
+	if (m_DepthAttachment)
+	{
+		GL_CALL(glDeleteRenderbuffers(1, &m_DepthAttachment));
+	}
+
+	m_RendererID = m_ColorAttachment = m_DepthAttachment = m_ResolveID = m_ResolveTexture = 0;
+	m_Memory.Release();
+}
+
+void Framebuffer::Invalidate()
+{
+	Release();
+
+	const int width = std::max(m_Specification.width, 1);
+	const int height = std::max(m_Specification.height, 1);
+	const bool isMultisampled = m_Specification.samples > 1;
+
+	GL_CALL(glGenFramebuffers(1, &m_RendererID));
+	GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+
+	/* Multisampled color can't be sampled directly, so it's a renderbuffer that gets resolved */
+	if (isMultisampled)
+	{
+		GL_CALL(glGenRenderbuffers(1, &m_ColorAttachment));
+		GL_CALL(glBindRenderbuffer(GL_RENDERBUFFER, m_ColorAttachment));
+		GL_CALL(glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_Specification.samples, GL_RGBA8, width, height));
+		GL_CALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorAttachment));
+	}
+	else
+	{
+		m_ColorAttachment = CreateColorTexture(width, height);
+		GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorAttachment, 0));
+	}
+
+	if (m_Specification.hasDepth)
+	{
+		GL_CALL(glGenRenderbuffers(1, &m_DepthAttachment));
+		GL_CALL(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment));
+		GL_CALL(glRenderbufferStorageMultisample(GL_RENDERBUFFER, isMultisampled ? m_Specification.samples : 0, GL_DEPTH24_STENCIL8, width, height));
+		GL_CALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachment));
+	}
+
+	GL_CALL(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+	CheckStatus("Off-screen");
+
+	if (isMultisampled)
+	{
+		GL_CALL(glGenFramebuffers(1, &m_ResolveID));
+		GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, m_ResolveID));
+		m_ResolveTexture = CreateColorTexture(width, height);
+		GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ResolveTexture, 0));
+		CheckStatus("Resolve");
+	}
+
+	GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	m_Memory.Track(GpuMemoryCategory::RENDER_TARGET, GetGpuSize());
+}
+
+void Framebuffer::Bind() const
+{
+	GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GL_CALL(glViewport(0, 0, m_Specification.width, m_Specification.height));
+}
+
+void Framebuffer::Unbind() const
+{
+	GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::Resize(int width, int height)
+{
+	if (width == m_Specification.width && height == m_Specification.height)
+		return;
+
+	m_Specification.width = width;
+	m_Specification.height = height;
+	Invalidate();
+}
+
+void Framebuffer::SetSamples(int samples)
+{
+	samples = std::max(1, std::min(samples, GetMaxSamples()));
+	if (samples == m_Specification.samples)
+		return;
+
+	/* Release needs the old sample count to know what the color attachment is */
+	Release();
+	m_Specification.samples = samples;
+	Invalidate();
+}
+
+void Framebuffer::Resolve(int width, int height) const
+{
+	if (!m_ResolveID)
+		return;
+
+	/* Same size on both sides: multisampled blits can't scale */
+	GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_ResolveID));
+	GL_CALL(glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+}
+
+void Framebuffer::BlitToScreen(int width, int height, int screenWidth, int screenHeight, GLenum filter) const
+{
+	GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_ResolveID ? m_ResolveID : m_RendererID));
+	GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
+	GL_CALL(glBlitFramebuffer(0, 0, width, height, 0, 0, screenWidth, screenHeight, GL_COLOR_BUFFER_BIT, filter));
+	GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::BlitFromScreen(int width, int height) const
+{
+	GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, 0));
+	GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_RendererID));
+	GL_CALL(glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+	GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+std::size_t Framebuffer::GetGpuSize() const
+{
+	/* RGBA8 color and D24S8 depth are both 4 bytes per sample */
+	const std::size_t pixels = (std::size_t)m_Specification.width * m_Specification.height;
+	std::size_t size = pixels * 4 * m_Specification.samples;
+	if (m_Specification.hasDepth)
+		size += pixels * 4 * m_Specification.samples;
+	if (m_ResolveID)
+		size += pixels * 4;
+	return size;
+}
+
+int Framebuffer::GetMaxSamples()
+{
+	int maxSamples = 1;
+	GL_CALL(glGetIntegerv(GL_MAX_SAMPLES, &maxSamples));
+	return maxSamples;
+}
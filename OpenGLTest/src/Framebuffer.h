@@ -0,0 +1,64 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuMemoryTracker.h"
+
+#include <cstddef>
+
+struct FramebufferSpecification
+{
+	int width = 0;
+	int height = 0;
+	int samples = 1; // More than 1 for MSAA, resolved into a regular texture by `Resolve`
+	bool hasDepth = true; // 24-bit depth + 8-bit stencil
+};
+
+/* Off-screen render target: an RGBA8 color attachment and an optional depth/stencil attachment */
+class Framebuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorAttachment; // Texture, or multisampled renderbuffer with MSAA
+	unsigned int m_DepthAttachment; // Renderbuffer
+
+	/* With MSAA, the single-sampled framebuffer the samples are resolved into */
+	unsigned int m_ResolveID;
+	unsigned int m_ResolveTexture;
+
+	FramebufferSpecification m_Specification;
+	GpuAllocation m_Memory;
+
+public:
+	Framebuffer(const FramebufferSpecification& specification);
+	~Framebuffer();
+
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	// Binds it for drawing, with the viewport covering all of it
+	void Bind() const;
+	void Unbind() const;
+
+	// Recreates the attachments (their content is lost), nothing happens when the size doesn't change
+	void Resize(int width, int height);
+	void SetSamples(int samples);
+
+	// Averages the samples of the [0; width) x [0; height) corner into the color texture (nothing to do without MSAA)
+	void Resolve(int width, int height) const;
+	// Stretches the (resolved) [0; width) x [0; height) corner over the whole default framebuffer
+	void BlitToScreen(int width, int height, int screenWidth, int screenHeight, GLenum filter = GL_LINEAR) const;
+	// Copies the [0; width) x [0; height) corner of the default framebuffer (needs a single-sampled framebuffer)
+	void BlitFromScreen(int width, int height) const;
+
+	// Single-sampled color texture (the resolved one with MSAA)
+	inline unsigned int GetColorTexture() const { return m_ResolveID ? m_ResolveTexture : m_ColorAttachment; }
+	inline const FramebufferSpecification& GetSpecification() const { return m_Specification; }
+	std::size_t GetGpuSize() const;
+
+	static int GetMaxSamples();
+
+private:
+	void Invalidate();
+	void Release();
+};
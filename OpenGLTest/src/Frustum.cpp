@@ -0,0 +1,151 @@
+#include "Frustum.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+	#define FRUSTUM_SSE
+	#include <xmmintrin.h>
+#endif
+
+Frustum Frustum::FromViewProjection(const glm::mat4& viewProjection)
+{
+	/* GLM is column-major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i]) */
+	const glm::mat4 rows = glm::transpose(viewProjection);
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2]; // OpenGL clips z to [-w; w]
+	frustum.planes[5] = rows[3] - rows[2];
+
+	for (glm::vec4& plane : frustum.planes)
+		plane /= glm::length(glm::vec3(plane));
+
+	return frustum;
+}
+
+Containment Frustum::Classify(const AABB& box, uint32_t& planeMask) const
+{
+	const glm::vec3 center = (box.min + box.max) * 0.5f;
+	const glm::vec3 extent = (box.max - box.min) * 0.5f;
+
+	for (int i = 0; i < 6; i++)
+	{
+		if (!(planeMask & (1u << i)))
+			continue;
+
+		/* Signed distance of the center, against how far the box reaches towards the plane */
+		const float distance = glm::dot(glm::vec3(planes[i]), center) + planes[i].w;
+		const float radius = glm::dot(glm::abs(glm::vec3(planes[i])), extent);
+
+		if (distance + radius < 0.0f)
+			return Containment::OUTSIDE;
+		if (distance - radius >= 0.0f)
+			planeMask &= ~(1u << i);
+	}
+
+	return planeMask == 0 ? Containment::INSIDE : Containment::INTERSECTING;
+}
+
+PackedBounds::PackedBounds()
+	: m_Count(0)
+{
+}
+
+void PackedBounds::Resize(std::size_t count)
+{
+	/* Padded so the last group of four can always be loaded whole */
+	const std::size_t paddedCount = (count + 3) / 4 * 4 + 4;
+
+	m_CenterX.resize(paddedCount, 0.0f);
+	m_CenterY.resize(paddedCount, 0.0f);
+	m_CenterZ.resize(paddedCount, 0.0f);
+	m_ExtentX.resize(paddedCount, 0.0f);
+	m_ExtentY.resize(paddedCount, 0.0f);
+	m_ExtentZ.resize(paddedCount, 0.0f);
+	m_Count = count;
+}
+
+void PackedBounds::Set(std::size_t index, const AABB& box)
+{
+	const glm::vec3 center = (box.min + box.max) * 0.5f;
+	const glm::vec3 extent = (box.max - box.min) * 0.5f;
+
+	m_CenterX[index] = center.x;
+	m_CenterY[index] = center.y;
+	m_CenterZ[index] = center.z;
+	m_ExtentX[index] = extent.x;
+	m_ExtentY[index] = extent.y;
+	m_ExtentZ[index] = extent.z;
+}
+
+AABB PackedBounds::Get(std::size_t index) const
+{
+	const glm::vec3 center(m_CenterX[index], m_CenterY[index], m_CenterZ[index]);
+	const glm::vec3 extent(m_ExtentX[index], m_ExtentY[index], m_ExtentZ[index]);
+	return { center - extent, center + extent };
+}
+
+void PackedBounds::Cull(const Frustum& frustum, std::size_t first, std::size_t last, const uint32_t* ids, std::vector<uint32_t>& visible) const
+{
+#ifdef FRUSTUM_SSE
+	/* Plane components broadcast once for the whole range */
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6], absPlaneX[6], absPlaneY[6], absPlaneZ[6];
+	for (int i = 0; i < 6; i++)
+	{
+		planeX[i] = _mm_set1_ps(frustum.planes[i].x);
+		planeY[i] = _mm_set1_ps(frustum.planes[i].y);
+		planeZ[i] = _mm_set1_ps(frustum.planes[i].z);
+		planeW[i] = _mm_set1_ps(frustum.planes[i].w);
+		absPlaneX[i] = _mm_andnot_ps(signMask, planeX[i]);
+		absPlaneY[i] = _mm_andnot_ps(signMask, planeY[i]);
+		absPlaneZ[i] = _mm_andnot_ps(signMask, planeZ[i]);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+
+	for (std::size_t i = first; i < last; i += 4)
+	{
+		const __m128 centerX = _mm_loadu_ps(&m_CenterX[i]);
+		const __m128 centerY = _mm_loadu_ps(&m_CenterY[i]);
+		const __m128 centerZ = _mm_loadu_ps(&m_CenterZ[i]);
+		const __m128 extentX = _mm_loadu_ps(&m_ExtentX[i]);
+		const __m128 extentY = _mm_loadu_ps(&m_ExtentY[i]);
+		const __m128 extentZ = _mm_loadu_ps(&m_ExtentZ[i]);
+
+		/* A box is out as soon as it's fully behind one plane: distance + radius < 0 */
+		__m128 isInside = _mm_cmpeq_ps(zero, zero);
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_mul_ps(planeX[p], centerX), planeW[p]);
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeY[p], centerY));
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[p], centerZ));
+
+			__m128 radius = _mm_mul_ps(absPlaneX[p], extentX);
+			radius = _mm_add_ps(radius, _mm_mul_ps(absPlaneY[p], extentY));
+			radius = _mm_add_ps(radius, _mm_mul_ps(absPlaneZ[p], extentZ));
+
+			isInside = _mm_and_ps(isInside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+		}
+
+		int mask = _mm_movemask_ps(isInside);
+		if (last - i < 4)
+			mask &= (1 << (last - i)) - 1; // Past the end of the range
+
+		while (mask)
+		{
+			const int lane = mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3;
+			mask &= mask - 1;
+			visible.push_back(ids ? ids[i + lane] : (uint32_t)(i + lane));
+		}
+	}
+#else
+	for (std::size_t i = first; i < last; i++)
+	{
+		uint32_t planeMask = 0x3F;
+		if (frustum.Classify(Get(i), planeMask) != Containment::OUTSIDE)
+			visible.push_back(ids ? ids[i] : (uint32_t)i);
+	}
+#endif
+}
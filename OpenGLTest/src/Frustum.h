@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+enum class Containment
+{
+	OUTSIDE = 0,
+	INTERSECTING = 1,
+	INSIDE = 2
+};
+
+struct Frustum
+{
+	glm::vec4 planes[6]; // Left, right, bottom, top, near, far: normal in xyz (pointing inwards), distance in w
+
+	// Gribb-Hartmann: the planes are sums/differences of the matrix rows (works for any projection)
+	static Frustum FromViewProjection(const glm::mat4& viewProjection);
+
+	// Only tests the planes whose bit is set in `planeMask`, clearing the bits of the planes the box is fully inside of
+	Containment Classify(const AABB& box, uint32_t& planeMask) const;
+};
+
+/* Boxes stored as centers and half extents, one array per axis, so four of them can be tested at once */
+class PackedBounds
+{
+private:
+	std::vector<float> m_CenterX, m_CenterY, m_CenterZ;
+	std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ;
+	std::size_t m_Count;
+
+public:
+	PackedBounds();
+
+	void Resize(std::size_t count);
+	void Set(std::size_t index, const AABB& box);
+	AABB Get(std::size_t index) const;
+	inline std::size_t GetCount() const { return m_Count; }
+
+	// Appends the boxes in [first; last) that aren't fully outside the frustum (as ids[index], or index if `ids` is null)
+	void Cull(const Frustum& frustum, std::size_t first, std::size_t last, const uint32_t* ids, std::vector<uint32_t>& visible) const;
+};
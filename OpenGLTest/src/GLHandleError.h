@@ -1,6 +1,7 @@
 #pragma once
 
 #include <GL/glew.h>
+#include "GLTrace.h"
 #include <iostream>
 
 #define ASSERT(x) if (!(x)) __debugbreak();
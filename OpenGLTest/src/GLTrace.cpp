@@ -0,0 +1,174 @@
+#include "GLTrace.h"
+#include "GLHandleError.h"
+
+#include <algorithm>
+
+bool IsGLTraceRecording = false;
+
+GLTrace::GLTrace()
+	: m_File(nullptr), m_FrameCount(0), m_RecordedFrameCount(0), m_CommandCount(0), m_ByteCount(0), m_UnpackAlignment(4)
+{
+}
+
+GLTrace& GLTrace::Get()
+{
+	static GLTrace trace;
+	return trace;
+}
+
+bool GLTrace::Start(const std::string& filepath, int frameCount, int width, int height)
+{
+	Stop();
+
+	m_File = std::fopen(filepath.c_str(), "wb");
+	if (!m_File)
+	{
+		Log("Couldn't open " + filepath + " to write the GL trace");
+		return false;
+	}
+
+	m_Filepath = filepath;
+	m_FrameCount = frameCount;
+	m_RecordedFrameCount = 0;
+	m_CommandCount = 0;
+	m_ByteCount = 0;
+	m_UnpackAlignment = 4;
+	m_Buffer.reserve(FlushSize * 2);
+
+	Header header = {};
+	std::copy(Magic, Magic + sizeof(Magic), header.magic);
+	header.version = Version;
+	header.width = width;
+	header.height = height;
+	Write(header);
+
+	IsGLTraceRecording = true;
+	Log("Recording GL calls to " + filepath + (frameCount > 0 ? " for " + std::to_string(frameCount) + " frames" : ""));
+	return true;
+}
+
+void GLTrace::Stop()
+{
+	if (!m_File)
+		return;
+
+	IsGLTraceRecording = false;
+	Flush();
+	if (!m_File)
+		return; // Failed to write, which already stopped it
+
+	std::fclose(m_File);
+	m_File = nullptr;
+
+	Log("GL trace " + m_Filepath + ": " + std::to_string(m_RecordedFrameCount) + " frames, " + std::to_string(m_CommandCount) + " calls, "
+		+ std::to_string(m_ByteCount / 1024) + " KB");
+}
+
+void GLTrace::OnFrameEnd()
+{
+	if (!IsGLTraceRecording)
+		return;
+
+	Record(TraceCommand::FRAME_END);
+	m_RecordedFrameCount++;
+	Flush();
+
+	if (m_FrameCount > 0 && m_RecordedFrameCount >= m_FrameCount)
+		Stop();
+}
+
+void GLTrace::RecordShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+	/* Replayed as a single string */
+	std::string source;
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (lengths && lengths[i] >= 0)
+			source.append(strings[i], lengths[i]);
+		else
+			source.append(strings[i]);
+	}
+
+	Record(TraceCommand::SHADER_SOURCE, shader, TracePayload { source.data(), (uint32_t)source.size() });
+}
+
+void GLTrace::RecordTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode)
+{
+	Write(TraceCommand::TRANSFORM_FEEDBACK_VARYINGS);
+	Write(program);
+	Write(bufferMode);
+	Write(count);
+	for (GLsizei i = 0; i < count; i++)
+		Write(TracePayload { varyings[i], (uint32_t)std::strlen(varyings[i]) });
+	m_CommandCount++;
+}
+
+void GLTrace::RecordTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+	const uint32_t size = pixels ? (uint32_t)GetImageSize(width, height, format, type, m_UnpackAlignment) : 0;
+	Record(TraceCommand::TEX_IMAGE_2D, target, level, internalFormat, width, height, border, format, type, TracePayload { pixels, size });
+}
+
+std::size_t GLTrace::GetImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, int alignment)
+{
+	std::size_t channelCount = 4;
+	switch (format)
+	{
+		case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT:
+			channelCount = 1;
+			break;
+		case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL:
+			channelCount = 2;
+			break;
+		case GL_RGB: case GL_RGB_INTEGER:
+			channelCount = 3;
+			break;
+	}
+
+	std::size_t channelSize = 1;
+	switch (type)
+	{
+		case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+			channelSize = 2;
+			break;
+		case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+			channelSize = 4;
+			break;
+		case GL_UNSIGNED_INT_24_8:
+			/* Packed: one 32-bit value per pixel */
+			channelCount = 1;
+			channelSize = 4;
+			break;
+	}
+
+	const std::size_t rowSize = (std::size_t)width * channelCount * channelSize;
+	const std::size_t paddedRowSize = (rowSize + alignment - 1) / alignment * alignment;
+	return height > 0 ? paddedRowSize * (height - 1) + rowSize : 0;
+}
+
+void GLTrace::Write(const TracePayload& payload)
+{
+	Write(payload.size);
+	const uint8_t* bytes = (const uint8_t*)payload.data;
+	if (payload.size > 0)
+		m_Buffer.insert(m_Buffer.end(), bytes, bytes + payload.size);
+}
+
+void GLTrace::Flush()
+{
+	if (!m_File || m_Buffer.empty())
+		return;
+
+	if (std::fwrite(m_Buffer.data(), 1, m_Buffer.size(), m_File) != m_Buffer.size())
+	{
+		Log("Couldn't write the GL trace to " + m_Filepath + ", stopping");
+		IsGLTraceRecording = false;
+		m_Buffer.clear();
+		std::fclose(m_File);
+		m_File = nullptr;
+		return;
+	}
+
+	m_ByteCount += m_Buffer.size();
+	m_Buffer.clear();
+}
@@ -0,0 +1,374 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Binary trace of the GL calls the application makes (`--trace`), replayed by `TraceReplayer` (`--replay`)
+ *
+ * Every command is its id followed by its arguments as they are in memory, no tags nor padding. Data the call reads
+ * from client memory (buffer and texture contents, uniform arrays, shader sources, names) follows as a payload: its size,
+ * then its bytes. Object names and uniform locations are recorded as the application saw them and remapped on replay.
+ * Queries, fences and readbacks that only feed the application (GPU timers, frame pacing, frame capture) aren't recorded
+ */
+enum class TraceCommand : uint8_t
+{
+	FRAME_END = 0,
+
+	GEN_BUFFERS, DELETE_BUFFERS, BIND_BUFFER, BIND_BUFFER_BASE, BUFFER_DATA, BUFFER_SUB_DATA, COPY_BUFFER_SUB_DATA, GET_BUFFER_SUB_DATA,
+	GEN_VERTEX_ARRAYS, DELETE_VERTEX_ARRAYS, BIND_VERTEX_ARRAY, ENABLE_VERTEX_ATTRIB_ARRAY, VERTEX_ATTRIB_POINTER, VERTEX_ATTRIB_I_POINTER, VERTEX_ATTRIB_DIVISOR,
+	GEN_TEXTURES, DELETE_TEXTURES, BIND_TEXTURE, ACTIVE_TEXTURE, TEX_PARAMETER_I, TEX_IMAGE_2D, PIXEL_STORE_I,
+	GEN_FRAMEBUFFERS, DELETE_FRAMEBUFFERS, BIND_FRAMEBUFFER, FRAMEBUFFER_TEXTURE_2D, FRAMEBUFFER_RENDERBUFFER, BLIT_FRAMEBUFFER,
+	GEN_RENDERBUFFERS, DELETE_RENDERBUFFERS, BIND_RENDERBUFFER, RENDERBUFFER_STORAGE_MULTISAMPLE,
+	CREATE_SHADER, SHADER_SOURCE, COMPILE_SHADER, DELETE_SHADER,
+	CREATE_PROGRAM, ATTACH_SHADER, DETACH_SHADER, TRANSFORM_FEEDBACK_VARYINGS, LINK_PROGRAM, DELETE_PROGRAM, USE_PROGRAM, GET_UNIFORM_LOCATION,
+	UNIFORM_1I, UNIFORM_1UI, UNIFORM_1F, UNIFORM_2F, UNIFORM_3F, UNIFORM_4F, UNIFORM_4FV, UNIFORM_MATRIX_4FV,
+	ENABLE, DISABLE, BLEND_FUNC, VIEWPORT, CLEAR_COLOR, CLEAR,
+	DRAW_ARRAYS, DRAW_ARRAYS_INSTANCED, DRAW_ELEMENTS, DRAW_ELEMENTS_BASE_VERTEX, MULTI_DRAW_ELEMENTS_INDIRECT, MULTI_DRAW_ELEMENTS_INDIRECT_COUNT,
+	DISPATCH_COMPUTE, MEMORY_BARRIER, BEGIN_TRANSFORM_FEEDBACK, END_TRANSFORM_FEEDBACK,
+	DRAW_BUFFERS, BIND_IMAGE_TEXTURE,
+
+	COUNT
+};
+
+// Client memory read by a call, written after its size
+struct TracePayload
+{
+	const void* data;
+	uint32_t size;
+};
+
+// Set while a trace is being written (defined in GLTrace.cpp): the hooks cost a branch otherwise
+extern bool IsGLTraceRecording;
+
+class GLTrace
+{
+public:
+	static constexpr char Magic[8] = { 'G', 'L', 'T', 'R', 'A', 'C', 'E', '\0' };
+	static constexpr uint32_t Version = 1;
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		int32_t width; // Of the window the trace was recorded in, which the replay opens at the same size
+		int32_t height;
+	};
+
+private:
+	static constexpr std::size_t FlushSize = 1 << 20;
+
+	std::FILE* m_File;
+	std::string m_Filepath;
+	std::vector<uint8_t> m_Buffer; // Written out once it reaches `FlushSize` and at the end of every frame
+	int m_FrameCount; // Stops after that many frames (0 for never)
+	int m_RecordedFrameCount;
+	uint64_t m_CommandCount;
+	uint64_t m_ByteCount;
+	int m_UnpackAlignment; // Rows of glTexImage2D's data are padded to it
+
+	GLTrace();
+
+public:
+	static GLTrace& Get();
+
+	GLTrace(const GLTrace&) = delete;
+	GLTrace& operator=(const GLTrace&) = delete;
+
+	// Right after the context is created, so the trace has every resource's creation in it
+	bool Start(const std::string& filepath, int frameCount, int width, int height);
+	void Stop();
+	// After the frame was presented
+	void OnFrameEnd();
+
+	template<typename... Args>
+	void Record(TraceCommand command, const Args&... args)
+	{
+		Write(command);
+		(Write(args), ...);
+		m_CommandCount++;
+
+		if (m_Buffer.size() >= FlushSize)
+			Flush();
+	}
+
+	/* Calls whose payload takes some work to put together */
+	void RecordShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths);
+	void RecordTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode);
+	void RecordTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
+	inline void SetUnpackAlignment(int alignment) { m_UnpackAlignment = alignment; }
+
+	// Bytes of client memory glTexImage2D reads
+	static std::size_t GetImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, int alignment);
+
+private:
+	template<typename T>
+	void Write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>, "Pointers have to be recorded as payloads or offsets");
+		const uint8_t* bytes = (const uint8_t*)&value;
+		m_Buffer.insert(m_Buffer.end(), bytes, bytes + sizeof(T));
+	}
+
+	void Write(const TracePayload& payload);
+	void Flush();
+};
+
+/*
+ * The hooks: same signature as the GL function, recording it (after the call when it hands back names) and calling it.
+ * The macros below point GL_CALL and every other GL call made past this header at them (`MemoryBarrier` would clash
+ * with the Windows macro, hence its hook's name)
+ */
+namespace gltrace
+{
+	// Pointer arguments that are offsets into a bound buffer
+	inline uint64_t ToOffset(const void* pointer) { return (uint64_t)(uintptr_t)pointer; }
+
+	inline void GenBuffers(GLsizei n, GLuint* buffers) { glGenBuffers(n, buffers); if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::GEN_BUFFERS, n, TracePayload { buffers, (uint32_t)(n * sizeof(GLuint)) }); }
+	inline void DeleteBuffers(GLsizei n, const GLuint* buffers) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DELETE_BUFFERS, n, TracePayload { buffers, (uint32_t)(n * sizeof(GLuint)) }); glDeleteBuffers(n, buffers); }
+	inline void BindBuffer(GLenum target, GLuint buffer) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BIND_BUFFER, target, buffer); glBindBuffer(target, buffer); }
+	inline void BindBufferBase(GLenum target, GLuint index, GLuint buffer) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BIND_BUFFER_BASE, target, index, buffer); glBindBufferBase(target, index, buffer); }
+	inline void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BUFFER_DATA, target, (int64_t)size, usage, TracePayload { data, data ? (uint32_t)size : 0 }); glBufferData(target, size, data, usage); }
+	inline void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BUFFER_SUB_DATA, target, (int64_t)offset, TracePayload { data, (uint32_t)size }); glBufferSubData(target, offset, size, data); }
+	inline void CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::COPY_BUFFER_SUB_DATA, readTarget, writeTarget, (int64_t)readOffset, (int64_t)writeOffset, (int64_t)size); glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size); }
+	inline void GetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::GET_BUFFER_SUB_DATA, target, (int64_t)offset, (int64_t)size); glGetBufferSubData(target, offset, size, data); }
+
+	inline void GenVertexArrays(GLsizei n, GLuint* arrays) { glGenVertexArrays(n, arrays); if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::GEN_VERTEX_ARRAYS, n, TracePayload { arrays, (uint32_t)(n * sizeof(GLuint)) }); }
+	inline void DeleteVertexArrays(GLsizei n, const GLuint* arrays) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DELETE_VERTEX_ARRAYS, n, TracePayload { arrays, (uint32_t)(n * sizeof(GLuint)) }); glDeleteVertexArrays(n, arrays); }
+	inline void BindVertexArray(GLuint array) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BIND_VERTEX_ARRAY, array); glBindVertexArray(array); }
+	inline void EnableVertexAttribArray(GLuint index) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::ENABLE_VERTEX_ATTRIB_ARRAY, index); glEnableVertexAttribArray(index); }
+	inline void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::VERTEX_ATTRIB_POINTER, index, size, type, normalized, stride, ToOffset(pointer)); glVertexAttribPointer(index, size, type, normalized, stride, pointer); }
+	inline void VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::VERTEX_ATTRIB_I_POINTER, index, size, type, stride, ToOffset(pointer)); glVertexAttribIPointer(index, size, type, stride, pointer); }
+	inline void VertexAttribDivisor(GLuint index, GLuint divisor) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::VERTEX_ATTRIB_DIVISOR, index, divisor); glVertexAttribDivisor(index, divisor); }
+
+	inline void GenTextures(GLsizei n, GLuint* textures) { glGenTextures(n, textures); if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::GEN_TEXTURES, n, TracePayload { textures, (uint32_t)(n * sizeof(GLuint)) }); }
+	inline void DeleteTextures(GLsizei n, const GLuint* textures) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DELETE_TEXTURES, n, TracePayload { textures, (uint32_t)(n * sizeof(GLuint)) }); glDeleteTextures(n, textures); }
+	inline void BindTexture(GLenum target, GLuint texture) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BIND_TEXTURE, target, texture); glBindTexture(target, texture); }
+	inline void ActiveTexture(GLenum texture) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::ACTIVE_TEXTURE, texture); glActiveTexture(texture); }
+	inline void TexParameteri(GLenum target, GLenum name, GLint param) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::TEX_PARAMETER_I, target, name, param); glTexParameteri(target, name, param); }
+	inline void TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) { if (IsGLTraceRecording) GLTrace::Get().RecordTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels); glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels); }
+	inline void PixelStorei(GLenum name, GLint param)
+	{
+		if (IsGLTraceRecording)
+		{
+			GLTrace::Get().Record(TraceCommand::PIXEL_STORE_I, name, param);
+			if (name == GL_UNPACK_ALIGNMENT)
+				GLTrace::Get().SetUnpackAlignment(param);
+		}
+		glPixelStorei(name, param);
+	}
+
+	inline void GenFramebuffers(GLsizei n, GLuint* framebuffers) { glGenFramebuffers(n, framebuffers); if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::GEN_FRAMEBUFFERS, n, TracePayload { framebuffers, (uint32_t)(n * sizeof(GLuint)) }); }
+	inline void DeleteFramebuffers(GLsizei n, const GLuint* framebuffers) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DELETE_FRAMEBUFFERS, n, TracePayload { framebuffers, (uint32_t)(n * sizeof(GLuint)) }); glDeleteFramebuffers(n, framebuffers); }
+	inline void BindFramebuffer(GLenum target, GLuint framebuffer) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BIND_FRAMEBUFFER, target, framebuffer); glBindFramebuffer(target, framebuffer); }
+	inline void FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::FRAMEBUFFER_TEXTURE_2D, target, attachment, textureTarget, texture, level); glFramebufferTexture2D(target, attachment, textureTarget, texture, level); }
+	inline void FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::FRAMEBUFFER_RENDERBUFFER, target, attachment, renderbufferTarget, renderbuffer); glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer); }
+	inline void BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BLIT_FRAMEBUFFER, srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter); glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter); }
+	inline void GenRenderbuffers(GLsizei n, GLuint* renderbuffers) { glGenRenderbuffers(n, renderbuffers); if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::GEN_RENDERBUFFERS, n, TracePayload { renderbuffers, (uint32_t)(n * sizeof(GLuint)) }); }
+	inline void DeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DELETE_RENDERBUFFERS, n, TracePayload { renderbuffers, (uint32_t)(n * sizeof(GLuint)) }); glDeleteRenderbuffers(n, renderbuffers); }
+	inline void BindRenderbuffer(GLenum target, GLuint renderbuffer) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BIND_RENDERBUFFER, target, renderbuffer); glBindRenderbuffer(target, renderbuffer); }
+	inline void RenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::RENDERBUFFER_STORAGE_MULTISAMPLE, target, samples, internalFormat, width, height); glRenderbufferStorageMultisample(target, samples, internalFormat, width, height); }
+
+	inline GLuint CreateShader(GLenum type) { const GLuint shader = glCreateShader(type); if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::CREATE_SHADER, type, shader); return shader; }
+	inline void ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) { if (IsGLTraceRecording) GLTrace::Get().RecordShaderSource(shader, count, strings, lengths); glShaderSource(shader, count, strings, lengths); }
+	inline void CompileShader(GLuint shader) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::COMPILE_SHADER, shader); glCompileShader(shader); }
+	inline void DeleteShader(GLuint shader) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DELETE_SHADER, shader); glDeleteShader(shader); }
+	inline GLuint CreateProgram() { const GLuint program = glCreateProgram(); if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::CREATE_PROGRAM, program); return program; }
+	inline void AttachShader(GLuint program, GLuint shader) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::ATTACH_SHADER, program, shader); glAttachShader(program, shader); }
+	inline void DetachShader(GLuint program, GLuint shader) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DETACH_SHADER, program, shader); glDetachShader(program, shader); }
+	inline void TransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode) { if (IsGLTraceRecording) GLTrace::Get().RecordTransformFeedbackVaryings(program, count, varyings, bufferMode); glTransformFeedbackVaryings(program, count, varyings, bufferMode); }
+	inline void LinkProgram(GLuint program) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::LINK_PROGRAM, program); glLinkProgram(program); }
+	inline void DeleteProgram(GLuint program) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DELETE_PROGRAM, program); glDeleteProgram(program); }
+	inline void UseProgram(GLuint program) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::USE_PROGRAM, program); glUseProgram(program); }
+	inline GLint GetUniformLocation(GLuint program, const GLchar* name) { const GLint location = glGetUniformLocation(program, name); if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::GET_UNIFORM_LOCATION, program, location, TracePayload { name, (uint32_t)std::strlen(name) }); return location; }
+
+	inline void Uniform1i(GLint location, GLint v0) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::UNIFORM_1I, location, v0); glUniform1i(location, v0); }
+	inline void Uniform1ui(GLint location, GLuint v0) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::UNIFORM_1UI, location, v0); glUniform1ui(location, v0); }
+	inline void Uniform1f(GLint location, GLfloat v0) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::UNIFORM_1F, location, v0); glUniform1f(location, v0); }
+	inline void Uniform2f(GLint location, GLfloat v0, GLfloat v1) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::UNIFORM_2F, location, v0, v1); glUniform2f(location, v0, v1); }
+	inline void Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::UNIFORM_3F, location, v0, v1, v2); glUniform3f(location, v0, v1, v2); }
+	inline void Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::UNIFORM_4F, location, v0, v1, v2, v3); glUniform4f(location, v0, v1, v2, v3); }
+	inline void Uniform4fv(GLint location, GLsizei count, const GLfloat* value) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::UNIFORM_4FV, location, TracePayload { value, (uint32_t)(count * 4 * sizeof(GLfloat)) }); glUniform4fv(location, count, value); }
+	inline void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::UNIFORM_MATRIX_4FV, location, transpose, TracePayload { value, (uint32_t)(count * 16 * sizeof(GLfloat)) }); glUniformMatrix4fv(location, count, transpose, value); }
+
+	inline void Enable(GLenum capability) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::ENABLE, capability); glEnable(capability); }
+	inline void Disable(GLenum capability) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DISABLE, capability); glDisable(capability); }
+	inline void BlendFunc(GLenum sourceFactor, GLenum destinationFactor) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BLEND_FUNC, sourceFactor, destinationFactor); glBlendFunc(sourceFactor, destinationFactor); }
+	inline void Viewport(GLint x, GLint y, GLsizei width, GLsizei height) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::VIEWPORT, x, y, width, height); glViewport(x, y, width, height); }
+	inline void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::CLEAR_COLOR, red, green, blue, alpha); glClearColor(red, green, blue, alpha); }
+	inline void Clear(GLbitfield mask) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::CLEAR, mask); glClear(mask); }
+
+	inline void DrawArrays(GLenum mode, GLint first, GLsizei count) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DRAW_ARRAYS, mode, first, count); glDrawArrays(mode, first, count); }
+	inline void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DRAW_ARRAYS_INSTANCED, mode, first, count, instanceCount); glDrawArraysInstanced(mode, first, count, instanceCount); }
+	inline void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DRAW_ELEMENTS, mode, count, type, ToOffset(indices)); glDrawElements(mode, count, type, indices); }
+	inline void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint baseVertex) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DRAW_ELEMENTS_BASE_VERTEX, mode, count, type, ToOffset(indices), baseVertex); glDrawElementsBaseVertex(mode, count, type, indices, baseVertex); }
+	inline void MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::MULTI_DRAW_ELEMENTS_INDIRECT, mode, type, ToOffset(indirect), drawCount, stride); glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride); }
+	inline void MultiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT, mode, type, ToOffset(indirect), (int64_t)drawCount, maxDrawCount, stride); glMultiDrawElementsIndirectCount(mode, type, indirect, drawCount, maxDrawCount, stride); }
+	inline void MultiDrawElementsIndirectCountARB(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT, mode, type, ToOffset(indirect), (int64_t)drawCount, maxDrawCount, stride); glMultiDrawElementsIndirectCountARB(mode, type, indirect, drawCount, maxDrawCount, stride); }
+	inline void DispatchCompute(GLuint x, GLuint y, GLuint z) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DISPATCH_COMPUTE, x, y, z); glDispatchCompute(x, y, z); }
+	inline void IssueMemoryBarrier(GLbitfield barriers) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::MEMORY_BARRIER, barriers); glMemoryBarrier(barriers); }
+	inline void BeginTransformFeedback(GLenum primitiveMode) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BEGIN_TRANSFORM_FEEDBACK, primitiveMode); glBeginTransformFeedback(primitiveMode); }
+	inline void EndTransformFeedback() { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::END_TRANSFORM_FEEDBACK); glEndTransformFeedback(); }
+
+	inline void DrawBuffers(GLsizei n, const GLenum* buffers) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::DRAW_BUFFERS, TracePayload { buffers, (uint32_t)(n * sizeof(GLenum)) }); glDrawBuffers(n, buffers); }
+	inline void BindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format) { if (IsGLTraceRecording) GLTrace::Get().Record(TraceCommand::BIND_IMAGE_TEXTURE, unit, texture, level, layered, layer, access, format); glBindImageTexture(unit, texture, level, layered, layer, access, format); }
+}
+
+/* The replayer calls GL directly */
+#ifndef GL_TRACE_NO_HOOKS
+	#undef glGenBuffers
+	#define glGenBuffers gltrace::GenBuffers
+	#undef glDeleteBuffers
+	#define glDeleteBuffers gltrace::DeleteBuffers
+	#undef glBindBuffer
+	#define glBindBuffer gltrace::BindBuffer
+	#undef glBindBufferBase
+	#define glBindBufferBase gltrace::BindBufferBase
+	#undef glBufferData
+	#define glBufferData gltrace::BufferData
+	#undef glBufferSubData
+	#define glBufferSubData gltrace::BufferSubData
+	#undef glCopyBufferSubData
+	#define glCopyBufferSubData gltrace::CopyBufferSubData
+	#undef glGetBufferSubData
+	#define glGetBufferSubData gltrace::GetBufferSubData
+
+	#undef glGenVertexArrays
+	#define glGenVertexArrays gltrace::GenVertexArrays
+	#undef glDeleteVertexArrays
+	#define glDeleteVertexArrays gltrace::DeleteVertexArrays
+	#undef glBindVertexArray
+	#define glBindVertexArray gltrace::BindVertexArray
+	#undef glEnableVertexAttribArray
+	#define glEnableVertexAttribArray gltrace::EnableVertexAttribArray
+	#undef glVertexAttribPointer
+	#define glVertexAttribPointer gltrace::VertexAttribPointer
+	#undef glVertexAttribIPointer
+	#define glVertexAttribIPointer gltrace::VertexAttribIPointer
+	#undef glVertexAttribDivisor
+	#define glVertexAttribDivisor gltrace::VertexAttribDivisor
+
+	#undef glGenTextures
+	#define glGenTextures gltrace::GenTextures
+	#undef glDeleteTextures
+	#define glDeleteTextures gltrace::DeleteTextures
+	#undef glBindTexture
+	#define glBindTexture gltrace::BindTexture
+	#undef glActiveTexture
+	#define glActiveTexture gltrace::ActiveTexture
+	#undef glTexParameteri
+	#define glTexParameteri gltrace::TexParameteri
+	#undef glTexImage2D
+	#define glTexImage2D gltrace::TexImage2D
+	#undef glPixelStorei
+	#define glPixelStorei gltrace::PixelStorei
+
+	#undef glGenFramebuffers
+	#define glGenFramebuffers gltrace::GenFramebuffers
+	#undef glDeleteFramebuffers
+	#define glDeleteFramebuffers gltrace::DeleteFramebuffers
+	#undef glBindFramebuffer
+	#define glBindFramebuffer gltrace::BindFramebuffer
+	#undef glFramebufferTexture2D
+	#define glFramebufferTexture2D gltrace::FramebufferTexture2D
+	#undef glFramebufferRenderbuffer
+	#define glFramebufferRenderbuffer gltrace::FramebufferRenderbuffer
+	#undef glBlitFramebuffer
+	#define glBlitFramebuffer gltrace::BlitFramebuffer
+	#undef glGenRenderbuffers
+	#define glGenRenderbuffers gltrace::GenRenderbuffers
+	#undef glDeleteRenderbuffers
+	#define glDeleteRenderbuffers gltrace::DeleteRenderbuffers
+	#undef glBindRenderbuffer
+	#define glBindRenderbuffer gltrace::BindRenderbuffer
+	#undef glRenderbufferStorageMultisample
+	#define glRenderbufferStorageMultisample gltrace::RenderbufferStorageMultisample
+
+	#undef glCreateShader
+	#define glCreateShader gltrace::CreateShader
+	#undef glShaderSource
+	#define glShaderSource gltrace::ShaderSource
+	#undef glCompileShader
+	#define glCompileShader gltrace::CompileShader
+	#undef glDeleteShader
+	#define glDeleteShader gltrace::DeleteShader
+	#undef glCreateProgram
+	#define glCreateProgram gltrace::CreateProgram
+	#undef glAttachShader
+	#define glAttachShader gltrace::AttachShader
+	#undef glDetachShader
+	#define glDetachShader gltrace::DetachShader
+	#undef glTransformFeedbackVaryings
+	#define glTransformFeedbackVaryings gltrace::TransformFeedbackVaryings
+	#undef glLinkProgram
+	#define glLinkProgram gltrace::LinkProgram
+	#undef glDeleteProgram
+	#define glDeleteProgram gltrace::DeleteProgram
+	#undef glUseProgram
+	#define glUseProgram gltrace::UseProgram
+	#undef glGetUniformLocation
+	#define glGetUniformLocation gltrace::GetUniformLocation
+
+	#undef glUniform1i
+	#define glUniform1i gltrace::Uniform1i
+	#undef glUniform1ui
+	#define glUniform1ui gltrace::Uniform1ui
+	#undef glUniform1f
+	#define glUniform1f gltrace::Uniform1f
+	#undef glUniform2f
+	#define glUniform2f gltrace::Uniform2f
+	#undef glUniform3f
+	#define glUniform3f gltrace::Uniform3f
+	#undef glUniform4f
+	#define glUniform4f gltrace::Uniform4f
+	#undef glUniform4fv
+	#define glUniform4fv gltrace::Uniform4fv
+	#undef glUniformMatrix4fv
+	#define glUniformMatrix4fv gltrace::UniformMatrix4fv
+
+	#undef glEnable
+	#define glEnable gltrace::Enable
+	#undef glDisable
+	#define glDisable gltrace::Disable
+	#undef glBlendFunc
+	#define glBlendFunc gltrace::BlendFunc
+	#undef glViewport
+	#define glViewport gltrace::Viewport
+	#undef glClearColor
+	#define glClearColor gltrace::ClearColor
+	#undef glClear
+	#define glClear gltrace::Clear
+
+	#undef glDrawArrays
+	#define glDrawArrays gltrace::DrawArrays
+	#undef glDrawArraysInstanced
+	#define glDrawArraysInstanced gltrace::DrawArraysInstanced
+	#undef glDrawElements
+	#define glDrawElements gltrace::DrawElements
+	#undef glDrawElementsBaseVertex
+	#define glDrawElementsBaseVertex gltrace::DrawElementsBaseVertex
+	#undef glMultiDrawElementsIndirect
+	#define glMultiDrawElementsIndirect gltrace::MultiDrawElementsIndirect
+	#undef glMultiDrawElementsIndirectCount
+	#define glMultiDrawElementsIndirectCount gltrace::MultiDrawElementsIndirectCount
+	#undef glMultiDrawElementsIndirectCountARB
+	#define glMultiDrawElementsIndirectCountARB gltrace::MultiDrawElementsIndirectCountARB
+	#undef glDispatchCompute
+	#define glDispatchCompute gltrace::DispatchCompute
+	#undef glMemoryBarrier
+	#define glMemoryBarrier gltrace::IssueMemoryBarrier
+	#undef glBeginTransformFeedback
+	#define glBeginTransformFeedback gltrace::BeginTransformFeedback
+	#undef glEndTransformFeedback
+	#define glEndTransformFeedback gltrace::EndTransformFeedback
+	#undef glDrawBuffers
+	#define glDrawBuffers gltrace::DrawBuffers
+	#undef glBindImageTexture
+	#define glBindImageTexture gltrace::BindImageTexture
+#endif
@@ -0,0 +1,201 @@
+#include "GeometryPool.h"
+#include "GLHandleError.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+
+GeometryPool::Page::Page(uint32_t vertexCapacity, uint32_t indexCapacity)
+	: vertexAllocator(vertexCapacity, 64), indexAllocator(indexCapacity, 256)
+{
+}
+
+GeometryPool::GeometryPool(const VertexBufferLayout& layout, uint32_t verticesPerPage, uint32_t indicesPerPage)
+	: m_Layout(layout), m_VerticesPerPage(verticesPerPage), m_IndicesPerPage(indicesPerPage), m_MeshCount(0)
+{
+}
+
+uint32_t GeometryPool::CreatePage(uint32_t minVertexCount, uint32_t minIndexCount)
+{
+	/* Meshes larger than a page get a page of their own */
+	auto page = std::make_unique<Page>(std::max(m_VerticesPerPage, minVertexCount), std::max(m_IndicesPerPage, minIndexCount));
+
+	page->vertexBuffer = std::make_unique<VertexBuffer>(nullptr, page->vertexAllocator.GetCapacity() * m_Layout.GetStride());
+	page->indexBuffer = std::make_unique<IndexBuffer>(nullptr, page->indexAllocator.GetCapacity());
+	SetUpVertexArray(*page);
+
+	m_Pages.push_back(std::move(page));
+	return (uint32_t)m_Pages.size() - 1;
+}
+
+void GeometryPool::SetUpVertexArray(Page& page) const
+{
+	/* The vertex array keeps the index buffer binding, so binding the page binds everything */
+	page.vertexArray = std::make_unique<VertexArray>();
+	page.vertexArray->AddBuffer(*page.vertexBuffer, m_Layout);
+	page.indexBuffer->Bind();
+
+	page.vertexArray->Unbind();
+	page.vertexBuffer->Unbind();
+	page.indexBuffer->Unbind();
+}
+
+MeshAllocation GeometryPool::Place(uint32_t vertexCount, uint32_t indexCount)
+{
+	MeshAllocation allocation;
+	allocation.vertexCount = vertexCount;
+	allocation.indexCount = indexCount;
+
+	/* First page with room for both the vertices and the indices */
+	for (uint32_t page = 0; page < m_Pages.size(); page++)
+	{
+		const uint32_t baseVertex = m_Pages[page]->vertexAllocator.Allocate(vertexCount);
+		if (baseVertex == BuddyAllocator::InvalidOffset)
+			continue;
+
+		const uint32_t firstIndex = m_Pages[page]->indexAllocator.Allocate(indexCount);
+		if (firstIndex == BuddyAllocator::InvalidOffset)
+		{
+			m_Pages[page]->vertexAllocator.Free(baseVertex);
+			continue;
+		}
+
+		allocation.page = page;
+		allocation.baseVertex = baseVertex;
+		allocation.firstIndex = firstIndex;
+		return allocation;
+	}
+
+	allocation.page = CreatePage(vertexCount, indexCount);
+	allocation.baseVertex = m_Pages[allocation.page]->vertexAllocator.Allocate(vertexCount);
+	allocation.firstIndex = m_Pages[allocation.page]->indexAllocator.Allocate(indexCount);
+	ASSERT(allocation.baseVertex != BuddyAllocator::InvalidOffset && allocation.firstIndex != BuddyAllocator::InvalidOffset);
+
+	return allocation;
+}
+
+MeshID GeometryPool::Allocate(const void* vertices, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount)
+{
+	ASSERT(vertexCount > 0 && indexCount > 0);
+
+	const MeshAllocation allocation = Place(vertexCount, indexCount);
+	const Page& page = *m_Pages[allocation.page];
+
+	/* Indices stay relative to the mesh, `baseVertex` offsets them when drawing */
+	const unsigned int stride = m_Layout.GetStride();
+	page.vertexBuffer->SetData(vertices, vertexCount * stride, allocation.baseVertex * stride);
+	page.indexBuffer->SetData(indices, indexCount, allocation.firstIndex);
+
+	MeshID mesh;
+	if (!m_FreeMeshIDs.empty())
+	{
+		mesh = m_FreeMeshIDs.back();
+		m_FreeMeshIDs.pop_back();
+	}
+	else
+	{
+		mesh = (MeshID)m_Meshes.size();
+		m_Meshes.emplace_back();
+		m_IsMeshAlive.push_back(0);
+	}
+
+	m_Meshes[mesh] = allocation;
+	m_IsMeshAlive[mesh] = 1;
+	m_MeshCount++;
+
+	return mesh;
+}
+
+void GeometryPool::Free(MeshID mesh)
+{
+	ASSERT(mesh < m_Meshes.size() && m_IsMeshAlive[mesh]);
+
+	const MeshAllocation& allocation = m_Meshes[mesh];
+	m_Pages[allocation.page]->vertexAllocator.Free(allocation.baseVertex);
+	m_Pages[allocation.page]->indexAllocator.Free(allocation.firstIndex);
+
+	m_IsMeshAlive[mesh] = 0;
+	m_FreeMeshIDs.push_back(mesh);
+	m_MeshCount--;
+}
+
+std::size_t GeometryPool::Defragment()
+{
+	/* Largest first: a fresh buddy allocator then packs the blocks without any hole */
+	std::vector<MeshID> liveMeshes;
+	liveMeshes.reserve(m_MeshCount);
+	for (MeshID mesh = 0; mesh < m_Meshes.size(); mesh++)
+	{
+		if (m_IsMeshAlive[mesh])
+			liveMeshes.push_back(mesh);
+	}
+
+	std::sort(liveMeshes.begin(), liveMeshes.end(), [this](MeshID a, MeshID b) {
+		return m_Meshes[a].vertexCount > m_Meshes[b].vertexCount;
+	});
+
+	const std::vector<std::unique_ptr<Page>> oldPages = std::move(m_Pages);
+	m_Pages.clear();
+
+	/* Copy buffer to buffer on the GPU, the data never comes back to the CPU */
+	const unsigned int stride = m_Layout.GetStride();
+	for (MeshID mesh : liveMeshes)
+	{
+		const MeshAllocation oldAllocation = m_Meshes[mesh];
+		const MeshAllocation allocation = Place(oldAllocation.vertexCount, oldAllocation.indexCount);
+		const Page& oldPage = *oldPages[oldAllocation.page];
+		const Page& page = *m_Pages[allocation.page];
+
+		GL_CALL(glBindBuffer(GL_COPY_READ_BUFFER, oldPage.vertexBuffer->GetRendererID()));
+		GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, page.vertexBuffer->GetRendererID()));
+		GL_CALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, oldAllocation.baseVertex * stride, allocation.baseVertex * stride, allocation.vertexCount * stride));
+
+		GL_CALL(glBindBuffer(GL_COPY_READ_BUFFER, oldPage.indexBuffer->GetRendererID()));
+		GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, page.indexBuffer->GetRendererID()));
+		GL_CALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, oldAllocation.firstIndex * sizeof(unsigned int), allocation.firstIndex * sizeof(unsigned int), allocation.indexCount * sizeof(unsigned int)));
+
+		m_Meshes[mesh] = allocation;
+	}
+
+	GL_CALL(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+	GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+
+	return oldPages.size() - m_Pages.size();
+}
+
+void GeometryPool::BindPage(uint32_t page) const
+{
+	m_Pages[page]->vertexArray->Bind();
+}
+
+void GeometryPool::UnbindPage() const
+{
+	GL_CALL(glBindVertexArray(0));
+	RenderStats::Get().OnVertexArrayBound(0);
+}
+
+GeometryPoolStats GeometryPool::GetStats() const
+{
+	GeometryPoolStats stats;
+	stats.pageCount = m_Pages.size();
+	stats.meshCount = m_MeshCount;
+
+	for (const auto& page : m_Pages)
+	{
+		const BuddyAllocator& vertices = page->vertexAllocator;
+		const BuddyAllocator& indices = page->indexAllocator;
+
+		stats.vertexCapacity += vertices.GetCapacity();
+		stats.allocatedVertices += vertices.GetAllocatedSize();
+		stats.usedVertices += vertices.GetRequestedSize();
+		stats.indexCapacity += indices.GetCapacity();
+		stats.allocatedIndices += indices.GetAllocatedSize();
+		stats.usedIndices += indices.GetRequestedSize();
+
+		stats.largestFreeVertexBlock = std::max<std::size_t>(stats.largestFreeVertexBlock, vertices.GetLargestFreeBlock());
+		stats.largestFreeIndexBlock = std::max<std::size_t>(stats.largestFreeIndexBlock, indices.GetLargestFreeBlock());
+		stats.vertexFragmentation = std::max(stats.vertexFragmentation, vertices.GetExternalFragmentation());
+		stats.indexFragmentation = std::max(stats.indexFragmentation, indices.GetExternalFragmentation());
+	}
+
+	return stats;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "BuddyAllocator.h"
+
+using MeshID = uint32_t;
+constexpr MeshID InvalidMesh = UINT32_MAX;
+
+// Where a mesh lives: draw it with glDrawElementsBaseVertex(firstIndex, baseVertex) with its page bound
+struct MeshAllocation
+{
+	uint32_t page = 0;
+	uint32_t baseVertex = 0;
+	uint32_t firstIndex = 0;
+	uint32_t vertexCount = 0;
+	uint32_t indexCount = 0;
+};
+
+struct GeometryPoolStats
+{
+	std::size_t pageCount = 0;
+	std::size_t meshCount = 0;
+
+	/* In vertices and indices, summed over the pages */
+	std::size_t vertexCapacity = 0;
+	std::size_t allocatedVertices = 0;
+	std::size_t usedVertices = 0; // Actually written (the rest of the allocated blocks is rounding)
+	std::size_t indexCapacity = 0;
+	std::size_t allocatedIndices = 0;
+	std::size_t usedIndices = 0;
+
+	std::size_t largestFreeVertexBlock = 0; // In any page
+	std::size_t largestFreeIndexBlock = 0;
+	float vertexFragmentation = 0.0f; // Worst page, see `BuddyAllocator::GetExternalFragmentation`
+	float indexFragmentation = 0.0f;
+};
+
+/*
+ * Many meshes, few buffers: every page is one large vertex buffer and index buffer (and the vertex array binding
+ * them), carved up by buddy allocators. Meshes sharing a page are drawn one after the other without rebinding anything
+ * All the meshes share one vertex layout
+ */
+class GeometryPool
+{
+private:
+	struct Page
+	{
+		std::unique_ptr<VertexArray> vertexArray;
+		std::unique_ptr<VertexBuffer> vertexBuffer;
+		std::unique_ptr<IndexBuffer> indexBuffer;
+		BuddyAllocator vertexAllocator; // In vertices, so block offsets are directly the base vertices
+		BuddyAllocator indexAllocator;
+
+		Page(uint32_t vertexCapacity, uint32_t indexCapacity);
+	};
+
+	VertexBufferLayout m_Layout;
+	uint32_t m_VerticesPerPage;
+	uint32_t m_IndicesPerPage;
+
+	std::vector<std::unique_ptr<Page>> m_Pages;
+	std::vector<MeshAllocation> m_Meshes; // Per `MeshID`, stable across `Defragment`
+	std::vector<uint8_t> m_IsMeshAlive;
+	std::vector<MeshID> m_FreeMeshIDs;
+	std::size_t m_MeshCount;
+
+public:
+	GeometryPool(const VertexBufferLayout& layout, uint32_t verticesPerPage = 1 << 18, uint32_t indicesPerPage = 1 << 20);
+
+	// Copies the mesh into the first page with room for it (a new page when none has), `vertices` follows the layout
+	MeshID Allocate(const void* vertices, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount);
+	void Free(MeshID mesh);
+
+	// Repacks the live meshes, largest first, into as few pages as possible (copied on the GPU), then drops the
+	// empty pages. IDs stay valid but their allocations move. Returns the number of pages released
+	std::size_t Defragment();
+
+	void BindPage(uint32_t page) const;
+	void UnbindPage() const;
+
+	inline const MeshAllocation& GetMesh(MeshID mesh) const { return m_Meshes[mesh]; }
+	inline std::size_t GetMeshCount() const { return m_MeshCount; }
+	inline std::size_t GetPageCount() const { return m_Pages.size(); }
+
+	GeometryPoolStats GetStats() const;
+
+private:
+	// Allocates room for a mesh, creating a page when none has any
+	MeshAllocation Place(uint32_t vertexCount, uint32_t indexCount);
+	uint32_t CreatePage(uint32_t minVertexCount, uint32_t minIndexCount);
+	void SetUpVertexArray(Page& page) const;
+};
@@ -0,0 +1,256 @@
+#include "GpuDrivenRenderer.h"
+#include "GLHandleError.h"
+#include "FrameArena.h"
+#include "RenderStats.h"
+
+#include <cfloat>
+
+static AABB TransformBounds(const AABB& bounds, const glm::mat4& matrix)
+{
+	/* Bounds of the 8 transformed corners */
+	AABB result = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+	for (int corner = 0; corner < 8; corner++)
+	{
+		const glm::vec3 point(
+			corner & 1 ? bounds.max.x : bounds.min.x,
+			corner & 2 ? bounds.max.y : bounds.min.y,
+			corner & 4 ? bounds.max.z : bounds.min.z
+		);
+		const glm::vec3 transformed = glm::vec3(matrix * glm::vec4(point, 1.0f));
+		result.min = glm::min(result.min, transformed);
+		result.max = glm::max(result.max, transformed);
+	}
+
+	return result;
+}
+
+GpuDrivenRenderer::GpuDrivenRenderer()
+	: m_ObjectIndexBuffer(0), m_ObjectIndexCapacity(0), m_AreObjectsDirty(false), m_ReadbackFences(), m_FrameIndex(0), m_VisibleCount(0),
+	m_IsDrawCountSupported(GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters), m_IsDrawCountEnabled(false)
+{
+	m_IsDrawCountEnabled = m_IsDrawCountSupported;
+
+	m_CullingShader = ResourceManager::Get().GetShader("res/shaders/GpuCulling.shader");
+	m_DrawShader = ResourceManager::Get().GetShader("res/shaders/GpuDriven.shader");
+
+	m_MeshBuffer = std::make_unique<ShaderStorageBuffer>(nullptr, (unsigned int)sizeof(GpuMesh));
+	m_ObjectBuffer = std::make_unique<ShaderStorageBuffer>(nullptr, (unsigned int)sizeof(GpuObject));
+	m_CommandBuffer = std::make_unique<ShaderStorageBuffer>(nullptr, (unsigned int)sizeof(DrawElementsIndirectCommand));
+	m_DrawCountBuffer = std::make_unique<ShaderStorageBuffer>(nullptr, (unsigned int)sizeof(uint32_t));
+	for (auto& readbackBuffer : m_ReadbackBuffers)
+		readbackBuffer = std::make_unique<ShaderStorageBuffer>(nullptr, (unsigned int)sizeof(uint32_t), GL_STREAM_READ);
+}
+
+GpuDrivenRenderer::~GpuDrivenRenderer()
+{
+	for (GLsync fence : m_ReadbackFences)
+	{
+		if (fence)
+		{
+			GL_CALL(glDeleteSync(fence));
+		}
+	}
+
+	if (m_ObjectIndexBuffer)
+	{
+		GL_CALL(glDeleteBuffers(1, &m_ObjectIndexBuffer));
+	}
+}
+
+bool GpuDrivenRenderer::IsSupported()
+{
+	return GLEW_VERSION_4_3;
+}
+
+uint32_t GpuDrivenRenderer::AddMesh(const float* positions, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount)
+{
+	/* Indices stay relative to the mesh, baseVertex offsets them into the shared buffer */
+	GpuMesh mesh = { indexCount, (uint32_t)m_Indices.size(), (int32_t)(m_Positions.size() / 3), 0 };
+
+	AABB bounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const glm::vec3 position(positions[i * 3 + 0], positions[i * 3 + 1], positions[i * 3 + 2]);
+		bounds.min = glm::min(bounds.min, position);
+		bounds.max = glm::max(bounds.max, position);
+	}
+
+	m_Positions.insert(m_Positions.end(), positions, positions + vertexCount * 3);
+	m_Indices.insert(m_Indices.end(), indices, indices + indexCount);
+	m_Meshes.push_back(mesh);
+	m_MeshBounds.push_back(bounds);
+
+	return (uint32_t)m_Meshes.size() - 1;
+}
+
+void GpuDrivenRenderer::UploadMeshes()
+{
+	m_VertexArray = std::make_unique<VertexArray>();
+	m_VertexBuffer = std::make_unique<VertexBuffer>(m_Positions.data(), (unsigned int)(m_Positions.size() * sizeof(float)));
+
+	VertexBufferLayout layout;
+	layout.Push(GL_FLOAT, 3);
+	m_VertexArray->AddBuffer(*m_VertexBuffer, layout);
+
+	m_IndexBuffer = std::make_unique<IndexBuffer>(m_Indices.data(), (unsigned int)m_Indices.size());
+
+	/* Attribute 1: the object index, advanced once per instance */
+	if (!m_ObjectIndexBuffer)
+	{
+		GL_CALL(glGenBuffers(1, &m_ObjectIndexBuffer));
+	}
+	GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, m_ObjectIndexBuffer));
+	GL_CALL(glEnableVertexAttribArray(1));
+	GL_CALL(glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(uint32_t), nullptr));
+	GL_CALL(glVertexAttribDivisor(1, 1));
+
+	m_VertexArray->Unbind();
+	m_VertexBuffer->Unbind();
+
+	m_MeshBuffer->SetData(m_Meshes.data(), (unsigned int)(m_Meshes.size() * sizeof(GpuMesh)));
+	m_AreObjectsDirty = true;
+}
+
+uint32_t GpuDrivenRenderer::AddObject(uint32_t mesh, const glm::mat4& modelMatrix, const glm::vec4& color)
+{
+	GpuObject object = {};
+	object.modelMatrix = modelMatrix;
+	object.color = color;
+	object.mesh = mesh;
+
+	const AABB bounds = TransformBounds(m_MeshBounds[mesh], modelMatrix);
+	object.boundsMin = glm::vec4(bounds.min, 1.0f);
+	object.boundsMax = glm::vec4(bounds.max, 1.0f);
+
+	m_Objects.push_back(object);
+	m_AreObjectsDirty = true;
+	return (uint32_t)m_Objects.size() - 1;
+}
+
+void GpuDrivenRenderer::SetObjectTransform(uint32_t object, const glm::mat4& modelMatrix)
+{
+	GpuObject& gpuObject = m_Objects[object];
+	gpuObject.modelMatrix = modelMatrix;
+
+	const AABB bounds = TransformBounds(m_MeshBounds[gpuObject.mesh], modelMatrix);
+	gpuObject.boundsMin = glm::vec4(bounds.min, 1.0f);
+	gpuObject.boundsMax = glm::vec4(bounds.max, 1.0f);
+
+	m_AreObjectsDirty = true;
+}
+
+void GpuDrivenRenderer::ClearObjects()
+{
+	m_Objects.clear();
+	m_AreObjectsDirty = true;
+}
+
+void GpuDrivenRenderer::ReadBackVisibleCount()
+{
+	/* The slot about to be reused was written `ReadbackLatency` frames ago, so its fence has (almost always) signaled */
+	const unsigned int slot = m_FrameIndex % ReadbackLatency;
+	if (!m_ReadbackFences[slot])
+		return;
+
+	GL_CALL(glClientWaitSync(m_ReadbackFences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000));
+	GL_CALL(glDeleteSync(m_ReadbackFences[slot]));
+	m_ReadbackFences[slot] = nullptr;
+
+	m_ReadbackBuffers[slot]->Bind(GL_COPY_READ_BUFFER);
+	GL_CALL(glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(uint32_t), &m_VisibleCount));
+	m_ReadbackBuffers[slot]->Unbind(GL_COPY_READ_BUFFER);
+}
+
+void GpuDrivenRenderer::Draw(const glm::mat4& viewProjection)
+{
+	if (!m_VertexArray || m_Objects.empty())
+		return;
+
+	const uint32_t objectCount = (uint32_t)m_Objects.size();
+
+	if (m_AreObjectsDirty)
+	{
+		m_ObjectBuffer->SetData(m_Objects.data(), objectCount * sizeof(GpuObject));
+
+		if (m_CommandBuffer->GetSize() < objectCount * sizeof(DrawElementsIndirectCommand))
+			m_CommandBuffer->SetData(nullptr, objectCount * sizeof(DrawElementsIndirectCommand));
+
+		/* Sized on its own: the command buffer may already be large enough for objects it has no index for */
+		if (m_ObjectIndexCapacity < objectCount)
+		{
+			FrameVector<uint32_t> objectIndices(objectCount);
+			for (uint32_t i = 0; i < objectCount; i++)
+				objectIndices[i] = i;
+			GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, m_ObjectIndexBuffer));
+			GL_CALL(glBufferData(GL_ARRAY_BUFFER, objectCount * sizeof(uint32_t), objectIndices.data(), GL_STATIC_DRAW));
+			m_ObjectIndexMemory.Track(GpuMemoryCategory::VERTEX_BUFFER, objectCount * sizeof(uint32_t));
+			GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+			m_ObjectIndexCapacity = objectCount;
+		}
+
+		m_AreObjectsDirty = false;
+	}
+
+	ReadBackVisibleCount();
+
+	const uint32_t zero = 0;
+	m_DrawCountBuffer->SetData(&zero, sizeof(uint32_t));
+
+	/* Cull: one invocation per object, writing its draw command */
+	const Frustum frustum = Frustum::FromViewProjection(viewProjection);
+
+	m_CullingShader->Bind();
+	m_CullingShader->SetUniform4fv("u_Planes", 6, &frustum.planes[0].x);
+	m_CullingShader->SetUniform1i("u_ObjectCount", (int)objectCount);
+	m_CullingShader->SetUniform1i("u_IsCompacting", m_IsDrawCountEnabled ? 1 : 0);
+
+	m_ObjectBuffer->BindBase(0);
+	m_MeshBuffer->BindBase(1);
+	m_CommandBuffer->BindBase(2);
+	m_DrawCountBuffer->BindBase(3);
+
+	GL_CALL(glDispatchCompute((objectCount + 63) / 64, 1, 1));
+	RenderStats::Get().Add(RenderCounter::COMPUTE_DISPATCHES);
+	/* The count is also copied below and reset by next frame's SetData, which are buffer updates */
+	GL_CALL(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT));
+
+	/* Keep a copy of the count to read back later without stalling */
+	const unsigned int slot = m_FrameIndex % ReadbackLatency;
+	m_DrawCountBuffer->Bind(GL_COPY_READ_BUFFER);
+	m_ReadbackBuffers[slot]->Bind(GL_COPY_WRITE_BUFFER);
+	GL_CALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(uint32_t)));
+	GL_CALL(m_ReadbackFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+	/* Draw everything with one call */
+	m_DrawShader->Bind();
+	m_DrawShader->SetUniformMat4f("u_ViewProjection", viewProjection);
+	m_ObjectBuffer->BindBase(0);
+
+	m_VertexArray->Bind();
+	m_IndexBuffer->Bind();
+	m_CommandBuffer->Bind(GL_DRAW_INDIRECT_BUFFER);
+
+	if (m_IsDrawCountEnabled)
+	{
+		m_DrawCountBuffer->Bind(GL_PARAMETER_BUFFER_ARB);
+		if (GLEW_VERSION_4_6)
+		{
+			GL_CALL(glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, objectCount, 0));
+		}
+		else
+		{
+			GL_CALL(glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, objectCount, 0));
+		}
+		m_DrawCountBuffer->Unbind(GL_PARAMETER_BUFFER_ARB);
+	}
+	else
+	{
+		GL_CALL(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, objectCount, 0));
+	}
+	RenderStats::Get().AddIndirectDraw(objectCount);
+
+	m_CommandBuffer->Unbind(GL_DRAW_INDIRECT_BUFFER);
+	m_VertexArray->Unbind();
+
+	m_FrameIndex++;
+}
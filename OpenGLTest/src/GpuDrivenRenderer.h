@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "ShaderStorageBuffer.h"
+#include "ResourceManager.h"
+#include "Frustum.h"
+
+#include "glm/glm.hpp"
+
+/* Mirrors the shaders' std430 structs (res/shaders/GpuCulling.shader and GpuDriven.shader) */
+struct GpuMesh
+{
+	uint32_t indexCount;
+	uint32_t firstIndex;
+	int32_t baseVertex;
+	uint32_t padding;
+};
+
+struct GpuObject
+{
+	glm::mat4 modelMatrix;
+	glm::vec4 color;
+	glm::vec4 boundsMin; // World space
+	glm::vec4 boundsMax;
+	uint32_t mesh;
+	uint32_t padding[3];
+};
+
+struct DrawElementsIndirectCommand
+{
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t baseVertex;
+	uint32_t baseInstance; // Used as the object index (see `m_ObjectIndexBuffer`)
+};
+
+/*
+ * GPU-driven path (GL 4.3+): every mesh lives in one shared vertex/index buffer and every object in an SSBO.
+ * A compute shader culls the objects against the frustum and writes the draw commands, which are all submitted with
+ * a single glMultiDrawElementsIndirect(Count): the CPU cost no longer depends on the number of objects
+ */
+class GpuDrivenRenderer
+{
+private:
+	static constexpr unsigned int ReadbackLatency = 3; // Frames before the visible count is read back (no stalls)
+
+	/* Geometry, uploaded once by `UploadMeshes` */
+	std::vector<float> m_Positions;
+	std::vector<unsigned int> m_Indices;
+	std::vector<GpuMesh> m_Meshes;
+	std::vector<AABB> m_MeshBounds;
+	std::unique_ptr<VertexArray> m_VertexArray;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	unsigned int m_ObjectIndexBuffer; // 0, 1, 2... as an instanced attribute: baseInstance turns it into the object index
+	uint32_t m_ObjectIndexCapacity; // Indices uploaded to it so far
+	GpuAllocation m_ObjectIndexMemory;
+
+	std::vector<GpuObject> m_Objects;
+	bool m_AreObjectsDirty;
+
+	std::unique_ptr<ShaderStorageBuffer> m_MeshBuffer;
+	std::unique_ptr<ShaderStorageBuffer> m_ObjectBuffer;
+	std::unique_ptr<ShaderStorageBuffer> m_CommandBuffer;
+	std::unique_ptr<ShaderStorageBuffer> m_DrawCountBuffer;
+	std::unique_ptr<ShaderStorageBuffer> m_ReadbackBuffers[ReadbackLatency];
+	GLsync m_ReadbackFences[ReadbackLatency];
+	unsigned int m_FrameIndex;
+	uint32_t m_VisibleCount;
+
+	ResourceHandle<Shader> m_CullingShader;
+	ResourceHandle<Shader> m_DrawShader;
+
+	bool m_IsDrawCountSupported;
+	bool m_IsDrawCountEnabled;
+
+public:
+	GpuDrivenRenderer();
+	~GpuDrivenRenderer();
+
+	// Compute shaders, SSBOs and indirect multi-draws are all core in 4.3
+	static bool IsSupported();
+
+	// Positions are tightly packed vec3s, indices are relative to the mesh's own vertices
+	uint32_t AddMesh(const float* positions, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount);
+	void UploadMeshes();
+
+	uint32_t AddObject(uint32_t mesh, const glm::mat4& modelMatrix, const glm::vec4& color);
+	void SetObjectTransform(uint32_t object, const glm::mat4& modelMatrix);
+	void ClearObjects();
+
+	// Culls on the GPU and draws whatever survived
+	void Draw(const glm::mat4& viewProjection);
+
+	// Without glMultiDrawElementsIndirectCount, culled objects are drawn with 0 instances instead of being compacted out
+	inline bool IsDrawCountSupported() const { return m_IsDrawCountSupported; }
+	inline void SetDrawCountEnabled(bool isEnabled) { m_IsDrawCountEnabled = isEnabled && m_IsDrawCountSupported; }
+	inline bool IsDrawCountEnabled() const { return m_IsDrawCountEnabled; }
+
+	inline std::size_t GetObjectCount() const { return m_Objects.size(); }
+	// As counted by the culling shader a few frames ago
+	inline uint32_t GetVisibleCount() const { return m_VisibleCount; }
+
+private:
+	void ReadBackVisibleCount();
+};
@@ -0,0 +1,295 @@
+#include "GpuMemoryTracker.h"
+#include "GLHandleError.h"
+
+#include "imgui/imgui.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+
+void GpuAllocation::Track(GpuMemoryCategory category, std::size_t size)
+{
+	Release();
+	m_ID = GpuMemoryTracker::Get().Allocate(category, size);
+}
+
+void GpuAllocation::Release()
+{
+	if (m_ID == 0)
+		return;
+
+	GpuMemoryTracker::Get().Free(m_ID);
+	m_ID = 0;
+}
+
+GpuMemoryTracker::GpuMemoryTracker()
+	: m_CurrentScope(0), m_LiveHistory(), m_ChurnHistory(), m_HistoryIndex(0), m_HistoryCount(0), m_FrameChurnBytes(0), m_FrameCount(0),
+	m_DriverSource(nullptr), m_DriverTotalKB(0), m_DriverFreeKB(0), m_DriverBaselineFreeKB(-1), m_TrackedBaselineBytes(0)
+{
+	m_Scopes.push_back({ "Application", Totals() });
+}
+
+GpuMemoryTracker& GpuMemoryTracker::Get()
+{
+	static GpuMemoryTracker tracker;
+	return tracker;
+}
+
+const char* GpuMemoryTracker::GetCategoryName(GpuMemoryCategory category)
+{
+	switch (category)
+	{
+	case GpuMemoryCategory::VERTEX_BUFFER: return "Vertex buffers";
+	case GpuMemoryCategory::INDEX_BUFFER: return "Index buffers";
+	case GpuMemoryCategory::STORAGE_BUFFER: return "Storage buffers";
+	case GpuMemoryCategory::TEXTURE: return "Textures";
+	case GpuMemoryCategory::RENDER_TARGET: return "Render targets";
+	case GpuMemoryCategory::READBACK_BUFFER: return "Readback buffers";
+	case GpuMemoryCategory::SHADER: return "Shader binaries";
+	default: return "Unknown";
+	}
+}
+
+void GpuMemoryTracker::Add(Totals& totals, std::size_t size)
+{
+	totals.liveBytes += size;
+	totals.peakBytes = std::max(totals.peakBytes, totals.liveBytes);
+	totals.allocatedBytes += size;
+	totals.liveCount++;
+	totals.allocationCount++;
+}
+
+void GpuMemoryTracker::Remove(Totals& totals, std::size_t size)
+{
+	totals.liveBytes -= size;
+	totals.liveCount--;
+	totals.freeCount++;
+}
+
+uint32_t GpuMemoryTracker::Allocate(GpuMemoryCategory category, std::size_t size)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	uint32_t id;
+	if (!m_FreeRecords.empty())
+	{
+		id = m_FreeRecords.back();
+		m_FreeRecords.pop_back();
+	}
+	else
+	{
+		m_Records.push_back(Record());
+		id = (uint32_t)m_Records.size();
+	}
+	m_Records[id - 1] = { size, category, m_CurrentScope };
+
+	Add(m_Total, size);
+	Add(m_Categories[(int)category], size);
+	Add(m_Scopes[m_CurrentScope].totals, size);
+	m_FrameChurnBytes += size;
+	return id;
+}
+
+void GpuMemoryTracker::Free(uint32_t id)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	/* Charged to where it was allocated, whichever test is open now */
+	const Record& record = m_Records[id - 1];
+	Remove(m_Total, record.size);
+	Remove(m_Categories[(int)record.category], record.size);
+	Remove(m_Scopes[record.scope].totals, record.size);
+	m_FrameChurnBytes += record.size;
+	m_FreeRecords.push_back(id);
+}
+
+void GpuMemoryTracker::SetScope(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	auto found = std::find_if(m_Scopes.begin(), m_Scopes.end(), [&name](const Scope& scope) { return scope.name == name; });
+	if (found == m_Scopes.end())
+	{
+		m_Scopes.push_back({ name, Totals() });
+		found = m_Scopes.end() - 1;
+	}
+	m_CurrentScope = (uint16_t)(found - m_Scopes.begin());
+}
+
+void GpuMemoryTracker::EndFrame()
+{
+	/* A couple of times per second at 60 FPS, the query may not be free on every driver */
+	if (m_FrameCount++ % 30 == 0)
+		QueryDriverMemory();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_LiveHistory[m_HistoryIndex] = m_Total.liveBytes / (1024.0f * 1024.0f);
+	m_ChurnHistory[m_HistoryIndex] = m_FrameChurnBytes / 1024.0f;
+	m_HistoryIndex = (m_HistoryIndex + 1) % HistorySize;
+	m_HistoryCount = std::min(m_HistoryCount + 1, HistorySize);
+	m_FrameChurnBytes = 0;
+}
+
+void GpuMemoryTracker::QueryDriverMemory()
+{
+	int values[4] = {};
+	if (GLEW_NVX_gpu_memory_info)
+	{
+		m_DriverSource = "GL_NVX_gpu_memory_info";
+		GL_CALL(glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, values));
+		m_DriverTotalKB = values[0];
+		GL_CALL(glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, values));
+		m_DriverFreeKB = values[0];
+	}
+	else if (GLEW_ATI_meminfo)
+	{
+		/* Buffers and textures come out of the same pool on current hardware, the first value is its free total */
+		m_DriverSource = "GL_ATI_meminfo";
+		GL_CALL(glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, values));
+		m_DriverFreeKB = values[0];
+	}
+	else
+	{
+		return;
+	}
+
+	/* Only changes compare: the driver also counts the window's own buffers, other applications, ... */
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_DriverBaselineFreeKB < 0)
+	{
+		m_DriverBaselineFreeKB = m_DriverFreeKB;
+		m_TrackedBaselineBytes = m_Total.liveBytes;
+	}
+}
+
+bool GpuMemoryTracker::WriteJson(const std::string& filepath)
+{
+	std::ofstream stream(filepath);
+	if (!stream)
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	auto writeTotals = [&stream](const Totals& totals)
+	{
+		stream << "\"live_bytes\": " << totals.liveBytes << ", \"peak_bytes\": " << totals.peakBytes << ", \"allocated_bytes\": " << totals.allocatedBytes;
+		stream << ", \"live_count\": " << totals.liveCount << ", \"allocations\": " << totals.allocationCount << ", \"frees\": " << totals.freeCount;
+	};
+
+	stream << "{\n";
+	stream << "  \"total\": { ";
+	writeTotals(m_Total);
+	stream << " },\n";
+
+	stream << "  \"categories\": [";
+	for (int i = 0; i < (int)GpuMemoryCategory::COUNT; i++)
+	{
+		stream << (i > 0 ? ",\n" : "\n") << "    { \"name\": \"" << GetCategoryName((GpuMemoryCategory)i) << "\", ";
+		writeTotals(m_Categories[i]);
+		stream << " }";
+	}
+	stream << "\n  ],\n";
+
+	/* Test names are ours and never need escaping */
+	stream << "  \"scopes\": [";
+	for (std::size_t i = 0; i < m_Scopes.size(); i++)
+	{
+		stream << (i > 0 ? ",\n" : "\n") << "    { \"name\": \"" << m_Scopes[i].name << "\", ";
+		writeTotals(m_Scopes[i].totals);
+		stream << " }";
+	}
+	stream << "\n  ],\n";
+
+	if (m_DriverSource)
+	{
+		stream << "  \"driver\": { \"source\": \"" << m_DriverSource << "\", \"dedicated_kb\": " << m_DriverTotalKB << ", \"free_kb\": " << m_DriverFreeKB;
+		stream << ", \"used_since_start_kb\": " << (m_DriverBaselineFreeKB - m_DriverFreeKB);
+		stream << ", \"tracked_since_start_kb\": " << ((long long)m_Total.liveBytes - (long long)m_TrackedBaselineBytes) / 1024 << " },\n";
+	}
+
+	/* Oldest frame first */
+	stream << "  \"history\": { \"live_mb\": [";
+	const int first = m_HistoryCount == HistorySize ? m_HistoryIndex : 0;
+	for (int i = 0; i < m_HistoryCount; i++)
+		stream << (i > 0 ? ", " : "") << m_LiveHistory[(first + i) % HistorySize];
+	stream << "], \"churn_kb\": [";
+	for (int i = 0; i < m_HistoryCount; i++)
+		stream << (i > 0 ? ", " : "") << m_ChurnHistory[(first + i) % HistorySize];
+	stream << "] }\n";
+
+	stream << "}\n";
+	return (bool)stream;
+}
+
+void GpuMemoryTracker::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("GPU memory"))
+		return;
+
+	ImGui::InputText("##JsonPath", m_JsonPath, sizeof(m_JsonPath));
+	ImGui::SameLine();
+	if (ImGui::Button("Dump JSON") && !WriteJson(m_JsonPath))
+		Log(std::string("Failed to write ") + m_JsonPath);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	constexpr float MB = 1024.0f * 1024.0f;
+	ImGui::Text("Live %.2f MB in %llu objects (peak %.2f MB)", m_Total.liveBytes / MB, (unsigned long long)m_Total.liveCount, m_Total.peakBytes / MB);
+	ImGui::Text("%llu allocations, %llu frees, %.2f MB allocated overall", (unsigned long long)m_Total.allocationCount, (unsigned long long)m_Total.freeCount, m_Total.allocatedBytes / MB);
+
+	if (m_DriverSource)
+	{
+		const long long driverUsedKB = m_DriverBaselineFreeKB - m_DriverFreeKB;
+		const long long trackedKB = ((long long)m_Total.liveBytes - (long long)m_TrackedBaselineBytes) / 1024;
+		ImGui::Text("Driver (%s): %.1f MB free", m_DriverSource, m_DriverFreeKB / 1024.0f);
+		ImGui::Text("Since start: driver %+.2f MB - tracked %+.2f MB - untracked %+.2f MB", driverUsedKB / 1024.0f, trackedKB / 1024.0f, (driverUsedKB - trackedKB) / 1024.0f);
+	}
+	else
+	{
+		ImGui::Text("No driver memory figures (neither GL_NVX_gpu_memory_info nor GL_ATI_meminfo)");
+	}
+
+	const int first = m_HistoryCount == HistorySize ? m_HistoryIndex : 0;
+	ImGui::PlotLines("##Live", m_LiveHistory, m_HistoryCount, first, "Live MB", 0.0f, FLT_MAX, ImVec2(0, 60));
+	ImGui::PlotHistogram("##Churn", m_ChurnHistory, m_HistoryCount, first, "Churn KB/frame", 0.0f, FLT_MAX, ImVec2(0, 60));
+
+	auto totalsRow = [MB](const char* name, const Totals& totals)
+	{
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn(); ImGui::TextUnformatted(name);
+		ImGui::TableNextColumn(); ImGui::Text("%.2f", totals.liveBytes / MB);
+		ImGui::TableNextColumn(); ImGui::Text("%.2f", totals.peakBytes / MB);
+		ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)totals.liveCount);
+		ImGui::TableNextColumn(); ImGui::Text("%llu / %llu", (unsigned long long)totals.allocationCount, (unsigned long long)totals.freeCount);
+	};
+
+	auto beginTable = [](const char* id, const char* firstColumn)
+	{
+		if (!ImGui::BeginTable(id, 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+			return false;
+		ImGui::TableSetupColumn(firstColumn);
+		ImGui::TableSetupColumn("Live MB");
+		ImGui::TableSetupColumn("Peak MB");
+		ImGui::TableSetupColumn("Objects");
+		ImGui::TableSetupColumn("Allocs / frees");
+		ImGui::TableHeadersRow();
+		return true;
+	};
+
+	if (beginTable("##Categories", "Category"))
+	{
+		for (int i = 0; i < (int)GpuMemoryCategory::COUNT; i++)
+			totalsRow(GetCategoryName((GpuMemoryCategory)i), m_Categories[i]);
+		ImGui::EndTable();
+	}
+
+	/* What a closed test still holds is either cached by the resource manager or leaked */
+	if (beginTable("##Scopes", "Opened in"))
+	{
+		for (const Scope& scope : m_Scopes)
+			totalsRow(scope.name.c_str(), scope.totals);
+		ImGui::EndTable();
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class GpuMemoryCategory
+{
+	VERTEX_BUFFER = 0,
+	INDEX_BUFFER,
+	STORAGE_BUFFER,
+	TEXTURE,
+	RENDER_TARGET,
+	READBACK_BUFFER,
+	SHADER,
+	COUNT
+};
+
+/* GPU memory owned by a GL wrapper, counted by the tracker for as long as it's alive */
+class GpuAllocation
+{
+private:
+	uint32_t m_ID; // 0 while nothing is tracked
+
+public:
+	GpuAllocation() : m_ID(0) {}
+	~GpuAllocation() { Release(); }
+
+	GpuAllocation(const GpuAllocation&) = delete;
+	GpuAllocation& operator=(const GpuAllocation&) = delete;
+
+	// Replaces whatever was tracked (after a reallocation, for example)
+	void Track(GpuMemoryCategory category, std::size_t size);
+	void Release();
+};
+
+/* Live and peak GPU memory per category and per test, allocation churn over time and the driver's own figures to compare */
+class GpuMemoryTracker
+{
+private:
+	struct Totals
+	{
+		std::size_t liveBytes = 0;
+		std::size_t peakBytes = 0;
+		std::size_t allocatedBytes = 0; // Over the whole run
+		uint64_t liveCount = 0;
+		uint64_t allocationCount = 0;
+		uint64_t freeCount = 0;
+	};
+
+	struct Record
+	{
+		std::size_t size;
+		GpuMemoryCategory category;
+		uint16_t scope;
+	};
+
+	struct Scope
+	{
+		std::string name;
+		Totals totals;
+	};
+
+	static constexpr int HistorySize = 600; // Frames
+
+	std::mutex m_Mutex;
+
+	std::vector<Record> m_Records; // Indexed by allocation ID - 1
+	std::vector<uint32_t> m_FreeRecords;
+
+	Totals m_Total;
+	Totals m_Categories[(int)GpuMemoryCategory::COUNT];
+	std::vector<Scope> m_Scopes; // Allocations get charged to the test that was open when they were made
+	uint16_t m_CurrentScope;
+
+	float m_LiveHistory[HistorySize]; // MB at the end of each frame
+	float m_ChurnHistory[HistorySize]; // KB allocated plus freed during each frame
+	int m_HistoryIndex;
+	int m_HistoryCount;
+	std::size_t m_FrameChurnBytes;
+	uint64_t m_FrameCount;
+
+	/* Driver figures (GL_NVX_gpu_memory_info or GL_ATI_meminfo), as free memory relative to the first query */
+	const char* m_DriverSource;
+	long long m_DriverTotalKB; // Dedicated memory, NVX only
+	long long m_DriverFreeKB;
+	long long m_DriverBaselineFreeKB;
+	std::size_t m_TrackedBaselineBytes;
+
+	char m_JsonPath[256] = "gpu_memory.json";
+
+	GpuMemoryTracker();
+
+public:
+	static GpuMemoryTracker& Get();
+
+	GpuMemoryTracker(const GpuMemoryTracker&) = delete;
+	GpuMemoryTracker& operator=(const GpuMemoryTracker&) = delete;
+
+	// Returns the ID to free it with (prefer `GpuAllocation`, which does both)
+	uint32_t Allocate(GpuMemoryCategory category, std::size_t size);
+	void Free(uint32_t id);
+
+	// Charges the next allocations to `name` (the test being opened, for instance)
+	void SetScope(const std::string& name);
+
+	// Closes the frame's sample in the time series (and samples the driver every now and then)
+	void EndFrame();
+
+	bool WriteJson(const std::string& filepath);
+
+	void OnImGuiRender();
+
+	std::size_t GetLiveBytes() const { return m_Total.liveBytes; }
+	std::size_t GetLiveBytes(GpuMemoryCategory category) const { return m_Categories[(int)category].liveBytes; }
+
+	static const char* GetCategoryName(GpuMemoryCategory category);
+
+private:
+	void QueryDriverMemory();
+	static void Add(Totals& totals, std::size_t size);
+	static void Remove(Totals& totals, std::size_t size);
+};
@@ -1,28 +1,78 @@
 #include "IndexBuffer.h"
 #include "GLHandleError.h"
+#include "RenderBackend.h"
+#include "RenderStats.h"
+
+#include <algorithm>
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-	: m_Count(count)
+	: m_RendererID(0), m_Count(count)
 {
+	if (IsSoftwareRendering())
+	{
+		/* Null reserves the indices, like glBufferData does */
+		if (data)
+			m_Indices.assign(data, data + count);
+		else
+			m_Indices.assign(count, 0);
+		m_Memory.Track(GpuMemoryCategory::INDEX_BUFFER, count * sizeof(unsigned int));
+		return;
+	}
+
 	/* Generate a new index buffer */
 	GL_CALL(glGenBuffers(1, &m_RendererID));
 	/* Bind it */
 	GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
 	/* Provide data to it */
 	GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count *  sizeof(unsigned int), data, GL_STATIC_DRAW));
+	m_Memory.Track(GpuMemoryCategory::INDEX_BUFFER, count * sizeof(unsigned int));
+	RenderStats::Get().Add(RenderCounter::RESOURCES_CREATED);
+	if (data)
+		RenderStats::Get().Add(RenderCounter::BUFFER_BYTES, count * sizeof(unsigned int));
 }
 
 IndexBuffer::~IndexBuffer()
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glDeleteBuffers(1, &m_RendererID));
+	RenderStats::Get().Add(RenderCounter::RESOURCES_DESTROYED);
 }
 
 void IndexBuffer::Bind() const
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
 }
 
 void IndexBuffer::Unbind() const
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 }
+
+void IndexBuffer::SetData(const unsigned int* data, unsigned int count, unsigned int first)
+{
+	if (IsSoftwareRendering())
+	{
+		/* GL would fail the call with GL_INVALID_VALUE */
+		if ((uint64_t)first + count > m_Indices.size())
+		{
+			Log("IndexBuffer::SetData out of range, ignored");
+			return;
+		}
+
+		std::copy(data, data + count, m_Indices.begin() + first);
+		return;
+	}
+
+	GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	GL_CALL(glBufferSubData(GL_COPY_WRITE_BUFFER, first * sizeof(unsigned int), count * sizeof(unsigned int), data));
+	GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+	RenderStats::Get().Add(RenderCounter::BUFFER_BYTES, count * sizeof(unsigned int));
+}
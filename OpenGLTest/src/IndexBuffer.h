@@ -1,10 +1,16 @@
 #pragma once
 
+#include "GpuMemoryTracker.h"
+
+#include <vector>
+
 class IndexBuffer
 {
 private:
 	unsigned int m_RendererID;
 	unsigned int m_Count;
+	GpuAllocation m_Memory;
+	std::vector<unsigned int> m_Indices; // Software backend only
 
 public:
 	IndexBuffer(const unsigned int* data, unsigned int count);
@@ -13,5 +19,11 @@ public:
 	void Bind() const;
 	void Unbind() const;
 
+	// Overwrites `count` indices starting at index `first` (bound to the copy target: binding it as the element
+	// buffer would change the index buffer of whatever vertex array is bound)
+	void SetData(const unsigned int* data, unsigned int count, unsigned int first = 0);
+
 	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const std::vector<unsigned int>& GetIndices() const { return m_Indices; }
 };
@@ -0,0 +1,369 @@
+#include "JobSystem.h"
+#include "GLHandleError.h"
+
+#include <chrono>
+
+static thread_local int t_ThreadIndex = -1; // -1: not a job system thread
+static thread_local uint32_t t_RandomState = 0x9E3779B9;
+
+static uint32_t NextRandom()
+{
+	/* xorshift32, only used to pick steal victims */
+	t_RandomState ^= t_RandomState << 13;
+	t_RandomState ^= t_RandomState >> 17;
+	t_RandomState ^= t_RandomState << 5;
+	return t_RandomState;
+}
+
+JobDeque::JobDeque()
+	: m_Top(0), m_Bottom(0)
+{
+	for (int64_t i = 0; i < Capacity; i++)
+		m_Jobs[i].store(nullptr, std::memory_order_relaxed);
+}
+
+bool JobDeque::Push(Job* job)
+{
+	const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+	const int64_t top = m_Top.load(std::memory_order_acquire);
+
+	if (bottom - top >= Capacity)
+		return false;
+
+	m_Jobs[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+	m_Bottom.store(bottom + 1, std::memory_order_release); // Publishes the job to thieves
+	return true;
+}
+
+Job* JobDeque::Pop()
+{
+	const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+	m_Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_Top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		/* Empty */
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = m_Jobs[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+
+	if (top == bottom)
+	{
+		/* Last job left, race the thieves for it */
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+Job* JobDeque::Steal()
+{
+	int64_t top = m_Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = m_Jobs[top & (Capacity - 1)].load(std::memory_order_relaxed);
+
+	if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr; // Lost against the owner or another thief
+
+	return job;
+}
+
+JobSystem::JobSystem()
+	: m_IsRunning(false), m_QueuedJobs(0), m_SleepingWorkers(0)
+{
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+
+	for (Job* job : m_FreeJobs)
+		delete job;
+}
+
+JobSystem& JobSystem::Get()
+{
+	static JobSystem instance;
+	return instance;
+}
+
+void JobSystem::Initialize(unsigned int threadCount)
+{
+	Shutdown();
+
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	t_ThreadIndex = 0; // The calling thread is the main thread
+
+	for (unsigned int i = 0; i < threadCount; i++)
+		m_Deques.push_back(std::unique_ptr<JobDeque>(new JobDeque()));
+
+	m_IsRunning = true;
+
+	for (unsigned int i = 1; i < threadCount; i++)
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+
+	Log("Job system running on " + std::to_string(threadCount) + " threads");
+}
+
+void JobSystem::Shutdown()
+{
+	if (!m_IsRunning)
+		return;
+
+	m_IsRunning = false;
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+	}
+	m_WakeCondition.notify_all();
+
+	for (std::thread& worker : m_Workers)
+		worker.join();
+	m_Workers.clear();
+
+	/* Anything still queued runs here rather than being dropped */
+	for (unsigned int i = 0; i < m_Deques.size(); i++)
+	{
+		while (Job* job = m_Deques[i]->Steal())
+		{
+			m_QueuedJobs--;
+			Execute(job);
+		}
+	}
+
+	m_Deques.clear();
+	ProcessMainThreadJobs();
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter)
+{
+	if (counter)
+		counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+
+	Enqueue(CreateJob(std::move(function), counter));
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter)
+{
+	if (counter)
+		counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+
+	Job* job = CreateJob(std::move(function), counter);
+
+	{
+		std::lock_guard<std::mutex> lock(dependency.m_Mutex);
+		if (!dependency.IsDone())
+		{
+			dependency.m_Continuations.push_back(job);
+			return;
+		}
+	}
+
+	Enqueue(job);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	while (!counter.IsDone())
+	{
+		if (t_ThreadIndex == 0)
+			ProcessMainThreadJobs();
+
+		if (t_ThreadIndex < 0 || !RunNextJob((unsigned int)t_ThreadIndex))
+			std::this_thread::yield();
+	}
+
+	/* The thread that finished the last job may still be holding the lock, wait for it before the counter goes away */
+	std::lock_guard<std::mutex> lock(counter.m_Mutex);
+}
+
+void JobSystem::RunOnMainThread(std::function<void()> function)
+{
+	if (t_ThreadIndex == 0)
+	{
+		function();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+		m_MainThreadJobs.push_back(std::move(function));
+	}
+
+	if (m_MainThreadWakeUp)
+		m_MainThreadWakeUp();
+}
+
+bool JobSystem::HasMainThreadJobs()
+{
+	std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+	return !m_MainThreadJobs.empty();
+}
+
+void JobSystem::ProcessMainThreadJobs()
+{
+	std::vector<std::function<void()>> jobs;
+	{
+		std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+		jobs.swap(m_MainThreadJobs);
+	}
+
+	for (auto& job : jobs)
+		job();
+}
+
+void JobSystem::ParallelForChunks(std::size_t begin, std::size_t end, std::size_t grainSize, const std::function<void(std::size_t, std::size_t)>& function)
+{
+	if (end <= begin)
+		return;
+
+	grainSize = std::max<std::size_t>(grainSize, 1);
+
+	/* Not worth splitting (or nobody to split it with) */
+	if (end - begin <= grainSize || m_Deques.size() <= 1 || t_ThreadIndex < 0)
+	{
+		function(begin, end);
+		return;
+	}
+
+	/* Each job only captures a reference and its first index, which fits in std::function's inline storage (no allocation per chunk) */
+	auto runChunk = [&function, end, grainSize](std::size_t chunkBegin) { function(chunkBegin, std::min(chunkBegin + grainSize, end)); };
+
+	JobCounter counter;
+	for (std::size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize)
+		Run([&runChunk, chunkBegin]() { runChunk(chunkBegin); }, &counter);
+
+	Wait(counter);
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+	t_ThreadIndex = (int)index;
+	t_RandomState ^= index * 0x85EBCA6B;
+
+	while (m_IsRunning)
+	{
+		if (RunNextJob(index))
+			continue;
+
+		/* Nothing to do, sleep until a job gets queued */
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_SleepingWorkers++;
+		m_WakeCondition.wait(lock, [this]() { return m_QueuedJobs.load() > 0 || !m_IsRunning; });
+		m_SleepingWorkers--;
+	}
+}
+
+bool JobSystem::RunNextJob(unsigned int index)
+{
+	Job* job = m_Deques[index]->Pop();
+
+	if (!job)
+	{
+		const unsigned int dequeCount = (unsigned int)m_Deques.size();
+		const unsigned int start = NextRandom() % dequeCount;
+
+		for (unsigned int i = 0; i < dequeCount && !job; i++)
+		{
+			const unsigned int victim = (start + i) % dequeCount;
+			if (victim != index)
+				job = m_Deques[victim]->Steal();
+		}
+	}
+
+	if (!job)
+		return false;
+
+	m_QueuedJobs--;
+	Execute(job);
+	return true;
+}
+
+Job* JobSystem::CreateJob(std::function<void()>&& function, JobCounter* counter)
+{
+	Job* job = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_JobPoolMutex);
+		if (!m_FreeJobs.empty())
+		{
+			job = m_FreeJobs.back();
+			m_FreeJobs.pop_back();
+		}
+	}
+
+	if (!job)
+		return new Job { std::move(function), counter };
+
+	job->function = std::move(function);
+	job->counter = counter;
+	return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	job->function();
+	Finish(job->counter);
+
+	/* Drop the captures now rather than whenever the job gets reused */
+	job->function = nullptr;
+	std::lock_guard<std::mutex> lock(m_JobPoolMutex);
+	m_FreeJobs.push_back(job);
+}
+
+void JobSystem::Enqueue(Job* job)
+{
+	/* Only job system threads own a deque; run it in place for anyone else, or if the deque is full */
+	if (t_ThreadIndex < 0 || (unsigned int)t_ThreadIndex >= m_Deques.size() || !m_Deques[t_ThreadIndex]->Push(job))
+	{
+		Execute(job);
+		return;
+	}
+
+	m_QueuedJobs++;
+
+	if (m_SleepingWorkers.load() > 0)
+	{
+		/* Taking the lock makes sure a worker about to sleep sees the new job */
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+		}
+		m_WakeCondition.notify_one();
+	}
+}
+
+void JobSystem::Finish(JobCounter* counter)
+{
+	if (!counter)
+		return;
+
+	/* Anything but the last decrement never touches the counter again */
+	int value = counter->m_Value.load(std::memory_order_relaxed);
+	while (value > 1)
+	{
+		if (counter->m_Value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+			return;
+	}
+
+	std::vector<Job*> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter->m_Mutex);
+		if (counter->m_Value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			continuations.swap(counter->m_Continuations);
+	}
+
+	for (Job* job : continuations)
+		Enqueue(job);
+}
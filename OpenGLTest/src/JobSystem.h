@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "FrameArena.h"
+
+struct Job;
+
+/* Counts unfinished jobs; jobs can be made to wait on a counter reaching zero */
+class JobCounter
+{
+private:
+	std::atomic<int> m_Value;
+	std::mutex m_Mutex;
+	std::vector<Job*> m_Continuations; // Jobs waiting for this counter to reach zero
+
+	friend class JobSystem;
+
+public:
+	JobCounter() : m_Value(0) {}
+
+	inline bool IsDone() const { return m_Value.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job
+{
+	std::function<void()> function;
+	JobCounter* counter; // Decremented once the job has run (optional)
+};
+
+/* Chase-Lev work-stealing deque: the owner pushes and pops at the bottom, other threads steal from the top without locking */
+class JobDeque
+{
+private:
+	static constexpr int64_t Capacity = 4096;
+
+	std::atomic<int64_t> m_Top;
+	std::atomic<int64_t> m_Bottom;
+	std::atomic<Job*> m_Jobs[Capacity];
+
+public:
+	JobDeque();
+
+	bool Push(Job* job);
+	Job* Pop();
+	Job* Steal();
+};
+
+class JobSystem
+{
+private:
+	std::vector<std::thread> m_Workers;
+	std::vector<std::unique_ptr<JobDeque>> m_Deques; // One per worker, index 0 belongs to the main thread
+	std::atomic<bool> m_IsRunning;
+
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WakeCondition;
+	std::atomic<int> m_QueuedJobs;
+	std::atomic<int> m_SleepingWorkers;
+
+	std::mutex m_MainThreadMutex;
+	std::vector<std::function<void()>> m_MainThreadJobs;
+	std::function<void()> m_MainThreadWakeUp;
+
+	/* Finished jobs get reused instead of deleted, so steady-state frames don't allocate them */
+	std::mutex m_JobPoolMutex;
+	std::vector<Job*> m_FreeJobs;
+
+	JobSystem();
+
+public:
+	~JobSystem();
+
+	static JobSystem& Get();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Starts `threadCount` threads in total (including the main thread), 0 means one per core
+	void Initialize(unsigned int threadCount = 0);
+	void Shutdown();
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Deques.size(); }
+
+	// Must be called from the main thread or a job
+	void Run(std::function<void()> function, JobCounter* counter = nullptr);
+	// Same, but the job isn't started until `dependency` reaches zero
+	void RunAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter = nullptr);
+	// Runs other jobs on the calling thread until the counter reaches zero
+	void Wait(JobCounter& counter);
+
+	// For work that has to touch the OpenGL context
+	void RunOnMainThread(std::function<void()> function);
+	void ProcessMainThreadJobs();
+	bool HasMainThreadJobs();
+	// Called by the posting thread whenever a job gets queued for the main thread (to interrupt an idle wait for events)
+	inline void SetMainThreadWakeUp(std::function<void()> wakeUp) { m_MainThreadWakeUp = std::move(wakeUp); }
+
+	// Calls function(chunkBegin, chunkEnd) over [begin; end) in chunks of at most `grainSize`
+	template <typename Function>
+	void ParallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const Function& function)
+	{
+		/* A std::function holds a reference_wrapper inline, so however much the lambda captures it doesn't get copied to the heap */
+		ParallelForChunks(begin, end, grainSize, std::cref(function));
+	}
+
+	// Maps every chunk to a partial result with map(chunkBegin, chunkEnd) and folds them with reduce(a, b)
+	// (the partials live in the frame arena, so it mustn't run in a job that outlives the frame)
+	template <typename T, typename Map, typename Reduce>
+	T ParallelReduce(std::size_t begin, std::size_t end, std::size_t grainSize, T identity, Map map, Reduce reduce)
+	{
+		if (end <= begin)
+			return identity;
+
+		grainSize = std::max<std::size_t>(grainSize, 1);
+		const std::size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+		FrameVector<T> partials(chunkCount, identity);
+
+		ParallelFor(0, chunkCount, 1, [&](std::size_t chunkBegin, std::size_t chunkEnd)
+		{
+			for (std::size_t chunk = chunkBegin; chunk < chunkEnd; chunk++)
+			{
+				const std::size_t first = begin + chunk * grainSize;
+				partials[chunk] = map(first, std::min(first + grainSize, end));
+			}
+		});
+
+		T result = identity;
+		for (const T& partial : partials)
+			result = reduce(result, partial);
+		return result;
+	}
+
+private:
+	void ParallelForChunks(std::size_t begin, std::size_t end, std::size_t grainSize, const std::function<void(std::size_t, std::size_t)>& function);
+	void WorkerLoop(unsigned int index);
+	bool RunNextJob(unsigned int index);
+	Job* CreateJob(std::function<void()>&& function, JobCounter* counter);
+	void Execute(Job* job);
+	void Enqueue(Job* job);
+	void Finish(JobCounter* counter);
+};
@@ -0,0 +1,1094 @@
+#include "MeshImporter.h"
+#include "GLHandleError.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+static float MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool EndsWith(const std::string& value, const std::string& suffix)
+{
+	return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+MeshData::MeshData(uint32_t attributes)
+	: m_Attributes(attributes | MESH_ATTRIBUTE_POSITION), m_Vertices(nullptr), m_Indices(nullptr), m_VertexCount(0), m_IndexCount(0),
+	m_Bounds({ glm::vec3(0.0f), glm::vec3(0.0f) })
+{
+}
+
+uint32_t MeshData::GetStride(uint32_t attributes)
+{
+	return 3 + (attributes & MESH_ATTRIBUTE_NORMAL ? 3 : 0) + (attributes & MESH_ATTRIBUTE_TEXCOORD ? 2 : 0);
+}
+
+VertexBufferLayout MeshData::GetLayout() const
+{
+	VertexBufferLayout layout;
+	layout.Push(GL_FLOAT, 3);
+	if (m_Attributes & MESH_ATTRIBUTE_NORMAL)
+		layout.Push(GL_FLOAT, 3);
+	if (m_Attributes & MESH_ATTRIBUTE_TEXCOORD)
+		layout.Push(GL_FLOAT, 2);
+	return layout;
+}
+
+/* ---------------------------------------------------------------- OBJ */
+
+static inline bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char* SkipSpaces(const char* p, const char* end)
+{
+	while (p < end && IsSpace(*p))
+		p++;
+	return p;
+}
+
+// Locale-independent and much faster than strtod, exact enough for vertex data (and exact for integers)
+static const char* ParseNumber(const char* p, const char* end, double& value)
+{
+	static const double PowersOfTen[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	p = SkipSpaces(p, end);
+
+	bool isNegative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+		isNegative = *p++ == '-';
+
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int digitCount = 0;
+
+	for (; p < end && *p >= '0' && *p <= '9'; p++)
+	{
+		if (digitCount++ < 19)
+			mantissa = mantissa * 10 + (*p - '0');
+		else
+			exponent++;
+	}
+
+	if (p < end && *p == '.')
+	{
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++)
+		{
+			if (digitCount++ < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				exponent--;
+			}
+		}
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		p++;
+		bool isExponentNegative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			isExponentNegative = *p++ == '-';
+
+		int explicitExponent = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; p++)
+			explicitExponent = std::min(explicitExponent * 10 + (*p - '0'), 1000);
+		exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+	}
+
+	double result = (double)mantissa;
+	while (exponent > 22) { result *= 1e22; exponent -= 22; }
+	while (exponent < -22) { result /= 1e22; exponent += 22; }
+	result = exponent >= 0 ? result * PowersOfTen[exponent] : result / PowersOfTen[-exponent];
+
+	value = isNegative ? -result : result;
+	return p;
+}
+
+static const char* ParseFloat(const char* p, const char* end, float& value)
+{
+	double number;
+	p = ParseNumber(p, end, number);
+	value = (float)number;
+	return p;
+}
+
+static const char* ParseInt(const char* p, const char* end, int& value)
+{
+	bool isNegative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+		isNegative = *p++ == '-';
+
+	value = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; p++)
+		value = value * 10 + (*p - '0');
+
+	if (isNegative)
+		value = -value;
+	return p;
+}
+
+/* OBJ indices are global (1-based) or relative to the last element read: relative ones are resolved once every chunk's counts are known */
+constexpr int32_t ObjNoIndex = INT32_MIN;
+
+namespace
+{
+struct ObjCorner
+{
+	int32_t position;
+	int32_t texCoord;
+	int32_t normal;
+	uint8_t localMask; // Bit i: index i is relative to the chunk (offset by the elements of the previous chunks)
+};
+
+struct ObjChunk
+{
+	const char* begin;
+	const char* end;
+
+	std::vector<float> positions;
+	std::vector<float> texCoords;
+	std::vector<float> normals;
+	std::vector<ObjCorner> corners; // Already triangulated
+	bool isValid = true;
+};
+}
+
+static int32_t ResolveObjIndex(int index, std::size_t localCount, uint8_t& localMask, uint8_t bit, bool& isValid)
+{
+	if (index > 0)
+		return index - 1;
+
+	if (index < 0)
+	{
+		localMask |= bit;
+		return (int32_t)localCount + index; // Can be negative: it then points into a previous chunk
+	}
+
+	isValid = false;
+	return ObjNoIndex;
+}
+
+static void ParseObjChunk(ObjChunk& chunk)
+{
+	std::vector<ObjCorner> polygon;
+
+	const char* p = chunk.begin;
+	while (p < chunk.end)
+	{
+		const char* lineEnd = (const char*)std::memchr(p, '\n', chunk.end - p);
+		if (!lineEnd)
+			lineEnd = chunk.end;
+
+		p = SkipSpaces(p, lineEnd);
+
+		if (lineEnd - p > 2 && p[0] == 'v' && IsSpace(p[1]))
+		{
+			float x, y, z;
+			p = ParseFloat(ParseFloat(ParseFloat(p + 1, lineEnd, x), lineEnd, y), lineEnd, z);
+			chunk.positions.insert(chunk.positions.end(), { x, y, z });
+		}
+		else if (lineEnd - p > 3 && p[0] == 'v' && p[1] == 'n' && IsSpace(p[2]))
+		{
+			float x, y, z;
+			p = ParseFloat(ParseFloat(ParseFloat(p + 2, lineEnd, x), lineEnd, y), lineEnd, z);
+			chunk.normals.insert(chunk.normals.end(), { x, y, z });
+		}
+		else if (lineEnd - p > 3 && p[0] == 'v' && p[1] == 't' && IsSpace(p[2]))
+		{
+			float u, v;
+			p = ParseFloat(ParseFloat(p + 2, lineEnd, u), lineEnd, v);
+			chunk.texCoords.insert(chunk.texCoords.end(), { u, v });
+		}
+		else if (lineEnd - p > 2 && p[0] == 'f' && IsSpace(p[1]))
+		{
+			/* "v", "v/vt", "v//vn" or "v/vt/vn" per corner */
+			polygon.clear();
+			p = SkipSpaces(p + 1, lineEnd);
+			while (p < lineEnd)
+			{
+				ObjCorner corner = { ObjNoIndex, ObjNoIndex, ObjNoIndex, 0 };
+				int index;
+
+				p = ParseInt(p, lineEnd, index);
+				corner.position = ResolveObjIndex(index, chunk.positions.size() / 3, corner.localMask, 1, chunk.isValid);
+
+				if (p < lineEnd && *p == '/')
+				{
+					p++;
+					if (p < lineEnd && *p != '/')
+					{
+						p = ParseInt(p, lineEnd, index);
+						corner.texCoord = ResolveObjIndex(index, chunk.texCoords.size() / 2, corner.localMask, 2, chunk.isValid);
+					}
+					if (p < lineEnd && *p == '/')
+					{
+						p = ParseInt(p + 1, lineEnd, index);
+						corner.normal = ResolveObjIndex(index, chunk.normals.size() / 3, corner.localMask, 4, chunk.isValid);
+					}
+				}
+
+				polygon.push_back(corner);
+
+				/* Anything else (a stray character) ends the face rather than looping forever */
+				if (p < lineEnd && !IsSpace(*p))
+					break;
+				p = SkipSpaces(p, lineEnd);
+			}
+
+			/* Triangle fan */
+			for (std::size_t i = 2; i < polygon.size(); i++)
+			{
+				chunk.corners.push_back(polygon[0]);
+				chunk.corners.push_back(polygon[i - 1]);
+				chunk.corners.push_back(polygon[i]);
+			}
+		}
+
+		/* Comments, groups, materials, smoothing groups... are all skipped */
+		p = lineEnd + 1;
+	}
+}
+
+std::unique_ptr<MeshData> MeshImporter::ImportObj(const MappedFile& file, const MeshImportOptions& options, MeshImportStats& stats)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	const char* text = (const char*)file.GetData();
+	const char* textEnd = text + file.GetSize();
+
+	/* Split on line boundaries, then parse every chunk on its own */
+	std::vector<ObjChunk> chunks;
+	for (const char* begin = text; begin < textEnd;)
+	{
+		const char* end = begin + std::min<std::size_t>(std::max<std::size_t>(options.chunkSize, 1), textEnd - begin);
+		if (end < textEnd)
+		{
+			end = (const char*)std::memchr(end, '\n', textEnd - end);
+			end = end ? end + 1 : textEnd;
+		}
+
+		chunks.emplace_back();
+		chunks.back().begin = begin;
+		chunks.back().end = end;
+		begin = end;
+	}
+
+	JobSystem::Get().ParallelFor(0, chunks.size(), 1, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+			ParseObjChunk(chunks[i]);
+	});
+
+	/* Where every chunk's elements start globally */
+	std::vector<std::size_t> positionStarts(chunks.size()), texCoordStarts(chunks.size()), normalStarts(chunks.size()), cornerStarts(chunks.size());
+	std::size_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0;
+	for (std::size_t i = 0; i < chunks.size(); i++)
+	{
+		if (!chunks[i].isValid)
+		{
+			Log("Invalid face index in OBJ");
+			return nullptr;
+		}
+
+		positionStarts[i] = positionCount;
+		texCoordStarts[i] = texCoordCount;
+		normalStarts[i] = normalCount;
+		cornerStarts[i] = cornerCount;
+
+		positionCount += chunks[i].positions.size() / 3;
+		texCoordCount += chunks[i].texCoords.size() / 2;
+		normalCount += chunks[i].normals.size() / 3;
+		cornerCount += chunks[i].corners.size();
+	}
+
+	if (cornerCount == 0)
+	{
+		Log("OBJ has no faces");
+		return nullptr;
+	}
+
+	std::vector<float> positions, texCoords, normals;
+	positions.reserve(positionCount * 3);
+	texCoords.reserve(texCoordCount * 2);
+	normals.reserve(normalCount * 3);
+	for (const ObjChunk& chunk : chunks)
+	{
+		positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+		texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+		normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+	}
+
+	/* Expand every corner to an interleaved vertex, missing attributes are zero */
+	auto mesh = std::make_unique<MeshData>(options.attributes);
+	const uint32_t stride = MeshData::GetStride(mesh->m_Attributes);
+	const bool hasNormals = mesh->m_Attributes & MESH_ATTRIBUTE_NORMAL;
+	const bool hasTexCoords = mesh->m_Attributes & MESH_ATTRIBUTE_TEXCOORD;
+
+	std::vector<float>& vertices = mesh->m_VertexStorage;
+	vertices.assign(cornerCount * stride, 0.0f);
+	std::atomic<bool> isValid(true);
+
+	JobSystem::Get().ParallelFor(0, chunks.size(), 1, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+		{
+			float* vertex = &vertices[cornerStarts[i] * stride];
+			for (const ObjCorner& corner : chunks[i].corners)
+			{
+				const int64_t position = corner.position + (corner.localMask & 1 ? (int64_t)positionStarts[i] : 0);
+				const int64_t texCoord = corner.texCoord + (corner.localMask & 2 ? (int64_t)texCoordStarts[i] : 0);
+				const int64_t normal = corner.normal + (corner.localMask & 4 ? (int64_t)normalStarts[i] : 0);
+
+				if (position < 0 || position >= (int64_t)positionCount)
+				{
+					isValid = false;
+					return;
+				}
+				std::memcpy(vertex, &positions[position * 3], 3 * sizeof(float));
+
+				float* attribute = vertex + 3;
+				if (hasNormals)
+				{
+					if (corner.normal != ObjNoIndex && normal >= 0 && normal < (int64_t)normalCount)
+						std::memcpy(attribute, &normals[normal * 3], 3 * sizeof(float));
+					attribute += 3;
+				}
+				if (hasTexCoords && corner.texCoord != ObjNoIndex && texCoord >= 0 && texCoord < (int64_t)texCoordCount)
+					std::memcpy(attribute, &texCoords[texCoord * 2], 2 * sizeof(float));
+
+				vertex += stride;
+			}
+		}
+	});
+
+	if (!isValid)
+	{
+		Log("OBJ face index out of range");
+		return nullptr;
+	}
+
+	stats.chunkCount = chunks.size();
+	stats.cornerCount = cornerCount;
+	stats.parseMilliseconds = MillisecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+
+	Weld(vertices, stride, mesh->m_IndexStorage);
+	if (hasNormals && normalCount == 0)
+		GenerateNormals(*mesh);
+
+	stats.weldMilliseconds = MillisecondsSince(start);
+	return mesh;
+}
+
+/* ---------------------------------------------------------------- glTF */
+
+namespace
+{
+/* Just enough JSON for a glTF header: numbers, strings, arrays and objects */
+struct JsonValue
+{
+	enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+	Type type = Type::NUL;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> elements;
+	std::vector<std::pair<std::string, JsonValue>> members;
+
+	const JsonValue* Find(const char* key) const
+	{
+		for (const auto& member : members)
+		{
+			if (member.first == key)
+				return &member.second;
+		}
+		return nullptr;
+	}
+
+	double GetNumber(const char* key, double fallback) const
+	{
+		const JsonValue* value = Find(key);
+		return value && value->type == Type::NUMBER ? value->number : fallback;
+	}
+};
+
+class JsonParser
+{
+private:
+	const char* m_Current;
+	const char* m_End;
+	int m_Depth;
+
+public:
+	JsonParser(const char* begin, const char* end)
+		: m_Current(begin), m_End(end), m_Depth(0) {}
+
+	bool Parse(JsonValue& value)
+	{
+		SkipSpaces();
+		if (m_Current >= m_End || ++m_Depth > 64)
+			return false;
+
+		bool isValid = true;
+		switch (*m_Current)
+		{
+		case '{':
+			value.type = JsonValue::Type::OBJECT;
+			m_Current++;
+			SkipSpaces();
+			if (m_Current < m_End && *m_Current == '}')
+			{
+				m_Current++;
+				break;
+			}
+			while (isValid)
+			{
+				value.members.emplace_back();
+				SkipSpaces();
+				isValid = ParseString(value.members.back().first) && Expect(':') && Parse(value.members.back().second);
+				SkipSpaces();
+				if (m_Current < m_End && *m_Current == ',')
+					m_Current++;
+				else
+				{
+					isValid = isValid && Expect('}');
+					break;
+				}
+			}
+			break;
+		case '[':
+			value.type = JsonValue::Type::ARRAY;
+			m_Current++;
+			SkipSpaces();
+			if (m_Current < m_End && *m_Current == ']')
+			{
+				m_Current++;
+				break;
+			}
+			while (isValid)
+			{
+				value.elements.emplace_back();
+				isValid = Parse(value.elements.back());
+				SkipSpaces();
+				if (m_Current < m_End && *m_Current == ',')
+					m_Current++;
+				else
+				{
+					isValid = isValid && Expect(']');
+					break;
+				}
+			}
+			break;
+		case '"':
+			value.type = JsonValue::Type::STRING;
+			isValid = ParseString(value.string);
+			break;
+		case 't':
+		case 'f':
+		case 'n':
+			value.type = *m_Current == 'n' ? JsonValue::Type::NUL : JsonValue::Type::BOOLEAN;
+			value.number = *m_Current == 't' ? 1.0 : 0.0;
+			while (m_Current < m_End && *m_Current >= 'a' && *m_Current <= 'z')
+				m_Current++;
+			break;
+		default:
+		{
+			const char* start = m_Current;
+			m_Current = ParseNumber(m_Current, m_End, value.number);
+			value.type = JsonValue::Type::NUMBER;
+			isValid = m_Current != start;
+			break;
+		}
+		}
+
+		m_Depth--;
+		return isValid;
+	}
+
+private:
+	void SkipSpaces()
+	{
+		while (m_Current < m_End && (IsSpace(*m_Current) || *m_Current == '\n'))
+			m_Current++;
+	}
+
+	bool Expect(char c)
+	{
+		SkipSpaces();
+		if (m_Current >= m_End || *m_Current != c)
+			return false;
+		m_Current++;
+		return true;
+	}
+
+	bool ParseString(std::string& string)
+	{
+		if (!Expect('"'))
+			return false;
+
+		while (m_Current < m_End && *m_Current != '"')
+		{
+			char c = *m_Current++;
+			if (c == '\\' && m_Current < m_End)
+			{
+				c = *m_Current++;
+				switch (c)
+				{
+				case 'n': c = '\n'; break;
+				case 't': c = '\t'; break;
+				case 'r': c = '\r'; break;
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case 'u': c = '?'; m_Current = std::min(m_Current + 4, m_End); break; // Names only matter when ASCII
+				}
+			}
+			string.push_back(c);
+		}
+
+		return Expect('"');
+	}
+};
+}
+
+constexpr uint32_t GlbMagic = 0x46546C67; // "glTF"
+constexpr uint32_t GlbChunkJson = 0x4E4F534A;
+constexpr uint32_t GlbChunkBin = 0x004E4942;
+
+struct GlbAccessor
+{
+	const unsigned char* data = nullptr;
+	std::size_t count = 0;
+	std::size_t stride = 0;
+	uint32_t componentType = 0;
+	uint32_t componentCount = 0;
+};
+
+static bool GetGlbAccessor(const JsonValue& json, const unsigned char* bin, std::size_t binSize, int index, GlbAccessor& accessor)
+{
+	const JsonValue* accessors = json.Find("accessors");
+	const JsonValue* bufferViews = json.Find("bufferViews");
+	if (!accessors || !bufferViews || index < 0 || index >= (int)accessors->elements.size())
+		return false;
+
+	const JsonValue& accessorJson = accessors->elements[index];
+	const int bufferViewIndex = (int)accessorJson.GetNumber("bufferView", -1);
+	if (bufferViewIndex < 0 || bufferViewIndex >= (int)bufferViews->elements.size() || accessorJson.Find("sparse"))
+		return false;
+
+	const JsonValue& bufferView = bufferViews->elements[bufferViewIndex];
+	if (bufferView.GetNumber("buffer", 0) != 0)
+		return false;
+
+	const JsonValue* type = accessorJson.Find("type");
+	if (!type)
+		return false;
+
+	accessor.componentCount = type->string == "SCALAR" ? 1 : type->string == "VEC2" ? 2 : type->string == "VEC3" ? 3 : type->string == "VEC4" ? 4 : 0;
+	accessor.componentType = (uint32_t)accessorJson.GetNumber("componentType", 0);
+	accessor.count = (std::size_t)accessorJson.GetNumber("count", 0);
+
+	const std::size_t componentSize = accessor.componentType == GL_UNSIGNED_BYTE ? 1 : accessor.componentType == GL_UNSIGNED_SHORT ? 2 : 4;
+	const std::size_t elementSize = componentSize * accessor.componentCount;
+	accessor.stride = (std::size_t)bufferView.GetNumber("byteStride", (double)elementSize);
+
+	const std::size_t offset = (std::size_t)bufferView.GetNumber("byteOffset", 0) + (std::size_t)accessorJson.GetNumber("byteOffset", 0);
+	const std::size_t viewEnd = (std::size_t)bufferView.GetNumber("byteOffset", 0) + (std::size_t)bufferView.GetNumber("byteLength", 0);
+	if (accessor.componentCount == 0 || accessor.count == 0 || viewEnd > binSize || offset + (accessor.count - 1) * accessor.stride + elementSize > viewEnd)
+		return false;
+
+	accessor.data = bin + offset;
+	return true;
+}
+
+// Copies a float accessor into `componentCount` floats of every vertex (at `attributeOffset` in the interleaved layout)
+static bool CopyGlbAttribute(const GlbAccessor& accessor, uint32_t componentCount, float* vertices, uint32_t stride, uint32_t attributeOffset)
+{
+	if (accessor.componentType != GL_FLOAT || accessor.componentCount < componentCount)
+		return false;
+
+	JobSystem::Get().ParallelFor(0, accessor.count, 16384, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+			std::memcpy(vertices + i * stride + attributeOffset, accessor.data + i * accessor.stride, componentCount * sizeof(float));
+	});
+
+	return true;
+}
+
+std::unique_ptr<MeshData> MeshImporter::ImportGlb(const MappedFile& file, const MeshImportOptions& options, MeshImportStats& stats)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	/* Header, then the JSON chunk and the (optional) binary chunk */
+	const unsigned char* data = file.GetData();
+	const std::size_t size = file.GetSize();
+
+	uint32_t header[3];
+	if (size < 20 || (std::memcpy(header, data, sizeof(header)), header[0] != GlbMagic || header[1] != 2))
+	{
+		Log("Not a glTF 2.0 binary");
+		return nullptr;
+	}
+
+	const unsigned char* json = nullptr;
+	const unsigned char* bin = nullptr;
+	std::size_t jsonSize = 0, binSize = 0;
+	for (std::size_t offset = 12; offset + 8 <= size;)
+	{
+		uint32_t chunkHeader[2];
+		std::memcpy(chunkHeader, data + offset, sizeof(chunkHeader));
+		if (offset + 8 + chunkHeader[0] > size)
+			break;
+
+		if (chunkHeader[1] == GlbChunkJson)
+		{
+			json = data + offset + 8;
+			jsonSize = chunkHeader[0];
+		}
+		else if (chunkHeader[1] == GlbChunkBin)
+		{
+			bin = data + offset + 8;
+			binSize = chunkHeader[0];
+		}
+
+		offset += 8 + ((chunkHeader[0] + 3) & ~3u);
+	}
+
+	JsonValue root;
+	if (!json || !JsonParser((const char*)json, (const char*)json + jsonSize).Parse(root) || root.type != JsonValue::Type::OBJECT)
+	{
+		Log("Invalid glTF JSON chunk");
+		return nullptr;
+	}
+
+	auto mesh = std::make_unique<MeshData>(options.attributes);
+	const uint32_t stride = MeshData::GetStride(mesh->m_Attributes);
+	const bool hasNormals = mesh->m_Attributes & MESH_ATTRIBUTE_NORMAL;
+	const bool hasTexCoords = mesh->m_Attributes & MESH_ATTRIBUTE_TEXCOORD;
+
+	std::vector<float>& vertices = mesh->m_VertexStorage;
+	std::vector<unsigned int>& indices = mesh->m_IndexStorage;
+	std::vector<bool> isNormalMissing; // Per vertex, for the primitives without NORMAL
+	bool hasMissingNormals = false;
+
+	/* Every triangle primitive of every mesh, appended one after the other */
+	const JsonValue* meshes = root.Find("meshes");
+	for (std::size_t meshIndex = 0; meshes && meshIndex < meshes->elements.size(); meshIndex++)
+	{
+		const JsonValue* primitives = meshes->elements[meshIndex].Find("primitives");
+		for (std::size_t primitiveIndex = 0; primitives && primitiveIndex < primitives->elements.size(); primitiveIndex++)
+		{
+			const JsonValue& primitive = primitives->elements[primitiveIndex];
+			const JsonValue* attributes = primitive.Find("attributes");
+			if (primitive.GetNumber("mode", GL_TRIANGLES) != GL_TRIANGLES || !attributes)
+			{
+				Log("Skipping a glTF primitive (only triangle lists are supported)");
+				continue;
+			}
+
+			GlbAccessor positions;
+			if (!GetGlbAccessor(root, bin, binSize, (int)attributes->GetNumber("POSITION", -1), positions))
+			{
+				Log("Skipping a glTF primitive (no usable POSITION)");
+				continue;
+			}
+
+			const std::size_t baseVertex = vertices.size() / stride;
+			vertices.resize(vertices.size() + positions.count * stride, 0.0f);
+			float* primitiveVertices = &vertices[baseVertex * stride];
+
+			bool isValid = CopyGlbAttribute(positions, 3, primitiveVertices, stride, 0);
+
+			GlbAccessor accessor;
+			if (hasNormals)
+			{
+				const bool hasFileNormals = GetGlbAccessor(root, bin, binSize, (int)attributes->GetNumber("NORMAL", -1), accessor) && accessor.count == positions.count;
+				if (hasFileNormals)
+					isValid = isValid && CopyGlbAttribute(accessor, 3, primitiveVertices, stride, 3);
+				isNormalMissing.resize(baseVertex + positions.count, !hasFileNormals);
+				hasMissingNormals = hasMissingNormals || !hasFileNormals;
+			}
+			if (hasTexCoords && GetGlbAccessor(root, bin, binSize, (int)attributes->GetNumber("TEXCOORD_0", -1), accessor) && accessor.count == positions.count)
+				isValid = isValid && CopyGlbAttribute(accessor, 2, primitiveVertices, stride, hasNormals ? 6 : 3);
+
+			if (!isValid)
+			{
+				Log("Unsupported glTF attribute format (only float attributes are supported)");
+				return nullptr;
+			}
+
+			/* Indices, widened to 32 bits and offset to the merged vertices */
+			const std::size_t firstIndex = indices.size();
+			if (GetGlbAccessor(root, bin, binSize, (int)primitive.GetNumber("indices", -1), accessor) && accessor.componentCount == 1)
+			{
+				indices.resize(firstIndex + accessor.count);
+				for (std::size_t i = 0; i < accessor.count; i++)
+				{
+					const unsigned char* index = accessor.data + i * accessor.stride;
+					uint32_t value;
+					if (accessor.componentType == GL_UNSIGNED_BYTE)
+						value = *index;
+					else if (accessor.componentType == GL_UNSIGNED_SHORT)
+						value = (uint32_t)index[0] | (uint32_t)index[1] << 8;
+					else
+						std::memcpy(&value, index, sizeof(value));
+
+					if (value >= positions.count)
+					{
+						Log("glTF index out of range");
+						return nullptr;
+					}
+					indices[firstIndex + i] = (unsigned int)(baseVertex + value);
+				}
+			}
+			else
+			{
+				for (std::size_t i = 0; i < positions.count; i++)
+					indices.push_back((unsigned int)(baseVertex + i));
+			}
+		}
+	}
+
+	if (indices.empty())
+	{
+		Log("glTF has no triangles");
+		return nullptr;
+	}
+
+	stats.chunkCount = 1;
+	stats.cornerCount = indices.size();
+	stats.parseMilliseconds = MillisecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+
+	/* Exporters often split vertices per primitive or per face, weld them back */
+	std::vector<unsigned int> remap;
+	Weld(vertices, stride, remap);
+	for (unsigned int& index : indices)
+		index = remap[index];
+
+	if (hasMissingNormals)
+	{
+		/* Zero normals never weld with imported ones, so each welded vertex is either missing its normal or not */
+		std::vector<bool> isWeldedNormalMissing(vertices.size() / stride, false);
+		for (std::size_t i = 0; i < remap.size(); i++)
+		{
+			if (isNormalMissing[i])
+				isWeldedNormalMissing[remap[i]] = true;
+		}
+		GenerateNormals(*mesh, &isWeldedNormalMissing);
+	}
+
+	stats.weldMilliseconds = MillisecondsSince(start);
+	return mesh;
+}
+
+/* ---------------------------------------------------------------- Welding and normals */
+
+static uint32_t HashVertex(const float* vertex, uint32_t stride)
+{
+	/* FNV-1a over the raw words, then a final mix so the low bits (the table slot) depend on every word */
+	uint32_t hash = 2166136261u;
+	for (uint32_t i = 0; i < stride; i++)
+	{
+		uint32_t word;
+		std::memcpy(&word, &vertex[i], sizeof(word));
+		hash = (hash ^ word) * 16777619u;
+	}
+
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6Bu;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35u;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+void MeshImporter::Weld(std::vector<float>& vertices, uint32_t stride, std::vector<unsigned int>& remap)
+{
+	const std::size_t count = vertices.size() / stride;
+	remap.resize(count);
+
+	/* Hashing is the expensive part and it's independent per vertex */
+	std::vector<uint32_t> hashes(count);
+	JobSystem::Get().ParallelFor(0, count, 16384, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+			hashes[i] = HashVertex(&vertices[i * stride], stride);
+	});
+
+	/* Open addressing with linear probing, the table stores indices of unique vertices */
+	std::size_t tableSize = 1;
+	while (tableSize < count * 2)
+		tableSize <<= 1;
+	const std::size_t mask = tableSize - 1;
+	std::vector<uint32_t> table(tableSize, UINT32_MAX);
+
+	/* Unique vertices are compacted in place: `uniqueCount` never passes `i`, so nothing unread gets overwritten */
+	uint32_t uniqueCount = 0;
+	for (std::size_t i = 0; i < count; i++)
+	{
+		const uint32_t hash = hashes[i];
+		const float* vertex = &vertices[i * stride];
+
+		for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask)
+		{
+			const uint32_t unique = table[slot];
+			if (unique == UINT32_MAX)
+			{
+				table[slot] = uniqueCount;
+				if (uniqueCount != i)
+					std::memcpy(&vertices[uniqueCount * stride], vertex, stride * sizeof(float));
+				hashes[uniqueCount] = hash;
+				remap[i] = uniqueCount++;
+				break;
+			}
+
+			if (hashes[unique] == hash && std::memcmp(&vertices[unique * stride], vertex, stride * sizeof(float)) == 0)
+			{
+				remap[i] = unique;
+				break;
+			}
+		}
+	}
+
+	vertices.resize(uniqueCount * stride);
+}
+
+void MeshImporter::GenerateNormals(MeshData& mesh, const std::vector<bool>* isMissing)
+{
+	/* Area-weighted face normals summed per vertex (vertices only differing by their missing normal were welded, so it's smooth) */
+	const uint32_t stride = MeshData::GetStride(mesh.m_Attributes);
+	std::vector<float>& vertices = mesh.m_VertexStorage;
+	const std::vector<unsigned int>& indices = mesh.m_IndexStorage;
+
+	for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		float* corners[3] = { &vertices[indices[i] * stride], &vertices[indices[i + 1] * stride], &vertices[indices[i + 2] * stride] };
+		const glm::vec3 p0(corners[0][0], corners[0][1], corners[0][2]);
+		const glm::vec3 p1(corners[1][0], corners[1][1], corners[1][2]);
+		const glm::vec3 p2(corners[2][0], corners[2][1], corners[2][2]);
+		const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			if (isMissing && !(*isMissing)[indices[i + corner]])
+				continue;
+
+			corners[corner][3] += normal.x;
+			corners[corner][4] += normal.y;
+			corners[corner][5] += normal.z;
+		}
+	}
+
+	for (std::size_t i = 0; i < vertices.size(); i += stride)
+	{
+		if (isMissing && !(*isMissing)[i / stride])
+			continue;
+
+		const glm::vec3 normal(vertices[i + 3], vertices[i + 4], vertices[i + 5]);
+		const float length = glm::length(normal);
+		const glm::vec3 unit = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+		vertices[i + 3] = unit.x;
+		vertices[i + 4] = unit.y;
+		vertices[i + 5] = unit.z;
+	}
+}
+
+void MeshImporter::Finish(MeshData& mesh)
+{
+	const uint32_t stride = MeshData::GetStride(mesh.m_Attributes);
+
+	mesh.m_Vertices = mesh.m_VertexStorage.data();
+	mesh.m_Indices = mesh.m_IndexStorage.data();
+	mesh.m_VertexCount = (uint32_t)(mesh.m_VertexStorage.size() / stride);
+	mesh.m_IndexCount = (uint32_t)mesh.m_IndexStorage.size();
+
+	mesh.m_Bounds = { glm::vec3(mesh.m_Vertices[0], mesh.m_Vertices[1], mesh.m_Vertices[2]), glm::vec3(mesh.m_Vertices[0], mesh.m_Vertices[1], mesh.m_Vertices[2]) };
+	for (uint32_t i = 1; i < mesh.m_VertexCount; i++)
+	{
+		const glm::vec3 position(mesh.m_Vertices[i * stride], mesh.m_Vertices[i * stride + 1], mesh.m_Vertices[i * stride + 2]);
+		mesh.m_Bounds.min = glm::min(mesh.m_Bounds.min, position);
+		mesh.m_Bounds.max = glm::max(mesh.m_Bounds.max, position);
+	}
+}
+
+/* ---------------------------------------------------------------- Loading and caching */
+
+std::unique_ptr<MeshData> MeshImporter::Import(const std::string& filepath, const MeshImportOptions& options, MeshImportStats* stats)
+{
+	const auto start = std::chrono::steady_clock::now();
+	MeshImportStats localStats;
+	MeshImportStats& result = stats ? *stats : localStats;
+	result = MeshImportStats();
+
+	MappedFile file(filepath);
+	if (!file.IsOpen())
+	{
+		Log("Failed to open " + filepath);
+		return nullptr;
+	}
+
+	std::unique_ptr<MeshData> mesh;
+	if (EndsWith(filepath, ".obj") || EndsWith(filepath, ".OBJ"))
+		mesh = ImportObj(file, options, result);
+	else if (EndsWith(filepath, ".glb") || EndsWith(filepath, ".GLB"))
+		mesh = ImportGlb(file, options, result);
+	else
+		Log("Unknown mesh format " + filepath + " (expected .obj or .glb)");
+
+	if (!mesh)
+	{
+		Log("Failed to import " + filepath);
+		return nullptr;
+	}
+
+	Finish(*mesh);
+	result.totalMilliseconds = MillisecondsSince(start);
+	return mesh;
+}
+
+std::unique_ptr<MeshData> MeshImporter::Load(const std::string& filepath, const MeshImportOptions& options, MeshImportStats* stats)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	if (options.isCacheEnabled)
+	{
+		if (auto mesh = LoadCache(filepath, options.attributes))
+		{
+			if (stats)
+			{
+				*stats = MeshImportStats();
+				stats->isFromCache = true;
+				stats->parseMilliseconds = stats->totalMilliseconds = MillisecondsSince(start);
+			}
+			return mesh;
+		}
+	}
+
+	auto mesh = Import(filepath, options, stats);
+	if (mesh && options.isCacheEnabled)
+	{
+		const auto cacheStart = std::chrono::steady_clock::now();
+		WriteCache(*mesh, filepath);
+		if (stats)
+		{
+			stats->cacheWriteMilliseconds = MillisecondsSince(cacheStart);
+			stats->totalMilliseconds = MillisecondsSince(start);
+		}
+	}
+
+	return mesh;
+}
+
+std::string MeshImporter::GetCachePath(const std::string& filepath)
+{
+	return filepath + ".meshcache";
+}
+
+// What the cache remembers of its source, to notice when it's been modified
+static bool GetSourceStamp(const std::string& filepath, uint64_t& size, int64_t& modifiedTime)
+{
+	std::error_code error;
+	size = std::filesystem::file_size(filepath, error);
+	if (error)
+		return false;
+
+	const auto time = std::filesystem::last_write_time(filepath, error);
+	if (error)
+		return false;
+
+	modifiedTime = (int64_t)time.time_since_epoch().count();
+	return true;
+}
+
+bool MeshImporter::WriteCache(const MeshData& mesh, const std::string& filepath)
+{
+	MeshCacheHeader header = {};
+	header.magic = MeshCacheMagic;
+	header.version = MeshCacheVersion;
+	if (!GetSourceStamp(filepath, header.sourceSize, header.sourceModifiedTime))
+		return false;
+
+	header.attributes = mesh.m_Attributes;
+	header.vertexCount = mesh.m_VertexCount;
+	header.indexCount = mesh.m_IndexCount;
+	std::memcpy(header.boundsMin, &mesh.m_Bounds.min.x, sizeof(header.boundsMin));
+	std::memcpy(header.boundsMax, &mesh.m_Bounds.max.x, sizeof(header.boundsMax));
+
+	const uint64_t vertexSize = (uint64_t)mesh.m_VertexCount * MeshData::GetStride(mesh.m_Attributes) * sizeof(float);
+	header.vertexOffset = (sizeof(MeshCacheHeader) + MeshCacheAlignment - 1) & ~(MeshCacheAlignment - 1);
+	header.indexOffset = (header.vertexOffset + vertexSize + MeshCacheAlignment - 1) & ~(MeshCacheAlignment - 1);
+
+	const std::string cachePath = GetCachePath(filepath);
+	std::ofstream stream(cachePath, std::ios::binary | std::ios::trunc);
+	if (!stream)
+	{
+		Log("Failed to open " + cachePath + " for writing");
+		return false;
+	}
+
+	const char padding[MeshCacheAlignment] = {};
+	stream.write((const char*)&header, sizeof(header));
+	stream.write(padding, header.vertexOffset - sizeof(header));
+	stream.write((const char*)mesh.m_Vertices, vertexSize);
+	stream.write(padding, header.indexOffset - header.vertexOffset - vertexSize);
+	stream.write((const char*)mesh.m_Indices, (std::size_t)mesh.m_IndexCount * sizeof(unsigned int));
+
+	return (bool)stream;
+}
+
+std::unique_ptr<MeshData> MeshImporter::LoadCache(const std::string& filepath, uint32_t attributes)
+{
+	uint64_t sourceSize;
+	int64_t sourceModifiedTime;
+	if (!GetSourceStamp(filepath, sourceSize, sourceModifiedTime))
+		return nullptr;
+
+	auto file = std::make_unique<MappedFile>(GetCachePath(filepath));
+	if (!file->IsOpen() || file->GetSize() < sizeof(MeshCacheHeader))
+		return nullptr;
+
+	/* Stale or foreign caches are silently ignored, the caller re-imports and overwrites them */
+	const MeshCacheHeader* header = (const MeshCacheHeader*)file->GetData();
+	attributes |= MESH_ATTRIBUTE_POSITION;
+	if (header->magic != MeshCacheMagic || header->version != MeshCacheVersion || header->attributes != attributes
+		|| header->sourceSize != sourceSize || header->sourceModifiedTime != sourceModifiedTime)
+		return nullptr;
+
+	const uint64_t vertexSize = (uint64_t)header->vertexCount * MeshData::GetStride(attributes) * sizeof(float);
+	const uint64_t indexSize = (uint64_t)header->indexCount * sizeof(unsigned int);
+	if (header->vertexCount == 0 || header->vertexOffset % MeshCacheAlignment != 0 || header->indexOffset % MeshCacheAlignment != 0
+		|| header->vertexOffset + vertexSize > file->GetSize() || header->indexOffset + indexSize > file->GetSize())
+		return nullptr;
+
+	/* A corrupt index would fetch out of the vertex buffer on the GPU */
+	const unsigned int* indices = (const unsigned int*)(file->GetData() + header->indexOffset);
+	unsigned int maxIndex = 0;
+	for (uint64_t i = 0; i < header->indexCount; i++)
+		maxIndex = std::max(maxIndex, indices[i]);
+	if (maxIndex >= header->vertexCount)
+		return nullptr;
+
+	auto mesh = std::make_unique<MeshData>(attributes);
+	mesh->m_Vertices = (const float*)(file->GetData() + header->vertexOffset);
+	mesh->m_Indices = indices;
+	mesh->m_VertexCount = header->vertexCount;
+	mesh->m_IndexCount = header->indexCount;
+	mesh->m_Bounds = { glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]), glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]) };
+	mesh->m_CacheFile = std::move(file);
+
+	return mesh;
+}
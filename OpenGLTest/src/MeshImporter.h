@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+#include "MappedFile.h"
+#include "Frustum.h"
+
+/*
+ * Mesh cache layout (little endian), written next to the source as "<source>.meshcache":
+ *   MeshCacheHeader
+ *   Vertices (interleaved as described by the attributes), starting on a MeshCacheAlignment boundary
+ *   Indices (uint32), same
+ *
+ * A cache is only used when its version, attributes, and the source's size and modification time all match
+ */
+
+constexpr uint32_t MeshCacheMagic = 0x434D4C47; // "GLMC"
+constexpr uint32_t MeshCacheVersion = 1;
+constexpr uint64_t MeshCacheAlignment = 64;
+
+// Interleaved in this order, position always comes first
+enum MeshAttribute : uint32_t
+{
+	MESH_ATTRIBUTE_POSITION = 1 << 0, // vec3
+	MESH_ATTRIBUTE_NORMAL = 1 << 1, // vec3
+	MESH_ATTRIBUTE_TEXCOORD = 1 << 2 // vec2
+};
+
+struct MeshCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceSize;
+	int64_t sourceModifiedTime;
+	uint32_t attributes;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t padding;
+	float boundsMin[3];
+	float boundsMax[3];
+	uint64_t vertexOffset; // From the start of the file
+	uint64_t indexOffset;
+};
+
+struct MeshImportOptions
+{
+	// Requested attributes: normals are generated when the file has none, texture coordinates are zero-filled
+	uint32_t attributes = MESH_ATTRIBUTE_POSITION | MESH_ATTRIBUTE_NORMAL | MESH_ATTRIBUTE_TEXCOORD;
+	bool isCacheEnabled = true;
+	std::size_t chunkSize = 1 << 20; // Bytes of OBJ text per parsing job
+};
+
+struct MeshImportStats
+{
+	bool isFromCache = false;
+	std::size_t chunkCount = 0;
+	std::size_t cornerCount = 0; // Before welding (3 per triangle)
+	float parseMilliseconds = 0.0f; // Or the cache mapping time
+	float weldMilliseconds = 0.0f;
+	float cacheWriteMilliseconds = 0.0f;
+	float totalMilliseconds = 0.0f;
+};
+
+/* Triangle list with interleaved vertices, either owned or pointing straight into a mapped cache file */
+class MeshData
+{
+private:
+	uint32_t m_Attributes;
+	std::vector<float> m_VertexStorage;
+	std::vector<unsigned int> m_IndexStorage;
+	std::unique_ptr<MappedFile> m_CacheFile;
+
+	const float* m_Vertices;
+	const unsigned int* m_Indices;
+	uint32_t m_VertexCount;
+	uint32_t m_IndexCount;
+	AABB m_Bounds;
+
+	friend class MeshImporter;
+
+public:
+	MeshData(uint32_t attributes);
+
+	VertexBufferLayout GetLayout() const;
+	static uint32_t GetStride(uint32_t attributes); // In floats
+
+	inline uint32_t GetAttributes() const { return m_Attributes; }
+	inline const float* GetVertices() const { return m_Vertices; }
+	inline const unsigned int* GetIndices() const { return m_Indices; }
+	inline uint32_t GetVertexCount() const { return m_VertexCount; }
+	inline uint32_t GetIndexCount() const { return m_IndexCount; }
+	inline const AABB& GetBounds() const { return m_Bounds; }
+	inline bool IsMapped() const { return m_CacheFile != nullptr; }
+};
+
+/*
+ * Wavefront OBJ and binary glTF 2.0 (.glb) importer
+ * OBJ text is parsed in chunks on the job system, every corner is expanded to an interleaved vertex, and identical
+ * vertices are welded through a hash map. glTF primitives are merged into one mesh (node transforms are ignored)
+ */
+class MeshImporter
+{
+public:
+	// Uses the cache when it's valid, otherwise imports the file and (re)writes the cache. Returns nullptr on failure
+	static std::unique_ptr<MeshData> Load(const std::string& filepath, const MeshImportOptions& options = MeshImportOptions(), MeshImportStats* stats = nullptr);
+
+	// Parses the source file, never touches the cache
+	static std::unique_ptr<MeshData> Import(const std::string& filepath, const MeshImportOptions& options = MeshImportOptions(), MeshImportStats* stats = nullptr);
+
+	static std::string GetCachePath(const std::string& filepath);
+	static bool WriteCache(const MeshData& mesh, const std::string& filepath);
+	// Maps the cache of `filepath`: the returned mesh reads its vertices and indices from the mapping, nothing is parsed
+	static std::unique_ptr<MeshData> LoadCache(const std::string& filepath, uint32_t attributes);
+
+private:
+	static std::unique_ptr<MeshData> ImportObj(const MappedFile& file, const MeshImportOptions& options, MeshImportStats& stats);
+	static std::unique_ptr<MeshData> ImportGlb(const MappedFile& file, const MeshImportOptions& options, MeshImportStats& stats);
+
+	// Replaces `vertices` (interleaved, `stride` floats each) by the unique ones, `remap[vertex]` being the new index
+	static void Weld(std::vector<float>& vertices, uint32_t stride, std::vector<unsigned int>& remap);
+	// Only for the vertices flagged in `isMissing` when given, the others keep the normal they were imported with
+	static void GenerateNormals(MeshData& mesh, const std::vector<bool>* isMissing = nullptr);
+	static void Finish(MeshData& mesh);
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+enum class RenderBackend
+{
+	OPENGL = 0,
+	SOFTWARE = 1 // `SoftwareRasterizer`: no GL context at all, the GL wrappers keep their data on the CPU instead
+};
+
+// Picked once at startup (`--backend`), before any resource is created (defined in Renderer.cpp)
+extern RenderBackend ActiveRenderBackend;
+
+inline bool IsSoftwareRendering() { return ActiveRenderBackend == RenderBackend::SOFTWARE; }
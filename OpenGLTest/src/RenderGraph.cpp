@@ -0,0 +1,638 @@
+#include "RenderGraph.h"
+#include "GLHandleError.h"
+#include "RenderStats.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <string>
+
+std::size_t RenderTargetDescription::GetSize() const
+{
+	/* RGBA8 and D24S8 are 4 bytes per pixel, RGBA16F 8 */
+	return (std::size_t)width * height * (format == RenderTargetFormat::RGBA16F ? 8 : 4);
+}
+
+RenderResource RenderPassBuilder::Create(const char* name, const RenderTargetDescription& description)
+{
+	const RenderResource resource = (RenderResource)m_Graph.m_Resources.size();
+	m_Graph.m_Resources.push_back({ name, description, 0, false, false, 0, 0, -1, -1, nullptr });
+	Write(resource);
+	return resource;
+}
+
+void RenderPassBuilder::Read(RenderResource resource)
+{
+	m_Graph.m_Accesses.push_back({ m_Pass, resource, false });
+}
+
+void RenderPassBuilder::Write(RenderResource resource)
+{
+	m_Graph.m_Accesses.push_back({ m_Pass, resource, true });
+}
+
+void RenderPassBuilder::SetCompute()
+{
+	m_Graph.m_Passes[m_Pass].isCompute = true;
+}
+
+void RenderPassBuilder::SetSideEffect()
+{
+	m_Graph.m_Passes[m_Pass].hasSideEffect = true;
+}
+
+unsigned int RenderPassContext::GetTexture(RenderResource resource) const
+{
+	const RenderGraph::Texture* texture = m_Graph.m_Resources[resource].texture;
+	return texture ? texture->rendererID : 0;
+}
+
+const RenderTargetDescription& RenderPassContext::GetDescription(RenderResource resource) const
+{
+	return m_Graph.m_Resources[resource].description;
+}
+
+void RenderPassContext::BindImage(RenderResource resource, unsigned int unit, GLenum access) const
+{
+	const RenderTargetDescription& description = GetDescription(resource);
+	const GLenum format = description.format == RenderTargetFormat::RGBA16F ? GL_RGBA16F : GL_RGBA8;
+	GL_CALL(glBindImageTexture(unit, GetTexture(resource), 0, GL_FALSE, 0, access, format));
+}
+
+RenderGraph::RenderGraph()
+	: m_IsAliasing(true), m_IsCompiled(false)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	while (!m_Textures.empty())
+		ReleaseTexture(m_Textures.size() - 1);
+}
+
+void RenderGraph::Reset()
+{
+	m_Passes.clear();
+	m_Resources.clear();
+	m_Accesses.clear();
+	m_Order.clear();
+	m_IsCompiled = false;
+}
+
+RenderResource RenderGraph::ImportFramebuffer(const char* name, GLuint framebuffer, int width, int height)
+{
+	RenderTargetDescription description;
+	description.width = width;
+	description.height = height;
+
+	const RenderResource resource = (RenderResource)m_Resources.size();
+	m_Resources.push_back({ name, description, framebuffer, true, false, 0, 0, -1, -1, nullptr });
+	return resource;
+}
+
+uint32_t RenderGraph::BeginPass(const char* name, ExecuteFunction execute)
+{
+	const uint32_t pass = (uint32_t)m_Passes.size();
+	m_Passes.push_back({ name, std::move(execute), (uint32_t)m_Accesses.size(), 0, 0, false, false, false, false });
+	return pass;
+}
+
+bool RenderGraph::Compile()
+{
+	m_IsCompiled = false;
+	m_Statistics = Statistics();
+	m_Statistics.passCount = (uint32_t)m_Passes.size();
+
+	if (!Validate())
+		return false;
+
+	Cull();
+	if (!Sort())
+		return false;
+
+	AssignTextures();
+	m_IsCompiled = true;
+	return true;
+}
+
+bool RenderGraph::Validate() const
+{
+	for (const Pass& pass : m_Passes)
+	{
+		int colorCount = 0;
+		int depthCount = 0;
+		bool isWritingImported = false;
+		bool isWritingTransient = false;
+
+		for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; i++)
+		{
+			const Access& access = m_Accesses[i];
+			if (access.resource >= m_Resources.size())
+			{
+				Log(std::string("Render graph: pass '") + pass.name + "' uses a resource that doesn't exist");
+				return false;
+			}
+
+			const Resource& resource = m_Resources[access.resource];
+			if (!access.isWrite)
+			{
+				if (resource.isImported)
+				{
+					Log(std::string("Render graph: pass '") + pass.name + "' reads '" + resource.name + "', an imported framebuffer can't be sampled");
+					return false;
+				}
+
+				for (uint32_t j = pass.firstAccess; j < pass.firstAccess + pass.accessCount; j++)
+				{
+					if (m_Accesses[j].isWrite && m_Accesses[j].resource == access.resource)
+					{
+						Log(std::string("Render graph: pass '") + pass.name + "' reads and writes '" + resource.name + "' (feedback loop)");
+						return false;
+					}
+				}
+
+				const bool isWritten = std::any_of(m_Accesses.begin(), m_Accesses.end(), [&access](const Access& other) { return other.isWrite && other.resource == access.resource; });
+				if (!isWritten)
+				{
+					Log(std::string("Render graph: pass '") + pass.name + "' reads '" + resource.name + "', which nothing writes");
+					return false;
+				}
+				continue;
+			}
+
+			if (resource.isImported)
+				isWritingImported = true;
+			else
+				isWritingTransient = true;
+
+			if (!resource.isImported && resource.description.IsDepth())
+				depthCount++;
+			else if (!resource.isImported)
+				colorCount++;
+		}
+
+		if (isWritingImported && isWritingTransient)
+		{
+			Log(std::string("Render graph: pass '") + pass.name + "' writes both an imported framebuffer and transient targets");
+			return false;
+		}
+		if (colorCount > MaxColorAttachments || depthCount > 1)
+		{
+			Log(std::string("Render graph: pass '") + pass.name + "' writes too many targets for one framebuffer");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void RenderGraph::Cull()
+{
+	/* Reference counts: a pass is referenced by each of its writes, a resource by each of its reads */
+	for (Resource& resource : m_Resources)
+	{
+		resource.readerCount = resource.isImported ? 1 : 0; // Whoever imported it reads it after the graph ran
+		resource.writerCount = 0;
+	}
+	for (const Access& access : m_Accesses)
+	{
+		if (access.isWrite)
+		{
+			m_Passes[access.pass].referenceCount++;
+			m_Resources[access.resource].writerCount++;
+		}
+		else
+		{
+			m_Resources[access.resource].readerCount++;
+		}
+	}
+
+	auto cullPass = [this](Pass& pass)
+	{
+		pass.isCulled = true;
+		m_Statistics.culledPassCount++;
+
+		/* What it read loses a reader, and may in turn have nobody left to read it */
+		for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; i++)
+		{
+			const Access& access = m_Accesses[i];
+			if (!access.isWrite && --m_Resources[access.resource].readerCount == 0)
+				m_Scratch.push_back(access.resource);
+		}
+	};
+
+	m_Scratch.clear();
+	for (RenderResource resource = 0; resource < m_Resources.size(); resource++)
+	{
+		if (m_Resources[resource].readerCount == 0)
+			m_Scratch.push_back(resource);
+	}
+	for (Pass& pass : m_Passes)
+	{
+		if (pass.referenceCount == 0 && !pass.hasSideEffect)
+			cullPass(pass);
+	}
+
+	/* Unread resources take their writers with them, once those have nothing else read */
+	while (!m_Scratch.empty())
+	{
+		const RenderResource resource = m_Scratch.back();
+		m_Scratch.pop_back();
+
+		for (const Access& access : m_Accesses)
+		{
+			if (!access.isWrite || access.resource != resource)
+				continue;
+
+			Pass& writer = m_Passes[access.pass];
+			if (!writer.isCulled && --writer.referenceCount == 0 && !writer.hasSideEffect)
+				cullPass(writer);
+		}
+	}
+}
+
+bool RenderGraph::IsReady(uint32_t pass) const
+{
+	const Pass& candidate = m_Passes[pass];
+	for (uint32_t i = candidate.firstAccess; i < candidate.firstAccess + candidate.accessCount; i++)
+	{
+		const Access& access = m_Accesses[i];
+		for (const Access& other : m_Accesses)
+		{
+			if (other.pass == pass || !other.isWrite || other.resource != access.resource)
+				continue;
+
+			const Pass& writer = m_Passes[other.pass];
+			if (writer.isCulled || writer.isOrdered)
+				continue;
+
+			/* Reads wait for every writer, writes to the same target keep the order they were added in */
+			if (!access.isWrite || other.pass < pass)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool RenderGraph::Sort()
+{
+	const uint32_t passCount = m_Statistics.passCount - m_Statistics.culledPassCount;
+
+	/* Kahn's algorithm, picking the first pass added among the ready ones so independent passes keep their order */
+	while (m_Order.size() < passCount)
+	{
+		uint32_t next = (uint32_t)m_Passes.size();
+		for (uint32_t pass = 0; pass < m_Passes.size(); pass++)
+		{
+			if (!m_Passes[pass].isCulled && !m_Passes[pass].isOrdered && IsReady(pass))
+			{
+				next = pass;
+				break;
+			}
+		}
+
+		if (next == m_Passes.size())
+		{
+			Log("Render graph: passes depend on each other in a cycle, nothing gets rendered");
+			return false;
+		}
+
+		m_Passes[next].isOrdered = true;
+		m_Order.push_back(next);
+	}
+
+	return true;
+}
+
+void RenderGraph::AssignTextures()
+{
+	/* Lifetimes, as positions in the execution order */
+	for (int position = 0; position < (int)m_Order.size(); position++)
+	{
+		const Pass& pass = m_Passes[m_Order[position]];
+		for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; i++)
+		{
+			Resource& resource = m_Resources[m_Accesses[i].resource];
+			if (resource.firstUse < 0)
+				resource.firstUse = position;
+			resource.lastUse = position;
+		}
+	}
+
+	m_Scratch.clear();
+	for (RenderResource resource = 0; resource < m_Resources.size(); resource++)
+	{
+		if (!m_Resources[resource].isImported && m_Resources[resource].firstUse >= 0)
+			m_Scratch.push_back(resource);
+	}
+	std::sort(m_Scratch.begin(), m_Scratch.end(), [this](RenderResource a, RenderResource b) { return m_Resources[a].firstUse < m_Resources[b].firstUse; });
+
+	/* Greedy: each target takes the first texture of its description that's free by its first use */
+	for (const std::unique_ptr<Texture>& texture : m_Textures)
+		texture->lastUse = -1;
+
+	for (RenderResource index : m_Scratch)
+	{
+		Resource& resource = m_Resources[index];
+		Texture* assigned = nullptr;
+		for (const std::unique_ptr<Texture>& texture : m_Textures)
+		{
+			if (texture->description == resource.description && (texture->lastUse < 0 || (m_IsAliasing && texture->lastUse < resource.firstUse)))
+			{
+				assigned = texture.get();
+				break;
+			}
+		}
+
+		if (!assigned)
+		{
+			std::unique_ptr<Texture> texture = std::make_unique<Texture>();
+			texture->description = resource.description;
+
+			GLenum internalFormat = GL_RGBA8;
+			GLenum format = GL_RGBA;
+			GLenum type = GL_UNSIGNED_BYTE;
+			if (resource.description.format == RenderTargetFormat::RGBA16F)
+			{
+				internalFormat = GL_RGBA16F;
+				type = GL_HALF_FLOAT;
+			}
+			else if (resource.description.IsDepth())
+			{
+				internalFormat = GL_DEPTH24_STENCIL8;
+				format = GL_DEPTH_STENCIL;
+				type = GL_UNSIGNED_INT_24_8;
+			}
+
+			const GLint filter = resource.description.IsDepth() ? GL_NEAREST : GL_LINEAR;
+			GL_CALL(glGenTextures(1, &texture->rendererID));
+			GL_CALL(glBindTexture(GL_TEXTURE_2D, texture->rendererID));
+			GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, resource.description.width, resource.description.height, 0, format, type, nullptr));
+			GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter));
+			GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter));
+			GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+			RenderStats::Get().ForgetTextureBindings();
+			texture->memory.Track(GpuMemoryCategory::RENDER_TARGET, resource.description.GetSize());
+
+			assigned = texture.get();
+			m_Textures.push_back(std::move(texture));
+		}
+
+		assigned->lastUse = resource.lastUse;
+		resource.texture = assigned;
+		m_Statistics.transientCount++;
+		m_Statistics.unaliasedBytes += resource.description.GetSize();
+	}
+
+	/* Whatever this frame didn't need goes (a resize, aliasing turned back on, passes removed...) */
+	for (std::size_t i = m_Textures.size(); i-- > 0;)
+	{
+		if (m_Textures[i]->lastUse < 0)
+			ReleaseTexture(i);
+		else
+			m_Statistics.aliasedBytes += m_Textures[i]->description.GetSize();
+	}
+	m_Statistics.textureCount = (uint32_t)m_Textures.size();
+
+	for (int position = 0; position < (int)m_Order.size(); position++)
+	{
+		std::size_t liveBytes = 0;
+		for (RenderResource index : m_Scratch)
+		{
+			if (m_Resources[index].firstUse <= position && position <= m_Resources[index].lastUse)
+				liveBytes += m_Resources[index].description.GetSize();
+		}
+		m_Statistics.overlapBytes = std::max(m_Statistics.overlapBytes, liveBytes);
+	}
+}
+
+void RenderGraph::Execute()
+{
+	if (!m_IsCompiled)
+		return;
+
+	const RenderPassContext context(*this);
+	for (uint32_t index : m_Order)
+	{
+		const Pass& pass = m_Passes[index];
+		const uint32_t endAccess = pass.firstAccess + pass.accessCount;
+
+		/* Image stores aren't coherent with what reads them next, unlike attachments */
+		bool isBarrierNeeded = false;
+		for (uint32_t i = pass.firstAccess; i < endAccess; i++)
+			isBarrierNeeded |= !m_Accesses[i].isWrite && m_Resources[m_Accesses[i].resource].isBarrierPending;
+		if (isBarrierNeeded)
+		{
+			GL_CALL(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT));
+			for (Resource& resource : m_Resources)
+				resource.isBarrierPending = false;
+		}
+
+		if (!pass.isCompute)
+		{
+			GLuint attachments[MaxColorAttachments + 1] = {};
+			int colorCount = 0;
+			const Resource* target = nullptr;
+			for (uint32_t i = pass.firstAccess; i < endAccess; i++)
+			{
+				if (!m_Accesses[i].isWrite)
+					continue;
+
+				const Resource& resource = m_Resources[m_Accesses[i].resource];
+				if (!target || (target->description.IsDepth() && !resource.description.IsDepth()))
+					target = &resource;
+				if (resource.isImported)
+					continue;
+
+				if (resource.description.IsDepth())
+					attachments[MaxColorAttachments] = resource.texture->rendererID;
+				else
+					attachments[colorCount++] = resource.texture->rendererID;
+			}
+
+			if (target)
+			{
+				const GLuint framebuffer = target->isImported ? target->importedFramebuffer : GetFramebuffer(attachments, colorCount);
+				GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+				GL_CALL(glViewport(0, 0, target->description.width, target->description.height));
+			}
+		}
+
+		GLenum unit = GL_TEXTURE0;
+		for (uint32_t i = pass.firstAccess; i < endAccess; i++)
+		{
+			if (m_Accesses[i].isWrite)
+				continue;
+
+			const GLuint texture = m_Resources[m_Accesses[i].resource].texture->rendererID;
+			GL_CALL(glActiveTexture(unit));
+			GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
+			RenderStats::Get().OnTextureBound(unit++ - GL_TEXTURE0, texture);
+		}
+		if (unit != GL_TEXTURE0)
+		{
+			GL_CALL(glActiveTexture(GL_TEXTURE0));
+		}
+
+		pass.execute(context);
+
+		if (pass.isCompute)
+		{
+			for (uint32_t i = pass.firstAccess; i < endAccess; i++)
+			{
+				if (m_Accesses[i].isWrite)
+					m_Resources[m_Accesses[i].resource].isBarrierPending = true;
+			}
+		}
+	}
+}
+
+GLuint RenderGraph::GetFramebuffer(const GLuint (&attachments)[MaxColorAttachments + 1], int colorCount)
+{
+	for (const CachedFramebuffer& framebuffer : m_Framebuffers)
+	{
+		if (std::equal(attachments, attachments + MaxColorAttachments + 1, framebuffer.attachments))
+			return framebuffer.rendererID;
+	}
+
+	CachedFramebuffer framebuffer;
+	std::copy(attachments, attachments + MaxColorAttachments + 1, framebuffer.attachments);
+	GL_CALL(glGenFramebuffers(1, &framebuffer.rendererID));
+	GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.rendererID));
+
+	GLenum drawBuffers[MaxColorAttachments];
+	for (int i = 0; i < colorCount; i++)
+	{
+		drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+		GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, attachments[i], 0));
+	}
+	if (attachments[MaxColorAttachments])
+	{
+		GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, attachments[MaxColorAttachments], 0));
+	}
+
+	/* One color attachment is what the default draw buffer already is */
+	if (colorCount != 1)
+	{
+		const GLenum none = GL_NONE;
+		GL_CALL(glDrawBuffers(colorCount > 0 ? colorCount : 1, colorCount > 0 ? drawBuffers : &none));
+	}
+
+	GL_CALL(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		Log("Render graph framebuffer is incomplete (status " + std::to_string(status) + ")");
+
+	m_Framebuffers.push_back(framebuffer);
+	return framebuffer.rendererID;
+}
+
+void RenderGraph::ReleaseTexture(std::size_t index)
+{
+	const GLuint rendererID = m_Textures[index]->rendererID;
+
+	/* The framebuffers it's attached to can't be used anymore either */
+	for (std::size_t i = m_Framebuffers.size(); i-- > 0;)
+	{
+		const GLuint* attachments = m_Framebuffers[i].attachments;
+		if (std::find(attachments, attachments + MaxColorAttachments + 1, rendererID) != attachments + MaxColorAttachments + 1)
+		{
+			GL_CALL(glDeleteFramebuffers(1, &m_Framebuffers[i].rendererID));
+			m_Framebuffers.erase(m_Framebuffers.begin() + i);
+		}
+	}
+
+	GL_CALL(glDeleteTextures(1, &rendererID));
+	m_Textures.erase(m_Textures.begin() + index);
+}
+
+void RenderGraph::OnImGuiRender() const
+{
+	constexpr float MB = 1024.0f * 1024.0f;
+	const Statistics& statistics = m_Statistics;
+	ImGui::Text("%u passes, %u culled", statistics.passCount, statistics.culledPassCount);
+	ImGui::Text("%u transient targets in %u textures", statistics.transientCount, statistics.textureCount);
+	ImGui::Text("Transient memory: %.2f MB, %.2f MB without aliasing", statistics.aliasedBytes / MB, statistics.unaliasedBytes / MB);
+	ImGui::Text("Most live at once: %.2f MB", statistics.overlapBytes / MB);
+
+	if (ImGui::BeginTable("##Passes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Pass");
+		ImGui::TableSetupColumn("Reads");
+		ImGui::TableSetupColumn("Writes");
+		ImGui::TableHeadersRow();
+
+		/* The ones that run in order, then the culled ones */
+		auto passRow = [this](const Pass& pass)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			if (pass.isCulled)
+				ImGui::TextDisabled("%s (culled)", pass.name);
+			else
+				ImGui::TextUnformatted(pass.name);
+
+			for (int column = 0; column < 2; column++)
+			{
+				const bool isWrite = column == 1;
+				ImGui::TableNextColumn();
+				for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; i++)
+				{
+					if (m_Accesses[i].isWrite == isWrite && m_Accesses[i].resource < m_Resources.size())
+						ImGui::TextUnformatted(m_Resources[m_Accesses[i].resource].name);
+				}
+			}
+		};
+		for (uint32_t pass : m_Order)
+			passRow(m_Passes[pass]);
+		for (const Pass& pass : m_Passes)
+		{
+			if (pass.isCulled)
+				passRow(pass);
+		}
+		ImGui::EndTable();
+	}
+
+	if (ImGui::BeginTable("##Targets", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Target");
+		ImGui::TableSetupColumn("Size");
+		ImGui::TableSetupColumn("Lifetime");
+		ImGui::TableSetupColumn("Texture");
+		ImGui::TableHeadersRow();
+
+		for (const Resource& resource : m_Resources)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			if (resource.firstUse < 0)
+				ImGui::TextDisabled("%s (unused)", resource.name);
+			else
+				ImGui::TextUnformatted(resource.name);
+			ImGui::TableNextColumn(); ImGui::Text("%dx%d %s", resource.description.width, resource.description.height, resource.isImported ? "imported" : GetFormatName(resource.description.format));
+			ImGui::TableNextColumn();
+			if (resource.firstUse >= 0)
+				ImGui::Text("%d - %d", resource.firstUse, resource.lastUse);
+			ImGui::TableNextColumn();
+			if (resource.texture)
+			{
+				const auto it = std::find_if(m_Textures.begin(), m_Textures.end(), [&resource](const std::unique_ptr<Texture>& texture) { return texture.get() == resource.texture; });
+				ImGui::Text("#%d", (int)(it - m_Textures.begin()));
+			}
+		}
+		ImGui::EndTable();
+	}
+}
+
+const char* RenderGraph::GetFormatName(RenderTargetFormat format)
+{
+	switch (format)
+	{
+		case RenderTargetFormat::RGBA8: return "RGBA8";
+		case RenderTargetFormat::RGBA16F: return "RGBA16F";
+		case RenderTargetFormat::DEPTH24_STENCIL8: return "D24S8";
+	}
+	return "?";
+}
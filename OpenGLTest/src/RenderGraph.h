@@ -0,0 +1,213 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuMemoryTracker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+enum class RenderTargetFormat
+{
+	RGBA8 = 0,
+	RGBA16F,
+	DEPTH24_STENCIL8
+};
+
+struct RenderTargetDescription
+{
+	int width = 0;
+	int height = 0;
+	RenderTargetFormat format = RenderTargetFormat::RGBA8;
+
+	inline bool operator==(const RenderTargetDescription& other) const { return width == other.width && height == other.height && format == other.format; }
+	inline bool IsDepth() const { return format == RenderTargetFormat::DEPTH24_STENCIL8; }
+	std::size_t GetSize() const;
+};
+
+// Index of a resource in the graph being built, only valid until the next `Reset`
+using RenderResource = uint32_t;
+constexpr RenderResource InvalidRenderResource = 0xFFFFFFFF;
+
+class RenderGraph;
+
+/* What a pass declares while it's being added to the graph */
+class RenderPassBuilder
+{
+private:
+	RenderGraph& m_Graph;
+	uint32_t m_Pass;
+
+public:
+	RenderPassBuilder(RenderGraph& graph, uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+
+	// A transient target, written by this pass. Its memory may be shared with other transient targets, so its content
+	// is undefined until the pass writes it (clear it first)
+	RenderResource Create(const char* name, const RenderTargetDescription& description);
+	// Sampled by the pass: bound to texture units 0, 1, ... in the order of the calls
+	void Read(RenderResource resource);
+	// Rendered to: color targets go to the color attachments in the order of the calls, a depth target to the depth/stencil one
+	void Write(RenderResource resource);
+	// The pass writes through image stores (`RenderPassContext::BindImage`) rather than attachments, so the passes
+	// reading what it writes get a memory barrier first
+	void SetCompute();
+	// Never culled, even when nothing reads what it writes
+	void SetSideEffect();
+};
+
+/* What a pass gets when it runs: its framebuffer, viewport and read textures are already bound */
+class RenderPassContext
+{
+private:
+	const RenderGraph& m_Graph;
+
+public:
+	RenderPassContext(const RenderGraph& graph) : m_Graph(graph) {}
+
+	unsigned int GetTexture(RenderResource resource) const;
+	const RenderTargetDescription& GetDescription(RenderResource resource) const;
+	// For compute passes: binds the resource's texture to image unit `unit`
+	void BindImage(RenderResource resource, unsigned int unit, GLenum access) const;
+};
+
+/*
+ * Frame graph: every frame, passes declare which targets they read and write, then `Compile` culls the passes whose
+ * output nobody reads, orders the rest so a target is read once all its writers ran, and gives each transient target a
+ * texture. Transient targets whose lifetimes (first to last use in that order) don't overlap share the same texture
+ * when they have the same description. `Execute` then binds each pass's framebuffer, viewport and textures, and issues
+ * a memory barrier after compute writes (rendering to a texture then sampling it needs none in GL).
+ * Textures and framebuffers are kept from one frame to the next, so a graph that doesn't change allocates nothing
+ */
+class RenderGraph
+{
+public:
+	using ExecuteFunction = std::function<void(const RenderPassContext&)>;
+
+	static constexpr int MaxColorAttachments = 4;
+
+	struct Statistics
+	{
+		uint32_t passCount = 0;
+		uint32_t culledPassCount = 0;
+		uint32_t transientCount = 0; // Of the passes that run
+		uint32_t textureCount = 0; // What they take once aliased
+		std::size_t unaliasedBytes = 0; // Every transient target allocated on its own
+		std::size_t aliasedBytes = 0; // What's actually allocated
+		std::size_t overlapBytes = 0; // Most transient memory live at once, the lower bound for aliasing
+	};
+
+private:
+	friend class RenderPassBuilder;
+	friend class RenderPassContext;
+
+	struct Pass
+	{
+		const char* name;
+		ExecuteFunction execute;
+		uint32_t firstAccess;
+		uint32_t accessCount;
+		uint32_t referenceCount; // Writes that someone reads, culled at 0
+		bool isCompute;
+		bool hasSideEffect;
+		bool isCulled;
+		bool isOrdered; // While sorting
+	};
+
+	struct Texture
+	{
+		RenderTargetDescription description;
+		GLuint rendererID;
+		GpuAllocation memory;
+		int lastUse; // While assigning, -1 when free for the frame
+	};
+
+	struct Resource
+	{
+		const char* name;
+		RenderTargetDescription description;
+		GLuint importedFramebuffer; // When imported (the default framebuffer is 0)
+		bool isImported;
+		bool isBarrierPending; // Written by a compute pass since the last barrier
+		uint32_t readerCount; // Of the passes that run
+		uint32_t writerCount;
+		int firstUse; // Positions in `m_Order`, -1 when unused
+		int lastUse;
+		Texture* texture; // Transient ones only
+	};
+
+	struct Access
+	{
+		uint32_t pass;
+		RenderResource resource;
+		bool isWrite;
+	};
+
+	struct CachedFramebuffer
+	{
+		GLuint attachments[MaxColorAttachments + 1]; // Colors then depth, 0 when unused
+		GLuint rendererID;
+	};
+
+	std::vector<Pass> m_Passes;
+	std::vector<Resource> m_Resources;
+	std::vector<Access> m_Accesses;
+	std::vector<uint32_t> m_Order; // Passes to run, in order
+	std::vector<uint32_t> m_Scratch; // Pass or resource indices, for whichever step needs them
+
+	/* Kept across frames */
+	std::vector<std::unique_ptr<Texture>> m_Textures;
+	std::vector<CachedFramebuffer> m_Framebuffers;
+
+	bool m_IsAliasing;
+	bool m_IsCompiled;
+	Statistics m_Statistics;
+
+public:
+	RenderGraph();
+	~RenderGraph();
+
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	// Forgets the passes and resources of the last frame (its textures are kept for the next one)
+	void Reset();
+
+	// An existing framebuffer the graph renders into but doesn't own (writing to it makes a pass an output)
+	RenderResource ImportFramebuffer(const char* name, GLuint framebuffer, int width, int height);
+	// `setup(RenderPassBuilder&)` runs right away to declare the pass's resources, `execute` runs from `Execute` if the pass isn't culled
+	template<typename Setup>
+	void AddPass(const char* name, Setup&& setup, ExecuteFunction execute)
+	{
+		const uint32_t pass = BeginPass(name, std::move(execute));
+		RenderPassBuilder builder(*this, pass);
+		setup(builder);
+		m_Passes[pass].accessCount = (uint32_t)m_Accesses.size() - m_Passes[pass].firstAccess;
+	}
+
+	// Culls, orders and assigns textures, false (and nothing runs) on a cycle or a feedback loop
+	bool Compile();
+	void Execute();
+
+	inline void SetAliasing(bool isAliasing) { m_IsAliasing = isAliasing; }
+	inline bool IsAliasing() const { return m_IsAliasing; }
+	inline const Statistics& GetStatistics() const { return m_Statistics; }
+
+	// Execution order, culled passes and which texture each transient target got
+	void OnImGuiRender() const;
+
+	static const char* GetFormatName(RenderTargetFormat format);
+
+private:
+	uint32_t BeginPass(const char* name, ExecuteFunction execute);
+	bool Validate() const;
+	void Cull();
+	bool Sort();
+	// Whether every pass that has to run before `pass` is already in `m_Order`
+	bool IsReady(uint32_t pass) const;
+	void AssignTextures();
+	GLuint GetFramebuffer(const GLuint (&attachments)[MaxColorAttachments + 1], int colorCount);
+	void ReleaseTexture(std::size_t index);
+};
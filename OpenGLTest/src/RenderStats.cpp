@@ -0,0 +1,272 @@
+#include "RenderStats.h"
+#include "GLHandleError.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <fstream>
+
+// CSV column of each counter
+static const char* CounterColumns[] = {
+	"draw_calls", "primitives", "vertices", "uniform_uploads", "buffer_bytes", "texture_bytes",
+	"program_switches", "vertex_array_switches", "texture_switches", "resources_created", "resources_destroyed",
+	"indirect_commands", "compute_dispatches"
+};
+static_assert(sizeof(CounterColumns) / sizeof(CounterColumns[0]) == (int)RenderCounter::COUNT, "One column per counter");
+
+RenderStats::RenderStats()
+	: m_BoundProgram(0), m_BoundVertexArray(0), m_BoundTextures(), m_LastFrame(), m_History(), m_Spikes(), m_HistoryIndex(0),
+	m_HistoryCount(0), m_AverageMilliseconds(0.0f), m_FrameStart(std::chrono::steady_clock::now()), m_CurrentSummary(0)
+{
+	for (std::atomic<uint64_t>& count : m_Counts)
+		count.store(0, std::memory_order_relaxed);
+
+	m_Frames.reserve(MaxRecordedFrames);
+	m_Summaries.push_back({ "Application" });
+	ForgetBindings();
+}
+
+RenderStats& RenderStats::Get()
+{
+	static RenderStats instance;
+	return instance;
+}
+
+void RenderStats::AddDraw(unsigned int mode, uint64_t vertexCount, uint64_t instanceCount)
+{
+	uint64_t primitiveCount;
+	switch (mode)
+	{
+		case GL_POINTS: primitiveCount = vertexCount; break;
+		case GL_LINES: primitiveCount = vertexCount / 2; break;
+		case GL_LINE_STRIP: primitiveCount = vertexCount > 1 ? vertexCount - 1 : 0; break;
+		case GL_LINE_LOOP: primitiveCount = vertexCount > 1 ? vertexCount : 0; break;
+		case GL_TRIANGLE_STRIP: case GL_TRIANGLE_FAN: primitiveCount = vertexCount > 2 ? vertexCount - 2 : 0; break;
+		default: primitiveCount = vertexCount / 3; break;
+	}
+
+	Add(RenderCounter::DRAW_CALLS);
+	Add(RenderCounter::VERTICES, vertexCount * instanceCount);
+	Add(RenderCounter::PRIMITIVES, primitiveCount * instanceCount);
+}
+
+void RenderStats::AddIndirectDraw(uint64_t maxCommandCount)
+{
+	Add(RenderCounter::DRAW_CALLS);
+	Add(RenderCounter::INDIRECT_COMMANDS, maxCommandCount);
+}
+
+void RenderStats::OnProgramBound(unsigned int program)
+{
+	if (program == m_BoundProgram)
+		return;
+
+	m_BoundProgram = program;
+	Add(RenderCounter::PROGRAM_SWITCHES);
+}
+
+void RenderStats::OnVertexArrayBound(unsigned int vertexArray)
+{
+	if (vertexArray == m_BoundVertexArray)
+		return;
+
+	m_BoundVertexArray = vertexArray;
+	Add(RenderCounter::VERTEX_ARRAY_SWITCHES);
+}
+
+void RenderStats::OnTextureBound(unsigned int slot, unsigned int texture)
+{
+	if (slot < TextureSlotCount)
+	{
+		if (texture == m_BoundTextures[slot])
+			return;
+		m_BoundTextures[slot] = texture;
+	}
+
+	Add(RenderCounter::TEXTURE_SWITCHES);
+}
+
+void RenderStats::ForgetTextureBindings()
+{
+	std::fill(m_BoundTextures, m_BoundTextures + TextureSlotCount, UINT32_MAX);
+}
+
+void RenderStats::ForgetBindings()
+{
+	/* No GL object is ever named UINT_MAX, so the first bind of the frame always counts */
+	m_BoundProgram = UINT32_MAX;
+	m_BoundVertexArray = UINT32_MAX;
+	ForgetTextureBindings();
+}
+
+void RenderStats::SetScope(const std::string& name)
+{
+	auto found = std::find_if(m_Summaries.begin(), m_Summaries.end(), [&name](const Summary& summary) { return summary.name == name; });
+	if (found == m_Summaries.end())
+	{
+		m_Summaries.push_back({ name });
+		found = m_Summaries.end() - 1;
+	}
+	m_CurrentSummary = found - m_Summaries.begin();
+	m_Frames.clear();
+}
+
+void RenderStats::EndFrame()
+{
+	const auto now = std::chrono::steady_clock::now();
+	const float milliseconds = std::chrono::duration<float, std::milli>(now - m_FrameStart).count();
+	m_FrameStart = now;
+
+	Frame frame;
+	for (int i = 0; i < CounterCount; i++)
+		frame.counts[i] = (uint32_t)std::min<uint64_t>(m_Counts[i].exchange(0, std::memory_order_relaxed), UINT32_MAX);
+	frame.milliseconds = milliseconds;
+
+	/* Against the average of the frames before, which the spike then only nudges */
+	frame.isSpike = m_HistoryCount >= SpikeWarmUpFrames && milliseconds > m_AverageMilliseconds * SpikeFactor;
+	m_AverageMilliseconds = m_HistoryCount == 0 ? milliseconds : m_AverageMilliseconds + (milliseconds - m_AverageMilliseconds) * 0.05f;
+
+	m_LastFrame = frame;
+	for (int i = 0; i < CounterCount; i++)
+		m_History[i][m_HistoryIndex] = (float)frame.counts[i];
+	m_History[CounterCount][m_HistoryIndex] = milliseconds;
+	m_Spikes[m_HistoryIndex] = frame.isSpike;
+	m_HistoryIndex = (m_HistoryIndex + 1) % HistorySize;
+	m_HistoryCount = std::min(m_HistoryCount + 1, HistorySize);
+
+	if (m_Frames.size() < MaxRecordedFrames)
+		m_Frames.push_back(frame);
+
+	Summary& summary = m_Summaries[m_CurrentSummary];
+	summary.frameCount++;
+	summary.spikeCount += frame.isSpike ? 1 : 0;
+	for (int i = 0; i < CounterCount; i++)
+		summary.totals[i] += frame.counts[i];
+	summary.milliseconds += milliseconds;
+
+	ForgetBindings();
+}
+
+bool RenderStats::WriteCsv(const std::string& filepath) const
+{
+	std::ofstream stream(filepath);
+	if (!stream)
+		return false;
+
+	stream << "test,frame,milliseconds,spike";
+	for (const char* column : CounterColumns)
+		stream << ',' << column;
+	stream << '\n';
+
+	const std::string& name = m_Summaries[m_CurrentSummary].name;
+	for (std::size_t i = 0; i < m_Frames.size(); i++)
+	{
+		const Frame& frame = m_Frames[i];
+		stream << '"' << name << "\"," << i << ',' << frame.milliseconds << ',' << (frame.isSpike ? 1 : 0);
+		for (uint32_t count : frame.counts)
+			stream << ',' << count;
+		stream << '\n';
+	}
+	return (bool)stream;
+}
+
+bool RenderStats::WriteSummaryCsv(const std::string& filepath) const
+{
+	std::ofstream stream(filepath);
+	if (!stream)
+		return false;
+
+	stream << "test,frames,spikes,milliseconds";
+	for (const char* column : CounterColumns)
+		stream << ',' << column;
+	stream << '\n';
+
+	for (const Summary& summary : m_Summaries)
+	{
+		if (summary.frameCount == 0)
+			continue;
+
+		const double frameCount = (double)summary.frameCount;
+		stream << '"' << summary.name << "\"," << summary.frameCount << ',' << summary.spikeCount << ',' << summary.milliseconds / frameCount;
+		for (double total : summary.totals)
+			stream << ',' << total / frameCount;
+		stream << '\n';
+	}
+	return (bool)stream;
+}
+
+void RenderStats::PlotWithSpikes(const char* id, const float* values, const char* overlay) const
+{
+	const int first = m_HistoryCount == HistorySize ? m_HistoryIndex : 0;
+	ImGui::PlotLines(id, values, m_HistoryCount, first, overlay, 0.0f, FLT_MAX, ImVec2(0, 40));
+	if (m_HistoryCount < 2)
+		return;
+
+	/* PlotLines spreads the samples over the frame minus its padding */
+	const ImVec2 padding = ImGui::GetStyle().FramePadding;
+	const ImVec2 min = ImVec2(ImGui::GetItemRectMin().x + padding.x, ImGui::GetItemRectMin().y + padding.y);
+	const ImVec2 max = ImVec2(ImGui::GetItemRectMax().x - padding.x, ImGui::GetItemRectMax().y - padding.y);
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	for (int i = 0; i < m_HistoryCount; i++)
+	{
+		if (!m_Spikes[(first + i) % HistorySize])
+			continue;
+
+		const float x = min.x + (max.x - min.x) * i / (m_HistoryCount - 1);
+		drawList->AddLine(ImVec2(x, min.y), ImVec2(x, max.y), IM_COL32(255, 64, 64, 160));
+	}
+}
+
+void RenderStats::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("Render statistics"))
+		return;
+
+	ImGui::InputText("##CsvPath", m_CsvPath, sizeof(m_CsvPath));
+	ImGui::SameLine();
+	if (ImGui::Button("Dump test CSV") && !WriteCsv(m_CsvPath))
+		Log(std::string("Failed to write ") + m_CsvPath);
+	ImGui::InputText("##SummaryCsvPath", m_SummaryCsvPath, sizeof(m_SummaryCsvPath));
+	ImGui::SameLine();
+	if (ImGui::Button("Dump summary CSV") && !WriteSummaryCsv(m_SummaryCsvPath))
+		Log(std::string("Failed to write ") + m_SummaryCsvPath);
+
+	const Summary& summary = m_Summaries[m_CurrentSummary];
+	ImGui::Text("%s: %llu frames recorded, %llu spikes (over %.0fx the average frame time, in red)", summary.name.c_str(),
+		(unsigned long long)m_Frames.size(), (unsigned long long)summary.spikeCount, SpikeFactor);
+
+	char overlay[64];
+	std::snprintf(overlay, sizeof(overlay), "Frame %.2f ms", m_LastFrame.milliseconds);
+	PlotWithSpikes("##Milliseconds", m_History[CounterCount], overlay);
+
+	for (int i = 0; i < CounterCount; i++)
+	{
+		std::snprintf(overlay, sizeof(overlay), "%s %u", GetCounterName((RenderCounter)i), m_LastFrame.counts[i]);
+		ImGui::PushID(i);
+		PlotWithSpikes("##Counter", m_History[i], overlay);
+		ImGui::PopID();
+	}
+}
+
+const char* RenderStats::GetCounterName(RenderCounter counter)
+{
+	switch (counter)
+	{
+		case RenderCounter::DRAW_CALLS: return "Draw calls";
+		case RenderCounter::PRIMITIVES: return "Primitives";
+		case RenderCounter::VERTICES: return "Vertices";
+		case RenderCounter::UNIFORM_UPLOADS: return "Uniform uploads";
+		case RenderCounter::BUFFER_BYTES: return "Buffer bytes";
+		case RenderCounter::TEXTURE_BYTES: return "Texture bytes";
+		case RenderCounter::PROGRAM_SWITCHES: return "Program switches";
+		case RenderCounter::VERTEX_ARRAY_SWITCHES: return "Vertex array switches";
+		case RenderCounter::TEXTURE_SWITCHES: return "Texture switches";
+		case RenderCounter::RESOURCES_CREATED: return "Resources created";
+		case RenderCounter::RESOURCES_DESTROYED: return "Resources destroyed";
+		case RenderCounter::INDIRECT_COMMANDS: return "Indirect commands";
+		case RenderCounter::COMPUTE_DISPATCHES: return "Compute dispatches";
+		default: return "?";
+	}
+}
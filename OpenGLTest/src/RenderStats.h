@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class RenderCounter
+{
+	DRAW_CALLS = 0, // A multi-draw counts once
+	PRIMITIVES, // Of the draws the CPU knows the size of (not indirect ones)
+	VERTICES, // Indices for indexed draws, times the instance count
+	UNIFORM_UPLOADS,
+	BUFFER_BYTES, // Vertex, index and storage buffer data uploaded
+	TEXTURE_BYTES,
+	PROGRAM_SWITCHES,
+	VERTEX_ARRAY_SWITCHES,
+	TEXTURE_SWITCHES,
+	RESOURCES_CREATED, // Shaders, buffers (storage buffers included) and textures
+	RESOURCES_DESTROYED,
+	INDIRECT_COMMANDS, // Upper bound: the commands a multi-draw may read, including the ones the GPU culled
+	COMPUTE_DISPATCHES,
+	COUNT
+};
+
+/* What each frame submits, counted where it gets submitted (`Renderer`, `Shader`, the buffers, `VertexArray`, `Texture`),
+with a rolling history, frame time spikes and per-test totals that can be written as CSV to compare scenes and builds */
+class RenderStats
+{
+private:
+	static constexpr int CounterCount = (int)RenderCounter::COUNT;
+	static constexpr int HistorySize = 600; // Frames
+	static constexpr int TextureSlotCount = 32;
+	static constexpr std::size_t MaxRecordedFrames = 36000; // Per test, 10 minutes at 60 FPS
+	static constexpr float SpikeFactor = 2.0f; // Times the average frame time
+	static constexpr int SpikeWarmUpFrames = 30; // Before the average means anything
+
+	struct Frame
+	{
+		uint32_t counts[CounterCount];
+		float milliseconds;
+		bool isSpike;
+	};
+
+	struct Summary
+	{
+		std::string name;
+		uint64_t frameCount = 0;
+		uint64_t spikeCount = 0;
+		double totals[CounterCount] = {};
+		double milliseconds = 0.0;
+	};
+
+	std::atomic<uint64_t> m_Counts[CounterCount]; // This frame (resources can be created from any thread)
+
+	/* Last bindings, to tell switches from re-binds. Main thread only, and forgotten at the end of each frame since ImGui
+	binds its own without telling */
+	unsigned int m_BoundProgram;
+	unsigned int m_BoundVertexArray;
+	unsigned int m_BoundTextures[TextureSlotCount];
+
+	Frame m_LastFrame;
+	float m_History[CounterCount + 1][HistorySize]; // Each counter, then the frame time
+	bool m_Spikes[HistorySize];
+	int m_HistoryIndex;
+	int m_HistoryCount;
+	float m_AverageMilliseconds; // Moving average
+	std::chrono::steady_clock::time_point m_FrameStart;
+
+	std::vector<Frame> m_Frames; // Since the current test was opened (reserved up front, so frames don't allocate)
+	std::vector<Summary> m_Summaries; // One per test opened so far
+	std::size_t m_CurrentSummary;
+
+	char m_CsvPath[256] = "render_stats.csv";
+	char m_SummaryCsvPath[256] = "render_stats_summary.csv";
+
+	RenderStats();
+
+public:
+	static RenderStats& Get();
+
+	RenderStats(const RenderStats&) = delete;
+	RenderStats& operator=(const RenderStats&) = delete;
+
+	inline void Add(RenderCounter counter, uint64_t amount = 1) { m_Counts[(int)counter].fetch_add(amount, std::memory_order_relaxed); }
+	// A draw call of `vertexCount` vertices (or indices) in `mode`, `instanceCount` times
+	void AddDraw(unsigned int mode, uint64_t vertexCount, uint64_t instanceCount = 1);
+	// One indirect multi-draw of up to `maxCommandCount` commands
+	void AddIndirectDraw(uint64_t maxCommandCount);
+
+	/* Count a switch when the binding changes */
+	void OnProgramBound(unsigned int program);
+	void OnVertexArrayBound(unsigned int vertexArray);
+	void OnTextureBound(unsigned int slot, unsigned int texture);
+	// After binding a texture on whichever unit is active (to create or update it): the slot isn't known, so the next
+	// bind of every slot counts as a switch
+	void ForgetTextureBindings();
+
+	// Starts a new recording and totals for `name` (the test being opened, for instance)
+	void SetScope(const std::string& name);
+
+	// Closes the frame's counts (on the main thread, at the frame boundary)
+	void EndFrame();
+
+	// Every frame recorded since the current test was opened
+	bool WriteCsv(const std::string& filepath) const;
+	// Per-frame averages of every test opened so far, one row each
+	bool WriteSummaryCsv(const std::string& filepath) const;
+
+	// Last frame's counters, their history and the frame time spikes
+	void OnImGuiRender();
+
+	static const char* GetCounterName(RenderCounter counter);
+
+private:
+	void ForgetBindings();
+	// Same as `ImGui::PlotLines`, with a red line at each spike
+	void PlotWithSpikes(const char* id, const float* values, const char* overlay) const;
+};
@@ -1,13 +1,43 @@
 #include "Renderer.h"
 #include "GLHandleError.h"
+#include "RenderBackend.h"
+#include "RenderStats.h"
+#include "SoftwareRasterizer.h"
+
+RenderBackend ActiveRenderBackend = RenderBackend::OPENGL;
+
+void Renderer::SetClearColor(float r, float g, float b, float a) const
+{
+	if (IsSoftwareRendering())
+	{
+		SoftwareRasterizer::Get().SetClearColor(r, g, b, a);
+		return;
+	}
+
+	GL_CALL(glClearColor(r, g, b, a));
+}
 
 void Renderer::Clear() const
 {
+	if (IsSoftwareRendering())
+	{
+		SoftwareRasterizer::Get().Clear();
+		return;
+	}
+
 	GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
 }
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader, GLenum mode) const
 {
+	RenderStats::Get().AddDraw(mode, ib.GetCount());
+
+	if (IsSoftwareRendering())
+	{
+		SoftwareRasterizer::Get().Draw(va, &ib, 0, 1, shader, mode);
+		return;
+	}
+
 	/* Re-bind shader */
 	shader.Bind();
 
@@ -23,6 +53,14 @@ void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer* ib, Shader& shader, GLenum mode) const
 {
+	RenderStats::Get().AddDraw(mode, ib->GetCount());
+
+	if (IsSoftwareRendering())
+	{
+		SoftwareRasterizer::Get().Draw(va, ib, 0, 1, shader, mode);
+		return;
+	}
+
 	/* Re-bind shader */
 	shader.Bind();
 
@@ -35,3 +73,96 @@ void Renderer::Draw(const VertexArray& va, const IndexBuffer* ib, Shader& shader
 	/* Draw */
 	GL_CALL(glDrawElements(mode, ib->GetCount(), GL_UNSIGNED_INT, nullptr));
 }
+
+void Renderer::DrawInstanced(const VertexArray& va, unsigned int vertexCount, unsigned int instanceCount, Shader& shader, GLenum mode) const
+{
+	RenderStats::Get().AddDraw(mode, vertexCount, instanceCount);
+
+	if (IsSoftwareRendering())
+	{
+		SoftwareRasterizer::Get().Draw(va, nullptr, vertexCount, instanceCount, shader, mode);
+		return;
+	}
+
+	/* Re-bind shader */
+	shader.Bind();
+
+	/* Re-bind VAO */
+	va.Bind();
+
+	/* Draw */
+	GL_CALL(glDrawArraysInstanced(mode, 0, vertexCount, instanceCount));
+}
+
+void Renderer::DrawVisible(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const glm::mat4& viewProjection, const glm::mat4* modelMatrices, const std::vector<uint32_t>& visibleObjects, GLenum mode) const
+{
+	if (IsSoftwareRendering())
+	{
+		for (uint32_t object : visibleObjects)
+		{
+			shader.SetUniformMat4f("u_MVP", viewProjection * modelMatrices[object]);
+			SoftwareRasterizer::Get().Draw(va, &ib, 0, 1, shader, mode);
+			RenderStats::Get().AddDraw(mode, ib.GetCount());
+		}
+		return;
+	}
+
+	/* Everything but the MVP is shared, so it's bound once for the whole list */
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+
+	const int mvpLocation = shader.GetUniformLocation("u_MVP");
+	RenderStats& stats = RenderStats::Get();
+
+	for (uint32_t object : visibleObjects)
+	{
+		const glm::mat4 mvp = viewProjection * modelMatrices[object];
+		GL_CALL(glUniformMatrix4fv(mvpLocation, 1, GL_FALSE, &mvp[0][0]));
+		GL_CALL(glDrawElements(mode, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+		stats.Add(RenderCounter::UNIFORM_UPLOADS);
+		stats.AddDraw(mode, ib.GetCount());
+	}
+}
+
+void Renderer::Draw(const GeometryPool& pool, MeshID mesh, Shader& shader, GLenum mode) const
+{
+	if (IsSoftwareRendering())
+		return;
+
+	const MeshAllocation& allocation = pool.GetMesh(mesh);
+
+	shader.Bind();
+	pool.BindPage(allocation.page);
+
+	GL_CALL(glDrawElementsBaseVertex(mode, allocation.indexCount, GL_UNSIGNED_INT, (const void*)(allocation.firstIndex * sizeof(unsigned int)), allocation.baseVertex));
+	RenderStats::Get().AddDraw(mode, allocation.indexCount);
+}
+
+void Renderer::DrawVisible(const GeometryPool& pool, const MeshID* meshes, Shader& shader, const glm::mat4& viewProjection, const glm::mat4* modelMatrices, const std::vector<uint32_t>& visibleObjects, GLenum mode) const
+{
+	if (IsSoftwareRendering())
+		return;
+
+	shader.Bind();
+
+	const int mvpLocation = shader.GetUniformLocation("u_MVP");
+	RenderStats& stats = RenderStats::Get();
+	uint32_t boundPage = UINT32_MAX;
+
+	for (uint32_t object : visibleObjects)
+	{
+		const MeshAllocation& allocation = pool.GetMesh(meshes[object]);
+		if (allocation.page != boundPage)
+		{
+			pool.BindPage(allocation.page);
+			boundPage = allocation.page;
+		}
+
+		const glm::mat4 mvp = viewProjection * modelMatrices[object];
+		GL_CALL(glUniformMatrix4fv(mvpLocation, 1, GL_FALSE, &mvp[0][0]));
+		GL_CALL(glDrawElementsBaseVertex(mode, allocation.indexCount, GL_UNSIGNED_INT, (const void*)(allocation.firstIndex * sizeof(unsigned int)), allocation.baseVertex));
+		stats.Add(RenderCounter::UNIFORM_UPLOADS);
+		stats.AddDraw(mode, allocation.indexCount);
+	}
+}
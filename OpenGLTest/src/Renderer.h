@@ -3,11 +3,25 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "GeometryPool.h"
+
+#include <vector>
 
 class Renderer
 {
 public:
+	void SetClearColor(float r, float g, float b, float a) const;
     void Clear() const;
 	void Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader, GLenum mode = GL_TRIANGLES) const;
 	void Draw(const VertexArray& va, const IndexBuffer* ib, Shader& shader, GLenum mode = GL_TRIANGLES) const;
+	// Non-indexed, `vertexCount` vertices drawn `instanceCount` times (attributes with a divisor advance per instance)
+	void DrawInstanced(const VertexArray& va, unsigned int vertexCount, unsigned int instanceCount, Shader& shader, GLenum mode = GL_TRIANGLE_STRIP) const;
+	// Draws the mesh once per object in `visibleObjects` (e.g. what survived culling), with u_MVP = viewProjection * modelMatrices[object]
+	void DrawVisible(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const glm::mat4& viewProjection, const glm::mat4* modelMatrices, const std::vector<uint32_t>& visibleObjects, GLenum mode = GL_TRIANGLES) const;
+
+	// Geometry pools live in GL buffers, so these two draw nothing with the software backend
+	// Draws one mesh of a geometry pool
+	void Draw(const GeometryPool& pool, MeshID mesh, Shader& shader, GLenum mode = GL_TRIANGLES) const;
+	// Same as the other `DrawVisible`, with object i drawing `meshes[i]`: the page is only rebound when it changes
+	void DrawVisible(const GeometryPool& pool, const MeshID* meshes, Shader& shader, const glm::mat4& viewProjection, const glm::mat4* modelMatrices, const std::vector<uint32_t>& visibleObjects, GLenum mode = GL_TRIANGLES) const;
 };
@@ -0,0 +1,229 @@
+#include "ResourceManager.h"
+
+#include "JobSystem.h"
+#include "imgui/imgui.h"
+#include "stb_image/stb_image.h"
+
+#include <chrono>
+#include <unordered_set>
+
+ResourceManager::ResourceManager()
+	: m_Budget(256 * 1024 * 1024), m_ResidentBytes(0), m_Hits(0), m_Misses(0), m_Evictions(0)
+{
+}
+
+ResourceManager& ResourceManager::Get()
+{
+	static ResourceManager instance;
+	return instance;
+}
+
+static float MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool ResourceManager::MountAssetPack(const std::string& filepath)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	std::unique_ptr<AssetPack> pack(new AssetPack(filepath));
+	if (!pack->IsValid())
+		return false;
+
+	m_AssetPack = std::move(pack);
+	Log("Mounted asset pack " + filepath + " in " + std::to_string(MillisecondsSince(start)) + " ms");
+	return true;
+}
+
+ResourceHandle<Shader> ResourceManager::GetShader(const std::string& filepath)
+{
+	const std::string key = "shader:" + filepath;
+
+	if (std::shared_ptr<void> cached = Find(key))
+		return std::static_pointer_cast<Shader>(cached);
+
+	auto start = std::chrono::steady_clock::now();
+	ResourceHandle<Shader> shader;
+
+	const AssetPackEntry* entry = m_AssetPack ? m_AssetPack->Find(filepath) : nullptr;
+	if (entry && entry->type == AssetType::SHADER)
+	{
+		/* Both stages are already split and null-terminated in the pack, compile them in place */
+		const char* vertexSource = (const char*)m_AssetPack->GetData(*entry);
+		const char* fragmentSource = vertexSource + entry->param0 + 1;
+		shader = std::make_shared<Shader>(filepath, vertexSource, (int)entry->param0, fragmentSource, (int)entry->param1);
+	}
+	else
+	{
+		shader = std::make_shared<Shader>(filepath);
+	}
+
+	Log("Loaded " + key + (entry ? " from pack" : "") + " in " + std::to_string(MillisecondsSince(start)) + " ms");
+	Insert(key, shader, shader->GetGpuSize());
+	return shader;
+}
+
+ResourceHandle<Texture> ResourceManager::GetTexture(const std::string& filepath, const TextureParams& params)
+{
+	const std::string key = GetTextureKey(filepath, params);
+
+	if (std::shared_ptr<void> cached = Find(key))
+		return std::static_pointer_cast<Texture>(cached);
+
+	auto start = std::chrono::steady_clock::now();
+	ResourceHandle<Texture> texture;
+
+	const AssetPackEntry* entry = m_AssetPack ? m_AssetPack->Find(filepath) : nullptr;
+	if (entry && entry->type == AssetType::TEXTURE)
+		texture = std::make_shared<Texture>(filepath, m_AssetPack->GetData(*entry), (int)entry->param0, (int)entry->param1, params);
+	else
+		texture = std::make_shared<Texture>(filepath, params);
+
+	Log("Loaded " + key + (entry ? " from pack" : "") + " in " + std::to_string(MillisecondsSince(start)) + " ms");
+	Insert(key, texture, texture->GetGpuSize());
+	return texture;
+}
+
+std::vector<ResourceHandle<Texture>> ResourceManager::GetTextures(const std::vector<std::string>& filepaths, const TextureParams& params)
+{
+	struct DecodedImage
+	{
+		unsigned char* pixels = nullptr;
+		int width = 0;
+		int height = 0;
+	};
+
+	std::vector<DecodedImage> images(filepaths.size());
+	std::vector<std::size_t> pending;
+
+	std::unordered_set<std::string> pendingPaths;
+
+	for (std::size_t i = 0; i < filepaths.size(); i++)
+	{
+		/* A path listed twice is decoded once, the second one then hits the cache below */
+		const bool isPacked = m_AssetPack && m_AssetPack->Find(filepaths[i]);
+		if (!isPacked && m_Entries.find(GetTextureKey(filepaths[i], params)) == m_Entries.end() && pendingPaths.insert(filepaths[i]).second)
+			pending.push_back(i);
+	}
+
+	/* Decoding is pure CPU work, only the upload below needs the GL context */
+	auto start = std::chrono::steady_clock::now();
+	JobSystem::Get().ParallelFor(0, pending.size(), 1, [&](std::size_t first, std::size_t last)
+	{
+		stbi_set_flip_vertically_on_load_thread(1); // Flip vertically since (0; 0) is the bottom left corner for OpenGL
+
+		for (std::size_t i = first; i < last; i++)
+		{
+			DecodedImage& image = images[pending[i]];
+			int bpp;
+			image.pixels = stbi_load(filepaths[pending[i]].c_str(), &image.width, &image.height, &bpp, 4);
+		}
+	});
+
+	if (!pending.empty())
+		Log("Decoded " + std::to_string(pending.size()) + " textures in parallel in " + std::to_string(MillisecondsSince(start)) + " ms");
+
+	std::vector<ResourceHandle<Texture>> textures;
+	for (std::size_t i = 0; i < filepaths.size(); i++)
+	{
+		if (!images[i].pixels)
+		{
+			textures.push_back(GetTexture(filepaths[i], params));
+			continue;
+		}
+
+		ResourceHandle<Texture> texture = std::make_shared<Texture>(filepaths[i], images[i].pixels, images[i].width, images[i].height, params);
+		stbi_image_free(images[i].pixels);
+
+		m_Misses++;
+		Insert(GetTextureKey(filepaths[i], params), texture, texture->GetGpuSize());
+		textures.push_back(texture);
+	}
+
+	return textures;
+}
+
+std::string ResourceManager::GetTextureKey(const std::string& filepath, const TextureParams& params)
+{
+	/* The same image sampled differently is a different GL texture, so the parameters are part of the key */
+	return "texture:" + filepath + "?filter=" + std::to_string(params.filter) + "&wrap=" + std::to_string(params.wrap);
+}
+
+std::shared_ptr<void> ResourceManager::Find(const std::string& key)
+{
+	auto it = m_Entries.find(key);
+	if (it == m_Entries.end())
+	{
+		m_Misses++;
+		return nullptr;
+	}
+
+	/* Move it to the front of the LRU list */
+	m_Lru.splice(m_Lru.begin(), m_Lru, it->second.LruPosition);
+	m_Hits++;
+	return it->second.Resource;
+}
+
+void ResourceManager::Insert(const std::string& key, std::shared_ptr<void> resource, std::size_t gpuSize)
+{
+	m_Lru.push_front(key);
+	m_Entries[key] = { resource, gpuSize, m_Lru.begin() };
+	m_ResidentBytes += gpuSize;
+
+	CollectGarbage();
+}
+
+void ResourceManager::CollectGarbage()
+{
+	if (m_ResidentBytes <= m_Budget)
+		return;
+
+	/* Walk from the least recently used end, skipping anything a test still holds a handle to */
+	auto it = m_Lru.end();
+	while (it != m_Lru.begin() && m_ResidentBytes > m_Budget)
+	{
+		--it;
+		auto entry = m_Entries.find(*it);
+
+		if (entry->second.Resource.use_count() > 1)
+			continue;
+
+		Log("Evicting " + *it + " (" + std::to_string(entry->second.GpuSize / 1024) + " KB)");
+		m_ResidentBytes -= entry->second.GpuSize;
+		m_Entries.erase(entry);
+		it = m_Lru.erase(it);
+		m_Evictions++;
+	}
+}
+
+void ResourceManager::Clear()
+{
+	m_Entries.clear();
+	m_Lru.clear();
+	m_ResidentBytes = 0;
+}
+
+void ResourceManager::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("Resource cache"))
+		return;
+
+	int budgetMB = (int)(m_Budget / (1024 * 1024));
+	if (ImGui::SliderInt("VRAM budget (MB)", &budgetMB, 0, 1024))
+	{
+		m_Budget = (std::size_t)budgetMB * 1024 * 1024;
+		CollectGarbage();
+	}
+
+	ImGui::Text("Resident: %zu resources, %.2f MB", m_Entries.size(), m_ResidentBytes / (1024.0f * 1024.0f));
+	if (m_AssetPack)
+		ImGui::Text("Asset pack: %.2f MB mapped", m_AssetPack->GetSize() / (1024.0f * 1024.0f));
+	ImGui::Text("Hits: %u - Misses: %u - Evictions: %u", m_Hits, m_Misses, m_Evictions);
+
+	for (const std::string& key : m_Lru)
+	{
+		const Entry& entry = m_Entries[key];
+		ImGui::BulletText("%s (%zu KB, %ld refs)", key.c_str(), entry.GpuSize / 1024, entry.Resource.use_count() - 1);
+	}
+}
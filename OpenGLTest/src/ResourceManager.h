@@ -0,0 +1,70 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AssetPack.h"
+#include "Shader.h"
+#include "Texture.h"
+
+/* A handle keeps its resource alive; the cache only evicts resources nobody holds a handle to */
+template <typename T>
+using ResourceHandle = std::shared_ptr<T>;
+
+class ResourceManager
+{
+private:
+	struct Entry
+	{
+		std::shared_ptr<void> Resource;
+		std::size_t GpuSize;
+		std::list<std::string>::iterator LruPosition;
+	};
+
+	std::unordered_map<std::string, Entry> m_Entries;
+	std::list<std::string> m_Lru; // Most recently used first
+
+	std::unique_ptr<AssetPack> m_AssetPack;
+
+	std::size_t m_Budget;
+	std::size_t m_ResidentBytes;
+	unsigned int m_Hits;
+	unsigned int m_Misses;
+	unsigned int m_Evictions;
+
+	ResourceManager();
+
+public:
+	static ResourceManager& Get();
+
+	ResourceManager(const ResourceManager&) = delete;
+	ResourceManager& operator=(const ResourceManager&) = delete;
+
+	// Resources found in a mounted pack are created from its mapped bytes instead of loose files
+	bool MountAssetPack(const std::string& filepath);
+
+	ResourceHandle<Shader> GetShader(const std::string& filepath);
+	ResourceHandle<Texture> GetTexture(const std::string& filepath, const TextureParams& params = TextureParams());
+	// Same as `GetTexture` for each path, but images that need decoding are decoded in parallel on the job system
+	std::vector<ResourceHandle<Texture>> GetTextures(const std::vector<std::string>& filepaths, const TextureParams& params = TextureParams());
+
+	// Evicts unreferenced resources, least recently used first, until the cache fits in the budget
+	void CollectGarbage();
+	// Drops every cached resource (must be called while the OpenGL context is still alive)
+	void Clear();
+
+	void OnImGuiRender();
+
+	inline void SetBudget(std::size_t bytes) { m_Budget = bytes; }
+	inline std::size_t GetBudget() const { return m_Budget; }
+	inline std::size_t GetResidentBytes() const { return m_ResidentBytes; }
+	inline std::size_t GetResourceCount() const { return m_Entries.size(); }
+
+private:
+	static std::string GetTextureKey(const std::string& filepath, const TextureParams& params);
+	std::shared_ptr<void> Find(const std::string& key);
+	void Insert(const std::string& key, std::shared_ptr<void> resource, std::size_t gpuSize);
+};
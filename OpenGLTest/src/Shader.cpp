@@ -1,49 +1,196 @@
 #include "Shader.h"
 #include "GLHandleError.h"
+#include "RenderBackend.h"
+#include "RenderStats.h"
+#include "SoftwarePrograms.h"
 
 #include <GL/glew.h>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
 Shader::Shader(const std::string& filepath)
-	: m_Filepath(filepath), m_RendererID(0)
+	: m_Filepath(filepath), m_RendererID(0), m_GpuSize(0), m_IsCompute(false), m_SoftwareProgram(nullptr)
 {
+	if (IsSoftwareRendering())
+	{
+		m_SoftwareProgram = SoftwareProgram::Find(filepath);
+		if (!m_SoftwareProgram)
+			Log("No software implementation of " + filepath + ", its draws are skipped");
+		return;
+	}
+
 	ShaderProgramSource source = ParseShader(filepath);
-    m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+	if (!source.ComputeSource.empty())
+	{
+		m_IsCompute = true;
+		m_RendererID = CreateComputeShader(source.ComputeSource.c_str(), (int)source.ComputeSource.size());
+	}
+	else if (!source.FeedbackVaryings.empty())
+	{
+		m_RendererID = CreateFeedbackShader(source.VertexSource.c_str(), (int)source.VertexSource.size(), source.FeedbackVaryings);
+	}
+	else
+	{
+		m_RendererID = CreateShader(
+			source.VertexSource.c_str(), (int)source.VertexSource.size(),
+			source.FragmentSource.c_str(), (int)source.FragmentSource.size()
+		);
+	}
+	QueryGpuSize();
+	RenderStats::Get().Add(RenderCounter::RESOURCES_CREATED);
+}
+
+Shader::Shader(const std::string& name, const char* vertexSource, int vertexLength, const char* fragmentSource, int fragmentLength)
+	: m_Filepath(name), m_RendererID(0), m_GpuSize(0), m_IsCompute(false), m_SoftwareProgram(nullptr)
+{
+	if (IsSoftwareRendering())
+	{
+		/* Asset pack entries keep the name of the file they were packed from */
+		m_SoftwareProgram = SoftwareProgram::Find(name);
+		if (!m_SoftwareProgram)
+			Log("No software implementation of " + name + ", its draws are skipped");
+		return;
+	}
+
+	m_RendererID = CreateShader(vertexSource, vertexLength, fragmentSource, fragmentLength);
+	QueryGpuSize();
+	RenderStats::Get().Add(RenderCounter::RESOURCES_CREATED);
 }
 
 Shader::~Shader()
 {
+	if (IsSoftwareRendering())
+		return;
+
     GL_CALL(glDeleteProgram(m_RendererID));
+	RenderStats::Get().Add(RenderCounter::RESOURCES_DESTROYED);
 }
 
 void Shader::Bind()
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glUseProgram(m_RendererID));
+	RenderStats::Get().OnProgramBound(m_RendererID);
 }
 
 void Shader::Unbind()
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glUseProgram(0));
+	RenderStats::Get().OnProgramBound(0);
 }
 
-void Shader::SetUniform1i(const std::string& name, int value)
+void Shader::SetUniform1i(std::string_view name, int value)
 {
+	RenderStats::Get().Add(RenderCounter::UNIFORM_UPLOADS);
+
+	if (IsSoftwareRendering())
+	{
+		const float values[] = { (float)value };
+		SetSoftwareUniform(name, values, 1);
+		return;
+	}
+
 	GL_CALL(glUniform1i(GetUniformLocation(name), value));
 }
 
-void Shader::SetUniform1f(const std::string& name, float value)
+void Shader::SetUniform1ui(std::string_view name, unsigned int value)
+{
+	RenderStats::Get().Add(RenderCounter::UNIFORM_UPLOADS);
+
+	if (IsSoftwareRendering())
+	{
+		const float values[] = { (float)value };
+		SetSoftwareUniform(name, values, 1);
+		return;
+	}
+
+	GL_CALL(glUniform1ui(GetUniformLocation(name), value));
+}
+
+void Shader::SetUniform1f(std::string_view name, float value)
 {
+	RenderStats::Get().Add(RenderCounter::UNIFORM_UPLOADS);
+
+	if (IsSoftwareRendering())
+	{
+		SetSoftwareUniform(name, &value, 1);
+		return;
+	}
+
 	GL_CALL(glUniform1f(GetUniformLocation(name), value));
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+void Shader::SetUniform2f(std::string_view name, float v0, float v1)
+{
+	RenderStats::Get().Add(RenderCounter::UNIFORM_UPLOADS);
+
+	if (IsSoftwareRendering())
+	{
+		const float values[] = { v0, v1 };
+		SetSoftwareUniform(name, values, 2);
+		return;
+	}
+
+	GL_CALL(glUniform2f(GetUniformLocation(name), v0, v1));
+}
+
+void Shader::SetUniform3f(std::string_view name, float v0, float v1, float v2)
 {
+	RenderStats::Get().Add(RenderCounter::UNIFORM_UPLOADS);
+
+	if (IsSoftwareRendering())
+	{
+		const float values[] = { v0, v1, v2 };
+		SetSoftwareUniform(name, values, 3);
+		return;
+	}
+
+    GL_CALL(glUniform3f(GetUniformLocation(name), v0, v1, v2));
+}
+
+void Shader::SetUniform4f(std::string_view name, float v0, float v1, float v2, float v3)
+{
+	RenderStats::Get().Add(RenderCounter::UNIFORM_UPLOADS);
+
+	if (IsSoftwareRendering())
+	{
+		const float values[] = { v0, v1, v2, v3 };
+		SetSoftwareUniform(name, values, 4);
+		return;
+	}
+
     GL_CALL(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
 }
 
-void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
+void Shader::SetUniform4fv(std::string_view name, int count, const float* values)
 {
+	RenderStats::Get().Add(RenderCounter::UNIFORM_UPLOADS);
+
+	if (IsSoftwareRendering())
+	{
+		SetSoftwareUniform(name, values, std::min(count * 4, 16));
+		return;
+	}
+
+	GL_CALL(glUniform4fv(GetUniformLocation(name), count, values));
+}
+
+void Shader::SetUniformMat4f(std::string_view name, const glm::mat4& matrix)
+{
+	RenderStats::Get().Add(RenderCounter::UNIFORM_UPLOADS);
+
+	if (IsSoftwareRendering())
+	{
+		SetSoftwareUniform(name, &matrix[0][0], 16);
+		return;
+	}
+
     GL_CALL(glUniformMatrix4fv(
         GetUniformLocation(name), // Location
         1, // Count
@@ -57,12 +204,21 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
     std::ifstream stream(filepath);
 
     std::string line;
-    std::stringstream ss[2];
+    std::stringstream ss[3];
+    std::vector<std::string> feedbackVaryings;
     ShaderType type = ShaderType::NONE;
 
     while (getline(stream, line))
     {
-        if (line.find("#shader") != std::string::npos)
+        if (line.find("#feedback") != std::string::npos)
+        {
+            // Not GLSL either: the names of the outputs to capture, separated by spaces
+            std::stringstream names(line.substr(line.find("#feedback") + 9));
+            std::string name;
+            while (names >> name)
+                feedbackVaryings.push_back(name);
+        }
+        else if (line.find("#shader") != std::string::npos)
         {
             if (line.find("vertex") != std::string::npos)
                 // Setting the mode/type to vertex
@@ -70,6 +226,9 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
             else if (line.find("fragment") != std::string::npos)
                 // Setting the mode/type to fragment
                 type = ShaderType::FRAGMENT;
+            else if (line.find("compute") != std::string::npos)
+                // Setting the mode/type to compute
+                type = ShaderType::COMPUTE;
         }
         else
         {
@@ -77,14 +236,13 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
         }
     }
 
-    return { ss[0].str(), ss[1].str() };
+    return { ss[0].str(), ss[1].str(), ss[2].str(), feedbackVaryings };
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+unsigned int Shader::CompileShader(unsigned int type, const char* source, int length)
 {
     GL_CALL(unsigned int id = glCreateShader(type));
-    const char* src = source.c_str();
-    GL_CALL(glShaderSource(id, 1, &src, nullptr));
+    GL_CALL(glShaderSource(id, 1, &source, &length));
     GL_CALL(glCompileShader(id));
 
     int result;
@@ -97,7 +255,7 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
         char* message = (char*)alloca(sizeof(char) * length);
         GL_CALL(glGetShaderInfoLog(id, length, &length, message));
 
-        Log("Failed to compile " + std::string(type == GL_VERTEX_SHADER ? "vertex" : "fragment") + " shader!");
+        Log("Failed to compile " + std::string(type == GL_VERTEX_SHADER ? "vertex" : type == GL_COMPUTE_SHADER ? "compute" : "fragment") + " shader!");
         Log(message);
 
         GL_CALL(glDeleteShader(id));
@@ -108,11 +266,11 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 }
 
 // TODO Move to constructor?
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+unsigned int Shader::CreateShader(const char* vertexShader, int vertexLength, const char* fragmentShader, int fragmentLength)
 {
     GL_CALL(unsigned int program = glCreateProgram());
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader, vertexLength);
+    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader, fragmentLength);
 
     GL_CALL(glAttachShader(program, vs));
     GL_CALL(glAttachShader(program, fs));
@@ -128,16 +286,102 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
     return program;
 }
 
-int Shader::GetUniformLocation(const std::string& name)
+unsigned int Shader::CreateComputeShader(const char* computeShader, int computeLength)
 {
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-        return m_UniformLocationCache[name];
+    GL_CALL(unsigned int program = glCreateProgram());
+    unsigned int cs = CompileShader(GL_COMPUTE_SHADER, computeShader, computeLength);
+
+    GL_CALL(glAttachShader(program, cs));
+    GL_CALL(glLinkProgram(program));
+    GL_CALL(glValidateProgram(program));
+
+    GL_CALL(glDeleteShader(cs));
 
-    GL_CALL(int location = glGetUniformLocation(m_RendererID, name.c_str()));
+    return program;
+}
+
+unsigned int Shader::CreateFeedbackShader(const char* vertexShader, int vertexLength, const std::vector<std::string>& varyings)
+{
+    GL_CALL(unsigned int program = glCreateProgram());
+    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader, vertexLength);
+
+    std::vector<const char*> names;
+    for (const std::string& varying : varyings)
+        names.push_back(varying.c_str());
+
+    GL_CALL(glAttachShader(program, vs));
+    GL_CALL(glTransformFeedbackVaryings(program, (int)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS));
+    GL_CALL(glLinkProgram(program));
+
+    int result;
+    GL_CALL(glGetProgramiv(program, GL_LINK_STATUS, &result));
+    if (result == GL_FALSE)
+    {
+        int length;
+        GL_CALL(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+
+        char* message = (char*)alloca(sizeof(char) * length);
+        GL_CALL(glGetProgramInfoLog(program, length, &length, message));
+
+        Log("Failed to link transform feedback program " + m_Filepath + "!");
+        Log(message);
+    }
+
+    GL_CALL(glDeleteShader(vs));
+
+    return program;
+}
+
+void Shader::QueryGpuSize()
+{
+	if (!GLEW_ARB_get_program_binary)
+		return;
+
+	int binaryLength = 0;
+	GL_CALL(glGetProgramiv(m_RendererID, GL_PROGRAM_BINARY_LENGTH, &binaryLength));
+	m_GpuSize = binaryLength;
+	m_Memory.Track(GpuMemoryCategory::SHADER, m_GpuSize);
+}
+
+int Shader::GetUniformLocation(std::string_view name)
+{
+    const auto it = m_UniformLocationCache.find(name);
+    if (it != m_UniformLocationCache.end())
+        return it->second;
+
+    /* glGetUniformLocation wants a null-terminated name, the copy also owns the cache key */
+    const std::string& storedName = m_UniformNames.emplace_back(name);
+
+    if (IsSoftwareRendering())
+    {
+        /* Every name gets a slot, there's no linked program to say which ones exist */
+        const int location = (int)m_SoftwareUniforms.size();
+        m_SoftwareUniforms.emplace_back();
+        m_UniformLocationCache[storedName] = location;
+        return location;
+    }
+
+    GL_CALL(int location = glGetUniformLocation(m_RendererID, storedName.c_str()));
     
     if (location == -1)
-        std::cout << "Warning: uniform '" << name << "' does not exist!" << std::endl;
+        std::cout << "Warning: uniform '" << storedName << "' does not exist!" << std::endl;
 
-    m_UniformLocationCache[name] = location;
+    m_UniformLocationCache[storedName] = location;
     return location;
 }
+
+void Shader::SetSoftwareUniform(std::string_view name, const float* values, int count)
+{
+    SoftwareUniform& uniform = m_SoftwareUniforms[GetUniformLocation(name)];
+    std::copy(values, values + count, uniform.values);
+    uniform.isSet = true;
+}
+
+const float* Shader::GetSoftwareUniform(std::string_view name) const
+{
+    const auto it = m_UniformLocationCache.find(name);
+    if (it == m_UniformLocationCache.end() || !m_SoftwareUniforms[it->second].isSet)
+        return nullptr;
+
+    return m_SoftwareUniforms[it->second].values;
+}
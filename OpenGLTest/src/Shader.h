@@ -1,21 +1,38 @@
 #pragma once
 
+#include <deque>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "glm/glm.hpp"
 
+#include "GpuMemoryTracker.h"
+
 enum class ShaderType
 {
 	NONE = -1,
 	VERTEX = 0,
-	FRAGMENT = 1
+	FRAGMENT = 1,
+	COMPUTE = 2
 };
 
 struct ShaderProgramSource
 {
 	std::string VertexSource;
 	std::string FragmentSource;
+	std::string ComputeSource; // When set, the program is a compute program (the other stages are ignored)
+	std::vector<std::string> FeedbackVaryings; // From `#feedback name...`: captured by transform feedback (interleaved, in that order)
+};
+
+class SoftwareProgram;
+
+// What a uniform was last set to, for the software backend (ints and samplers are stored as floats)
+struct SoftwareUniform
+{
+	float values[16] = {};
+	bool isSet = false;
 };
 
 class Shader
@@ -23,24 +40,57 @@ class Shader
 private:
 	std::string m_Filepath;
 	unsigned int m_RendererID;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	std::unordered_map<std::string_view, int> m_UniformLocationCache; // Keys point into `m_UniformNames`
+	std::deque<std::string> m_UniformNames; // A deque never moves its elements, so the keys stay valid
+	std::size_t m_GpuSize;
+	GpuAllocation m_Memory;
+	bool m_IsCompute;
+
+	/* Software backend only */
+	const SoftwareProgram* m_SoftwareProgram; // The C++ implementation standing in for the GLSL one (null if there's none)
+	std::vector<SoftwareUniform> m_SoftwareUniforms; // Indexed by location
 
 public:
 	Shader(const std::string& filepath);
+	// Builds the program straight from already split stage sources (e.g. memory-mapped from an asset pack)
+	Shader(const std::string& name, const char* vertexSource, int vertexLength, const char* fragmentSource, int fragmentLength);
 	~Shader();
 
 	void Bind();
 	void Unbind();
 	
 	// Set uniforms
-	void SetUniform1i(const std::string& name, int value);
-	void SetUniform1f(const std::string& name, float value);
-	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
+	void SetUniform1i(std::string_view name, int value);
+	void SetUniform1ui(std::string_view name, unsigned int value);
+	void SetUniform1f(std::string_view name, float value);
+	void SetUniform2f(std::string_view name, float v0, float v1);
+	void SetUniform3f(std::string_view name, float v0, float v1, float v2);
+	void SetUniform4f(std::string_view name, float v0, float v1, float v2, float v3);
+	void SetUniform4fv(std::string_view name, int count, const float* values);
+	void SetUniformMat4f(std::string_view name, const glm::mat4& matrix);
+
+	inline bool IsCompute() const { return m_IsCompute; }
+
+	inline const SoftwareProgram* GetSoftwareProgram() const { return m_SoftwareProgram; }
+	// Null until the uniform gets set
+	const float* GetSoftwareUniform(std::string_view name) const;
+
+	// Size of the linked program binary (0 if the driver can't report it)
+	inline std::size_t GetGpuSize() const { return m_GpuSize; }
+
+	// Looked up once per name, then served from `m_UniformLocationCache` (without building a string, so it doesn't allocate)
+	int GetUniformLocation(std::string_view name);
+	// Forgets the cached locations (the next lookups go back to the driver)
+	inline void ClearUniformLocationCache() { m_UniformLocationCache.clear(); m_UniformNames.clear(); }
+
+	static ShaderProgramSource ParseShader(const std::string& filepath);
 
 private:
-	ShaderProgramSource ParseShader(const std::string& filepath);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader); // TODO Move to constructor?
-	int GetUniformLocation(const std::string& name);
+	unsigned int CompileShader(unsigned int type, const char* source, int length);
+	unsigned int CreateShader(const char* vertexShader, int vertexLength, const char* fragmentShader, int fragmentLength); // TODO Move to constructor?
+	unsigned int CreateComputeShader(const char* computeShader, int computeLength);
+	// Vertex stage only (draw with GL_RASTERIZER_DISCARD), the varyings are set up before linking
+	unsigned int CreateFeedbackShader(const char* vertexShader, int vertexLength, const std::vector<std::string>& varyings);
+	void QueryGpuSize();
+	void SetSoftwareUniform(std::string_view name, const float* values, int count);
 };
@@ -0,0 +1,56 @@
+#include "ShaderStorageBuffer.h"
+#include "GLHandleError.h"
+#include "RenderStats.h"
+
+ShaderStorageBuffer::ShaderStorageBuffer(const void* data, unsigned int size, GLenum usage)
+	: m_Size(size)
+{
+	GL_CALL(glGenBuffers(1, &m_RendererID));
+	GL_CALL(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+	GL_CALL(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, usage));
+	m_Memory.Track(GpuMemoryCategory::STORAGE_BUFFER, size);
+	RenderStats::Get().Add(RenderCounter::RESOURCES_CREATED);
+	if (data)
+		RenderStats::Get().Add(RenderCounter::BUFFER_BYTES, size);
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+	GL_CALL(glDeleteBuffers(1, &m_RendererID));
+	RenderStats::Get().Add(RenderCounter::RESOURCES_DESTROYED);
+}
+
+void ShaderStorageBuffer::BindBase(unsigned int index) const
+{
+	GL_CALL(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, m_RendererID));
+}
+
+void ShaderStorageBuffer::Bind(GLenum target) const
+{
+	GL_CALL(glBindBuffer(target, m_RendererID));
+}
+
+void ShaderStorageBuffer::Unbind(GLenum target) const
+{
+	GL_CALL(glBindBuffer(target, 0));
+}
+
+void ShaderStorageBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+	if (data)
+		RenderStats::Get().Add(RenderCounter::BUFFER_BYTES, size);
+
+	GL_CALL(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+
+	if (offset + size > m_Size)
+	{
+		/* Grow to fit: everything before `offset` is lost, so only reallocate for whole-buffer updates */
+		ASSERT(offset == 0);
+		m_Size = size;
+		GL_CALL(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_DRAW));
+		m_Memory.Track(GpuMemoryCategory::STORAGE_BUFFER, size);
+		return;
+	}
+
+	GL_CALL(glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
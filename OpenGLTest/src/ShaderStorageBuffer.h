@@ -0,0 +1,29 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuMemoryTracker.h"
+
+/* Buffer written or read by shaders (GL 4.3+), also bindable as a draw indirect or parameter buffer */
+class ShaderStorageBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	GpuAllocation m_Memory;
+
+public:
+	ShaderStorageBuffer(const void* data, unsigned int size, GLenum usage = GL_DYNAMIC_DRAW);
+	~ShaderStorageBuffer();
+
+	// Binds it to `binding = index` of the shaders' storage blocks
+	void BindBase(unsigned int index) const;
+	void Bind(GLenum target = GL_SHADER_STORAGE_BUFFER) const;
+	void Unbind(GLenum target = GL_SHADER_STORAGE_BUFFER) const;
+
+	// Reallocates when `size` doesn't fit
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+};
@@ -0,0 +1,46 @@
+#include "SimulationClock.h"
+
+#include "imgui/imgui.h"
+
+SimulationClock::SimulationClock(double fixedStep)
+	: m_FixedStep(fixedStep), m_Accumulator(0.0), m_LastTime(-1.0), m_FrameDelta(0.0f), m_MaxStepsPerFrame(8), m_IsPipelined(false)
+{
+}
+
+int SimulationClock::Advance(double now)
+{
+	if (m_LastTime < 0.0)
+	{
+		m_LastTime = now;
+		return 0;
+	}
+
+	m_FrameDelta = (float)(now - m_LastTime);
+	m_LastTime = now;
+	m_Accumulator += m_FrameDelta;
+
+	int steps = 0;
+	while (m_Accumulator >= m_FixedStep && steps < m_MaxStepsPerFrame)
+	{
+		m_Accumulator -= m_FixedStep;
+		steps++;
+	}
+
+	if (steps == m_MaxStepsPerFrame && m_Accumulator >= m_FixedStep)
+		m_Accumulator = 0.0;
+
+	return steps;
+}
+
+void SimulationClock::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("Simulation"))
+		return;
+
+	int rate = (int)(1.0 / m_FixedStep + 0.5);
+	if (ImGui::SliderInt("Fixed rate (Hz)", &rate, 10, 240))
+		m_FixedStep = 1.0 / rate;
+
+	ImGui::Checkbox("Pipelined (simulate next frame on a worker)", &m_IsPipelined);
+	ImGui::Text("Frame delta %.3f ms - interpolation %.2f", m_FrameDelta * 1000.0f, GetAlpha());
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+/* Turns real frame times into a whole number of fixed simulation steps, keeping the remainder for interpolation */
+class SimulationClock
+{
+private:
+	double m_FixedStep; // Seconds
+	double m_Accumulator;
+	double m_LastTime;
+	float m_FrameDelta; // Real seconds between the last two frames
+	int m_MaxStepsPerFrame; // Drops time instead of spiraling when the simulation can't keep up
+	bool m_IsPipelined;
+
+public:
+	SimulationClock(double fixedStep = 1.0 / 60.0);
+
+	// Returns how many fixed steps have to be simulated for a frame starting at `now` (in seconds)
+	int Advance(double now);
+
+	// How far the simulation is between its last two steps, in [0; 1)
+	inline float GetAlpha() const { return (float)(m_Accumulator / m_FixedStep); }
+	inline float GetFixedStep() const { return (float)m_FixedStep; }
+	inline float GetFrameDelta() const { return m_FrameDelta; }
+
+	// When pipelined, the next frame is simulated on a worker thread while the current one is being rendered
+	inline bool IsPipelined() const { return m_IsPipelined; }
+
+	void OnImGuiRender();
+};
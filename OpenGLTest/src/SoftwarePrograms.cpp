@@ -0,0 +1,134 @@
+#include "SoftwarePrograms.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+/* texture(sampler2D, vec2) for an RGBA8 texture stored bottom row first, following its filter and wrap */
+static void Sample(const Texture& texture, float s, float t, float* rgba)
+{
+	const int width = texture.GetWidth();
+	const int height = texture.GetHeight();
+	if (width == 0 || height == 0)
+	{
+		std::fill(rgba, rgba + 4, 0.0f);
+		return;
+	}
+
+	const bool isRepeat = texture.GetParams().wrap == GL_REPEAT;
+	const unsigned char* pixels = texture.GetPixels();
+	const auto texel = [&](int x, int y)
+	{
+		x = isRepeat ? ((x % width) + width) % width : std::clamp(x, 0, width - 1);
+		y = isRepeat ? ((y % height) + height) % height : std::clamp(y, 0, height - 1);
+		return pixels + ((std::size_t)y * width + x) * 4;
+	};
+
+	if (texture.GetParams().filter == GL_NEAREST)
+	{
+		const unsigned char* p = texel((int)std::floor(s * width), (int)std::floor(t * height));
+		for (int channel = 0; channel < 4; channel++)
+			rgba[channel] = p[channel] * (1.0f / 255.0f);
+		return;
+	}
+
+	/* Bilinear, between the 4 texel centers around the sample */
+	const float x = s * width - 0.5f;
+	const float y = t * height - 0.5f;
+	const int x0 = (int)std::floor(x);
+	const int y0 = (int)std::floor(y);
+	const float ax = x - x0;
+	const float ay = y - y0;
+
+	const unsigned char* p00 = texel(x0, y0);
+	const unsigned char* p10 = texel(x0 + 1, y0);
+	const unsigned char* p01 = texel(x0, y0 + 1);
+	const unsigned char* p11 = texel(x0 + 1, y0 + 1);
+	for (int channel = 0; channel < 4; channel++)
+	{
+		const float bottom = p00[channel] + (p10[channel] - p00[channel]) * ax;
+		const float top = p01[channel] + (p11[channel] - p01[channel]) * ax;
+		rgba[channel] = (bottom + (top - bottom) * ay) * (1.0f / 255.0f);
+	}
+}
+
+/* res/shaders/Basic.shader: positions already in clip space, flat u_Color */
+class BasicProgram : public SoftwareProgram
+{
+public:
+	int GetVaryingCount() const override { return 0; }
+
+	void ShadeVertex(const SoftwareUniforms& uniforms, const glm::vec4* attributes, glm::vec4& position, float* varyings) const override
+	{
+		position = attributes[0];
+	}
+
+	void ShadeFragments(const SoftwareUniforms& uniforms, const float (*varyings)[4], float (*colors)[4]) const override
+	{
+		for (int channel = 0; channel < 4; channel++)
+			std::fill(colors[channel], colors[channel] + 4, uniforms.color[channel]);
+	}
+};
+
+/* res/shaders/BasicWithTexture.shader: u_MVP * position, the texture sampled at the interpolated coordinates */
+class BasicWithTextureProgram : public SoftwareProgram
+{
+public:
+	int GetVaryingCount() const override { return 2; }
+
+	void ShadeVertex(const SoftwareUniforms& uniforms, const glm::vec4* attributes, glm::vec4& position, float* varyings) const override
+	{
+		position = uniforms.mvp * attributes[0];
+		varyings[0] = attributes[1].x;
+		varyings[1] = attributes[1].y;
+	}
+
+	void ShadeFragments(const SoftwareUniforms& uniforms, const float (*varyings)[4], float (*colors)[4]) const override
+	{
+		for (int lane = 0; lane < 4; lane++)
+		{
+			float rgba[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			if (uniforms.texture)
+				Sample(*uniforms.texture, varyings[0][lane], varyings[1][lane], rgba);
+
+			for (int channel = 0; channel < 4; channel++)
+				colors[channel][lane] = rgba[channel];
+		}
+	}
+};
+
+/* res/shaders/Sombrero.shader: u_MVP * vec4(aPos, 1.0), flat u_Color */
+class SombreroProgram : public SoftwareProgram
+{
+public:
+	int GetVaryingCount() const override { return 0; }
+
+	void ShadeVertex(const SoftwareUniforms& uniforms, const glm::vec4* attributes, glm::vec4& position, float* varyings) const override
+	{
+		position = uniforms.mvp * glm::vec4(glm::vec3(attributes[0]), 1.0f);
+	}
+
+	void ShadeFragments(const SoftwareUniforms& uniforms, const float (*varyings)[4], float (*colors)[4]) const override
+	{
+		for (int channel = 0; channel < 4; channel++)
+			std::fill(colors[channel], colors[channel] + 4, uniforms.color[channel]);
+	}
+};
+
+const SoftwareProgram* SoftwareProgram::Find(const std::string& filepath)
+{
+	static const BasicProgram basic;
+	static const BasicWithTextureProgram basicWithTexture;
+	static const SombreroProgram sombrero;
+
+	const std::string filename = std::filesystem::path(filepath).filename().string();
+	if (filename == "Basic.shader")
+		return &basic;
+	if (filename == "BasicWithTexture.shader")
+		return &basicWithTexture;
+	if (filename == "Sombrero.shader")
+		return &sombrero;
+
+	return nullptr;
+}
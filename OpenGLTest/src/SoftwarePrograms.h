@@ -0,0 +1,34 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <string>
+
+class Texture;
+
+// The uniforms the supported programs read, gathered from the `Shader` once per draw
+struct SoftwareUniforms
+{
+	glm::mat4 mvp = glm::mat4(1.0f); // u_MVP
+	glm::vec4 color = glm::vec4(0.0f); // u_Color
+	const Texture* texture = nullptr; // Bound to u_Texture's slot
+};
+
+/* C++ stand-in for a GLSL program, run by `SoftwareRasterizer`: vertices one at a time, fragments 4 at a time */
+class SoftwareProgram
+{
+public:
+	static constexpr int MaxAttributes = 4;
+	static constexpr int MaxVaryings = 4; // Floats interpolated from the vertices to the fragments
+
+	virtual ~SoftwareProgram() {}
+
+	virtual int GetVaryingCount() const = 0;
+	// `attributes[i]` is location i, the components the buffer doesn't have filled in with (0, 0, 0, 1) like in GL
+	virtual void ShadeVertex(const SoftwareUniforms& uniforms, const glm::vec4* attributes, glm::vec4& position, float* varyings) const = 0;
+	// Structure of arrays: `varyings[v][lane]` in, `colors[channel][lane]` (RGBA, 0 to 1) out, for 4 adjacent pixels
+	virtual void ShadeFragments(const SoftwareUniforms& uniforms, const float (*varyings)[4], float (*colors)[4]) const = 0;
+
+	// From the shader's file name (res/shaders/Basic.shader, BasicWithTexture.shader and Sombrero.shader), null otherwise
+	static const SoftwareProgram* Find(const std::string& filepath);
+};
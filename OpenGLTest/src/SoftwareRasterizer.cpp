@@ -0,0 +1,664 @@
+#include "SoftwareRasterizer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "JobSystem.h"
+#include "GLHandleError.h"
+
+#include "glm/gtc/type_ptr.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+	#define RASTERIZER_SSE
+	#include <emmintrin.h>
+#endif
+
+static inline uint8_t ToUnorm8(float value)
+{
+	return (uint8_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+static inline uint32_t PackColor(float r, float g, float b, float a)
+{
+	/* Bytes in memory: R, G, B, A (what glReadPixels gives with GL_RGBA) */
+	return (uint32_t)ToUnorm8(r) | ((uint32_t)ToUnorm8(g) << 8) | ((uint32_t)ToUnorm8(b) << 16) | ((uint32_t)ToUnorm8(a) << 24);
+}
+
+/* GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, alpha included */
+static inline void Blend(uint32_t& pixel, float r, float g, float b, float a)
+{
+	a = std::min(std::max(a, 0.0f), 1.0f);
+	if (a >= 1.0f)
+	{
+		pixel = PackColor(r, g, b, a);
+		return;
+	}
+
+	const float inverseAlpha = (1.0f - a) * (1.0f / 255.0f);
+	pixel = PackColor(
+		r * a + (pixel & 0xFF) * inverseAlpha,
+		g * a + ((pixel >> 8) & 0xFF) * inverseAlpha,
+		b * a + ((pixel >> 16) & 0xFF) * inverseAlpha,
+		a * a + (pixel >> 24) * inverseAlpha
+	);
+}
+
+static glm::vec4 FetchAttribute(const SoftwareAttribute& attribute, std::size_t vertex, unsigned int instance)
+{
+	glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+
+	const std::size_t element = attribute.divisor ? instance / attribute.divisor : vertex;
+	const std::size_t typeSize = VertexBufferElement::GetSizeOfType(attribute.type);
+	const std::size_t offset = attribute.offset + element * attribute.stride;
+	if (offset + attribute.count * typeSize > attribute.data->size())
+		return value;
+
+	const unsigned char* data = attribute.data->data() + offset;
+	for (unsigned int component = 0; component < std::min(attribute.count, 4u); component++)
+	{
+		switch (attribute.type)
+		{
+			case GL_FLOAT:
+				std::memcpy(&value[component], data + component * sizeof(float), sizeof(float));
+				break;
+			case GL_UNSIGNED_INT:
+			{
+				uint32_t integer;
+				std::memcpy(&integer, data + component * sizeof(uint32_t), sizeof(uint32_t));
+				value[component] = (float)integer;
+				break;
+			}
+			case GL_UNSIGNED_BYTE:
+				value[component] = attribute.isNormalized ? data[component] * (1.0f / 255.0f) : (float)data[component];
+				break;
+		}
+	}
+
+	return value;
+}
+
+// How many vertices every per-vertex attribute has data for
+static std::size_t GetVertexCount(const VertexArray& va)
+{
+	std::size_t count = SIZE_MAX;
+	for (const SoftwareAttribute& attribute : va.GetSoftwareAttributes())
+	{
+		if (attribute.divisor != 0)
+			continue;
+
+		const std::size_t elementSize = attribute.count * VertexBufferElement::GetSizeOfType(attribute.type);
+		if (attribute.data->size() < attribute.offset + elementSize)
+			return 0;
+		count = std::min(count, (attribute.data->size() - attribute.offset - elementSize) / attribute.stride + 1);
+	}
+
+	return count == SIZE_MAX ? 0 : count;
+}
+
+// Clip space plane `plane` (-x, +x, -y, +y, -z, +z), positive on the inside
+static inline float PlaneDistance(const glm::vec4& position, int plane)
+{
+	const float coordinate = position[plane >> 1];
+	return (plane & 1) ? position.w - coordinate : position.w + coordinate;
+}
+
+static inline int GetOutCode(const glm::vec4& position)
+{
+	int code = 0;
+	for (int plane = 0; plane < 6; plane++)
+	{
+		if (PlaneDistance(position, plane) < 0.0f)
+			code |= 1 << plane;
+	}
+	return code;
+}
+
+SoftwareRasterizer::SoftwareRasterizer()
+	: m_Width(0), m_Height(0), m_TileColumns(0), m_TileRows(0), m_ClearColor(0), m_Textures(), m_DrawCount(0), m_TriangleCount(0), m_FragmentCount(0)
+{
+}
+
+SoftwareRasterizer& SoftwareRasterizer::Get()
+{
+	static SoftwareRasterizer rasterizer;
+	return rasterizer;
+}
+
+void SoftwareRasterizer::Resize(int width, int height)
+{
+	m_Width = std::min(std::max(width, 0), MaxSize);
+	m_Height = std::min(std::max(height, 0), MaxSize);
+	m_TileColumns = (m_Width + TileSize - 1) / TileSize;
+	m_TileRows = (m_Height + TileSize - 1) / TileSize;
+	m_ColorBuffer.assign((std::size_t)m_Width * m_Height, m_ClearColor);
+}
+
+void SoftwareRasterizer::SetClearColor(float r, float g, float b, float a)
+{
+	m_ClearColor = PackColor(r, g, b, a);
+}
+
+void SoftwareRasterizer::Clear()
+{
+	std::fill(m_ColorBuffer.begin(), m_ColorBuffer.end(), m_ClearColor);
+}
+
+void SoftwareRasterizer::BindTexture(unsigned int slot, const Texture* texture)
+{
+	if (slot < MaxTextureSlots)
+		m_Textures[slot] = texture;
+}
+
+void SoftwareRasterizer::UnbindTexture(const Texture* texture)
+{
+	for (const Texture*& bound : m_Textures)
+	{
+		if (bound == texture)
+			bound = nullptr;
+	}
+}
+
+void SoftwareRasterizer::ResetStats()
+{
+	m_DrawCount = 0;
+	m_TriangleCount = 0;
+	m_FragmentCount = 0;
+}
+
+void SoftwareRasterizer::Draw(const VertexArray& va, const IndexBuffer* ib, unsigned int vertexCount, unsigned int instanceCount, const Shader& shader, GLenum mode)
+{
+	const SoftwareProgram* program = shader.GetSoftwareProgram();
+	if (!program || m_Width == 0 || m_Height == 0)
+		return;
+
+	/* Uniforms keep their GL defaults (zeros, identity for the matrix) until set */
+	SoftwareUniforms uniforms;
+	if (const float* mvp = shader.GetSoftwareUniform("u_MVP"))
+		uniforms.mvp = glm::make_mat4(mvp);
+	if (const float* color = shader.GetSoftwareUniform("u_Color"))
+		uniforms.color = glm::make_vec4(color);
+	const float* textureSlot = shader.GetSoftwareUniform("u_Texture");
+	const unsigned int slot = textureSlot ? (unsigned int)*textureSlot : 0;
+	uniforms.texture = slot < MaxTextureSlots ? m_Textures[slot] : nullptr;
+
+	const std::size_t count = ib ? ib->GetCount() : vertexCount;
+	std::size_t primitiveCount = 0;
+	switch (mode)
+	{
+		case GL_TRIANGLES:
+			primitiveCount = count / 3;
+			break;
+		case GL_TRIANGLE_STRIP:
+			primitiveCount = count >= 3 ? count - 2 : 0;
+			break;
+		case GL_LINES:
+			primitiveCount = count / 2;
+			break;
+		default:
+			Log("Software rasterizer: unsupported primitive mode " + std::to_string(mode));
+			return;
+	}
+	if (primitiveCount == 0 || instanceCount == 0)
+		return;
+
+	/* Indexed draws shade every vertex of the buffers once, like a post-transform cache that never misses */
+	const std::size_t shadedCount = ib ? GetVertexCount(va) : vertexCount;
+	const int varyingCount = program->GetVaryingCount();
+
+	const std::size_t tileCount = (std::size_t)m_TileColumns * m_TileRows;
+	const std::size_t chunkCount = std::min(MaxChunks, (primitiveCount + PrimitivesPerChunk - 1) / PrimitivesPerChunk);
+	const std::size_t chunkSize = (primitiveCount + chunkCount - 1) / chunkCount;
+	if (m_ChunkTriangles.size() < chunkCount)
+		m_ChunkTriangles.resize(chunkCount);
+	if (m_ChunkBins.size() < chunkCount * tileCount)
+		m_ChunkBins.resize(chunkCount * tileCount);
+
+	m_DrawCount++;
+
+	for (unsigned int instance = 0; instance < instanceCount; instance++)
+	{
+		ShadeVertices(va, shadedCount, instance, *program, uniforms);
+
+		/* Front end: chunks of primitives in parallel, each with its own bins so nothing is shared */
+		JobSystem::Get().ParallelFor(0, chunkCount, 1, [&](std::size_t firstChunk, std::size_t lastChunk)
+		{
+			for (std::size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+				ProcessPrimitives(chunk, chunk * chunkSize, std::min(primitiveCount, (chunk + 1) * chunkSize), ib, mode, varyingCount);
+		});
+
+		/* Back end: tiles in parallel, each going through the chunks in order */
+		JobSystem::Get().ParallelFor(0, tileCount, 1, [&](std::size_t firstTile, std::size_t lastTile)
+		{
+			for (std::size_t tile = firstTile; tile < lastTile; tile++)
+				RasterizeTile((int)tile, chunkCount, *program, uniforms);
+		});
+	}
+}
+
+void SoftwareRasterizer::ShadeVertices(const VertexArray& va, std::size_t vertexCount, unsigned int instance, const SoftwareProgram& program, const SoftwareUniforms& uniforms)
+{
+	m_Vertices.resize(vertexCount);
+	const std::vector<SoftwareAttribute>& attributes = va.GetSoftwareAttributes();
+
+	JobSystem::Get().ParallelFor(0, vertexCount, 1024, [&](std::size_t first, std::size_t last)
+	{
+		glm::vec4 inputs[SoftwareProgram::MaxAttributes];
+		for (std::size_t vertex = first; vertex < last; vertex++)
+		{
+			std::fill(inputs, inputs + SoftwareProgram::MaxAttributes, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+			for (const SoftwareAttribute& attribute : attributes)
+			{
+				if (attribute.location < SoftwareProgram::MaxAttributes)
+					inputs[attribute.location] = FetchAttribute(attribute, vertex, instance);
+			}
+
+			program.ShadeVertex(uniforms, inputs, m_Vertices[vertex].position, m_Vertices[vertex].varyings);
+		}
+	});
+}
+
+void SoftwareRasterizer::ProcessPrimitives(std::size_t chunk, std::size_t begin, std::size_t end, const IndexBuffer* ib, GLenum mode, int varyingCount)
+{
+	const std::size_t tileCount = (std::size_t)m_TileColumns * m_TileRows;
+	m_ChunkTriangles[chunk].clear();
+	for (std::size_t tile = 0; tile < tileCount; tile++)
+		m_ChunkBins[chunk * tileCount + tile].clear();
+
+	const unsigned int* indices = ib ? ib->GetIndices().data() : nullptr;
+	const std::size_t vertexCount = m_Vertices.size();
+	const auto vertexAt = [&](std::size_t position) -> std::size_t { return indices ? indices[position] : position; };
+
+	for (std::size_t primitive = begin; primitive < end; primitive++)
+	{
+		if (mode == GL_LINES)
+		{
+			const std::size_t a = vertexAt(primitive * 2);
+			const std::size_t b = vertexAt(primitive * 2 + 1);
+			if (a < vertexCount && b < vertexCount)
+				ClipLine(chunk, m_Vertices[a], m_Vertices[b], varyingCount);
+			continue;
+		}
+
+		std::size_t a, b, c;
+		if (mode == GL_TRIANGLE_STRIP)
+		{
+			/* Every other triangle of a strip is flipped back to the strip's winding */
+			a = vertexAt(primitive + (primitive & 1));
+			b = vertexAt(primitive + 1 - (primitive & 1));
+			c = vertexAt(primitive + 2);
+		}
+		else
+		{
+			a = vertexAt(primitive * 3);
+			b = vertexAt(primitive * 3 + 1);
+			c = vertexAt(primitive * 3 + 2);
+		}
+
+		if (a < vertexCount && b < vertexCount && c < vertexCount)
+			ClipTriangle(chunk, m_Vertices[a], m_Vertices[b], m_Vertices[c], varyingCount);
+	}
+
+	m_TriangleCount.fetch_add(m_ChunkTriangles[chunk].size(), std::memory_order_relaxed);
+}
+
+void SoftwareRasterizer::ClipTriangle(std::size_t chunk, const ShadedVertex& a, const ShadedVertex& b, const ShadedVertex& c, int varyingCount)
+{
+	const int codeA = GetOutCode(a.position);
+	const int codeB = GetOutCode(b.position);
+	const int codeC = GetOutCode(c.position);
+
+	/* Entirely outside one plane, or entirely inside (most triangles) */
+	if (codeA & codeB & codeC)
+		return;
+	if ((codeA | codeB | codeC) == 0)
+	{
+		SetupTriangle(chunk, Project(a, varyingCount), Project(b, varyingCount), Project(c, varyingCount), varyingCount);
+		return;
+	}
+
+	/* Sutherland-Hodgman against the planes it crosses: 3 vertices plus at most one per plane */
+	ShadedVertex polygons[2][9] = { { a, b, c } };
+	int count = 3;
+	int current = 0;
+	const int crossedPlanes = codeA | codeB | codeC;
+
+	for (int plane = 0; plane < 6; plane++)
+	{
+		if (!(crossedPlanes & (1 << plane)))
+			continue;
+
+		const ShadedVertex* input = polygons[current];
+		ShadedVertex* output = polygons[1 - current];
+		int outputCount = 0;
+
+		for (int i = 0; i < count; i++)
+		{
+			const ShadedVertex& vertex = input[i];
+			const ShadedVertex& next = input[(i + 1) % count];
+			const float distance = PlaneDistance(vertex.position, plane);
+			const float nextDistance = PlaneDistance(next.position, plane);
+
+			if (distance >= 0.0f)
+				output[outputCount++] = vertex;
+			if ((distance >= 0.0f) != (nextDistance >= 0.0f))
+				output[outputCount++] = Lerp(vertex, next, distance / (distance - nextDistance), varyingCount);
+		}
+
+		count = outputCount;
+		current = 1 - current;
+		if (count < 3)
+			return;
+	}
+
+	/* Fan out of the clipped polygon */
+	const ScreenVertex first = Project(polygons[current][0], varyingCount);
+	ScreenVertex previous = Project(polygons[current][1], varyingCount);
+	for (int i = 2; i < count; i++)
+	{
+		const ScreenVertex vertex = Project(polygons[current][i], varyingCount);
+		SetupTriangle(chunk, first, previous, vertex, varyingCount);
+		previous = vertex;
+	}
+}
+
+void SoftwareRasterizer::ClipLine(std::size_t chunk, const ShadedVertex& a, const ShadedVertex& b, int varyingCount)
+{
+	/* Liang-Barsky: the part of the segment inside every plane */
+	float start = 0.0f;
+	float end = 1.0f;
+	for (int plane = 0; plane < 6; plane++)
+	{
+		const float distanceA = PlaneDistance(a.position, plane);
+		const float distanceB = PlaneDistance(b.position, plane);
+		if (distanceA < 0.0f && distanceB < 0.0f)
+			return;
+		if (distanceA < 0.0f)
+			start = std::max(start, distanceA / (distanceA - distanceB));
+		else if (distanceB < 0.0f)
+			end = std::min(end, distanceA / (distanceA - distanceB));
+	}
+	if (start > end)
+		return;
+
+	const ShadedVertex clipped[2] = {
+		start > 0.0f ? Lerp(a, b, start, varyingCount) : a,
+		end < 1.0f ? Lerp(a, b, end, varyingCount) : b
+	};
+
+	/* Window coordinates of both ends, before snapping */
+	float x[2], y[2];
+	float values[2][MaxValues];
+	for (int i = 0; i < 2; i++)
+	{
+		const glm::vec4& position = clipped[i].position;
+		const float inverseW = position.w > 0.0f ? 1.0f / position.w : 0.0f;
+		x[i] = (position.x * inverseW * 0.5f + 0.5f) * m_Width;
+		y[i] = (position.y * inverseW * 0.5f + 0.5f) * m_Height;
+		values[i][0] = inverseW;
+		for (int varying = 0; varying < varyingCount; varying++)
+			values[i][1 + varying] = clipped[i].varyings[varying] * inverseW;
+	}
+
+	/* Widened by half a pixel on each side */
+	const float dx = x[1] - x[0];
+	const float dy = y[1] - y[0];
+	const float length = std::sqrt(dx * dx + dy * dy);
+	const float nx = length > 0.0001f ? -dy / length * 0.5f : 0.0f;
+	const float ny = length > 0.0001f ? dx / length * 0.5f : 0.5f;
+
+	const ScreenVertex startLeft = SnapToSubpixels(x[0] + nx, y[0] + ny, values[0], 1 + varyingCount);
+	const ScreenVertex startRight = SnapToSubpixels(x[0] - nx, y[0] - ny, values[0], 1 + varyingCount);
+	const ScreenVertex endLeft = SnapToSubpixels(x[1] + nx, y[1] + ny, values[1], 1 + varyingCount);
+	const ScreenVertex endRight = SnapToSubpixels(x[1] - nx, y[1] - ny, values[1], 1 + varyingCount);
+
+	SetupTriangle(chunk, startLeft, startRight, endRight, varyingCount);
+	SetupTriangle(chunk, startLeft, endRight, endLeft, varyingCount);
+}
+
+SoftwareRasterizer::ShadedVertex SoftwareRasterizer::Lerp(const ShadedVertex& a, const ShadedVertex& b, float t, int varyingCount)
+{
+	ShadedVertex result;
+	result.position = a.position + (b.position - a.position) * t;
+	for (int varying = 0; varying < varyingCount; varying++)
+		result.varyings[varying] = a.varyings[varying] + (b.varyings[varying] - a.varyings[varying]) * t;
+	return result;
+}
+
+SoftwareRasterizer::ScreenVertex SoftwareRasterizer::Project(const ShadedVertex& vertex, int varyingCount) const
+{
+	/* Values get divided by w here and multiplied back per pixel, which makes the interpolation perspective-correct */
+	const float inverseW = vertex.position.w > 0.0f ? 1.0f / vertex.position.w : 0.0f;
+
+	float values[MaxValues];
+	values[0] = inverseW;
+	for (int varying = 0; varying < varyingCount; varying++)
+		values[1 + varying] = vertex.varyings[varying] * inverseW;
+
+	return SnapToSubpixels(
+		(vertex.position.x * inverseW * 0.5f + 0.5f) * m_Width,
+		(vertex.position.y * inverseW * 0.5f + 0.5f) * m_Height,
+		values, 1 + varyingCount
+	);
+}
+
+SoftwareRasterizer::ScreenVertex SoftwareRasterizer::SnapToSubpixels(float x, float y, const float* values, int valueCount) const
+{
+	/* Clamped to the viewport: clipping already put them there, give or take rounding (and half a line width) */
+	ScreenVertex vertex;
+	vertex.x = (int32_t)std::lround(std::min(std::max(x, 0.0f), (float)m_Width) * (1 << SubpixelBits));
+	vertex.y = (int32_t)std::lround(std::min(std::max(y, 0.0f), (float)m_Height) * (1 << SubpixelBits));
+	std::copy(values, values + valueCount, vertex.values);
+	return vertex;
+}
+
+void SoftwareRasterizer::SetupTriangle(std::size_t chunk, const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, int varyingCount)
+{
+	/* Twice the signed area, in subpixels squared. No face culling: clockwise triangles get turned around */
+	const ScreenVertex* vertices[3] = { &a, &b, &c };
+	int64_t area = (int64_t)(b.x - a.x) * (c.y - a.y) - (int64_t)(b.y - a.y) * (c.x - a.x);
+	if (area == 0)
+		return;
+	if (area < 0)
+	{
+		std::swap(vertices[1], vertices[2]);
+		area = -area;
+	}
+
+	/* Pixels whose center is within the bounds */
+	constexpr int32_t half = 1 << (SubpixelBits - 1);
+	const int32_t minX = std::min({ a.x, b.x, c.x });
+	const int32_t minY = std::min({ a.y, b.y, c.y });
+	const int32_t maxX = std::max({ a.x, b.x, c.x });
+	const int32_t maxY = std::max({ a.y, b.y, c.y });
+
+	Triangle triangle;
+	triangle.minX = std::max(0, (minX - half + (1 << SubpixelBits) - 1) >> SubpixelBits);
+	triangle.minY = std::max(0, (minY - half + (1 << SubpixelBits) - 1) >> SubpixelBits);
+	triangle.maxX = std::min(m_Width - 1, (maxX - half) >> SubpixelBits);
+	triangle.maxY = std::min(m_Height - 1, (maxY - half) >> SubpixelBits);
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+		return;
+
+	/*
+	 * Edge i goes from vertex i + 1 to vertex i + 2, positive on the inside and proportional to vertex i's barycentric
+	 * weight. With every vertex inside a viewport of at most `MaxSize`, its value at any pixel of the viewport is at
+	 * most twice the area of a triangle inside it: 2^30 subpixels squared, which fits in 32 bits.
+	 * Top-left fill rule: pixel centers exactly on an edge only belong to it if it's a left or top edge
+	 */
+	for (int i = 0; i < 3; i++)
+	{
+		const ScreenVertex& from = *vertices[(i + 1) % 3];
+		const ScreenVertex& to = *vertices[(i + 2) % 3];
+		const int32_t stepX = from.y - to.y;
+		const int32_t stepY = to.x - from.x;
+		const bool isTopLeft = stepX > 0 || (stepX == 0 && stepY < 0);
+
+		triangle.edgeStepX[i] = stepX * (1 << SubpixelBits);
+		triangle.edgeStepY[i] = stepY * (1 << SubpixelBits);
+		triangle.edgeOrigin[i] = (int64_t)stepX * (half - from.x) + (int64_t)stepY * (half - from.y) - (isTopLeft ? 0 : 1);
+	}
+
+	triangle.inverseArea = 1.0f / (float)area;
+	for (int value = 0; value < 1 + varyingCount; value++)
+	{
+		triangle.base[value] = vertices[0]->values[value];
+		triangle.delta1[value] = vertices[1]->values[value] - vertices[0]->values[value];
+		triangle.delta2[value] = vertices[2]->values[value] - vertices[0]->values[value];
+	}
+
+	std::vector<Triangle>& triangles = m_ChunkTriangles[chunk];
+	const uint32_t index = (uint32_t)triangles.size();
+	triangles.push_back(triangle);
+
+	const std::size_t tileCount = (std::size_t)m_TileColumns * m_TileRows;
+	for (int tileY = triangle.minY / TileSize; tileY <= triangle.maxY / TileSize; tileY++)
+	{
+		for (int tileX = triangle.minX / TileSize; tileX <= triangle.maxX / TileSize; tileX++)
+			m_ChunkBins[chunk * tileCount + (std::size_t)tileY * m_TileColumns + tileX].push_back(index);
+	}
+}
+
+void SoftwareRasterizer::RasterizeTile(int tile, std::size_t chunkCount, const SoftwareProgram& program, const SoftwareUniforms& uniforms)
+{
+	const std::size_t tileCount = (std::size_t)m_TileColumns * m_TileRows;
+	const int tileMinX = (tile % m_TileColumns) * TileSize;
+	const int tileMinY = (tile / m_TileColumns) * TileSize;
+	const int tileMaxX = std::min(tileMinX + TileSize, m_Width) - 1;
+	const int tileMaxY = std::min(tileMinY + TileSize, m_Height) - 1;
+	const int varyingCount = program.GetVaryingCount();
+
+	uint64_t fragmentCount = 0;
+	alignas(16) float w1[4];
+	alignas(16) float w2[4];
+
+	for (std::size_t chunk = 0; chunk < chunkCount; chunk++)
+	{
+		const std::vector<uint32_t>& bin = m_ChunkBins[chunk * tileCount + tile];
+		const std::vector<Triangle>& triangles = m_ChunkTriangles[chunk];
+
+		for (uint32_t index : bin)
+		{
+			const Triangle& triangle = triangles[index];
+			const int minX = std::max(triangle.minX, tileMinX);
+			const int maxX = std::min(triangle.maxX, tileMaxX);
+			const int minY = std::max(triangle.minY, tileMinY);
+			const int maxY = std::min(triangle.maxY, tileMaxY);
+
+#ifdef RASTERIZER_SSE
+			__m128i laneSteps[3];
+			__m128i blockSteps[3];
+			for (int i = 0; i < 3; i++)
+			{
+				const int32_t step = triangle.edgeStepX[i];
+				laneSteps[i] = _mm_setr_epi32(0, step, step * 2, step * 3);
+				blockSteps[i] = _mm_set1_epi32(step * 4);
+			}
+			const __m128 inverseArea = _mm_set1_ps(triangle.inverseArea);
+#endif
+
+			for (int y = minY; y <= maxY; y++)
+			{
+				uint32_t* row = m_ColorBuffer.data() + (std::size_t)y * m_Width;
+
+				int32_t rowEdges[3];
+				for (int i = 0; i < 3; i++)
+					rowEdges[i] = (int32_t)(triangle.edgeOrigin[i] + (int64_t)triangle.edgeStepX[i] * minX + (int64_t)triangle.edgeStepY[i] * y);
+
+#ifdef RASTERIZER_SSE
+				/* 4 pixels at a time: inside where no edge function has its sign bit set */
+				__m128i edges[3];
+				for (int i = 0; i < 3; i++)
+					edges[i] = _mm_add_epi32(_mm_set1_epi32(rowEdges[i]), laneSteps[i]);
+
+				for (int x = minX; x <= maxX; x += 4)
+				{
+					const int remaining = maxX - x + 1;
+					const int laneMask = remaining >= 4 ? 0xF : (1 << remaining) - 1;
+					const __m128i outside = _mm_or_si128(_mm_or_si128(edges[0], edges[1]), edges[2]);
+					const int mask = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & laneMask;
+
+					if (mask)
+					{
+						_mm_store_ps(w1, _mm_mul_ps(_mm_cvtepi32_ps(edges[1]), inverseArea));
+						_mm_store_ps(w2, _mm_mul_ps(_mm_cvtepi32_ps(edges[2]), inverseArea));
+						ShadeBlock(triangle, w1, w2, mask, row + x, varyingCount, program, uniforms);
+						fragmentCount += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+					}
+
+					for (int i = 0; i < 3; i++)
+						edges[i] = _mm_add_epi32(edges[i], blockSteps[i]);
+				}
+#else
+				for (int x = minX; x <= maxX; x += 4)
+				{
+					int mask = 0;
+					for (int lane = 0; lane < 4 && x + lane <= maxX; lane++)
+					{
+						const int32_t e0 = rowEdges[0] + triangle.edgeStepX[0] * lane;
+						const int32_t e1 = rowEdges[1] + triangle.edgeStepX[1] * lane;
+						const int32_t e2 = rowEdges[2] + triangle.edgeStepX[2] * lane;
+						if ((e0 | e1 | e2) >= 0)
+							mask |= 1 << lane;
+						w1[lane] = e1 * triangle.inverseArea;
+						w2[lane] = e2 * triangle.inverseArea;
+					}
+
+					if (mask)
+					{
+						ShadeBlock(triangle, w1, w2, mask, row + x, varyingCount, program, uniforms);
+						fragmentCount += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+					}
+
+					for (int i = 0; i < 3; i++)
+						rowEdges[i] += triangle.edgeStepX[i] * 4;
+				}
+#endif
+			}
+		}
+	}
+
+	m_FragmentCount.fetch_add(fragmentCount, std::memory_order_relaxed);
+}
+
+void SoftwareRasterizer::ShadeBlock(const Triangle& triangle, const float* w1, const float* w2, int mask, uint32_t* pixels, int varyingCount, const SoftwareProgram& program, const SoftwareUniforms& uniforms) const
+{
+	alignas(16) float varyings[SoftwareProgram::MaxVaryings][4];
+	alignas(16) float colors[4][4];
+
+	if (varyingCount > 0)
+	{
+#ifdef RASTERIZER_SSE
+		const __m128 weight1 = _mm_load_ps(w1);
+		const __m128 weight2 = _mm_load_ps(w2);
+		const auto interpolate = [&](int value)
+		{
+			return _mm_add_ps(_mm_set1_ps(triangle.base[value]),
+				_mm_add_ps(_mm_mul_ps(weight1, _mm_set1_ps(triangle.delta1[value])), _mm_mul_ps(weight2, _mm_set1_ps(triangle.delta2[value]))));
+		};
+
+		const __m128 w = _mm_div_ps(_mm_set1_ps(1.0f), interpolate(0));
+		for (int varying = 0; varying < varyingCount; varying++)
+			_mm_store_ps(varyings[varying], _mm_mul_ps(interpolate(1 + varying), w));
+#else
+		for (int lane = 0; lane < 4; lane++)
+		{
+			const float inverseW = triangle.base[0] + w1[lane] * triangle.delta1[0] + w2[lane] * triangle.delta2[0];
+			const float w = inverseW != 0.0f ? 1.0f / inverseW : 0.0f;
+			for (int varying = 0; varying < varyingCount; varying++)
+				varyings[varying][lane] = (triangle.base[1 + varying] + w1[lane] * triangle.delta1[1 + varying] + w2[lane] * triangle.delta2[1 + varying]) * w;
+		}
+#endif
+	}
+
+	program.ShadeFragments(uniforms, varyings, colors);
+
+	for (int lane = 0; lane < 4; lane++)
+	{
+		if (mask & (1 << lane))
+			Blend(pixels[lane], colors[0][lane], colors[1][lane], colors[2][lane], colors[3][lane]);
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "SoftwarePrograms.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class VertexArray;
+class IndexBuffer;
+class Shader;
+
+/*
+ * The software backend's GPU: draws go through a C++ `SoftwareProgram` per vertex, then get clipped, set up and
+ * binned into screen tiles by chunks of primitives in parallel. Tiles are then rasterized in parallel, each by one job,
+ * with integer edge functions and interpolation evaluated 4 pixels at a time (SSE when available). Primitives keep
+ * their submission order within a tile, so blending comes out as it would on a GPU
+ */
+class SoftwareRasterizer
+{
+public:
+	static constexpr int TileSize = 64;
+	static constexpr int SubpixelBits = 4;
+	// Vertices are clipped to the viewport, which at most this size keeps every edge function within 32 bits
+	static constexpr int MaxSize = 2048;
+	static constexpr int MaxTextureSlots = 16;
+
+private:
+	static constexpr std::size_t PrimitivesPerChunk = 2048;
+	static constexpr std::size_t MaxChunks = 64;
+	static constexpr int MaxValues = 1 + SoftwareProgram::MaxVaryings; // 1/w, then each varying divided by w
+
+	struct ShadedVertex
+	{
+		glm::vec4 position; // Clip space
+		float varyings[SoftwareProgram::MaxVaryings];
+	};
+
+	struct ScreenVertex
+	{
+		int32_t x, y; // Window coordinates in subpixels
+		float values[MaxValues]; // Interpolated linearly in screen space
+	};
+
+	struct Triangle
+	{
+		int minX, minY, maxX, maxY; // Pixels, inclusive, within the viewport
+		int64_t edgeOrigin[3]; // Edge functions at the center of pixel (0, 0), fill rule bias included
+		int32_t edgeStepX[3];
+		int32_t edgeStepY[3];
+		float inverseArea;
+		// Each value is base + w1 * delta1 + w2 * delta2, with w1 and w2 the barycentric weights of vertices 1 and 2
+		float base[MaxValues];
+		float delta1[MaxValues];
+		float delta2[MaxValues];
+	};
+
+	int m_Width;
+	int m_Height;
+	int m_TileColumns;
+	int m_TileRows;
+	std::vector<uint32_t> m_ColorBuffer; // RGBA8, bottom row first like GL's
+	uint32_t m_ClearColor;
+
+	const Texture* m_Textures[MaxTextureSlots];
+
+	/* Per draw, kept around so steady-state drawing doesn't allocate */
+	std::vector<ShadedVertex> m_Vertices;
+	std::vector<std::vector<Triangle>> m_ChunkTriangles;
+	std::vector<std::vector<uint32_t>> m_ChunkBins; // [chunk * tile count + tile]: indices into the chunk's triangles
+
+	uint64_t m_DrawCount;
+	std::atomic<uint64_t> m_TriangleCount; // Set up (after clipping, lines count twice)
+	std::atomic<uint64_t> m_FragmentCount; // Covered pixels shaded
+
+	SoftwareRasterizer();
+
+public:
+	static SoftwareRasterizer& Get();
+
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+	// Sizes the color buffer (clamped to `MaxSize`), which is also the viewport
+	void Resize(int width, int height);
+	void SetClearColor(float r, float g, float b, float a);
+	void Clear();
+
+	void BindTexture(unsigned int slot, const Texture* texture);
+	// Unbinds it from whichever slot it's bound to
+	void UnbindTexture(const Texture* texture);
+
+	// Indexed when `ib` is set, vertices 0 to `vertexCount` - 1 otherwise. GL_TRIANGLES, GL_TRIANGLE_STRIP and GL_LINES,
+	// blended as GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA (what the application sets up), without depth test
+	void Draw(const VertexArray& va, const IndexBuffer* ib, unsigned int vertexCount, unsigned int instanceCount, const Shader& shader, GLenum mode);
+
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline const uint32_t* GetPixels() const { return m_ColorBuffer.data(); }
+
+	inline uint64_t GetDrawCount() const { return m_DrawCount; }
+	inline uint64_t GetTriangleCount() const { return m_TriangleCount.load(std::memory_order_relaxed); }
+	inline uint64_t GetFragmentCount() const { return m_FragmentCount.load(std::memory_order_relaxed); }
+	void ResetStats();
+
+private:
+	static ShadedVertex Lerp(const ShadedVertex& a, const ShadedVertex& b, float t, int varyingCount);
+	void ShadeVertices(const VertexArray& va, std::size_t vertexCount, unsigned int instance, const SoftwareProgram& program, const SoftwareUniforms& uniforms);
+	// Clips, sets up and bins primitives [begin; end) into the chunk's triangles and bins
+	void ProcessPrimitives(std::size_t chunk, std::size_t begin, std::size_t end, const IndexBuffer* ib, GLenum mode, int varyingCount);
+	void ClipTriangle(std::size_t chunk, const ShadedVertex& a, const ShadedVertex& b, const ShadedVertex& c, int varyingCount);
+	// As a 1 pixel wide quad (two triangles)
+	void ClipLine(std::size_t chunk, const ShadedVertex& a, const ShadedVertex& b, int varyingCount);
+	ScreenVertex Project(const ShadedVertex& vertex, int varyingCount) const;
+	ScreenVertex SnapToSubpixels(float x, float y, const float* values, int valueCount) const;
+	void SetupTriangle(std::size_t chunk, const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, int varyingCount);
+	void RasterizeTile(int tile, std::size_t chunkCount, const SoftwareProgram& program, const SoftwareUniforms& uniforms);
+	void ShadeBlock(const Triangle& triangle, const float* w1, const float* w2, int mask, uint32_t* pixels, int varyingCount, const SoftwareProgram& program, const SoftwareUniforms& uniforms) const;
+};
@@ -1,12 +1,42 @@
 #include "Texture.h"
+#include "RenderBackend.h"
+#include "RenderStats.h"
+#include "SoftwareRasterizer.h"
 #include "stb_image/stb_image.h"
 
-Texture::Texture(const std::string& filepath)
+Texture::Texture(const std::string& filepath, const TextureParams& params)
 	: m_RendererID(0), m_Filepath(filepath), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
 {
 	stbi_set_flip_vertically_on_load(1); // Flip vertically since (0; 0) is the bottom left corner for OpenGL
 	m_LocalBuffer = stbi_load(filepath.c_str(), &m_Width, &m_Height, &m_BPP, 4); // 4 is 'desired channels' (RGBA)
 
+	Upload(m_LocalBuffer, params);
+
+	if (m_LocalBuffer)
+		stbi_image_free(m_LocalBuffer);
+	m_LocalBuffer = nullptr;
+}
+
+Texture::Texture(const std::string& name, const unsigned char* pixels, int width, int height, const TextureParams& params)
+	: m_RendererID(0), m_Filepath(name), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(4)
+{
+	Upload(pixels, params);
+}
+
+void Texture::Upload(const unsigned char* pixels, const TextureParams& params)
+{
+	if (IsSoftwareRendering())
+	{
+		/* Missing files come out as an empty texture, which samples as transparent black */
+		m_Params = params;
+		if (pixels)
+			m_Pixels.assign(pixels, pixels + GetGpuSize());
+		else
+			m_Width = m_Height = 0;
+		m_Memory.Track(GpuMemoryCategory::TEXTURE, GetGpuSize());
+		return;
+	}
+
 	/* Generate and bind a new texture */
 	GL_CALL(glGenTextures(1, &m_RendererID));
 	GL_CALL(glBindTexture(GL_TEXTURE_2D, m_RendererID));
@@ -17,26 +47,26 @@ Texture::Texture(const std::string& filepath)
 	GL_CALL(glTexParameteri(
 		GL_TEXTURE_2D, // Target
 		GL_TEXTURE_MIN_FILTER, // Parameter name
-		GL_LINEAR // Parameter value
+		params.filter // Parameter value
 	));
 
 	// Magnification filter - for areas that are larger than the texture size
 	GL_CALL(glTexParameteri(
 		GL_TEXTURE_2D,
 		GL_TEXTURE_MAG_FILTER,
-		GL_LINEAR
+		params.filter
 	));
 
 	// Wrap params
 	GL_CALL(glTexParameteri(
 		GL_TEXTURE_2D,
 		GL_TEXTURE_WRAP_S, // Horizontal wrap
-		GL_CLAMP_TO_EDGE
+		params.wrap
 	));
 	GL_CALL(glTexParameteri(
 		GL_TEXTURE_2D,
-		GL_TEXTURE_WRAP_S, // Vertical wrap
-		GL_CLAMP_TO_EDGE
+		GL_TEXTURE_WRAP_T, // Vertical wrap
+		params.wrap
 	));
 
 	/* Send to OpenGL our data */
@@ -49,28 +79,52 @@ Texture::Texture(const std::string& filepath)
 		0, // Border
 		GL_RGBA, // Format - the format of the data we're providing to OpenGL
 		GL_UNSIGNED_BYTE, // Type
-		m_LocalBuffer // Pointer to 'pixels' = Our data :)
+		pixels // Pointer to 'pixels' = Our data :)
 	));
 
 	/* Unbind texture */
 	GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
-	
-	if (m_LocalBuffer)
-		stbi_image_free(m_LocalBuffer);
+	RenderStats::Get().ForgetTextureBindings();
+
+	m_Memory.Track(GpuMemoryCategory::TEXTURE, GetGpuSize());
+	RenderStats::Get().Add(RenderCounter::RESOURCES_CREATED);
+	if (pixels)
+		RenderStats::Get().Add(RenderCounter::TEXTURE_BYTES, GetGpuSize());
 }
 
 Texture::~Texture()
 {
+	if (IsSoftwareRendering())
+	{
+		SoftwareRasterizer::Get().UnbindTexture(this);
+		return;
+	}
+
 	GL_CALL(glDeleteTextures(1, &m_RendererID));
+	RenderStats::Get().Add(RenderCounter::RESOURCES_DESTROYED);
 }
 
 void Texture::Bind(unsigned int slot) const
 {
+	if (IsSoftwareRendering())
+	{
+		SoftwareRasterizer::Get().BindTexture(slot, this);
+		return;
+	}
+
 	GL_CALL(glActiveTexture(GL_TEXTURE0 + slot));
 	GL_CALL(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	RenderStats::Get().OnTextureBound(slot, m_RendererID);
 }
 
 void Texture::Unbind() const
 {
+	if (IsSoftwareRendering())
+	{
+		SoftwareRasterizer::Get().UnbindTexture(this);
+		return;
+	}
+
 	GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+	RenderStats::Get().ForgetTextureBindings();
 }
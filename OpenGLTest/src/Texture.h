@@ -1,6 +1,16 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 #include "GLHandleError.h"
+#include "GpuMemoryTracker.h"
+
+struct TextureParams
+{
+	GLenum filter = GL_LINEAR; // Used for both minification and magnification
+	GLenum wrap = GL_CLAMP_TO_EDGE; // Used for both horizontal and vertical wrap
+};
 
 class Texture
 {
@@ -9,9 +19,16 @@ private:
 	unsigned int m_RendererID;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	GpuAllocation m_Memory;
+
+	/* Software backend only */
+	TextureParams m_Params;
+	std::vector<unsigned char> m_Pixels; // RGBA8, bottom row first
 
 public:
-	Texture(const std::string& filepath);
+	Texture(const std::string& filepath, const TextureParams& params = TextureParams());
+	// Uploads already decoded RGBA8 pixels, bottom row first (e.g. memory-mapped from an asset pack)
+	Texture(const std::string& name, const unsigned char* pixels, int width, int height, const TextureParams& params = TextureParams());
 	~Texture();
 
 	void Bind(unsigned int slot = 0) const;
@@ -19,4 +36,12 @@ public:
 
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+	inline const TextureParams& GetParams() const { return m_Params; }
+	inline const unsigned char* GetPixels() const { return m_Pixels.data(); }
+
+	// Bytes taken by the texture in GPU memory (stored as RGBA8)
+	inline std::size_t GetGpuSize() const { return (std::size_t)m_Width * m_Height * 4; }
+
+private:
+	void Upload(const unsigned char* pixels, const TextureParams& params);
 };
@@ -0,0 +1,863 @@
+/* Replayed calls go straight to GL, not through the recording hooks */
+#define GL_TRACE_NO_HOOKS
+
+#include "TraceReplayer.h"
+#include "GLHandleError.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+TraceReplayer::TraceReplayer(const ReplayOptions& options, const unsigned char* commands, std::size_t size)
+	: m_Options(options), m_Cursor(commands), m_End(commands + size), m_IsTruncated(false), m_CurrentProgram(0), m_ActiveTexture(GL_TEXTURE0)
+{
+}
+
+const unsigned char* TraceReplayer::ReadPayload(uint32_t& size)
+{
+	size = Read<uint32_t>();
+	if ((std::size_t)(m_End - m_Cursor) < size)
+	{
+		m_IsTruncated = true;
+		m_Cursor = m_End;
+		size = 0;
+	}
+
+	const unsigned char* data = size > 0 ? m_Cursor : nullptr;
+	m_Cursor += size;
+	return data;
+}
+
+GLuint TraceReplayer::Map(const std::unordered_map<GLuint, GLuint>& names, GLuint name)
+{
+	const auto it = names.find(name);
+	return it != names.end() ? it->second : name;
+}
+
+void TraceReplayer::GenNames(std::unordered_map<GLuint, GLuint>& names, void (*generate)(GLsizei, GLuint*))
+{
+	const GLsizei count = Read<GLsizei>();
+	uint32_t size;
+	const unsigned char* recorded = ReadPayload(size);
+	if (count <= 0 || size != count * sizeof(GLuint))
+		return;
+
+	std::vector<GLuint> generated(count);
+	generate(count, generated.data());
+	for (GLsizei i = 0; i < count; i++)
+	{
+		GLuint name;
+		std::memcpy(&name, recorded + i * sizeof(GLuint), sizeof(GLuint));
+		names[name] = generated[i];
+	}
+}
+
+void TraceReplayer::DeleteNames(std::unordered_map<GLuint, GLuint>& names, void (*destroy)(GLsizei, const GLuint*), StateKind kind)
+{
+	const GLsizei count = Read<GLsizei>();
+	uint32_t size;
+	const unsigned char* recorded = ReadPayload(size);
+	if (count <= 0 || size != count * sizeof(GLuint))
+		return;
+
+	std::vector<GLuint> mapped(count);
+	for (GLsizei i = 0; i < count; i++)
+	{
+		GLuint name;
+		std::memcpy(&name, recorded + i * sizeof(GLuint), sizeof(GLuint));
+		mapped[i] = Map(names, name);
+		names.erase(name);
+		ForgetState(kind, name);
+	}
+	destroy(count, mapped.data());
+}
+
+GLint TraceReplayer::MapUniformLocation(GLint location) const
+{
+	const auto it = m_UniformLocations.find(((uint64_t)m_CurrentProgram << 32) | (uint32_t)location);
+	return it != m_UniformLocations.end() ? it->second : location;
+}
+
+bool TraceReplayer::IsRedundant(uint64_t slot, uint64_t value)
+{
+	if (!m_Options.isRedundantStateStripped)
+		return false;
+
+	const auto [it, isInserted] = m_State.try_emplace(slot, value);
+	if (!isInserted && it->second == value)
+	{
+		m_Frame.strippedCount++;
+		return true;
+	}
+
+	it->second = value;
+	return false;
+}
+
+void TraceReplayer::ForgetState(StateKind kind, GLuint name)
+{
+	/* Deleted objects get unbound from wherever they were bound */
+	for (auto it = m_State.begin(); it != m_State.end();)
+	{
+		if ((StateKind)(it->first >> 56) == kind && it->second == name)
+			it = m_State.erase(it);
+		else
+			++it;
+	}
+
+	if (kind == StateKind::PROGRAM)
+	{
+		for (auto it = m_UniformValues.begin(); it != m_UniformValues.end();)
+		{
+			if ((GLuint)(it->first >> 32) == name)
+				it = m_UniformValues.erase(it);
+			else
+				++it;
+		}
+	}
+}
+
+bool TraceReplayer::IsUniformRedundant(GLint location, TraceCommand command, const void* values, uint32_t size)
+{
+	if (!m_Options.isRedundantStateStripped || size > sizeof(UniformValue::bytes))
+		return false;
+
+	UniformValue& current = m_UniformValues[((uint64_t)m_CurrentProgram << 32) | (uint32_t)location];
+	if (current.command == command && current.size == size && std::memcmp(current.bytes, values, size) == 0)
+	{
+		m_Frame.strippedCount++;
+		return true;
+	}
+
+	current.command = command;
+	current.size = size;
+	std::memcpy(current.bytes, values, size);
+	return false;
+}
+
+bool TraceReplayer::ReplayFrame()
+{
+	while (m_Cursor < m_End)
+	{
+		const TraceCommand command = Read<TraceCommand>();
+		if (command == TraceCommand::FRAME_END)
+			return true;
+
+		m_Frame.callCount++;
+		Execute(command);
+		if (m_IsTruncated)
+			break;
+	}
+
+	return false;
+}
+
+void TraceReplayer::Execute(TraceCommand command)
+{
+	switch (command)
+	{
+		/* Buffers */
+		case TraceCommand::GEN_BUFFERS:
+			GenNames(m_Buffers, [](GLsizei n, GLuint* names) { glGenBuffers(n, names); });
+			break;
+		case TraceCommand::DELETE_BUFFERS:
+			DeleteNames(m_Buffers, [](GLsizei n, const GLuint* names) { glDeleteBuffers(n, names); }, StateKind::BUFFER);
+			break;
+		case TraceCommand::BIND_BUFFER:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLuint buffer = Read<GLuint>();
+			if (!IsRedundant(StateSlot(StateKind::BUFFER, target), buffer))
+				glBindBuffer(target, Map(m_Buffers, buffer));
+			break;
+		}
+		case TraceCommand::BIND_BUFFER_BASE:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLuint index = Read<GLuint>();
+			const GLuint buffer = Read<GLuint>();
+			glBindBufferBase(target, index, Map(m_Buffers, buffer));
+			m_State[StateSlot(StateKind::BUFFER, target)] = buffer; // Also binds it to the target
+			break;
+		}
+		case TraceCommand::BUFFER_DATA:
+		{
+			const GLenum target = Read<GLenum>();
+			const int64_t size = Read<int64_t>();
+			const GLenum usage = Read<GLenum>();
+			uint32_t payloadSize;
+			const unsigned char* data = ReadPayload(payloadSize);
+			glBufferData(target, (GLsizeiptr)size, data, usage);
+			break;
+		}
+		case TraceCommand::BUFFER_SUB_DATA:
+		{
+			const GLenum target = Read<GLenum>();
+			const int64_t offset = Read<int64_t>();
+			uint32_t size;
+			const unsigned char* data = ReadPayload(size);
+			glBufferSubData(target, (GLintptr)offset, size, data);
+			break;
+		}
+		case TraceCommand::COPY_BUFFER_SUB_DATA:
+		{
+			const GLenum readTarget = Read<GLenum>();
+			const GLenum writeTarget = Read<GLenum>();
+			const int64_t readOffset = Read<int64_t>();
+			const int64_t writeOffset = Read<int64_t>();
+			const int64_t size = Read<int64_t>();
+			glCopyBufferSubData(readTarget, writeTarget, (GLintptr)readOffset, (GLintptr)writeOffset, (GLsizeiptr)size);
+			break;
+		}
+		case TraceCommand::GET_BUFFER_SUB_DATA:
+		{
+			const GLenum target = Read<GLenum>();
+			const int64_t offset = Read<int64_t>();
+			const int64_t size = Read<int64_t>();
+			m_Scratch.resize(std::max<std::size_t>(m_Scratch.size(), (std::size_t)size));
+			glGetBufferSubData(target, (GLintptr)offset, (GLsizeiptr)size, m_Scratch.data());
+			break;
+		}
+
+		/* Vertex arrays */
+		case TraceCommand::GEN_VERTEX_ARRAYS:
+			GenNames(m_VertexArrays, [](GLsizei n, GLuint* names) { glGenVertexArrays(n, names); });
+			break;
+		case TraceCommand::DELETE_VERTEX_ARRAYS:
+			DeleteNames(m_VertexArrays, [](GLsizei n, const GLuint* names) { glDeleteVertexArrays(n, names); }, StateKind::VERTEX_ARRAY);
+			m_State.erase(StateSlot(StateKind::BUFFER, GL_ELEMENT_ARRAY_BUFFER));
+			break;
+		case TraceCommand::BIND_VERTEX_ARRAY:
+		{
+			const GLuint array = Read<GLuint>();
+			if (!IsRedundant(StateSlot(StateKind::VERTEX_ARRAY), array))
+			{
+				glBindVertexArray(Map(m_VertexArrays, array));
+				m_State.erase(StateSlot(StateKind::BUFFER, GL_ELEMENT_ARRAY_BUFFER)); // Part of the vertex array's state
+			}
+			break;
+		}
+		case TraceCommand::ENABLE_VERTEX_ATTRIB_ARRAY:
+			glEnableVertexAttribArray(Read<GLuint>());
+			break;
+		case TraceCommand::VERTEX_ATTRIB_POINTER:
+		{
+			const GLuint index = Read<GLuint>();
+			const GLint size = Read<GLint>();
+			const GLenum type = Read<GLenum>();
+			const GLboolean normalized = Read<GLboolean>();
+			const GLsizei stride = Read<GLsizei>();
+			const uint64_t offset = Read<uint64_t>();
+			glVertexAttribPointer(index, size, type, normalized, stride, (const void*)(uintptr_t)offset);
+			break;
+		}
+		case TraceCommand::VERTEX_ATTRIB_I_POINTER:
+		{
+			const GLuint index = Read<GLuint>();
+			const GLint size = Read<GLint>();
+			const GLenum type = Read<GLenum>();
+			const GLsizei stride = Read<GLsizei>();
+			const uint64_t offset = Read<uint64_t>();
+			glVertexAttribIPointer(index, size, type, stride, (const void*)(uintptr_t)offset);
+			break;
+		}
+		case TraceCommand::VERTEX_ATTRIB_DIVISOR:
+		{
+			const GLuint index = Read<GLuint>();
+			const GLuint divisor = Read<GLuint>();
+			glVertexAttribDivisor(index, divisor);
+			break;
+		}
+
+		/* Textures */
+		case TraceCommand::GEN_TEXTURES:
+			GenNames(m_Textures, [](GLsizei n, GLuint* names) { glGenTextures(n, names); });
+			break;
+		case TraceCommand::DELETE_TEXTURES:
+			DeleteNames(m_Textures, [](GLsizei n, const GLuint* names) { glDeleteTextures(n, names); }, StateKind::TEXTURE);
+			break;
+		case TraceCommand::BIND_TEXTURE:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLuint texture = Read<GLuint>();
+			if (!IsRedundant(StateSlot(StateKind::TEXTURE, m_ActiveTexture - GL_TEXTURE0, target), texture))
+				glBindTexture(target, Map(m_Textures, texture));
+			break;
+		}
+		case TraceCommand::ACTIVE_TEXTURE:
+			m_ActiveTexture = Read<GLenum>();
+			if (!IsRedundant(StateSlot(StateKind::ACTIVE_TEXTURE), m_ActiveTexture))
+				glActiveTexture(m_ActiveTexture);
+			break;
+		case TraceCommand::TEX_PARAMETER_I:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLenum name = Read<GLenum>();
+			const GLint param = Read<GLint>();
+			glTexParameteri(target, name, param);
+			break;
+		}
+		case TraceCommand::TEX_IMAGE_2D:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLint level = Read<GLint>();
+			const GLint internalFormat = Read<GLint>();
+			const GLsizei width = Read<GLsizei>();
+			const GLsizei height = Read<GLsizei>();
+			const GLint border = Read<GLint>();
+			const GLenum format = Read<GLenum>();
+			const GLenum type = Read<GLenum>();
+			uint32_t size;
+			const unsigned char* pixels = ReadPayload(size);
+			glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+			break;
+		}
+		case TraceCommand::PIXEL_STORE_I:
+		{
+			const GLenum name = Read<GLenum>();
+			const GLint param = Read<GLint>();
+			if (!IsRedundant(StateSlot(StateKind::PIXEL_STORE, name), (uint32_t)param))
+				glPixelStorei(name, param);
+			break;
+		}
+
+		/* Framebuffers */
+		case TraceCommand::GEN_FRAMEBUFFERS:
+			GenNames(m_Framebuffers, [](GLsizei n, GLuint* names) { glGenFramebuffers(n, names); });
+			break;
+		case TraceCommand::DELETE_FRAMEBUFFERS:
+			DeleteNames(m_Framebuffers, [](GLsizei n, const GLuint* names) { glDeleteFramebuffers(n, names); }, StateKind::FRAMEBUFFER);
+			break;
+		case TraceCommand::BIND_FRAMEBUFFER:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLuint framebuffer = Read<GLuint>();
+
+			/* GL_FRAMEBUFFER is both the read and the draw one */
+			bool isRedundant;
+			if (target == GL_FRAMEBUFFER)
+			{
+				const bool isReadRedundant = IsRedundant(StateSlot(StateKind::FRAMEBUFFER, GL_READ_FRAMEBUFFER), framebuffer);
+				const bool isDrawRedundant = IsRedundant(StateSlot(StateKind::FRAMEBUFFER, GL_DRAW_FRAMEBUFFER), framebuffer);
+				isRedundant = isReadRedundant && isDrawRedundant;
+				m_Frame.strippedCount -= (isReadRedundant ? 1 : 0) + (isDrawRedundant ? 1 : 0) - (isRedundant ? 1 : 0);
+			}
+			else
+				isRedundant = IsRedundant(StateSlot(StateKind::FRAMEBUFFER, target), framebuffer);
+
+			if (!isRedundant)
+				glBindFramebuffer(target, Map(m_Framebuffers, framebuffer));
+			break;
+		}
+		case TraceCommand::FRAMEBUFFER_TEXTURE_2D:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLenum attachment = Read<GLenum>();
+			const GLenum textureTarget = Read<GLenum>();
+			const GLuint texture = Read<GLuint>();
+			const GLint level = Read<GLint>();
+			glFramebufferTexture2D(target, attachment, textureTarget, Map(m_Textures, texture), level);
+			break;
+		}
+		case TraceCommand::FRAMEBUFFER_RENDERBUFFER:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLenum attachment = Read<GLenum>();
+			const GLenum renderbufferTarget = Read<GLenum>();
+			const GLuint renderbuffer = Read<GLuint>();
+			glFramebufferRenderbuffer(target, attachment, renderbufferTarget, Map(m_Renderbuffers, renderbuffer));
+			break;
+		}
+		case TraceCommand::BLIT_FRAMEBUFFER:
+		{
+			GLint coordinates[8];
+			for (GLint& coordinate : coordinates)
+				coordinate = Read<GLint>();
+			const GLbitfield mask = Read<GLbitfield>();
+			const GLenum filter = Read<GLenum>();
+			glBlitFramebuffer(coordinates[0], coordinates[1], coordinates[2], coordinates[3], coordinates[4], coordinates[5], coordinates[6], coordinates[7], mask, filter);
+			break;
+		}
+		case TraceCommand::GEN_RENDERBUFFERS:
+			GenNames(m_Renderbuffers, [](GLsizei n, GLuint* names) { glGenRenderbuffers(n, names); });
+			break;
+		case TraceCommand::DELETE_RENDERBUFFERS:
+			DeleteNames(m_Renderbuffers, [](GLsizei n, const GLuint* names) { glDeleteRenderbuffers(n, names); }, StateKind::RENDERBUFFER);
+			break;
+		case TraceCommand::BIND_RENDERBUFFER:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLuint renderbuffer = Read<GLuint>();
+			if (!IsRedundant(StateSlot(StateKind::RENDERBUFFER), renderbuffer))
+				glBindRenderbuffer(target, Map(m_Renderbuffers, renderbuffer));
+			break;
+		}
+		case TraceCommand::RENDERBUFFER_STORAGE_MULTISAMPLE:
+		{
+			const GLenum target = Read<GLenum>();
+			const GLsizei samples = Read<GLsizei>();
+			const GLenum internalFormat = Read<GLenum>();
+			const GLsizei width = Read<GLsizei>();
+			const GLsizei height = Read<GLsizei>();
+			glRenderbufferStorageMultisample(target, samples, internalFormat, width, height);
+			break;
+		}
+
+		/* Shaders and programs */
+		case TraceCommand::CREATE_SHADER:
+		{
+			const GLenum type = Read<GLenum>();
+			const GLuint shader = Read<GLuint>();
+			m_Shaders[shader] = glCreateShader(type);
+			break;
+		}
+		case TraceCommand::SHADER_SOURCE:
+		{
+			const GLuint shader = Read<GLuint>();
+			uint32_t size;
+			const GLchar* source = (const GLchar*)ReadPayload(size);
+			const GLint length = (GLint)size;
+			glShaderSource(Map(m_Shaders, shader), 1, &source, &length);
+			break;
+		}
+		case TraceCommand::COMPILE_SHADER:
+			glCompileShader(Map(m_Shaders, Read<GLuint>()));
+			break;
+		case TraceCommand::DELETE_SHADER:
+		{
+			const GLuint shader = Read<GLuint>();
+			glDeleteShader(Map(m_Shaders, shader));
+			m_Shaders.erase(shader);
+			break;
+		}
+		case TraceCommand::CREATE_PROGRAM:
+			m_Programs[Read<GLuint>()] = glCreateProgram();
+			break;
+		case TraceCommand::ATTACH_SHADER:
+		{
+			const GLuint program = Read<GLuint>();
+			const GLuint shader = Read<GLuint>();
+			glAttachShader(Map(m_Programs, program), Map(m_Shaders, shader));
+			break;
+		}
+		case TraceCommand::DETACH_SHADER:
+		{
+			const GLuint program = Read<GLuint>();
+			const GLuint shader = Read<GLuint>();
+			glDetachShader(Map(m_Programs, program), Map(m_Shaders, shader));
+			break;
+		}
+		case TraceCommand::TRANSFORM_FEEDBACK_VARYINGS:
+		{
+			const GLuint program = Read<GLuint>();
+			const GLenum bufferMode = Read<GLenum>();
+			const GLsizei count = Read<GLsizei>();
+
+			std::vector<std::string> names(std::max(count, 0));
+			std::vector<const GLchar*> varyings(names.size());
+			for (std::size_t i = 0; i < names.size(); i++)
+			{
+				uint32_t size;
+				const GLchar* name = (const GLchar*)ReadPayload(size);
+				names[i].assign(name ? name : "", size);
+				varyings[i] = names[i].c_str();
+			}
+			glTransformFeedbackVaryings(Map(m_Programs, program), count, varyings.data(), bufferMode);
+			break;
+		}
+		case TraceCommand::LINK_PROGRAM:
+		{
+			const GLuint program = Read<GLuint>();
+			glLinkProgram(Map(m_Programs, program));
+			ForgetState(StateKind::PROGRAM, program); // Uniforms go back to their defaults
+			break;
+		}
+		case TraceCommand::DELETE_PROGRAM:
+		{
+			const GLuint program = Read<GLuint>();
+			glDeleteProgram(Map(m_Programs, program));
+			m_Programs.erase(program);
+			ForgetState(StateKind::PROGRAM, program);
+			break;
+		}
+		case TraceCommand::USE_PROGRAM:
+			m_CurrentProgram = Read<GLuint>();
+			if (!IsRedundant(StateSlot(StateKind::PROGRAM), m_CurrentProgram))
+				glUseProgram(Map(m_Programs, m_CurrentProgram));
+			break;
+		case TraceCommand::GET_UNIFORM_LOCATION:
+		{
+			const GLuint program = Read<GLuint>();
+			const GLint location = Read<GLint>();
+			uint32_t size;
+			const char* name = (const char*)ReadPayload(size);
+			const std::string nullTerminatedName(name ? name : "", size);
+			m_UniformLocations[((uint64_t)program << 32) | (uint32_t)location] = glGetUniformLocation(Map(m_Programs, program), nullTerminatedName.c_str());
+			break;
+		}
+
+		/* Uniforms (copied out of the trace, which has no alignment) */
+		case TraceCommand::UNIFORM_1I:
+		{
+			const GLint location = Read<GLint>();
+			const GLint value = Read<GLint>();
+			if (!IsUniformRedundant(location, command, &value, sizeof(value)))
+				glUniform1i(MapUniformLocation(location), value);
+			break;
+		}
+		case TraceCommand::UNIFORM_1UI:
+		{
+			const GLint location = Read<GLint>();
+			const GLuint value = Read<GLuint>();
+			if (!IsUniformRedundant(location, command, &value, sizeof(value)))
+				glUniform1ui(MapUniformLocation(location), value);
+			break;
+		}
+		case TraceCommand::UNIFORM_1F:
+		case TraceCommand::UNIFORM_2F:
+		case TraceCommand::UNIFORM_3F:
+		case TraceCommand::UNIFORM_4F:
+		{
+			const GLint location = Read<GLint>();
+			const int count = 1 + (int)command - (int)TraceCommand::UNIFORM_1F;
+			float values[4] = {};
+			for (int i = 0; i < count; i++)
+				values[i] = Read<float>();
+			if (IsUniformRedundant(location, command, values, count * sizeof(float)))
+				break;
+
+			const GLint mappedLocation = MapUniformLocation(location);
+			switch (count)
+			{
+				case 1: glUniform1f(mappedLocation, values[0]); break;
+				case 2: glUniform2f(mappedLocation, values[0], values[1]); break;
+				case 3: glUniform3f(mappedLocation, values[0], values[1], values[2]); break;
+				default: glUniform4f(mappedLocation, values[0], values[1], values[2], values[3]); break;
+			}
+			break;
+		}
+		case TraceCommand::UNIFORM_4FV:
+		case TraceCommand::UNIFORM_MATRIX_4FV:
+		{
+			const GLint location = Read<GLint>();
+			const GLboolean transpose = command == TraceCommand::UNIFORM_MATRIX_4FV ? Read<GLboolean>() : GL_FALSE;
+			uint32_t size;
+			const unsigned char* data = ReadPayload(size);
+			if (IsUniformRedundant(location, command, data, size))
+				break;
+
+			std::vector<float> values(size / sizeof(float));
+			if (size > 0)
+				std::memcpy(values.data(), data, values.size() * sizeof(float));
+
+			if (command == TraceCommand::UNIFORM_4FV)
+				glUniform4fv(MapUniformLocation(location), (GLsizei)(values.size() / 4), values.data());
+			else
+				glUniformMatrix4fv(MapUniformLocation(location), (GLsizei)(values.size() / 16), transpose, values.data());
+			break;
+		}
+
+		/* Fixed-function state */
+		case TraceCommand::ENABLE:
+		case TraceCommand::DISABLE:
+		{
+			const GLenum capability = Read<GLenum>();
+			const bool isEnabled = command == TraceCommand::ENABLE;
+			if (IsRedundant(StateSlot(StateKind::CAPABILITY, capability), isEnabled))
+				break;
+
+			if (isEnabled)
+				glEnable(capability);
+			else
+				glDisable(capability);
+			break;
+		}
+		case TraceCommand::BLEND_FUNC:
+		{
+			const GLenum sourceFactor = Read<GLenum>();
+			const GLenum destinationFactor = Read<GLenum>();
+			if (!IsRedundant(StateSlot(StateKind::BLEND_FUNC), ((uint64_t)sourceFactor << 32) | destinationFactor))
+				glBlendFunc(sourceFactor, destinationFactor);
+			break;
+		}
+		case TraceCommand::VIEWPORT:
+		{
+			const GLint x = Read<GLint>();
+			const GLint y = Read<GLint>();
+			const GLsizei width = Read<GLsizei>();
+			const GLsizei height = Read<GLsizei>();
+			const bool isOriginRedundant = IsRedundant(StateSlot(StateKind::VIEWPORT, 0), ((uint64_t)(uint32_t)x << 32) | (uint32_t)y);
+			const bool isSizeRedundant = IsRedundant(StateSlot(StateKind::VIEWPORT, 1), ((uint64_t)(uint32_t)width << 32) | (uint32_t)height);
+			m_Frame.strippedCount -= (isOriginRedundant ? 1 : 0) + (isSizeRedundant ? 1 : 0) - (isOriginRedundant && isSizeRedundant ? 1 : 0);
+			if (!isOriginRedundant || !isSizeRedundant)
+				glViewport(x, y, width, height);
+			break;
+		}
+		case TraceCommand::CLEAR_COLOR:
+		{
+			float color[4];
+			for (float& channel : color)
+				channel = Read<float>();
+
+			uint64_t packed[2];
+			std::memcpy(packed, color, sizeof(color));
+			const bool isRedRedundant = IsRedundant(StateSlot(StateKind::CLEAR_COLOR, 0), packed[0]);
+			const bool isBlueRedundant = IsRedundant(StateSlot(StateKind::CLEAR_COLOR, 1), packed[1]);
+			m_Frame.strippedCount -= (isRedRedundant ? 1 : 0) + (isBlueRedundant ? 1 : 0) - (isRedRedundant && isBlueRedundant ? 1 : 0);
+			if (!isRedRedundant || !isBlueRedundant)
+				glClearColor(color[0], color[1], color[2], color[3]);
+			break;
+		}
+		case TraceCommand::CLEAR:
+			glClear(Read<GLbitfield>());
+			break;
+
+		/* Draws and dispatches */
+		case TraceCommand::DRAW_ARRAYS:
+		{
+			const GLenum mode = Read<GLenum>();
+			const GLint first = Read<GLint>();
+			const GLsizei count = Read<GLsizei>();
+			glDrawArrays(mode, first, count);
+			m_Frame.drawCount++;
+			break;
+		}
+		case TraceCommand::DRAW_ARRAYS_INSTANCED:
+		{
+			const GLenum mode = Read<GLenum>();
+			const GLint first = Read<GLint>();
+			const GLsizei count = Read<GLsizei>();
+			const GLsizei instanceCount = Read<GLsizei>();
+			glDrawArraysInstanced(mode, first, count, instanceCount);
+			m_Frame.drawCount++;
+			break;
+		}
+		case TraceCommand::DRAW_ELEMENTS:
+		{
+			const GLenum mode = Read<GLenum>();
+			const GLsizei count = Read<GLsizei>();
+			const GLenum type = Read<GLenum>();
+			const uint64_t offset = Read<uint64_t>();
+			glDrawElements(mode, count, type, (const void*)(uintptr_t)offset);
+			m_Frame.drawCount++;
+			break;
+		}
+		case TraceCommand::DRAW_ELEMENTS_BASE_VERTEX:
+		{
+			const GLenum mode = Read<GLenum>();
+			const GLsizei count = Read<GLsizei>();
+			const GLenum type = Read<GLenum>();
+			const uint64_t offset = Read<uint64_t>();
+			const GLint baseVertex = Read<GLint>();
+			glDrawElementsBaseVertex(mode, count, type, (const void*)(uintptr_t)offset, baseVertex);
+			m_Frame.drawCount++;
+			break;
+		}
+		case TraceCommand::MULTI_DRAW_ELEMENTS_INDIRECT:
+		{
+			const GLenum mode = Read<GLenum>();
+			const GLenum type = Read<GLenum>();
+			const uint64_t offset = Read<uint64_t>();
+			const GLsizei drawCount = Read<GLsizei>();
+			const GLsizei stride = Read<GLsizei>();
+			glMultiDrawElementsIndirect(mode, type, (const void*)(uintptr_t)offset, drawCount, stride);
+			m_Frame.drawCount++;
+			break;
+		}
+		case TraceCommand::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT:
+		{
+			const GLenum mode = Read<GLenum>();
+			const GLenum type = Read<GLenum>();
+			const uint64_t offset = Read<uint64_t>();
+			const int64_t drawCountOffset = Read<int64_t>();
+			const GLsizei maxDrawCount = Read<GLsizei>();
+			const GLsizei stride = Read<GLsizei>();
+			if (GLEW_VERSION_4_6)
+			{
+				glMultiDrawElementsIndirectCount(mode, type, (const void*)(uintptr_t)offset, (GLintptr)drawCountOffset, maxDrawCount, stride);
+			}
+			else
+			{
+				glMultiDrawElementsIndirectCountARB(mode, type, (const void*)(uintptr_t)offset, (GLintptr)drawCountOffset, maxDrawCount, stride);
+			}
+			m_Frame.drawCount++;
+			break;
+		}
+		case TraceCommand::DISPATCH_COMPUTE:
+		{
+			const GLuint x = Read<GLuint>();
+			const GLuint y = Read<GLuint>();
+			const GLuint z = Read<GLuint>();
+			glDispatchCompute(x, y, z);
+			m_Frame.drawCount++;
+			break;
+		}
+		case TraceCommand::MEMORY_BARRIER:
+			glMemoryBarrier(Read<GLbitfield>());
+			break;
+		case TraceCommand::BEGIN_TRANSFORM_FEEDBACK:
+			glBeginTransformFeedback(Read<GLenum>());
+			break;
+		case TraceCommand::END_TRANSFORM_FEEDBACK:
+			glEndTransformFeedback();
+			break;
+		case TraceCommand::DRAW_BUFFERS:
+		{
+			uint32_t size;
+			const unsigned char* data = ReadPayload(size);
+			std::vector<GLenum> buffers(size / sizeof(GLenum));
+			if (size > 0)
+				std::memcpy(buffers.data(), data, buffers.size() * sizeof(GLenum));
+			glDrawBuffers((GLsizei)buffers.size(), buffers.data());
+			break;
+		}
+		case TraceCommand::BIND_IMAGE_TEXTURE:
+		{
+			const GLuint unit = Read<GLuint>();
+			const GLuint texture = Read<GLuint>();
+			const GLint level = Read<GLint>();
+			const GLboolean layered = Read<GLboolean>();
+			const GLint layer = Read<GLint>();
+			const GLenum access = Read<GLenum>();
+			const GLenum format = Read<GLenum>();
+			glBindImageTexture(unit, Map(m_Textures, texture), level, layered, layer, access, format);
+			break;
+		}
+
+		default:
+			/* Can't know how long its arguments are, so nothing past it can be read */
+			Log("Unknown command " + std::to_string((int)command) + " in the trace, stopping there");
+			m_IsTruncated = true;
+			m_Cursor = m_End;
+			break;
+	}
+}
+
+int TraceReplayer::Run(const ReplayOptions& options)
+{
+	MappedFile file(options.filepath);
+	GLTrace::Header header;
+	if (!file.IsOpen() || file.GetSize() < sizeof(header))
+	{
+		std::printf("Couldn't read the GL trace %s\n", options.filepath.c_str());
+		return 1;
+	}
+
+	std::memcpy(&header, file.GetData(), sizeof(header));
+	if (std::memcmp(header.magic, GLTrace::Magic, sizeof(header.magic)) != 0 || header.version != GLTrace::Version)
+	{
+		std::printf("%s isn't a GL trace (or is from another version)\n", options.filepath.c_str());
+		return 1;
+	}
+
+	if (!glfwInit())
+		return 1;
+
+	/* Same context as the one it was recorded with */
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = glfwCreateWindow(header.width, header.height, "OpenGL Test - replay", NULL, NULL);
+	if (!window)
+	{
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		window = glfwCreateWindow(header.width, header.height, "OpenGL Test - replay", NULL, NULL);
+	}
+	if (!window)
+	{
+		glfwTerminate();
+		return 1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+	if (glewInit() != GLEW_OK)
+	{
+		glfwTerminate();
+		return 1;
+	}
+
+	TraceReplayer replayer(options, file.GetData() + sizeof(header), file.GetSize() - sizeof(header));
+	std::vector<FrameStats> frames;
+	uint32_t callCount = 0;
+	uint32_t strippedCount = 0;
+
+	/* Whatever was left over from the previous frame isn't counted against this one */
+	glFinish();
+	bool isFrameEnded = true;
+	while (isFrameEnded && !glfwWindowShouldClose(window))
+	{
+		replayer.m_Frame = FrameStats();
+		const auto frameStart = std::chrono::steady_clock::now();
+		isFrameEnded = replayer.ReplayFrame();
+		const auto submitEnd = std::chrono::steady_clock::now();
+		if (!isFrameEnded)
+			break; // Calls after the last recorded frame end don't make up a whole frame
+
+		glfwSwapBuffers(window);
+		glFinish();
+		const auto frameEnd = std::chrono::steady_clock::now();
+
+		replayer.m_Frame.submitMilliseconds = std::chrono::duration<double, std::milli>(submitEnd - frameStart).count();
+		replayer.m_Frame.frameMilliseconds = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+		frames.push_back(replayer.m_Frame);
+		callCount += replayer.m_Frame.callCount;
+		strippedCount += replayer.m_Frame.strippedCount;
+
+		glfwPollEvents();
+	}
+
+	if (replayer.m_IsTruncated)
+		std::printf("The trace is truncated or corrupted, replayed up to there\n");
+
+	std::printf("Replayed %s: %zu frames, %u calls", options.filepath.c_str(), frames.size(), callCount);
+	if (options.isRedundantStateStripped)
+		std::printf(", %u redundant ones stripped", strippedCount);
+	std::printf("\n");
+
+	if (!frames.empty())
+	{
+		std::printf("%-8s %10s %10s %10s %10s %10s\n", "", "mean", "median", "p95", "min", "max");
+		const auto printTimings = [&frames](const char* name, double FrameStats::* milliseconds)
+		{
+			std::vector<double> timings;
+			timings.reserve(frames.size());
+			for (const FrameStats& frame : frames)
+				timings.push_back(frame.*milliseconds);
+			std::sort(timings.begin(), timings.end());
+
+			double sum = 0.0;
+			for (double timing : timings)
+				sum += timing;
+			const double median = timings.size() % 2 ? timings[timings.size() / 2] : (timings[timings.size() / 2 - 1] + timings[timings.size() / 2]) * 0.5;
+			const double p95 = timings[std::min(timings.size() - 1, (std::size_t)(timings.size() * 0.95))];
+			std::printf("%-8s %10.3f %10.3f %10.3f %10.3f %10.3f\n", name, sum / timings.size(), median, p95, timings.front(), timings.back());
+		};
+		printTimings("submit", &FrameStats::submitMilliseconds);
+		printTimings("frame", &FrameStats::frameMilliseconds);
+	}
+
+	if (!options.csvPath.empty())
+	{
+		std::FILE* csv = std::fopen(options.csvPath.c_str(), "w");
+		if (csv)
+		{
+			std::fprintf(csv, "frame,calls,draws,stripped,submit_ms,frame_ms\n");
+			for (std::size_t i = 0; i < frames.size(); i++)
+			{
+				std::fprintf(csv, "%zu,%u,%u,%u,%.4f,%.4f\n", i, frames[i].callCount, frames[i].drawCount, frames[i].strippedCount,
+					frames[i].submitMilliseconds, frames[i].frameMilliseconds);
+			}
+			std::fclose(csv);
+		}
+		else
+			std::printf("Failed to write %s\n", options.csvPath.c_str());
+	}
+
+	glfwTerminate();
+	return replayer.m_IsTruncated ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "GLTrace.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ReplayOptions
+{
+	std::string filepath;
+	bool isRedundantStateStripped = false; // Skips binds and state changes to what's already current, and uniforms set to their current value
+	std::string csvPath; // Per-frame figures, when set
+};
+
+/*
+ * Plays a GL trace back (`--replay`) in a window of the size it was recorded at, as fast as it goes: no vsync, no
+ * input, no ImGui, nothing computed, so the same trace gives the same workload every time. Every frame is waited for
+ * (glFinish) before the next one starts, and timed
+ */
+class TraceReplayer
+{
+private:
+	struct FrameStats
+	{
+		uint32_t callCount = 0;
+		uint32_t drawCount = 0; // Draws and dispatches
+		uint32_t strippedCount = 0;
+		double submitMilliseconds = 0.0; // Issuing the calls
+		double frameMilliseconds = 0.0; // Until the GPU is done with it, swap included
+	};
+
+	/* What the redundant state stripping compares against, keyed by `StateSlot` */
+	enum class StateKind : uint64_t
+	{
+		PROGRAM, VERTEX_ARRAY, BUFFER, TEXTURE, ACTIVE_TEXTURE, FRAMEBUFFER, RENDERBUFFER, CAPABILITY, BLEND_FUNC, VIEWPORT, CLEAR_COLOR, PIXEL_STORE
+	};
+
+	struct UniformValue
+	{
+		TraceCommand command;
+		uint32_t size;
+		uint8_t bytes[64];
+	};
+
+	ReplayOptions m_Options;
+	const unsigned char* m_Cursor;
+	const unsigned char* m_End;
+	bool m_IsTruncated;
+
+	/* Recorded names to the ones this context gave out */
+	std::unordered_map<GLuint, GLuint> m_Buffers;
+	std::unordered_map<GLuint, GLuint> m_VertexArrays;
+	std::unordered_map<GLuint, GLuint> m_Textures;
+	std::unordered_map<GLuint, GLuint> m_Framebuffers;
+	std::unordered_map<GLuint, GLuint> m_Renderbuffers;
+	std::unordered_map<GLuint, GLuint> m_Shaders;
+	std::unordered_map<GLuint, GLuint> m_Programs;
+	std::unordered_map<uint64_t, GLint> m_UniformLocations; // (recorded program, recorded location)
+
+	GLuint m_CurrentProgram; // Recorded name, uniforms go to it
+	GLenum m_ActiveTexture;
+	std::unordered_map<uint64_t, uint64_t> m_State;
+	std::unordered_map<uint64_t, UniformValue> m_UniformValues; // (recorded program, recorded location)
+
+	std::vector<unsigned char> m_Scratch; // Readbacks land there
+	FrameStats m_Frame;
+
+	TraceReplayer(const ReplayOptions& options, const unsigned char* commands, std::size_t size);
+
+	template<typename T>
+	T Read()
+	{
+		T value = {};
+		if ((std::size_t)(m_End - m_Cursor) < sizeof(T))
+		{
+			m_IsTruncated = true;
+			m_Cursor = m_End;
+			return value;
+		}
+
+		std::memcpy(&value, m_Cursor, sizeof(T));
+		m_Cursor += sizeof(T);
+		return value;
+	}
+
+	// Points into the trace, null when empty
+	const unsigned char* ReadPayload(uint32_t& size);
+
+	// Replays the commands up to the end of the frame, false at the end of the trace
+	bool ReplayFrame();
+	void Execute(TraceCommand command);
+
+	static GLuint Map(const std::unordered_map<GLuint, GLuint>& names, GLuint name);
+	void GenNames(std::unordered_map<GLuint, GLuint>& names, void (*generate)(GLsizei, GLuint*));
+	// Maps and forgets the names, then drops whatever state referred to them
+	void DeleteNames(std::unordered_map<GLuint, GLuint>& names, void (*destroy)(GLsizei, const GLuint*), StateKind kind);
+	GLint MapUniformLocation(GLint location) const;
+
+	static inline uint64_t StateSlot(StateKind kind, uint64_t a = 0, uint64_t b = 0) { return ((uint64_t)kind << 56) | (a << 28) | b; }
+	// When stripping: true if the slot already holds `value` (the call can go), otherwise it's updated
+	bool IsRedundant(uint64_t slot, uint64_t value);
+	void ForgetState(StateKind kind, GLuint name);
+	bool IsUniformRedundant(GLint location, TraceCommand command, const void* values, uint32_t size);
+
+public:
+	// Opens the window and the context, replays `options.filepath` and prints the timings, returns the exit code
+	static int Run(const ReplayOptions& options);
+};
@@ -0,0 +1,219 @@
+#include "TransformSystem.h"
+#include "GLHandleError.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+	#define TRANSFORM_SYSTEM_SSE
+	#include <xmmintrin.h>
+#endif
+
+#ifdef TRANSFORM_SYSTEM_SSE
+/* Column-major 4x4 product: each output column is a linear combination of the left matrix's columns */
+static inline void MultiplyColumns(__m128 left0, __m128 left1, __m128 left2, __m128 left3, const float* right, float* out)
+{
+	for (int column = 0; column < 4; column++)
+	{
+		const float* r = right + column * 4;
+		__m128 result = _mm_mul_ps(left0, _mm_set1_ps(r[0]));
+		result = _mm_add_ps(result, _mm_mul_ps(left1, _mm_set1_ps(r[1])));
+		result = _mm_add_ps(result, _mm_mul_ps(left2, _mm_set1_ps(r[2])));
+		result = _mm_add_ps(result, _mm_mul_ps(left3, _mm_set1_ps(r[3])));
+		_mm_storeu_ps(out + column * 4, result);
+	}
+}
+#endif
+
+static inline void Multiply(const glm::mat4& left, const glm::mat4& right, glm::mat4& out)
+{
+#ifdef TRANSFORM_SYSTEM_SSE
+	const float* l = &left[0][0];
+	MultiplyColumns(_mm_loadu_ps(l), _mm_loadu_ps(l + 4), _mm_loadu_ps(l + 8), _mm_loadu_ps(l + 12), &right[0][0], &out[0][0]);
+#else
+	out = left * right;
+#endif
+}
+
+TransformSystem::TransformSystem()
+	: m_HasDirtyNodes(false), m_LastUpdatedCount(0)
+{
+}
+
+void TransformSystem::Reserve(std::size_t count)
+{
+	m_Parents.reserve(count);
+	m_Positions.reserve(count);
+	m_Rotations.reserve(count);
+	m_Scales.reserve(count);
+	m_WorldMatrices.reserve(count);
+	m_MVPs.reserve(count);
+	m_IsDirty.reserve(count);
+	m_Depths.reserve(count);
+}
+
+void TransformSystem::Clear()
+{
+	m_Parents.clear();
+	m_Positions.clear();
+	m_Rotations.clear();
+	m_Scales.clear();
+	m_WorldMatrices.clear();
+	m_MVPs.clear();
+	m_IsDirty.clear();
+	m_Depths.clear();
+	m_Levels.clear();
+	m_HasDirtyNodes = false;
+	m_LastUpdatedCount = 0;
+}
+
+TransformID TransformSystem::Create(TransformID parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	ASSERT(parent == InvalidTransform || parent < m_Parents.size());
+
+	const TransformID id = (TransformID)m_Parents.size();
+	const uint32_t depth = parent == InvalidTransform ? 0 : m_Depths[parent] + 1;
+
+	m_Parents.push_back(parent);
+	m_Positions.push_back(position);
+	m_Rotations.push_back(rotation);
+	m_Scales.push_back(scale);
+	m_WorldMatrices.push_back(glm::mat4(1.0f));
+	m_MVPs.push_back(glm::mat4(1.0f));
+	m_IsDirty.push_back(1);
+	m_Depths.push_back(depth);
+
+	if (depth >= m_Levels.size())
+		m_Levels.resize(depth + 1);
+	m_Levels[depth].push_back(id);
+
+	m_HasDirtyNodes = true;
+	return id;
+}
+
+void TransformSystem::SetPosition(TransformID id, const glm::vec3& position)
+{
+	m_Positions[id] = position;
+	m_IsDirty[id] = 1;
+	m_HasDirtyNodes = true;
+}
+
+void TransformSystem::SetRotation(TransformID id, const glm::quat& rotation)
+{
+	m_Rotations[id] = rotation;
+	m_IsDirty[id] = 1;
+	m_HasDirtyNodes = true;
+}
+
+void TransformSystem::SetScale(TransformID id, const glm::vec3& scale)
+{
+	m_Scales[id] = scale;
+	m_IsDirty[id] = 1;
+	m_HasDirtyNodes = true;
+}
+
+void TransformSystem::PropagateDirtyFlags()
+{
+	/* Parents come before their children, so a single forward pass reaches the bottom of every dirty subtree */
+	const TransformID* parents = m_Parents.data();
+	uint8_t* isDirty = m_IsDirty.data();
+
+	for (std::size_t i = 0; i < m_Parents.size(); i++)
+	{
+		if (parents[i] != InvalidTransform)
+			isDirty[i] |= isDirty[parents[i]];
+	}
+}
+
+std::size_t TransformSystem::UpdateNodes(const TransformID* ids, std::size_t count)
+{
+	std::size_t updatedCount = 0;
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		const TransformID id = ids[i];
+		if (!m_IsDirty[id])
+			continue;
+
+		/* Local = T * R * S, built directly instead of through three matrix products */
+		const glm::mat3 rotation = glm::mat3_cast(m_Rotations[id]);
+		const glm::vec3& scale = m_Scales[id];
+		const glm::mat4 localMatrix(
+			glm::vec4(rotation[0] * scale.x, 0.0f),
+			glm::vec4(rotation[1] * scale.y, 0.0f),
+			glm::vec4(rotation[2] * scale.z, 0.0f),
+			glm::vec4(m_Positions[id], 1.0f)
+		);
+
+		const TransformID parent = m_Parents[id];
+		if (parent == InvalidTransform)
+			m_WorldMatrices[id] = localMatrix;
+		else
+			Multiply(m_WorldMatrices[parent], localMatrix, m_WorldMatrices[id]);
+
+		updatedCount++;
+	}
+
+	return updatedCount;
+}
+
+void TransformSystem::UpdateWorldMatrices(std::size_t grainSize)
+{
+	m_LastUpdatedCount = 0;
+
+	if (!m_HasDirtyNodes)
+		return;
+
+	PropagateDirtyFlags();
+
+	/* A level only depends on the one above it, so its nodes can be spread across the job system */
+	for (const std::vector<TransformID>& level : m_Levels)
+	{
+		if (grainSize == 0 || level.size() <= grainSize)
+		{
+			m_LastUpdatedCount += UpdateNodes(level.data(), level.size());
+			continue;
+		}
+
+		m_LastUpdatedCount += JobSystem::Get().ParallelReduce(0, level.size(), grainSize, (std::size_t)0,
+			[&](std::size_t first, std::size_t last) { return UpdateNodes(level.data() + first, last - first); },
+			[](std::size_t a, std::size_t b) { return a + b; }
+		);
+	}
+
+	std::memset(m_IsDirty.data(), 0, m_IsDirty.size());
+	m_HasDirtyNodes = false;
+}
+
+void TransformSystem::UpdateMVPs(const glm::mat4& viewProjection, std::size_t grainSize)
+{
+	if (grainSize == 0)
+	{
+		MultiplyMatrices(viewProjection, m_WorldMatrices.data(), m_MVPs.data(), m_WorldMatrices.size());
+		return;
+	}
+
+	JobSystem::Get().ParallelFor(0, m_WorldMatrices.size(), grainSize, [&](std::size_t first, std::size_t last)
+	{
+		MultiplyMatrices(viewProjection, m_WorldMatrices.data() + first, m_MVPs.data() + first, last - first);
+	});
+}
+
+void TransformSystem::MultiplyMatrices(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, std::size_t count)
+{
+#ifdef TRANSFORM_SYSTEM_SSE
+	/* The left matrix stays in registers for the whole batch */
+	const float* l = &left[0][0];
+	const __m128 left0 = _mm_loadu_ps(l);
+	const __m128 left1 = _mm_loadu_ps(l + 4);
+	const __m128 left2 = _mm_loadu_ps(l + 8);
+	const __m128 left3 = _mm_loadu_ps(l + 12);
+
+	for (std::size_t i = 0; i < count; i++)
+		MultiplyColumns(left0, left1, left2, left3, &right[i][0][0], &out[i][0][0]);
+#else
+	for (std::size_t i = 0; i < count; i++)
+		out[i] = left * right[i];
+#endif
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+using TransformID = uint32_t;
+constexpr TransformID InvalidTransform = 0xFFFFFFFF;
+
+/*
+ * Transform hierarchy in structure-of-arrays layout, indexed by TransformID
+ * Parents are always created before their children, and every node is also listed under its depth,
+ * so world matrices can be updated level by level (each level in parallel) with the parent already up to date
+ */
+class TransformSystem
+{
+private:
+	/* Hot data: one array per component */
+	std::vector<TransformID> m_Parents;
+	std::vector<glm::vec3> m_Positions;
+	std::vector<glm::quat> m_Rotations;
+	std::vector<glm::vec3> m_Scales;
+	std::vector<glm::mat4> m_WorldMatrices;
+	std::vector<glm::mat4> m_MVPs;
+	std::vector<uint8_t> m_IsDirty; // Local transform changed since the last update (set by the setters)
+
+	std::vector<uint32_t> m_Depths;
+	std::vector<std::vector<TransformID>> m_Levels; // Nodes per depth, roots first
+
+	bool m_HasDirtyNodes;
+	std::size_t m_LastUpdatedCount;
+
+public:
+	TransformSystem();
+
+	void Reserve(std::size_t count);
+	void Clear();
+
+	TransformID Create(TransformID parent = InvalidTransform, const glm::vec3& position = glm::vec3(0.0f), const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+
+	void SetPosition(TransformID id, const glm::vec3& position);
+	void SetRotation(TransformID id, const glm::quat& rotation);
+	void SetScale(TransformID id, const glm::vec3& scale);
+
+	inline const glm::vec3& GetPosition(TransformID id) const { return m_Positions[id]; }
+	inline const glm::quat& GetRotation(TransformID id) const { return m_Rotations[id]; }
+	inline const glm::vec3& GetScale(TransformID id) const { return m_Scales[id]; }
+	inline TransformID GetParent(TransformID id) const { return m_Parents[id]; }
+	inline const glm::mat4& GetWorldMatrix(TransformID id) const { return m_WorldMatrices[id]; }
+	inline const glm::mat4& GetMVP(TransformID id) const { return m_MVPs[id]; }
+	inline std::size_t GetCount() const { return m_Parents.size(); }
+
+	// How many world matrices the last `UpdateWorldMatrices` recomputed
+	inline std::size_t GetLastUpdatedCount() const { return m_LastUpdatedCount; }
+
+	// Recomputes the world matrices of the dirty nodes and everything below them (`grainSize` nodes per job, 0 keeps it on the calling thread)
+	void UpdateWorldMatrices(std::size_t grainSize = 1024);
+	// MVP = viewProjection * world for every node, batched 4x4 SIMD products
+	void UpdateMVPs(const glm::mat4& viewProjection, std::size_t grainSize = 4096);
+
+	// out[i] = left * right[i] (SSE when available, plain GLM otherwise)
+	static void MultiplyMatrices(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, std::size_t count);
+
+private:
+	void PropagateDirtyFlags();
+	std::size_t UpdateNodes(const TransformID* ids, std::size_t count); // Returns how many were dirty
+};
@@ -1,18 +1,51 @@
 #include "VertexArray.h"
 #include "GLHandleError.h"
+#include "RenderBackend.h"
+#include "RenderStats.h"
+
+#include <algorithm>
 
 VertexArray::VertexArray()
+	: m_Renderer_ID(0)
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glGenVertexArrays(1, &m_Renderer_ID));
 }
 
 VertexArray::~VertexArray()
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glDeleteVertexArrays(1, &m_Renderer_ID));
 }
 
-void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute)
 {
+	if (IsSoftwareRendering())
+	{
+		/* Same bookkeeping as GL: where each attribute comes from, replacing what was at its location */
+		const auto& elements = layout.GetElements();
+		unsigned int offset = 0;
+
+		for (unsigned int i = 0; i < elements.size(); i++)
+		{
+			const auto& element = elements[i];
+			const SoftwareAttribute attribute = { firstAttribute + i, vb.GetData(), element.type, element.count, element.isNormalized, layout.GetStride(), offset, layout.GetDivisor() };
+
+			auto existing = std::find_if(m_SoftwareAttributes.begin(), m_SoftwareAttributes.end(), [&](const SoftwareAttribute& other) { return other.location == attribute.location; });
+			if (existing != m_SoftwareAttributes.end())
+				*existing = attribute;
+			else
+				m_SoftwareAttributes.push_back(attribute);
+
+			offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		}
+		return;
+	}
+
 	/* Bind the vertex array */
 	Bind();
 
@@ -26,16 +59,18 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 	for (unsigned int i = 0; i < elements.size(); i++)
 	{
 		const auto& element = elements[i];
+		const unsigned int attribute = firstAttribute + i;
 
-		GL_CALL(glEnableVertexAttribArray(i));
+		GL_CALL(glEnableVertexAttribArray(attribute));
 		GL_CALL(glVertexAttribPointer(
-			i,
+			attribute,
 			element.count,
 			element.type,
 			element.isNormalized,
 			layout.GetStride(),
 			(const void*)offset
 		));
+		GL_CALL(glVertexAttribDivisor(attribute, layout.GetDivisor()));
 
 		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
 	}
@@ -43,10 +78,18 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 
 void VertexArray::Bind() const
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glBindVertexArray(m_Renderer_ID));
+	RenderStats::Get().OnVertexArrayBound(m_Renderer_ID);
 }
 
 void VertexArray::Unbind() const
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glBindVertexArray(0));
+	RenderStats::Get().OnVertexArrayBound(0);
 }
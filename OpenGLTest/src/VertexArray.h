@@ -3,16 +3,36 @@
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 
+#include <memory>
+#include <vector>
+
+// Where the software backend fetches an attribute from (what glVertexAttribPointer records for GL)
+struct SoftwareAttribute
+{
+	unsigned int location;
+	std::shared_ptr<const std::vector<unsigned char>> data;
+	unsigned int type;
+	unsigned int count;
+	unsigned int isNormalized;
+	unsigned int stride;
+	unsigned int offset;
+	unsigned int divisor;
+};
+
 class VertexArray
 {
 private:
 	unsigned int m_Renderer_ID;
+	std::vector<SoftwareAttribute> m_SoftwareAttributes; // Software backend only
 
 public:
 	VertexArray();
 	~VertexArray();
 
-	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	// The layout's attributes take the locations from `firstAttribute` on (so several buffers can feed one vertex array)
+	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute = 0);
 	void Bind() const;
 	void Unbind() const;
+
+	inline const std::vector<SoftwareAttribute>& GetSoftwareAttributes() const { return m_SoftwareAttributes; }
 };
@@ -1,27 +1,76 @@
 #include "VertexBuffer.h"
 #include "GLHandleError.h"
+#include "RenderBackend.h"
+#include "RenderStats.h"
 
-VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+#include <cstring>
+
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, GLenum usage)
+	: m_RendererID(0)
 {
+	if (IsSoftwareRendering())
+	{
+		m_Data = std::make_shared<std::vector<unsigned char>>(size);
+		if (data)
+			std::memcpy(m_Data->data(), data, size);
+		m_Memory.Track(GpuMemoryCategory::VERTEX_BUFFER, size);
+		return;
+	}
+
 	/* Generate a new buffer */
 	GL_CALL(glGenBuffers(1, &m_RendererID));
 	/* Bind it */
 	GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
 	/* Provide data to it */
-	GL_CALL(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	GL_CALL(glBufferData(GL_ARRAY_BUFFER, size, data, usage));
+	m_Memory.Track(GpuMemoryCategory::VERTEX_BUFFER, size);
+	RenderStats::Get().Add(RenderCounter::RESOURCES_CREATED);
+	if (data)
+		RenderStats::Get().Add(RenderCounter::BUFFER_BYTES, size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glDeleteBuffers(1, &m_RendererID));
+	RenderStats::Get().Add(RenderCounter::RESOURCES_DESTROYED);
 }
 
 void VertexBuffer::Bind() const
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
 }
 
 void VertexBuffer::Unbind() const
 {
+	if (IsSoftwareRendering())
+		return;
+
 	GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
 }
+
+void VertexBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+	if (IsSoftwareRendering())
+	{
+		/* GL would fail the call with GL_INVALID_VALUE */
+		if ((uint64_t)offset + size > m_Data->size())
+		{
+			Log("VertexBuffer::SetData out of range, ignored");
+			return;
+		}
+
+		std::memcpy(m_Data->data() + offset, data, size);
+		return;
+	}
+
+	GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	GL_CALL(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
+	GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+	RenderStats::Get().Add(RenderCounter::BUFFER_BYTES, size);
+}
@@ -1,18 +1,33 @@
 #pragma once
 
+#include <GL/glew.h>
+
+#include "GpuMemoryTracker.h"
+
+#include <memory>
+#include <vector>
+
 class VertexBuffer
 {
 private:
 	unsigned int m_RendererID;
+	GpuAllocation m_Memory;
+	// Software backend only: shared with the vertex arrays using it, which (like GL's) outlive the buffer object
+	std::shared_ptr<std::vector<unsigned char>> m_Data;
 
 public:
-	VertexBuffer(const void* data, unsigned int size);
+	// `usage` is a hint: e.g. GL_DYNAMIC_COPY for buffers the GPU writes itself (transform feedback, compute)
+	VertexBuffer(const void* data, unsigned int size, GLenum usage = GL_STATIC_DRAW);
 	~VertexBuffer();
 
 	void Bind() const;
 	void Unbind() const;
 
-	//void SetData();
+	// Overwrites `size` bytes at `offset`, the buffer is never reallocated
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
 	//void Lock();
 	//void Unlock();
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const std::shared_ptr<std::vector<unsigned char>>& GetData() const { return m_Data; }
 };
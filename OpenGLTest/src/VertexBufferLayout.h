@@ -33,12 +33,17 @@ class VertexBufferLayout
 private:
 	std::vector<VertexBufferElement> m_Elements;
 	unsigned int m_Stride;
+	unsigned int m_Divisor;
 
 public:
 	VertexBufferLayout()
-		: m_Stride(0) {} // Init as 0
+		: m_Stride(0), m_Divisor(0) {} // Init as 0
 
 	void Push(unsigned int type, unsigned int count);
-	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
+	// 0: the attributes advance per vertex - n: once every n instances (e.g. 1 for per-particle data under a shared quad)
+	inline void SetDivisor(unsigned int divisor) { m_Divisor = divisor; }
+
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
+	inline unsigned int GetDivisor() const { return m_Divisor; }
 };
@@ -0,0 +1,289 @@
+#include "Benchmark.h"
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace benchmark
+{
+	State::State(std::size_t iterations, long long argument)
+		: m_Iterations(iterations), m_Remaining(iterations), m_Argument(argument), m_IsStarted(false), m_IsPaused(false),
+		m_Start(), m_Elapsed(Clock::duration::zero()), m_ItemsProcessed(0), m_BytesProcessed(0)
+	{
+	}
+
+	bool State::KeepRunning()
+	{
+		/* Like the main loop does every frame, otherwise the arena fills up and everything after measures its heap fallback */
+		FrameArena::Get().Reset();
+
+		if (!m_IsStarted)
+		{
+			m_IsStarted = true;
+			m_Start = Clock::now();
+		}
+
+		if (m_Remaining > 0 && m_Error.empty())
+		{
+			m_Remaining--;
+			return true;
+		}
+
+		if (!m_IsPaused)
+			m_Elapsed += Clock::now() - m_Start;
+		m_IsPaused = true;
+		return false;
+	}
+
+	void State::PauseTiming()
+	{
+		if (m_IsPaused)
+			return;
+
+		m_Elapsed += Clock::now() - m_Start;
+		m_IsPaused = true;
+	}
+
+	void State::ResumeTiming()
+	{
+		if (!m_IsPaused)
+			return;
+
+		m_IsPaused = false;
+		m_Start = Clock::now();
+	}
+
+	void State::SkipWithError(const std::string& message)
+	{
+		m_Error = message;
+		m_Remaining = 0;
+	}
+
+	/* Not inlined so the compiler has to assume the pointed value is read */
+#ifdef _MSC_VER
+	__declspec(noinline)
+#else
+	__attribute__((noinline))
+#endif
+	void UseCharPointer(const volatile char* pointer)
+	{
+		(void)pointer;
+	}
+
+	Registry& Registry::Get()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	void Registry::Register(const std::string& name, BenchmarkFunction function, const std::vector<long long>& arguments)
+	{
+		m_Entries.push_back({ name, function, arguments });
+	}
+
+	Result Registry::RunOne(const std::string& name, BenchmarkFunction function, long long argument, const Options& options)
+	{
+		Result result = { name, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, "" };
+
+		FrameArena& arena = FrameArena::Get();
+		arena.Reset();
+		const uint64_t overflowsBefore = arena.GetTotalOverflows();
+
+		/* Grow the iteration count until a run lasts `minTime` (warms up the caches on the way) */
+		std::size_t iterations = 1;
+		while (true)
+		{
+			State state(iterations, argument);
+			function(state);
+
+			if (!state.GetError().empty())
+			{
+				result.error = state.GetError();
+				return result;
+			}
+
+			const double seconds = state.GetElapsedSeconds();
+			if (seconds >= options.minTime || iterations >= 1000000000)
+				break;
+
+			/* Aim a bit past `minTime` when the last run was long enough to extrapolate from, otherwise go 10x */
+			const double multiplier = seconds / options.minTime > 0.1 ? 1.4 * options.minTime / std::max(seconds, 1e-9) : 10.0;
+			iterations = std::max(iterations + 1, (std::size_t)(iterations * std::min(multiplier, 10.0)));
+		}
+
+		/* Timed repetitions with the calibrated iteration count */
+		std::vector<double> timings;
+		double totalSeconds = 0.0;
+		long long totalItems = 0, totalBytes = 0;
+		for (int repetition = 0; repetition < options.repetitions; repetition++)
+		{
+			State state(iterations, argument);
+			function(state);
+
+			timings.push_back(state.GetElapsedSeconds() * 1e9 / iterations);
+			totalSeconds += state.GetElapsedSeconds();
+			totalItems += state.GetItemsProcessed();
+			totalBytes += state.GetBytesProcessed();
+		}
+
+		/* A single iteration has to fit in the arena, or the timings include its heap fallback */
+		arena.Reset();
+		if (arena.GetTotalOverflows() != overflowsBefore)
+		{
+			result.error = "frame arena overflowed " + std::to_string(arena.GetTotalOverflows() - overflowsBefore) + " times (an iteration needs more than "
+				+ std::to_string(arena.GetCapacity() / 1024) + " KB), timings would include heap allocations";
+			return result;
+		}
+
+		std::sort(timings.begin(), timings.end());
+
+		double sum = 0.0;
+		for (double timing : timings)
+			sum += timing;
+
+		result.iterations = iterations;
+		result.repetitions = (int)timings.size();
+		result.mean = sum / timings.size();
+		result.median = timings.size() % 2 ? timings[timings.size() / 2] : (timings[timings.size() / 2 - 1] + timings[timings.size() / 2]) * 0.5;
+		result.min = timings.front();
+		result.max = timings.back();
+
+		double variance = 0.0;
+		for (double timing : timings)
+			variance += (timing - result.mean) * (timing - result.mean);
+		result.stddev = timings.size() > 1 ? std::sqrt(variance / (timings.size() - 1)) : 0.0;
+
+		result.itemsPerSecond = totalSeconds > 0.0 ? totalItems / totalSeconds : 0.0;
+		result.bytesPerSecond = totalSeconds > 0.0 ? totalBytes / totalSeconds : 0.0;
+		return result;
+	}
+
+	int Registry::Run(const Options& options)
+	{
+		/* Registration order depends on the static initialization order of the translation units */
+		std::sort(m_Entries.begin(), m_Entries.end(), [](const Entry& a, const Entry& b) { return a.name < b.name; });
+
+#ifdef _DEBUG
+		std::cout << "***WARNING*** Benchmarking a Debug build, timings are not representative" << std::endl;
+#endif
+		std::printf("%-48s %14s %14s %10s %12s %16s\n", "Benchmark", "Mean (ns)", "Median (ns)", "CV", "Iterations", "Throughput");
+
+		std::vector<Result> results;
+		bool hasFailed = false;
+
+		for (const Entry& entry : m_Entries)
+		{
+			std::vector<long long> arguments = entry.arguments;
+			if (arguments.empty())
+				arguments.push_back(0);
+
+			for (long long argument : arguments)
+			{
+				const std::string name = entry.arguments.empty() ? entry.name : entry.name + "/" + std::to_string(argument);
+				if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+					continue;
+
+				Result result = RunOne(name, entry.function, argument, options);
+				results.push_back(result);
+
+				if (!result.error.empty())
+				{
+					std::printf("%-48s ERROR: %s\n", name.c_str(), result.error.c_str());
+					hasFailed = true;
+					continue;
+				}
+
+				char throughput[32] = "";
+				if (result.bytesPerSecond > 0.0)
+					std::snprintf(throughput, sizeof(throughput), "%.1f MB/s", result.bytesPerSecond / (1024.0 * 1024.0));
+				else if (result.itemsPerSecond > 0.0)
+					std::snprintf(throughput, sizeof(throughput), "%.2f M/s", result.itemsPerSecond / 1e6);
+
+				std::printf("%-48s %14.1f %14.1f %9.2f%% %12zu %16s\n", name.c_str(), result.mean, result.median,
+					result.mean > 0.0 ? 100.0 * result.stddev / result.mean : 0.0, result.iterations, throughput);
+			}
+		}
+
+		if (!options.jsonOutputPath.empty() && !WriteJson(options.jsonOutputPath, results, options))
+		{
+			std::cout << "Failed to write " << options.jsonOutputPath << std::endl;
+			return 1;
+		}
+
+		return hasFailed ? 1 : 0;
+	}
+
+	static std::string EscapeJson(const std::string& value)
+	{
+		std::string escaped;
+		for (char c : value)
+		{
+			if (c == '"' || c == '\\')
+				escaped += '\\';
+			if ((unsigned char)c >= 0x20)
+				escaped += c;
+		}
+
+		return escaped;
+	}
+
+	bool Registry::WriteJson(const std::string& filepath, const std::vector<Result>& results, const Options& options)
+	{
+		std::ofstream stream(filepath);
+		if (!stream)
+			return false;
+
+		char date[32];
+		std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+		stream << "{\n";
+		stream << "  \"context\": {\n";
+		stream << "    \"date\": \"" << date << "\",\n";
+		stream << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef _DEBUG
+		stream << "    \"build_type\": \"debug\",\n";
+#else
+		stream << "    \"build_type\": \"release\",\n";
+#endif
+		stream << "    \"repetitions\": " << options.repetitions << ",\n";
+		stream << "    \"min_time\": " << options.minTime << "\n";
+		stream << "  },\n";
+		stream << "  \"benchmarks\": [";
+
+		for (std::size_t i = 0; i < results.size(); i++)
+		{
+			const Result& result = results[i];
+
+			stream << (i > 0 ? ",\n" : "\n") << "    {\n";
+			stream << "      \"name\": \"" << EscapeJson(result.name) << "\",\n";
+			if (!result.error.empty())
+			{
+				stream << "      \"error_occurred\": true,\n";
+				stream << "      \"error_message\": \"" << EscapeJson(result.error) << "\"\n";
+				stream << "    }";
+				continue;
+			}
+
+			stream << "      \"iterations\": " << result.iterations << ",\n";
+			stream << "      \"repetitions\": " << result.repetitions << ",\n";
+			stream << "      \"time_unit\": \"ns\",\n";
+			stream << "      \"mean\": " << result.mean << ",\n";
+			stream << "      \"median\": " << result.median << ",\n";
+			stream << "      \"stddev\": " << result.stddev << ",\n";
+			stream << "      \"min\": " << result.min << ",\n";
+			stream << "      \"max\": " << result.max << ",\n";
+			stream << "      \"items_per_second\": " << result.itemsPerSecond << ",\n";
+			stream << "      \"bytes_per_second\": " << result.bytesPerSecond << "\n";
+			stream << "    }";
+		}
+
+		stream << "\n  ]\n}\n";
+		return (bool)stream;
+	}
+}
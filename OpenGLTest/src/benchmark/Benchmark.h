@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+/*
+ * Microbenchmarks for the CPU-side hot paths (`OpenGLTest --benchmark [filter]`)
+ *
+ * void ShaderParse(benchmark::State& state)
+ * {
+ *     // Setup (not timed)
+ *     while (state.KeepRunning())
+ *         benchmark::DoNotOptimize(Shader::ParseShader(path));
+ * }
+ * BENCHMARK(ShaderParse, 1000, 10000); // Run once per argument, read back with `state.GetArgument()`
+ */
+namespace benchmark
+{
+	class State
+	{
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		std::size_t m_Iterations;
+		std::size_t m_Remaining;
+		long long m_Argument;
+		bool m_IsStarted;
+		bool m_IsPaused;
+		Clock::time_point m_Start;
+		Clock::duration m_Elapsed;
+		long long m_ItemsProcessed;
+		long long m_BytesProcessed;
+		std::string m_Error;
+
+	public:
+		State(std::size_t iterations, long long argument);
+
+		// Starts the timer on the first call and stops it after the last iteration. Each call is also a frame boundary for
+		// `FrameArena`, so what an iteration allocates there must not outlive it
+		bool KeepRunning();
+
+		// Excludes per-iteration setup from the measurement (both have a cost of their own, avoid in tight loops)
+		void PauseTiming();
+		void ResumeTiming();
+
+		inline long long GetArgument() const { return m_Argument; }
+		inline std::size_t GetIterations() const { return m_Iterations; }
+		inline double GetElapsedSeconds() const { return std::chrono::duration<double>(m_Elapsed).count(); }
+
+		// Totals over all the iterations, reported as throughput
+		inline void SetItemsProcessed(long long items) { m_ItemsProcessed = items; }
+		inline void SetBytesProcessed(long long bytes) { m_BytesProcessed = bytes; }
+		inline long long GetItemsProcessed() const { return m_ItemsProcessed; }
+		inline long long GetBytesProcessed() const { return m_BytesProcessed; }
+
+		// Stops the benchmark early and reports it as failed (e.g. a missing resource)
+		void SkipWithError(const std::string& message);
+		inline const std::string& GetError() const { return m_Error; }
+	};
+
+	using BenchmarkFunction = void(*)(State&);
+
+	struct Options
+	{
+		std::string filter; // Only runs benchmarks whose name contains it (all of them if empty)
+		std::string jsonOutputPath; // Also writes the results there when set
+		int repetitions = 5;
+		double minTime = 0.1; // Seconds each repetition has to last (sets the iteration count)
+	};
+
+	struct Result
+	{
+		std::string name;
+		std::size_t iterations;
+		int repetitions;
+		// Nanoseconds per iteration across the repetitions
+		double mean;
+		double median;
+		double stddev;
+		double min;
+		double max;
+		double itemsPerSecond;
+		double bytesPerSecond;
+		std::string error;
+	};
+
+	class Registry
+	{
+	private:
+		struct Entry
+		{
+			std::string name;
+			BenchmarkFunction function;
+			std::vector<long long> arguments;
+		};
+
+		std::vector<Entry> m_Entries;
+
+		Registry() {}
+
+	public:
+		static Registry& Get();
+
+		void Register(const std::string& name, BenchmarkFunction function, const std::vector<long long>& arguments);
+
+		// Runs every matching benchmark, prints a table to the console and returns the process exit code
+		int Run(const Options& options);
+
+	private:
+		Result RunOne(const std::string& name, BenchmarkFunction function, long long argument, const Options& options);
+		static bool WriteJson(const std::string& filepath, const std::vector<Result>& results, const Options& options);
+	};
+
+	struct Registration
+	{
+		Registration(const char* name, BenchmarkFunction function, const std::vector<long long>& arguments)
+		{
+			Registry::Get().Register(name, function, arguments);
+		}
+	};
+
+	void UseCharPointer(const volatile char* pointer);
+
+	// Keeps the compiler from optimizing away a value that is computed but never used
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#ifdef _MSC_VER
+		UseCharPointer(&reinterpret_cast<const volatile char&>(value));
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	// Forces pending writes to memory (e.g. to keep stores into a buffer that is never read)
+	inline void ClobberMemory()
+	{
+#ifdef _MSC_VER
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : : "memory");
+#endif
+	}
+}
+
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+#define BENCHMARK(function, ...) static benchmark::Registration BENCHMARK_CONCAT(s_Benchmark, __LINE__)(#function, function, { __VA_ARGS__ })
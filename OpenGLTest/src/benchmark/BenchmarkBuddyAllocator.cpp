@@ -0,0 +1,49 @@
+#include "Benchmark.h"
+#include "BuddyAllocator.h"
+
+#include <random>
+
+/* Argument: live allocation count, each iteration frees a random one and allocates a new one (mesh streaming) */
+static void BuddyAllocatorChurn(benchmark::State& state)
+{
+	const std::size_t liveCount = state.GetArgument();
+	BuddyAllocator allocator((uint32_t)liveCount * 2048, 64);
+
+	std::mt19937 random(42);
+	std::uniform_int_distribution<uint32_t> size(16, 1024);
+	std::uniform_int_distribution<std::size_t> slot(0, liveCount - 1);
+
+	std::vector<uint32_t> offsets(liveCount);
+	for (uint32_t& offset : offsets)
+		offset = allocator.Allocate(size(random));
+
+	while (state.KeepRunning())
+	{
+		uint32_t& offset = offsets[slot(random)];
+		allocator.Free(offset);
+		offset = allocator.Allocate(size(random));
+		benchmark::DoNotOptimize(offset);
+	}
+
+	state.SetItemsProcessed(state.GetIterations());
+}
+BENCHMARK(BuddyAllocatorChurn, 1000, 100000);
+
+/* Fill and empty the whole allocator with minimum blocks: the worst case for splits and merges */
+static void BuddyAllocatorFillAndClear(benchmark::State& state)
+{
+	const uint32_t count = (uint32_t)state.GetArgument();
+	BuddyAllocator allocator(count * 64, 64);
+	std::vector<uint32_t> offsets(count);
+
+	while (state.KeepRunning())
+	{
+		for (uint32_t& offset : offsets)
+			offset = allocator.Allocate(64);
+		for (uint32_t offset : offsets)
+			allocator.Free(offset);
+	}
+
+	state.SetItemsProcessed(count * (long long)state.GetIterations());
+}
+BENCHMARK(BuddyAllocatorFillAndClear, 1024, 65536);
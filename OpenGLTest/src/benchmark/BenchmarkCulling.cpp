@@ -0,0 +1,126 @@
+#include "Benchmark.h"
+#include "Bvh.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <random>
+
+/* Argument: object count, boxes scattered like the frustum culling test (about a sixth of them visible) */
+static std::vector<AABB> GenerateBounds(std::size_t count)
+{
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> size(0.5f, 2.0f);
+
+	std::vector<AABB> bounds(count);
+	for (AABB& box : bounds)
+	{
+		const glm::vec3 center(position(random), position(random), position(random));
+		const float halfSize = size(random) * 0.5f;
+		box = { center - halfSize, center + halfSize };
+	}
+
+	return bounds;
+}
+
+static Frustum GetFrustum()
+{
+	const glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 300.0f);
+	const glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	return Frustum::FromViewProjection(projectionMatrix * viewMatrix);
+}
+
+/* One box at a time, as a baseline for the packed tests */
+static void CullingScalar(benchmark::State& state)
+{
+	const std::vector<AABB> bounds = GenerateBounds(state.GetArgument());
+	const Frustum frustum = GetFrustum();
+	std::vector<uint32_t> visible;
+
+	while (state.KeepRunning())
+	{
+		visible.clear();
+		for (uint32_t i = 0; i < bounds.size(); i++)
+		{
+			uint32_t planeMask = 0x3F;
+			if (frustum.Classify(bounds[i], planeMask) != Containment::OUTSIDE)
+				visible.push_back(i);
+		}
+		benchmark::DoNotOptimize(visible.data());
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(CullingScalar, 10000, 100000);
+
+static void CullingFlat(benchmark::State& state)
+{
+	Bvh bvh;
+	bvh.Build(GenerateBounds(state.GetArgument()));
+	const Frustum frustum = GetFrustum();
+	std::vector<uint32_t> visible;
+	CullingStats stats;
+
+	while (state.KeepRunning())
+	{
+		visible.clear();
+		bvh.CullFlat(frustum, visible, stats);
+		benchmark::DoNotOptimize(visible.data());
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(CullingFlat, 10000, 100000);
+
+static void CullingBvh(benchmark::State& state)
+{
+	Bvh bvh;
+	bvh.Build(GenerateBounds(state.GetArgument()));
+	const Frustum frustum = GetFrustum();
+	std::vector<uint32_t> visible;
+	CullingStats stats;
+
+	while (state.KeepRunning())
+	{
+		visible.clear();
+		bvh.Cull(frustum, visible, stats);
+		benchmark::DoNotOptimize(visible.data());
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(CullingBvh, 10000, 100000);
+
+static void CullingBvhBuild(benchmark::State& state)
+{
+	const std::vector<AABB> bounds = GenerateBounds(state.GetArgument());
+	Bvh bvh;
+
+	while (state.KeepRunning())
+		bvh.Build(bounds);
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(CullingBvhBuild, 10000, 100000);
+
+/* 10% of the objects moved every iteration */
+static void CullingBvhRefit(benchmark::State& state)
+{
+	std::vector<AABB> bounds = GenerateBounds(state.GetArgument());
+	Bvh bvh;
+	bvh.Build(bounds);
+
+	const uint32_t movingCount = (uint32_t)bounds.size() / 10;
+	float offset = 0.0f;
+
+	while (state.KeepRunning())
+	{
+		offset = offset > 1.0f ? -1.0f : offset + 0.01f;
+		for (uint32_t i = 0; i < movingCount; i++)
+			bvh.UpdateBounds(i, { bounds[i].min + offset, bounds[i].max + offset });
+		bvh.Refit();
+	}
+
+	state.SetItemsProcessed(movingCount * (long long)state.GetIterations());
+}
+BENCHMARK(CullingBvhRefit, 10000, 100000);
@@ -0,0 +1,82 @@
+#include "Benchmark.h"
+#include "Expression.h"
+
+#include <cmath>
+
+/* Argument: point count, laid out as a square grid over [-1; 1] */
+static void GenerateGridPoints(std::size_t count, std::vector<float>& x, std::vector<float>& y)
+{
+	const std::size_t side = (std::size_t)std::sqrt((double)count);
+	x.resize(count);
+	y.resize(count);
+	for (std::size_t i = 0; i < count; i++)
+	{
+		x[i] = -1.0f + 2.0f * (i % side) / side;
+		y[i] = -1.0f + 2.0f * (i / side) / side;
+	}
+}
+
+/* The sombrero as it used to be hard-wired, as a baseline for the bytecode */
+static void ExpressionNativeSombrero(benchmark::State& state)
+{
+	std::vector<float> x, y, z(state.GetArgument());
+	GenerateGridPoints(state.GetArgument(), x, y);
+
+	while (state.KeepRunning())
+	{
+		for (std::size_t i = 0; i < z.size(); i++)
+		{
+			const float r = std::sqrt(std::pow(x[i] * 10.0f, 2) + std::pow(y[i] * 10.0f, 2));
+			z[i] = std::abs(x[i]) < 0.0001f && std::abs(y[i]) < 0.0001f ? 1.0f : std::sin(r) / r;
+		}
+		benchmark::DoNotOptimize(z.data());
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(ExpressionNativeSombrero, 4096, 1048576);
+
+static void ExpressionEvaluateSombrero(benchmark::State& state)
+{
+	const Expression expression("sinc(10 * sqrt(x^2 + y^2))");
+	std::vector<float> x, y, z(state.GetArgument());
+	GenerateGridPoints(state.GetArgument(), x, y);
+
+	while (state.KeepRunning())
+	{
+		expression.Evaluate(x.data(), y.data(), z.data(), z.size());
+		benchmark::DoNotOptimize(z.data());
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(ExpressionEvaluateSombrero, 4096, 1048576);
+
+/* Arithmetic only: how far the interpreter gets when every instruction is SIMD */
+static void ExpressionEvaluatePolynomial(benchmark::State& state)
+{
+	const Expression expression("0.5 * x^2 * y - 0.25 * x * y^2 + 3 * x - y + 1");
+	std::vector<float> x, y, z(state.GetArgument());
+	GenerateGridPoints(state.GetArgument(), x, y);
+
+	while (state.KeepRunning())
+	{
+		expression.Evaluate(x.data(), y.data(), z.data(), z.size());
+		benchmark::DoNotOptimize(z.data());
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(ExpressionEvaluatePolynomial, 4096, 1048576);
+
+/* Parse, fold and compile, what every keystroke in the function box costs */
+static void ExpressionCompile(benchmark::State& state)
+{
+	Expression expression;
+
+	while (state.KeepRunning())
+		benchmark::DoNotOptimize(expression.Compile("sin(x * 3) * cos(y * 3) + 0.5 * exp(-(x^2 + y^2) * 4) + sinc(10 * sqrt(x^2 + y^2))"));
+
+	state.SetItemsProcessed(state.GetIterations());
+}
+BENCHMARK(ExpressionCompile);
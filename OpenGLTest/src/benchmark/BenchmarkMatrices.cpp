@@ -0,0 +1,8 @@
+/* GLM as the rest of the project builds it (no intrinsics) */
+#include "BenchmarkMatrices.h"
+
+static void MatrixMvp(benchmark::State& state)
+{
+	benchmark::ComposeMvps<glm::defaultp>(state);
+}
+BENCHMARK(MatrixMvp, 1, 1024);
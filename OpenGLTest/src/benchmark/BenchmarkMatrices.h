@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Benchmark.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <vector>
+
+namespace benchmark
+{
+	/*
+	 * Sombrero-style MVP (two rotations, a view translation and a perspective projection) for `argument` objects per iteration
+	 * Templated on the qualifier so each translation unit gets its own instantiation, with whatever GLM configuration it was compiled with
+	 */
+	template<glm::qualifier Q>
+	void ComposeMvps(State& state)
+	{
+		using Matrix = glm::mat<4, 4, float, Q>;
+		using Vector = glm::vec<3, float, Q>;
+
+		const std::size_t count = (std::size_t)state.GetArgument();
+		std::vector<float> angles(count);
+		for (std::size_t i = 0; i < count; i++)
+			angles[i] = (float)i * 0.01f;
+		std::vector<Matrix> mvps(count);
+
+		const Matrix projectionMatrix = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+		const Matrix viewMatrix = glm::translate(Matrix(1.0f), Vector(0.0f, 0.0f, -3.0f));
+
+		while (state.KeepRunning())
+		{
+			for (std::size_t i = 0; i < count; i++)
+			{
+				Matrix modelMatrix = glm::rotate(Matrix(1.0f), glm::radians(-60.0f), Vector(1.0f, 0.0f, 0.0f));
+				modelMatrix = glm::rotate(modelMatrix, angles[i], Vector(0.0f, 0.0f, 1.0f));
+				mvps[i] = projectionMatrix * viewMatrix * modelMatrix;
+			}
+
+			ClobberMemory();
+		}
+
+		DoNotOptimize(mvps[count - 1]);
+		state.SetItemsProcessed((long long)count * (long long)state.GetIterations());
+	}
+}
@@ -0,0 +1,19 @@
+/*
+ * Same MVP composition with GLM's SIMD code paths (kept to this translation unit, the macros must come before any GLM header)
+ * GLM only takes them for the aligned types, which don't exist anywhere else in the project, so the two can't clash at link time
+ */
+#define GLM_FORCE_INTRINSICS
+#include "glm/glm.hpp"
+#include "glm/gtc/type_aligned.hpp"
+
+#include "BenchmarkMatrices.h"
+
+static void MatrixMvpIntrinsics(benchmark::State& state)
+{
+#if GLM_CONFIG_SIMD == GLM_ENABLE
+	benchmark::ComposeMvps<glm::aligned_highp>(state);
+#else
+	state.SkipWithError("GLM_FORCE_INTRINSICS has no SIMD instruction set to use on this target");
+#endif
+}
+BENCHMARK(MatrixMvpIntrinsics, 1, 1024);
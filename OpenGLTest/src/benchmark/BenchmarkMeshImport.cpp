@@ -0,0 +1,199 @@
+#include "Benchmark.h"
+#include "MeshImporter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+/* Argument: torus resolution, N * N vertices and 2 * N * N triangles (written once per argument to the temp directory) */
+struct Torus
+{
+	std::vector<float> positions;
+	std::vector<float> normals;
+	std::vector<float> texCoords;
+	std::vector<unsigned int> indices; // Quads split in two
+};
+
+static Torus GenerateTorus(std::size_t resolution)
+{
+	Torus torus;
+	for (std::size_t ring = 0; ring < resolution; ring++)
+	{
+		for (std::size_t side = 0; side < resolution; side++)
+		{
+			const float u = 6.2831853f * ring / resolution;
+			const float v = 6.2831853f * side / resolution;
+			const float normal[3] = { std::cos(v) * std::cos(u), std::sin(v), std::cos(v) * std::sin(u) };
+
+			torus.positions.insert(torus.positions.end(), { std::cos(u) + 0.3f * normal[0], 0.3f * normal[1], std::sin(u) + 0.3f * normal[2] });
+			torus.normals.insert(torus.normals.end(), { normal[0], normal[1], normal[2] });
+			torus.texCoords.insert(torus.texCoords.end(), { (float)ring / resolution, (float)side / resolution });
+
+			const unsigned int a = (unsigned int)(ring * resolution + side);
+			const unsigned int b = (unsigned int)(((ring + 1) % resolution) * resolution + side);
+			const unsigned int c = (unsigned int)(((ring + 1) % resolution) * resolution + (side + 1) % resolution);
+			const unsigned int d = (unsigned int)(ring * resolution + (side + 1) % resolution);
+			torus.indices.insert(torus.indices.end(), { a, b, c, a, c, d });
+		}
+	}
+
+	return torus;
+}
+
+static std::string GetTorusPath(std::size_t resolution, const char* extension)
+{
+	return (std::filesystem::temp_directory_path() / ("OpenGLTestBenchmarkTorus" + std::to_string(resolution) + extension)).string();
+}
+
+static std::string WriteTorusObj(std::size_t resolution)
+{
+	const std::string filepath = GetTorusPath(resolution, ".obj");
+	const Torus torus = GenerateTorus(resolution);
+
+	std::FILE* file = std::fopen(filepath.c_str(), "w");
+	for (std::size_t i = 0; i < torus.positions.size(); i += 3)
+		std::fprintf(file, "v %f %f %f\n", torus.positions[i], torus.positions[i + 1], torus.positions[i + 2]);
+	for (std::size_t i = 0; i < torus.texCoords.size(); i += 2)
+		std::fprintf(file, "vt %f %f\n", torus.texCoords[i], torus.texCoords[i + 1]);
+	for (std::size_t i = 0; i < torus.normals.size(); i += 3)
+		std::fprintf(file, "vn %f %f %f\n", torus.normals[i], torus.normals[i + 1], torus.normals[i + 2]);
+
+	/* Quads, as most exporters write them */
+	for (std::size_t i = 0; i < torus.indices.size(); i += 6)
+	{
+		const unsigned int quad[4] = { torus.indices[i] + 1, torus.indices[i + 1] + 1, torus.indices[i + 2] + 1, torus.indices[i + 5] + 1 };
+		std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", quad[0], quad[0], quad[0], quad[1], quad[1], quad[1], quad[2], quad[2], quad[2], quad[3], quad[3], quad[3]);
+	}
+
+	std::fclose(file);
+	return filepath;
+}
+
+static std::string WriteTorusGlb(std::size_t resolution)
+{
+	const std::string filepath = GetTorusPath(resolution, ".glb");
+	const Torus torus = GenerateTorus(resolution);
+
+	const std::size_t vertexCount = torus.positions.size() / 3;
+	const std::size_t positionsSize = torus.positions.size() * sizeof(float);
+	const std::size_t normalsSize = torus.normals.size() * sizeof(float);
+	const std::size_t texCoordsSize = torus.texCoords.size() * sizeof(float);
+	const std::size_t indicesSize = torus.indices.size() * sizeof(unsigned int);
+	const std::size_t binSize = positionsSize + normalsSize + texCoordsSize + indicesSize;
+
+	const std::string n = std::to_string(vertexCount);
+	std::string json =
+		"{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":" + std::to_string(binSize) + "}],"
+		"\"bufferViews\":["
+		"{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" + std::to_string(positionsSize) + "},"
+		"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionsSize) + ",\"byteLength\":" + std::to_string(normalsSize) + "},"
+		"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionsSize + normalsSize) + ",\"byteLength\":" + std::to_string(texCoordsSize) + "},"
+		"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionsSize + normalsSize + texCoordsSize) + ",\"byteLength\":" + std::to_string(indicesSize) + "}],"
+		"\"accessors\":["
+		"{\"bufferView\":0,\"componentType\":5126,\"count\":" + n + ",\"type\":\"VEC3\"},"
+		"{\"bufferView\":1,\"componentType\":5126,\"count\":" + n + ",\"type\":\"VEC3\"},"
+		"{\"bufferView\":2,\"componentType\":5126,\"count\":" + n + ",\"type\":\"VEC2\"},"
+		"{\"bufferView\":3,\"componentType\":5125,\"count\":" + std::to_string(torus.indices.size()) + ",\"type\":\"SCALAR\"}],"
+		"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}]}";
+	while (json.size() % 4 != 0)
+		json.push_back(' ');
+
+	const uint32_t header[3] = { 0x46546C67, 2, (uint32_t)(12 + 8 + json.size() + 8 + binSize) };
+	const uint32_t jsonChunk[2] = { (uint32_t)json.size(), 0x4E4F534A };
+	const uint32_t binChunk[2] = { (uint32_t)binSize, 0x004E4942 };
+
+	std::ofstream stream(filepath, std::ios::binary | std::ios::trunc);
+	stream.write((const char*)header, sizeof(header));
+	stream.write((const char*)jsonChunk, sizeof(jsonChunk));
+	stream.write(json.data(), json.size());
+	stream.write((const char*)binChunk, sizeof(binChunk));
+	stream.write((const char*)torus.positions.data(), positionsSize);
+	stream.write((const char*)torus.normals.data(), normalsSize);
+	stream.write((const char*)torus.texCoords.data(), texCoordsSize);
+	stream.write((const char*)torus.indices.data(), indicesSize);
+
+	return filepath;
+}
+
+static void RemoveMesh(const std::string& filepath)
+{
+	std::filesystem::remove(filepath);
+	std::filesystem::remove(MeshImporter::GetCachePath(filepath));
+}
+
+/* Full parse, expansion and welding of an OBJ text file */
+static void MeshImportObj(benchmark::State& state)
+{
+	const std::string filepath = WriteTorusObj(state.GetArgument());
+	MeshImportOptions options;
+	options.isCacheEnabled = false;
+
+	while (state.KeepRunning())
+		benchmark::DoNotOptimize(MeshImporter::Import(filepath, options));
+
+	state.SetBytesProcessed((long long)std::filesystem::file_size(filepath) * state.GetIterations());
+	RemoveMesh(filepath);
+}
+BENCHMARK(MeshImportObj, 100, 500);
+
+/* Same, but the whole file is one chunk (one thread), to see what the parallel parse buys */
+static void MeshImportObjSingleChunk(benchmark::State& state)
+{
+	const std::string filepath = WriteTorusObj(state.GetArgument());
+	MeshImportOptions options;
+	options.isCacheEnabled = false;
+	options.chunkSize = SIZE_MAX;
+
+	while (state.KeepRunning())
+		benchmark::DoNotOptimize(MeshImporter::Import(filepath, options));
+
+	state.SetBytesProcessed((long long)std::filesystem::file_size(filepath) * state.GetIterations());
+	RemoveMesh(filepath);
+}
+BENCHMARK(MeshImportObjSingleChunk, 100, 500);
+
+static void MeshImportGlb(benchmark::State& state)
+{
+	const std::string filepath = WriteTorusGlb(state.GetArgument());
+	MeshImportOptions options;
+	options.isCacheEnabled = false;
+
+	while (state.KeepRunning())
+		benchmark::DoNotOptimize(MeshImporter::Import(filepath, options));
+
+	state.SetBytesProcessed((long long)std::filesystem::file_size(filepath) * state.GetIterations());
+	RemoveMesh(filepath);
+}
+BENCHMARK(MeshImportGlb, 100, 500);
+
+/* Mapping the cache, then touching one float per page as the upload would */
+static void MeshImportCached(benchmark::State& state)
+{
+	const std::string filepath = WriteTorusObj(state.GetArgument());
+	MeshImporter::Load(filepath);
+
+	std::size_t bytes = 0;
+	while (state.KeepRunning())
+	{
+		auto mesh = MeshImporter::LoadCache(filepath, MeshImportOptions().attributes);
+		if (!mesh)
+		{
+			state.SkipWithError("No valid cache");
+			break;
+		}
+
+		float sum = 0.0f;
+		const std::size_t floatCount = (std::size_t)mesh->GetVertexCount() * MeshData::GetStride(mesh->GetAttributes());
+		for (std::size_t i = 0; i < floatCount; i += 1024)
+			sum += mesh->GetVertices()[i];
+		benchmark::DoNotOptimize(sum);
+
+		bytes = floatCount * sizeof(float) + mesh->GetIndexCount() * sizeof(unsigned int);
+	}
+
+	state.SetBytesProcessed((long long)bytes * state.GetIterations());
+	RemoveMesh(filepath);
+}
+BENCHMARK(MeshImportCached, 100, 500);
@@ -0,0 +1,35 @@
+#include "Benchmark.h"
+#include "tests/TestSombrero.h"
+
+/* Argument: vertices per side (the test itself uses 60) */
+
+static void SombreroGenerateGrid(benchmark::State& state)
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> lineEndpointIndices;
+
+	while (state.KeepRunning())
+	{
+		test::TestSombrero::GenerateGrid(state.GetArgument(), vertices, lineEndpointIndices);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(SombreroGenerateGrid, 64, 256, 1024);
+
+/* Whole grid in a single job, as a baseline for the job system's speedup */
+static void SombreroGenerateGridSingleThread(benchmark::State& state)
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> lineEndpointIndices;
+
+	while (state.KeepRunning())
+	{
+		test::TestSombrero::GenerateGrid(state.GetArgument(), vertices, lineEndpointIndices, state.GetArgument());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(SombreroGenerateGridSingleThread, 64, 256, 1024);
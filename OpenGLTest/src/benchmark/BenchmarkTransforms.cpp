@@ -0,0 +1,136 @@
+#include "Benchmark.h"
+#include "TransformSystem.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+/* Argument: node count, in a 4-ary tree (node i hangs from node (i - 1) / 4, about 9 levels at 100k) */
+static void BuildHierarchy(TransformSystem& transforms, std::size_t count)
+{
+	transforms.Reserve(count);
+	transforms.Create();
+
+	for (std::size_t i = 1; i < count; i++)
+	{
+		const glm::quat rotation = glm::angleAxis(i * 0.01f, glm::vec3(0.0f, 0.0f, 1.0f));
+		transforms.Create((TransformID)((i - 1) / 4), glm::vec3(1.0f, 0.5f, 0.0f), rotation, glm::vec3(0.9f));
+	}
+}
+
+/* Root moved every iteration: the whole tree is dirty */
+static void TransformWorldAll(benchmark::State& state)
+{
+	TransformSystem transforms;
+	BuildHierarchy(transforms, state.GetArgument());
+
+	float angle = 0.0f;
+	while (state.KeepRunning())
+	{
+		transforms.SetRotation(0, glm::angleAxis(angle += 0.01f, glm::vec3(0.0f, 0.0f, 1.0f)));
+		transforms.UpdateWorldMatrices();
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(TransformWorldAll, 10000, 100000);
+
+static void TransformWorldAllSingleThread(benchmark::State& state)
+{
+	TransformSystem transforms;
+	BuildHierarchy(transforms, state.GetArgument());
+
+	float angle = 0.0f;
+	while (state.KeepRunning())
+	{
+		transforms.SetRotation(0, glm::angleAxis(angle += 0.01f, glm::vec3(0.0f, 0.0f, 1.0f)));
+		transforms.UpdateWorldMatrices(0);
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(TransformWorldAllSingleThread, 10000, 100000);
+
+/* One depth-3 node (out of 64) moved every iteration: only its subtree gets recomputed */
+static void TransformWorldPartial(benchmark::State& state)
+{
+	TransformSystem transforms;
+	BuildHierarchy(transforms, state.GetArgument());
+	transforms.UpdateWorldMatrices();
+
+	TransformID node = 21; // First node at depth 3
+	long long updatedCount = 0;
+	while (state.KeepRunning())
+	{
+		transforms.SetPosition(node, transforms.GetPosition(node) + glm::vec3(0.001f));
+		transforms.UpdateWorldMatrices();
+		updatedCount += transforms.GetLastUpdatedCount();
+		node = node == 84 ? 21 : node + 1;
+	}
+
+	state.SetItemsProcessed(updatedCount);
+}
+BENCHMARK(TransformWorldPartial, 10000, 100000);
+
+/* What the tests do today: rebuild every model matrix through glm::translate/rotate/scale, no hierarchy reuse */
+static void TransformWorldAdHocGlm(benchmark::State& state)
+{
+	TransformSystem transforms;
+	BuildHierarchy(transforms, state.GetArgument());
+	std::vector<glm::mat4> worldMatrices(transforms.GetCount());
+
+	while (state.KeepRunning())
+	{
+		for (TransformID id = 0; id < transforms.GetCount(); id++)
+		{
+			glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), transforms.GetPosition(id));
+			modelMatrix = modelMatrix * glm::mat4_cast(transforms.GetRotation(id));
+			modelMatrix = glm::scale(modelMatrix, transforms.GetScale(id));
+
+			const TransformID parent = transforms.GetParent(id);
+			worldMatrices[id] = parent == InvalidTransform ? modelMatrix : worldMatrices[parent] * modelMatrix;
+		}
+
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(TransformWorldAdHocGlm, 10000, 100000);
+
+static void TransformMVPs(benchmark::State& state)
+{
+	TransformSystem transforms;
+	BuildHierarchy(transforms, state.GetArgument());
+	transforms.UpdateWorldMatrices();
+
+	const glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f) * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+
+	while (state.KeepRunning())
+	{
+		transforms.UpdateMVPs(viewProjection, 0);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(TransformMVPs, 10000, 100000);
+
+/* Same products through glm's operator*, as a baseline for the SIMD batch */
+static void TransformMVPsGlm(benchmark::State& state)
+{
+	TransformSystem transforms;
+	BuildHierarchy(transforms, state.GetArgument());
+	transforms.UpdateWorldMatrices();
+	std::vector<glm::mat4> mvps(transforms.GetCount());
+
+	const glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f) * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+
+	while (state.KeepRunning())
+	{
+		for (TransformID id = 0; id < transforms.GetCount(); id++)
+			mvps[id] = viewProjection * transforms.GetWorldMatrix(id);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(TransformMVPsGlm, 10000, 100000);
@@ -0,0 +1,37 @@
+#include "Benchmark.h"
+#include "VertexBufferLayout.h"
+
+/* Position, texture coordinates and a material index, as the textured tests would lay them out */
+static void VertexBufferLayoutPush(benchmark::State& state)
+{
+	while (state.KeepRunning())
+	{
+		VertexBufferLayout layout;
+		layout.Push(GL_FLOAT, 3);
+		layout.Push(GL_FLOAT, 2);
+		layout.Push(GL_UNSIGNED_INT, 1);
+		benchmark::DoNotOptimize(layout.GetStride());
+	}
+
+	state.SetItemsProcessed(3 * (long long)state.GetIterations());
+}
+BENCHMARK(VertexBufferLayoutPush);
+
+/* `VertexArray::AddBuffer` walks the elements every time a buffer is bound to a layout */
+static void VertexBufferLayoutGetElements(benchmark::State& state)
+{
+	VertexBufferLayout layout;
+	for (long long i = 0; i < state.GetArgument(); i++)
+		layout.Push(GL_FLOAT, 4);
+
+	while (state.KeepRunning())
+	{
+		unsigned int count = 0;
+		for (const VertexBufferElement& element : layout.GetElements())
+			count += element.count;
+		benchmark::DoNotOptimize(count);
+	}
+
+	state.SetItemsProcessed(state.GetArgument() * (long long)state.GetIterations());
+}
+BENCHMARK(VertexBufferLayoutGetElements, 1, 4, 16);
@@ -0,0 +1,121 @@
+#include "SceneBenchmark.h"
+#include "Renderer.h"
+#include "RenderBackend.h"
+#include "SoftwareRasterizer.h"
+#include "FrameCapture.h"
+#include "GLHandleError.h"
+#include "FrameArena.h"
+
+#include "tests/TestClearColor.h"
+#include "tests/TestSquare.h"
+#include "tests/TestSombrero.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace benchmark
+{
+	struct Scene
+	{
+		const char* name;
+		const char* filename;
+		std::function<test::Test*()> create;
+	};
+
+	static void RenderFrame(Renderer& renderer, test::Test& test)
+	{
+		/* Frame boundary, as in the main loop */
+		FrameArena::Get().Reset();
+
+		test.OnUpdate(1.0f / 60.0f);
+		test.SetInterpolationAlpha(1.0f);
+		test.OnPublishRenderState();
+
+		renderer.SetClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		renderer.Clear();
+		test.OnRender(renderer);
+
+		/* Draws are only queued on GL, the frame has to be done for the time to mean anything */
+		if (!IsSoftwareRendering())
+		{
+			GL_CALL(glFinish());
+		}
+	}
+
+	static void SaveFrame(const SceneOptions& options, const Scene& scene)
+	{
+		std::vector<uint8_t> pixels;
+		int width = options.width;
+		int height = options.height;
+
+		if (IsSoftwareRendering())
+		{
+			const SoftwareRasterizer& rasterizer = SoftwareRasterizer::Get();
+			width = rasterizer.GetWidth();
+			height = rasterizer.GetHeight();
+			const uint8_t* data = (const uint8_t*)rasterizer.GetPixels();
+			pixels.assign(data, data + (std::size_t)width * height * 4);
+		}
+		else
+		{
+			pixels.resize((std::size_t)width * height * 4);
+			GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+			GL_CALL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+		}
+
+		std::filesystem::create_directories(options.captureDirectory);
+		const std::string filepath = (std::filesystem::path(options.captureDirectory) / (std::string(scene.filename) + (IsSoftwareRendering() ? "-software.png" : "-opengl.png"))).string();
+		if (!FrameCapture::SavePng(filepath, pixels.data(), width, height))
+			std::printf("Failed to write %s\n", filepath.c_str());
+	}
+
+	int RunScenes(const SceneOptions& options)
+	{
+		const Scene scenes[] = {
+			{ "Clear color", "clear-color", []() -> test::Test* { return new test::TestClearColor(); } },
+			{ "Square", "square", []() -> test::Test* { return new test::TestSquare(); } },
+			{ "Sombrero", "sombrero", []() -> test::Test* { return new test::TestSombrero(); } }
+		};
+
+		const bool isSoftware = IsSoftwareRendering();
+		std::printf("Scenes on the %s backend, %d frames each\n", isSoftware ? "software" : "OpenGL", options.frames);
+		if (isSoftware)
+			std::printf("%-16s %12s %10s %16s %16s\n", "Scene", "ms/frame", "FPS", "Triangles/frame", "Mpixels/s");
+		else
+			std::printf("%-16s %12s %10s\n", "Scene", "ms/frame", "FPS");
+
+		Renderer renderer;
+		for (const Scene& scene : scenes)
+		{
+			std::unique_ptr<test::Test> test(scene.create());
+
+			/* First frame outside of the measurement: lazy initialization, caches, ... */
+			RenderFrame(renderer, *test);
+			SoftwareRasterizer::Get().ResetStats();
+
+			const auto start = std::chrono::steady_clock::now();
+			for (int frame = 0; frame < options.frames; frame++)
+				RenderFrame(renderer, *test);
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			const double milliseconds = seconds * 1000.0 / options.frames;
+			if (isSoftware)
+			{
+				const SoftwareRasterizer& rasterizer = SoftwareRasterizer::Get();
+				std::printf("%-16s %12.3f %10.1f %16.0f %16.1f\n", scene.name, milliseconds, 1000.0 / milliseconds,
+					(double)rasterizer.GetTriangleCount() / options.frames, rasterizer.GetFragmentCount() / seconds / 1e6);
+			}
+			else
+				std::printf("%-16s %12.3f %10.1f\n", scene.name, milliseconds, 1000.0 / milliseconds);
+
+			if (!options.captureDirectory.empty())
+				SaveFrame(options, scene);
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+namespace benchmark
+{
+	struct SceneOptions
+	{
+		int frames = 300; // Per scene, at a fixed 60 Hz simulation step
+		int width = 0; // Of what gets captured (the window or the software color buffer)
+		int height = 0;
+		std::string captureDirectory; // Saves each scene's last frame there as a PNG when set
+	};
+
+	/*
+	 * Renders the Clear color, Square and Sombrero tests for `frames` frames each with whichever backend is active, waiting
+	 * for every frame to be done, and prints the time per frame (`--scene-benchmark`, and `--backend software`).
+	 * Running it under Mesa with LIBGL_ALWAYS_SOFTWARE=1 measures llvmpipe on the same scenes
+	 */
+	int RunScenes(const SceneOptions& options);
+}
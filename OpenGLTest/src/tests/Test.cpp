@@ -1,4 +1,7 @@
 #include "Test.h"
+#include "ResourceManager.h"
+#include "GpuMemoryTracker.h"
+#include "RenderStats.h"
 
 namespace test
 {
@@ -7,12 +10,23 @@ namespace test
 	{
 	}
 
+	Test* TestMenu::CreateTest(std::size_t index)
+	{
+		GpuMemoryTracker::Get().SetScope(m_Tests[index].first);
+		RenderStats::Get().SetScope(m_Tests[index].first);
+		return m_Tests[index].second();
+	}
+
 	void TestMenu::OnImGuiRender(ImGuiIO& io)
 	{
-		for (auto& test : m_Tests)
+		for (std::size_t i = 0; i < m_Tests.size(); i++)
 		{
-			if (ImGui::Button(test.first.c_str()))
-				m_CurrentTest = test.second();
+			if (ImGui::Button(m_Tests[i].first.c_str()))
+				m_CurrentTest = CreateTest(i);
 		}
+
+		ResourceManager::Get().OnImGuiRender();
+		GpuMemoryTracker::Get().OnImGuiRender();
+		RenderStats::Get().OnImGuiRender();
 	}
 }
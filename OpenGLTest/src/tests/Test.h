@@ -3,9 +3,12 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <atomic>
 
 #include "Renderer.h"
 
+#include <GLFW/glfw3.h>
+
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_opengl3.h"
@@ -18,9 +21,28 @@ namespace test
 		Test() {};
 		virtual ~Test() {};
 
+		// Called at a fixed rate, possibly several times per frame and from a worker thread: no OpenGL nor ImGui calls in here
 		virtual void OnUpdate(float deltaTime) {}
-		virtual void OnRender(Renderer renderer) {}
+		// Called on the main thread while no simulation is running: copy what `OnRender` needs out of the simulated state
+		virtual void OnPublishRenderState() {}
+		virtual void OnRender(Renderer& renderer) {}
 		virtual void OnImGuiRender(ImGuiIO& io) {}
+
+		// How far the published state is between its last two simulation steps
+		inline void SetInterpolationAlpha(float alpha) { m_InterpolationAlpha = alpha; }
+
+		// Whether the scene changes by itself from one frame to the next (otherwise on-demand rendering waits for input)
+		virtual bool IsAnimating() const { return true; }
+
+		// For changes that don't come from input (work finishing on another thread, ...): the next frame gets rendered
+		inline void MarkDirty() { m_IsDirty = true; glfwPostEmptyEvent(); }
+		inline bool ConsumeDirty() { return m_IsDirty.exchange(false); }
+
+	protected:
+		float m_InterpolationAlpha = 1.0f;
+
+	private:
+		std::atomic<bool> m_IsDirty = { false };
 	};
 
 	class TestMenu : public Test
@@ -29,6 +51,7 @@ namespace test
 		TestMenu(Test*& currentTestPointer);
 		
 		void OnImGuiRender(ImGuiIO& io) override;
+		bool IsAnimating() const override { return false; }
 
 		template <typename T>
 		void RegisterTest(const std::string& name)
@@ -37,6 +60,11 @@ namespace test
 			m_Tests.push_back(std::make_pair(name, std::function<Test*()>([]() -> Test* { return new T(); })));
 		}
 
+		inline std::size_t GetTestCount() const { return m_Tests.size(); }
+		inline const std::string& GetTestName(std::size_t index) const { return m_Tests[index].first; }
+		// Creates a registered test (its GPU memory gets charged to it), the caller owns it
+		Test* CreateTest(std::size_t index);
+
 	private:
 		Test*& m_CurrentTest;
 		std::vector<std::pair<std::string, std::function<Test*()>>> m_Tests;
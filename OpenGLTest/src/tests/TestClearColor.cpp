@@ -1,5 +1,4 @@
 #include "TestClearColor.h"
-#include "GLHandleError.h"
 #include "imgui/imgui.h"
 
 namespace test
@@ -9,15 +8,15 @@ namespace test
 	{
 	}
 
-	void test::TestClearColor::OnRender(Renderer renderer)
+	void test::TestClearColor::OnRender(Renderer& renderer)
 	{
-		GL_CALL(glClearColor(
+		renderer.SetClearColor(
 			m_Clear_Color[0],
 			m_Clear_Color[1],
 			m_Clear_Color[2],
 			m_Clear_Color[3]
-		));
-		GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
+		);
+		renderer.Clear();
 	}
 
 	void test::TestClearColor::OnImGuiRender(ImGuiIO& io)
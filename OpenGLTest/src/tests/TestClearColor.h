@@ -9,8 +9,9 @@ namespace test
 	public:
 		TestClearColor();
 
-		void OnRender(Renderer renderer) override;
+		void OnRender(Renderer& renderer) override;
 		void OnImGuiRender(ImGuiIO& io) override;
+		bool IsAnimating() const override { return false; }
 
 	private:
 		float m_Clear_Color[4];
@@ -0,0 +1,185 @@
+#include "TestCulling.h"
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+
+#include <chrono>
+#include <random>
+
+namespace test
+{
+	TestCulling::TestCulling()
+	{
+		/* Unit wireframe cube, scaled per object */
+		float vertices[] = {
+			-0.5f, -0.5f, -0.5f,
+			 0.5f, -0.5f, -0.5f,
+			 0.5f,  0.5f, -0.5f,
+			-0.5f,  0.5f, -0.5f,
+			-0.5f, -0.5f,  0.5f,
+			 0.5f, -0.5f,  0.5f,
+			 0.5f,  0.5f,  0.5f,
+			-0.5f,  0.5f,  0.5f
+		};
+
+		unsigned int lineEndpointIndices[] = {
+			0, 1, 1, 2, 2, 3, 3, 0,
+			4, 5, 5, 6, 6, 7, 7, 4,
+			0, 4, 1, 5, 2, 6, 3, 7
+		};
+
+		VertexBuffer vb(vertices, sizeof(vertices));
+
+		VertexBufferLayout layout;
+		layout.Push(GL_FLOAT, 3);
+
+		m_VertexArray.AddBuffer(vb, layout);
+		m_IndexBuffer = new IndexBuffer(lineEndpointIndices, 24);
+
+		m_Shader->Bind();
+		m_Shader->SetUniform4f("u_Color", 0.3f, 0.8f, 1.0f, 1.0f);
+
+		m_VertexArray.Unbind();
+		m_Shader->Unbind();
+		vb.Unbind();
+		m_IndexBuffer->Unbind();
+
+		Generate();
+	}
+
+	TestCulling::~TestCulling()
+	{
+		delete m_IndexBuffer;
+		m_IndexBuffer = nullptr;
+	}
+
+	void TestCulling::Generate()
+	{
+		/* Fixed seed, so the numbers are comparable between runs */
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+		std::uniform_real_distribution<float> size(0.5f, 2.0f);
+
+		m_BasePositions.resize(m_ObjectCount);
+		m_Sizes.resize(m_ObjectCount);
+		std::vector<AABB> bounds(m_ObjectCount);
+
+		/* Room for every object to be visible, so culling (and publishing) never grows it mid-frame */
+		m_VisibleObjects.reserve(m_ObjectCount);
+		m_RenderMatrices.reserve(m_ObjectCount);
+
+		m_Transforms.Clear();
+		m_Transforms.Reserve(m_ObjectCount);
+
+		for (int i = 0; i < m_ObjectCount; i++)
+		{
+			m_BasePositions[i] = glm::vec3(position(random), position(random), position(random));
+			m_Sizes[i] = size(random);
+			bounds[i] = { m_BasePositions[i] - m_Sizes[i] * 0.5f, m_BasePositions[i] + m_Sizes[i] * 0.5f };
+
+			m_Transforms.Create(InvalidTransform, m_BasePositions[i], glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(m_Sizes[i]));
+		}
+
+		m_Transforms.UpdateWorldMatrices();
+		m_Bvh.Build(bounds);
+		OnPublishRenderState();
+	}
+
+	void TestCulling::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+
+		/* Move the orbiting objects and refit the hierarchy around them (instead of rebuilding it) */
+		const auto start = std::chrono::steady_clock::now();
+
+		const int movingCount = (int)(m_MovingFraction * m_BasePositions.size());
+		for (int i = 0; i < movingCount; i++)
+		{
+			const float phase = m_Time + i * 0.1f;
+			const glm::vec3 position = m_BasePositions[i] + glm::vec3(std::sin(phase), std::cos(phase * 0.7f), std::cos(phase)) * 5.0f;
+
+			m_Transforms.SetPosition(i, position);
+			m_Bvh.UpdateBounds(i, { position - m_Sizes[i] * 0.5f, position + m_Sizes[i] * 0.5f });
+		}
+
+		m_Transforms.UpdateWorldMatrices();
+		m_Bvh.Refit();
+
+		m_RefitMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void TestCulling::OnPublishRenderState()
+	{
+		m_RenderTime = m_Time;
+
+		const glm::mat4* worldMatrices = &m_Transforms.GetWorldMatrix(0);
+		m_RenderMatrices.assign(worldMatrices, worldMatrices + m_Transforms.GetCount());
+		m_RenderBvh = m_Bvh;
+	}
+
+	void TestCulling::OnRender(Renderer& renderer)
+	{
+		const float yaw = glm::radians(m_RenderTime * m_CameraSpeed);
+		const glm::mat4 projectionMatrix = glm::perspective(glm::radians(m_FieldOfView), (float)WindowWidth / WindowHeight, 0.1f, 300.0f);
+		const glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f), glm::vec3(std::sin(yaw), 0.0f, -std::cos(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 viewProjection = projectionMatrix * viewMatrix;
+
+		if (!m_IsCullingCameraFrozen)
+			m_CullingViewProjection = viewProjection;
+
+		m_VisibleObjects.clear();
+		const Frustum frustum = Frustum::FromViewProjection(m_CullingViewProjection);
+
+		switch ((CullingMode)m_CullingMode)
+		{
+		case CullingMode::NONE:
+			for (uint32_t i = 0; i < m_RenderMatrices.size(); i++)
+				m_VisibleObjects.push_back(i);
+			m_Stats = CullingStats();
+			m_Stats.visibleCount = m_RenderMatrices.size();
+			break;
+		case CullingMode::FLAT:
+			m_RenderBvh.CullFlat(frustum, m_VisibleObjects, m_Stats);
+			break;
+		case CullingMode::BVH:
+			m_RenderBvh.Cull(frustum, m_VisibleObjects, m_Stats);
+			break;
+		}
+
+		renderer.DrawVisible(m_VertexArray, *m_IndexBuffer, *m_Shader, viewProjection, m_RenderMatrices.data(), m_VisibleObjects, GL_LINES);
+	}
+
+	void TestCulling::OnImGuiRender(ImGuiIO& io)
+	{
+		ImGui::SliderInt("Objects (on regenerate)", &m_ObjectCount, 1000, 200000);
+		ImGui::SliderFloat("Moving fraction", &m_MovingFraction, 0.0f, 1.0f);
+		if (ImGui::Button("Regenerate"))
+			Generate();
+
+		ImGui::RadioButton("No culling", &m_CullingMode, (int)CullingMode::NONE);
+		ImGui::SameLine();
+		ImGui::RadioButton("Flat (SIMD)", &m_CullingMode, (int)CullingMode::FLAT);
+		ImGui::SameLine();
+		ImGui::RadioButton("BVH", &m_CullingMode, (int)CullingMode::BVH);
+
+		ImGui::Checkbox("Freeze culling camera", &m_IsCullingCameraFrozen);
+		ImGui::SliderFloat("Field of view", &m_FieldOfView, 20.0f, 120.0f);
+		ImGui::SliderFloat("Camera speed (deg/s)", &m_CameraSpeed, -90.0f, 90.0f);
+
+		ImGui::Text("Visible %zu - culled %zu (of %zu)", m_Stats.visibleCount, m_Stats.culledCount, m_Bvh.GetObjectCount());
+		ImGui::Text("Culling %.3f ms - %zu nodes visited", m_Stats.milliseconds, m_Stats.nodesVisited);
+		ImGui::Text("Move + refit %.3f ms - %zu nodes, %zu refits since the last build", m_RefitMilliseconds, m_Bvh.GetNodeCount(), m_Bvh.GetRefitCount());
+
+		if (ImGui::Button("Rebuild BVH"))
+		{
+			std::vector<AABB> bounds(m_BasePositions.size());
+			for (std::size_t i = 0; i < bounds.size(); i++)
+			{
+				const glm::vec3 position = m_Transforms.GetPosition(i);
+				bounds[i] = { position - m_Sizes[i] * 0.5f, position + m_Sizes[i] * 0.5f };
+			}
+			m_Bvh.Build(bounds);
+			OnPublishRenderState();
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Test.h"
+#include "AppWindow.h"
+#include "ResourceManager.h"
+#include "TransformSystem.h"
+#include "Bvh.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	class TestCulling : public Test
+	{
+	public:
+		TestCulling();
+		~TestCulling();
+
+		void OnUpdate(float deltaTime) override;
+		void OnPublishRenderState() override;
+		void OnRender(Renderer& renderer) override;
+		void OnImGuiRender(ImGuiIO& io) override;
+
+	private:
+		enum class CullingMode
+		{
+			NONE = 0,
+			FLAT = 1, // Every box, four at a time
+			BVH = 2
+		};
+
+		void Generate();
+
+		ResourceHandle<Shader> m_Shader = ResourceManager::Get().GetShader("res/shaders/Sombrero.shader");
+		VertexArray m_VertexArray;
+		IndexBuffer* m_IndexBuffer = nullptr;
+
+		int m_ObjectCount = 20000; // Applied on `Generate`
+		float m_MovingFraction = 0.1f; // The first objects orbit around their base position
+		std::vector<glm::vec3> m_BasePositions;
+		std::vector<float> m_Sizes;
+
+		TransformSystem m_Transforms;
+		Bvh m_Bvh;
+
+		int m_CullingMode = (int)CullingMode::BVH;
+		bool m_IsCullingCameraFrozen = false; // Keeps culling against the old frustum while the camera moves, to see what gets culled
+		glm::mat4 m_CullingViewProjection = glm::mat4(1.0f);
+		float m_FieldOfView = 60.0f;
+		float m_CameraSpeed = 10.0f; // Degrees per second
+
+		/* Simulated state */
+		float m_Time = 0.0f;
+		float m_RefitMilliseconds = 0.0f;
+
+		/* Render state, copied from the simulated one so the next steps can run while it's culled and drawn */
+		float m_RenderTime = 0.0f;
+		std::vector<glm::mat4> m_RenderMatrices;
+		Bvh m_RenderBvh;
+
+		std::vector<uint32_t> m_VisibleObjects;
+		CullingStats m_Stats;
+	};
+}
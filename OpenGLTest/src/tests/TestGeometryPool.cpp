@@ -0,0 +1,212 @@
+#include "TestGeometryPool.h"
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace test
+{
+	TestGeometryPool::TestGeometryPool()
+		: m_Random(42)
+	{
+		m_Shader->Bind();
+		m_Shader->SetUniform4f("u_Color", 0.9f, 0.6f, 0.3f, 1.0f);
+		m_Shader->Unbind();
+
+		Generate();
+	}
+
+	void TestGeometryPool::Generate()
+	{
+		m_PoolMeshes.clear();
+		m_SeparateMeshes.clear();
+
+		VertexBufferLayout layout;
+		layout.Push(GL_FLOAT, 3);
+		m_Pool = std::make_unique<GeometryPool>(layout);
+		m_GeneratedStorage = (Storage)m_Storage;
+
+		m_PoolMeshes.resize(m_ObjectCount, InvalidMesh);
+		m_SeparateMeshes.resize(m_ObjectCount);
+		m_ModelMatrices.resize(m_ObjectCount);
+		m_AllObjects.resize(m_ObjectCount);
+
+		/* On a grid around the camera */
+		const int side = (int)std::ceil(std::sqrt((float)m_ObjectCount));
+		for (int i = 0; i < m_ObjectCount; i++)
+		{
+			const glm::vec3 position((i % side - side * 0.5f) * 3.0f, -4.0f, (i / side - side * 0.5f) * 3.0f);
+			m_ModelMatrices[i] = glm::translate(glm::mat4(1.0f), position);
+			m_AllObjects[i] = i;
+
+			CreateMesh(i);
+		}
+	}
+
+	void TestGeometryPool::CreateMesh(uint32_t object)
+	{
+		/* A wireframe blob: latitude rings and meridians, with a random resolution so the meshes all have different sizes */
+		std::uniform_int_distribution<int> stackDistribution(2, 16);
+		std::uniform_int_distribution<int> sliceDistribution(3, 24);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		const int stacks = stackDistribution(m_Random);
+		const int slices = sliceDistribution(m_Random);
+		const float bumpiness = unit(m_Random) * 0.3f;
+		const float phase = unit(m_Random) * 6.28f;
+
+		std::vector<float> vertices;
+		std::vector<unsigned int> lineEndpointIndices;
+		vertices.reserve((stacks + 1) * slices * 3);
+
+		for (int stack = 0; stack <= stacks; stack++)
+		{
+			const float latitude = 3.1416f * stack / stacks;
+			for (int slice = 0; slice < slices; slice++)
+			{
+				const float longitude = 6.2832f * slice / slices;
+				const float radius = 1.0f + bumpiness * std::sin(latitude * 3.0f + phase) * std::cos(longitude * 2.0f);
+
+				vertices.push_back(radius * std::sin(latitude) * std::cos(longitude));
+				vertices.push_back(radius * std::cos(latitude));
+				vertices.push_back(radius * std::sin(latitude) * std::sin(longitude));
+
+				const unsigned int vertex = stack * slices + slice;
+				lineEndpointIndices.push_back(vertex);
+				lineEndpointIndices.push_back(stack * slices + (slice + 1) % slices);
+				if (stack < stacks)
+				{
+					lineEndpointIndices.push_back(vertex);
+					lineEndpointIndices.push_back(vertex + slices);
+				}
+			}
+		}
+
+		const uint32_t vertexCount = (uint32_t)vertices.size() / 3;
+		if (m_GeneratedStorage == Storage::POOL)
+		{
+			m_PoolMeshes[object] = m_Pool->Allocate(vertices.data(), vertexCount, lineEndpointIndices.data(), (uint32_t)lineEndpointIndices.size());
+			return;
+		}
+
+		SeparateMesh& mesh = m_SeparateMeshes[object];
+		mesh.vertexArray = std::make_unique<VertexArray>();
+		mesh.vertexBuffer = std::make_unique<VertexBuffer>(vertices.data(), (unsigned int)(vertices.size() * sizeof(float)));
+
+		VertexBufferLayout layout;
+		layout.Push(GL_FLOAT, 3);
+		mesh.vertexArray->AddBuffer(*mesh.vertexBuffer, layout);
+		mesh.indexBuffer = std::make_unique<IndexBuffer>(lineEndpointIndices.data(), (unsigned int)lineEndpointIndices.size());
+
+		mesh.vertexArray->Unbind();
+		mesh.vertexBuffer->Unbind();
+		mesh.indexBuffer->Unbind();
+	}
+
+	void TestGeometryPool::DestroyMesh(uint32_t object)
+	{
+		if (m_GeneratedStorage == Storage::POOL)
+		{
+			m_Pool->Free(m_PoolMeshes[object]);
+			m_PoolMeshes[object] = InvalidMesh;
+			return;
+		}
+
+		m_SeparateMeshes[object] = SeparateMesh();
+	}
+
+	void TestGeometryPool::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+	}
+
+	void TestGeometryPool::OnPublishRenderState()
+	{
+		m_RenderTime = m_Time;
+	}
+
+	void TestGeometryPool::OnRender(Renderer& renderer)
+	{
+		/* Streaming allocates and frees GL buffers (or pool blocks), so it stays on the render thread */
+		if (m_IsStreaming && !m_AllObjects.empty())
+		{
+			std::uniform_int_distribution<uint32_t> objectDistribution(0, (uint32_t)m_AllObjects.size() - 1);
+			for (int i = 0; i < m_StreamedPerFrame; i++)
+			{
+				const uint32_t object = objectDistribution(m_Random);
+				DestroyMesh(object);
+				CreateMesh(object);
+			}
+		}
+
+		const float yaw = glm::radians(m_RenderTime * m_CameraSpeed);
+		const glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), (float)WindowWidth / WindowHeight, 0.1f, 300.0f);
+		const glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f), glm::vec3(std::sin(yaw), -0.3f, -std::cos(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 viewProjection = projectionMatrix * viewMatrix;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		if (m_GeneratedStorage == Storage::POOL)
+		{
+			renderer.DrawVisible(*m_Pool, m_PoolMeshes.data(), *m_Shader, viewProjection, m_ModelMatrices.data(), m_AllObjects, GL_LINES);
+		}
+		else
+		{
+			/* One vertex array and index buffer bind per object */
+			for (uint32_t object : m_AllObjects)
+			{
+				m_Shader->Bind();
+				m_Shader->SetUniformMat4f("u_MVP", viewProjection * m_ModelMatrices[object]);
+				renderer.Draw(*m_SeparateMeshes[object].vertexArray, *m_SeparateMeshes[object].indexBuffer, *m_Shader, GL_LINES);
+			}
+		}
+
+		const float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_SubmissionMilliseconds = m_SubmissionMilliseconds * 0.95f + milliseconds * 0.05f;
+	}
+
+	void TestGeometryPool::OnImGuiRender(ImGuiIO& io)
+	{
+		ImGui::SliderInt("Objects (on regenerate)", &m_ObjectCount, 100, 20000);
+		ImGui::RadioButton("Separate buffers", &m_Storage, (int)Storage::SEPARATE_BUFFERS);
+		ImGui::SameLine();
+		ImGui::RadioButton("Geometry pool", &m_Storage, (int)Storage::POOL);
+		if (ImGui::Button("Regenerate"))
+			Generate();
+
+		ImGui::Checkbox("Stream meshes", &m_IsStreaming);
+		ImGui::SliderInt("Meshes replaced per frame", &m_StreamedPerFrame, 1, 500);
+		ImGui::SliderFloat("Camera speed (deg/s)", &m_CameraSpeed, -90.0f, 90.0f);
+
+		ImGui::Text("CPU submission %.3f ms", m_SubmissionMilliseconds);
+
+		if (m_GeneratedStorage == Storage::SEPARATE_BUFFERS)
+		{
+			ImGui::Text("%zu vertex arrays, %zu buffers", m_SeparateMeshes.size(), m_SeparateMeshes.size() * 2);
+			return;
+		}
+
+		if (ImGui::CollapsingHeader("Pool", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			const GeometryPoolStats stats = m_Pool->GetStats();
+
+			ImGui::Text("%zu meshes in %zu pages (%zu buffers)", stats.meshCount, stats.pageCount, stats.pageCount * 2);
+			ImGui::Text("Vertices: %.1f%% allocated, %.1f%% of that used", 100.0f * stats.allocatedVertices / std::max<std::size_t>(stats.vertexCapacity, 1), 100.0f * stats.usedVertices / std::max<std::size_t>(stats.allocatedVertices, 1));
+			ImGui::Text("Indices: %.1f%% allocated, %.1f%% of that used", 100.0f * stats.allocatedIndices / std::max<std::size_t>(stats.indexCapacity, 1), 100.0f * stats.usedIndices / std::max<std::size_t>(stats.allocatedIndices, 1));
+			ImGui::Text("Largest free block: %zu vertices, %zu indices", stats.largestFreeVertexBlock, stats.largestFreeIndexBlock);
+			ImGui::Text("External fragmentation (worst page): vertices %.2f, indices %.2f", stats.vertexFragmentation, stats.indexFragmentation);
+
+			if (ImGui::Button("Defragment"))
+			{
+				const auto start = std::chrono::steady_clock::now();
+				m_ReleasedPages = m_Pool->Defragment();
+				m_DefragmentMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			}
+			ImGui::SameLine();
+			ImGui::Text("%.3f ms, %zu pages released", m_DefragmentMilliseconds, m_ReleasedPages);
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Test.h"
+#include "AppWindow.h"
+#include "ResourceManager.h"
+#include "GeometryPool.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <memory>
+#include <random>
+
+namespace test
+{
+	/* Thousands of distinct small meshes, each in its own buffers or all suballocated from a geometry pool */
+	class TestGeometryPool : public Test
+	{
+	public:
+		TestGeometryPool();
+
+		void OnUpdate(float deltaTime) override;
+		void OnPublishRenderState() override;
+		void OnRender(Renderer& renderer) override;
+		void OnImGuiRender(ImGuiIO& io) override;
+		bool IsAnimating() const override { return m_CameraSpeed != 0.0f || m_IsStreaming; }
+
+	private:
+		enum class Storage
+		{
+			SEPARATE_BUFFERS = 0,
+			POOL = 1
+		};
+
+		struct SeparateMesh
+		{
+			std::unique_ptr<VertexArray> vertexArray;
+			std::unique_ptr<VertexBuffer> vertexBuffer;
+			std::unique_ptr<IndexBuffer> indexBuffer;
+		};
+
+		void Generate();
+		// Replaces the mesh of `object` by a new random one
+		void CreateMesh(uint32_t object);
+		void DestroyMesh(uint32_t object);
+
+		ResourceHandle<Shader> m_Shader = ResourceManager::Get().GetShader("res/shaders/Sombrero.shader");
+		std::unique_ptr<GeometryPool> m_Pool;
+		std::mt19937 m_Random;
+
+		int m_Storage = (int)Storage::POOL; // Applied on `Generate`
+		Storage m_GeneratedStorage = Storage::POOL;
+		int m_ObjectCount = 4000; // Applied on `Generate`
+
+		std::vector<MeshID> m_PoolMeshes; // Per object, one of them is used depending on the storage
+		std::vector<SeparateMesh> m_SeparateMeshes;
+		std::vector<glm::mat4> m_ModelMatrices;
+		std::vector<uint32_t> m_AllObjects;
+
+		bool m_IsStreaming = false; // Replaces meshes every frame, like streaming levels of detail in and out
+		int m_StreamedPerFrame = 20;
+		float m_CameraSpeed = 10.0f; // Degrees per second
+
+		/* Simulated state */
+		float m_Time = 0.0f;
+
+		/* Render state */
+		float m_RenderTime = 0.0f;
+
+		float m_SubmissionMilliseconds = 0.0f; // Smoothed
+		float m_DefragmentMilliseconds = 0.0f;
+		std::size_t m_ReleasedPages = 0;
+	};
+}
@@ -0,0 +1,213 @@
+#include "TestGpuDriven.h"
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+
+#include <chrono>
+#include <random>
+
+namespace test
+{
+	TestGpuDriven::TestGpuDriven()
+		: m_IsGpuDrivenSupported(GpuDrivenRenderer::IsSupported()), m_IsGpuDriven(false)
+	{
+		if (m_IsGpuDrivenSupported)
+		{
+			m_GpuDrivenRenderer = std::make_unique<GpuDrivenRenderer>();
+			m_IsGpuDriven = true;
+		}
+
+		/* A few small meshes, shared by every object */
+		const float cubeVertices[] = {
+			-0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f,  0.5f, -0.5f,  -0.5f,  0.5f, -0.5f,
+			-0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f,  0.5f,  0.5f,  -0.5f,  0.5f,  0.5f
+		};
+		const unsigned int cubeIndices[] = {
+			0, 2, 1, 0, 3, 2,   4, 5, 6, 4, 6, 7,   0, 1, 5, 0, 5, 4,
+			3, 6, 2, 3, 7, 6,   0, 4, 7, 0, 7, 3,   1, 2, 6, 1, 6, 5
+		};
+		AddMesh(cubeVertices, 8, cubeIndices, 36);
+
+		const float pyramidVertices[] = {
+			-0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f, -0.5f,  0.5f,  -0.5f, -0.5f,  0.5f,
+			 0.0f,  0.5f,  0.0f
+		};
+		const unsigned int pyramidIndices[] = {
+			0, 1, 2, 0, 2, 3,   0, 4, 1,   1, 4, 2,   2, 4, 3,   3, 4, 0
+		};
+		AddMesh(pyramidVertices, 5, pyramidIndices, 18);
+
+		const float octahedronVertices[] = {
+			 0.5f,  0.0f,  0.0f,  -0.5f,  0.0f,  0.0f,   0.0f,  0.5f,  0.0f,
+			 0.0f, -0.5f,  0.0f,   0.0f,  0.0f,  0.5f,   0.0f,  0.0f, -0.5f
+		};
+		const unsigned int octahedronIndices[] = {
+			0, 2, 4,   4, 2, 1,   1, 2, 5,   5, 2, 0,
+			0, 4, 3,   4, 1, 3,   1, 5, 3,   5, 0, 3
+		};
+		AddMesh(octahedronVertices, 6, octahedronIndices, 24);
+
+		if (m_GpuDrivenRenderer)
+			m_GpuDrivenRenderer->UploadMeshes();
+
+		m_Shader->Bind();
+		m_Shader->Unbind();
+
+		Generate();
+	}
+
+	void TestGpuDriven::AddMesh(const float* positions, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount)
+	{
+		/* Classic path: one vertex array and index buffer per mesh */
+		Mesh mesh;
+		mesh.vertexArray = std::make_unique<VertexArray>();
+		mesh.vertexBuffer = std::make_unique<VertexBuffer>(positions, vertexCount * 3 * sizeof(float));
+
+		VertexBufferLayout layout;
+		layout.Push(GL_FLOAT, 3);
+		mesh.vertexArray->AddBuffer(*mesh.vertexBuffer, layout);
+		mesh.indexBuffer = std::make_unique<IndexBuffer>(indices, indexCount);
+
+		mesh.vertexArray->Unbind();
+		mesh.vertexBuffer->Unbind();
+		mesh.indexBuffer->Unbind();
+
+		AABB bounds = { glm::vec3(positions[0], positions[1], positions[2]), glm::vec3(positions[0], positions[1], positions[2]) };
+		for (uint32_t i = 1; i < vertexCount; i++)
+		{
+			bounds.min = glm::min(bounds.min, glm::vec3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]));
+			bounds.max = glm::max(bounds.max, glm::vec3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]));
+		}
+
+		m_Meshes.push_back(std::move(mesh));
+		m_MeshBounds.push_back(bounds);
+
+		/* GPU-driven path: everything appended to the shared buffers */
+		if (m_GpuDrivenRenderer)
+			m_GpuDrivenRenderer->AddMesh(positions, vertexCount, indices, indexCount);
+	}
+
+	void TestGpuDriven::Generate()
+	{
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> position(-150.0f, 150.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		m_ObjectMeshes.resize(m_ObjectCount);
+		m_ModelMatrices.resize(m_ObjectCount);
+		m_Colors.resize(m_ObjectCount);
+		std::vector<AABB> bounds(m_ObjectCount);
+
+		/* The CPU path refills it every frame, sized up front for everything being visible */
+		m_VisibleObjects.reserve(m_ObjectCount);
+
+		if (m_GpuDrivenRenderer)
+			m_GpuDrivenRenderer->ClearObjects();
+
+		for (int i = 0; i < m_ObjectCount; i++)
+		{
+			m_ObjectMeshes[i] = i % m_Meshes.size();
+			glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random), position(random)));
+			modelMatrix = glm::rotate(modelMatrix, unit(random) * 6.28f, glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + 0.01f));
+			m_ModelMatrices[i] = glm::scale(modelMatrix, glm::vec3(0.5f + unit(random) * 1.5f));
+			m_Colors[i] = glm::vec4(0.3f + unit(random) * 0.7f, 0.3f + unit(random) * 0.7f, 0.3f + unit(random) * 0.7f, 1.0f);
+
+			/* World bounds of the rotated mesh: extents projected through the absolute matrix */
+			const AABB& meshBounds = m_MeshBounds[m_ObjectMeshes[i]];
+			const glm::vec3 center = glm::vec3(m_ModelMatrices[i] * glm::vec4((meshBounds.min + meshBounds.max) * 0.5f, 1.0f));
+			const glm::mat3 absoluteMatrix = glm::mat3(glm::abs(m_ModelMatrices[i][0]), glm::abs(m_ModelMatrices[i][1]), glm::abs(m_ModelMatrices[i][2]));
+			const glm::vec3 extent = absoluteMatrix * ((meshBounds.max - meshBounds.min) * 0.5f);
+			bounds[i] = { center - extent, center + extent };
+
+			if (m_GpuDrivenRenderer)
+				m_GpuDrivenRenderer->AddObject(m_ObjectMeshes[i], m_ModelMatrices[i], m_Colors[i]);
+		}
+
+		m_Bvh.Build(bounds);
+	}
+
+	void TestGpuDriven::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+	}
+
+	void TestGpuDriven::OnPublishRenderState()
+	{
+		m_RenderTime = m_Time;
+	}
+
+	void TestGpuDriven::OnRender(Renderer& renderer)
+	{
+		const float yaw = glm::radians(m_RenderTime * m_CameraSpeed);
+		const glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), (float)WindowWidth / WindowHeight, 0.1f, 250.0f);
+		const glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f), glm::vec3(std::sin(yaw), 0.0f, -std::cos(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 viewProjection = projectionMatrix * viewMatrix;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		if (m_IsGpuDriven)
+		{
+			m_GpuDrivenRenderer->Draw(viewProjection);
+			m_DrawCallCount = 1;
+		}
+		else
+		{
+			/* The classic path: cull on the CPU, then bind, set uniforms and draw object by object */
+			m_VisibleObjects.clear();
+			if (m_IsCpuCullingOn)
+			{
+				CullingStats stats;
+				m_Bvh.Cull(Frustum::FromViewProjection(viewProjection), m_VisibleObjects, stats);
+			}
+			else
+			{
+				for (uint32_t i = 0; i < m_ModelMatrices.size(); i++)
+					m_VisibleObjects.push_back(i);
+			}
+
+			for (uint32_t object : m_VisibleObjects)
+			{
+				const Mesh& mesh = m_Meshes[m_ObjectMeshes[object]];
+				m_Shader->Bind();
+				m_Shader->SetUniformMat4f("u_MVP", viewProjection * m_ModelMatrices[object]);
+				m_Shader->SetUniform4f("u_Color", m_Colors[object].r, m_Colors[object].g, m_Colors[object].b, m_Colors[object].a);
+				renderer.Draw(*mesh.vertexArray, *mesh.indexBuffer, *m_Shader);
+			}
+
+			m_DrawCallCount = m_VisibleObjects.size();
+		}
+
+		const float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_SubmissionMilliseconds = m_SubmissionMilliseconds * 0.95f + milliseconds * 0.05f;
+	}
+
+	void TestGpuDriven::OnImGuiRender(ImGuiIO& io)
+	{
+		if (!m_IsGpuDrivenSupported)
+			ImGui::TextWrapped("The GPU-driven path needs an OpenGL 4.3 context (this one is %s)", (const char*)glGetString(GL_VERSION));
+
+		ImGui::SliderInt("Objects (on regenerate)", &m_ObjectCount, 1000, 200000);
+		if (ImGui::Button("Regenerate"))
+			Generate();
+
+		if (m_IsGpuDrivenSupported)
+		{
+			ImGui::Checkbox("GPU-driven (compute culling + multi-draw indirect)", &m_IsGpuDriven);
+
+			bool isDrawCountEnabled = m_GpuDrivenRenderer->IsDrawCountEnabled();
+			if (m_GpuDrivenRenderer->IsDrawCountSupported() && ImGui::Checkbox("Compact draws (indirect count)", &isDrawCountEnabled))
+				m_GpuDrivenRenderer->SetDrawCountEnabled(isDrawCountEnabled);
+		}
+
+		if (!m_IsGpuDriven)
+			ImGui::Checkbox("CPU culling (BVH)", &m_IsCpuCullingOn);
+
+		ImGui::SliderFloat("Camera speed (deg/s)", &m_CameraSpeed, -90.0f, 90.0f);
+
+		ImGui::Text("CPU submission %.3f ms - %zu draw calls", m_SubmissionMilliseconds, m_DrawCallCount);
+		if (m_IsGpuDriven)
+			ImGui::Text("Visible %u of %zu (read back from the GPU)", m_GpuDrivenRenderer->GetVisibleCount(), m_GpuDrivenRenderer->GetObjectCount());
+		else
+			ImGui::Text("Visible %zu of %zu", m_VisibleObjects.size(), m_ModelMatrices.size());
+	}
+}
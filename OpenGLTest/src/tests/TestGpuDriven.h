@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Test.h"
+#include "AppWindow.h"
+#include "ResourceManager.h"
+#include "GpuDrivenRenderer.h"
+#include "Bvh.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <memory>
+
+namespace test
+{
+	/* Stress scene: the same objects submitted one `Renderer::Draw` at a time, or culled and drawn by the GPU */
+	class TestGpuDriven : public Test
+	{
+	public:
+		TestGpuDriven();
+
+		void OnUpdate(float deltaTime) override;
+		void OnPublishRenderState() override;
+		void OnRender(Renderer& renderer) override;
+		void OnImGuiRender(ImGuiIO& io) override;
+		bool IsAnimating() const override { return m_CameraSpeed != 0.0f; }
+
+	private:
+		struct Mesh
+		{
+			std::unique_ptr<VertexArray> vertexArray;
+			std::unique_ptr<VertexBuffer> vertexBuffer;
+			std::unique_ptr<IndexBuffer> indexBuffer;
+		};
+
+		void AddMesh(const float* positions, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount);
+		void Generate();
+
+		bool m_IsGpuDrivenSupported;
+		bool m_IsGpuDriven;
+		bool m_IsCpuCullingOn = true; // Classic path only (the GPU-driven path always culls)
+
+		ResourceHandle<Shader> m_Shader = ResourceManager::Get().GetShader("res/shaders/Sombrero.shader");
+		std::vector<Mesh> m_Meshes;
+		std::vector<AABB> m_MeshBounds;
+		std::unique_ptr<GpuDrivenRenderer> m_GpuDrivenRenderer;
+
+		int m_ObjectCount = 50000; // Applied on `Generate`
+		std::vector<uint32_t> m_ObjectMeshes;
+		std::vector<glm::mat4> m_ModelMatrices;
+		std::vector<glm::vec4> m_Colors;
+		Bvh m_Bvh;
+		std::vector<uint32_t> m_VisibleObjects;
+
+		float m_CameraSpeed = 10.0f; // Degrees per second
+
+		/* Simulated state */
+		float m_Time = 0.0f;
+
+		/* Render state */
+		float m_RenderTime = 0.0f;
+
+		float m_SubmissionMilliseconds = 0.0f; // Smoothed CPU time spent culling and submitting draws
+		std::size_t m_DrawCallCount = 0;
+	};
+}
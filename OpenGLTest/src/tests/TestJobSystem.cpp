@@ -0,0 +1,132 @@
+#include "TestJobSystem.h"
+#include "TestSombrero.h"
+#include "JobSystem.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace test
+{
+	TestJobSystem::TestJobSystem()
+	{
+	}
+
+	TestJobSystem::~TestJobSystem()
+	{
+		/* Leave the job system on every core for the other tests */
+		if (JobSystem::Get().GetThreadCount() != std::max(1u, std::thread::hardware_concurrency()))
+			JobSystem::Get().Initialize();
+	}
+
+	void TestJobSystem::UpdateTransforms(const std::vector<glm::vec3>& positions, const std::vector<float>& angles, std::vector<glm::mat4>& modelMatrices, std::size_t grainSize)
+	{
+		modelMatrices.resize(positions.size());
+
+		JobSystem::Get().ParallelFor(0, positions.size(), grainSize, [&](std::size_t first, std::size_t last)
+		{
+			for (std::size_t i = first; i < last; i++)
+			{
+				glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), positions[i]);
+				modelMatrix = glm::rotate(modelMatrix, angles[i], glm::vec3(0.0f, 0.0f, 1.0f));
+				modelMatrices[i] = glm::scale(modelMatrix, glm::vec3(0.5f));
+			}
+		});
+	}
+
+	float TestJobSystem::TimeWorkload()
+	{
+		std::vector<float> timings;
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+
+		/* One extra run to warm up the caches and the worker threads */
+		for (int i = 0; i <= m_Repetitions; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			if (m_Workload == 0)
+				TestSombrero::GenerateGrid(m_GridSize, vertices, indices, m_GrainSize);
+			else if (m_Workload == 1)
+				UpdateTransforms(m_Positions, m_Angles, m_ModelMatrices, m_GrainSize);
+			else
+			{
+				/* Moving the root dirties the whole hierarchy */
+				m_Transforms.SetRotation(0, glm::angleAxis(i * 0.01f, glm::vec3(0.0f, 0.0f, 1.0f)));
+				m_Transforms.UpdateWorldMatrices(m_GrainSize);
+			}
+
+			if (i > 0)
+				timings.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		std::sort(timings.begin(), timings.end());
+		return timings[timings.size() / 2];
+	}
+
+	void TestJobSystem::RunScalingBenchmark()
+	{
+		m_Results.clear();
+
+		if (m_Workload == 1)
+		{
+			m_Positions.resize(m_TransformCount);
+			m_Angles.resize(m_TransformCount);
+			for (int i = 0; i < m_TransformCount; i++)
+			{
+				m_Positions[i] = glm::vec3((float)(i % 1000), (float)(i / 1000), 0.0f);
+				m_Angles[i] = i * 0.001f;
+			}
+		}
+		else if (m_Workload == 2)
+		{
+			/* 4-ary tree, node i hangs from node (i - 1) / 4 */
+			m_Transforms.Clear();
+			m_Transforms.Reserve(m_TransformCount);
+			m_Transforms.Create();
+			for (int i = 1; i < m_TransformCount; i++)
+				m_Transforms.Create((TransformID)((i - 1) / 4), glm::vec3(1.0f, 0.5f, 0.0f), glm::angleAxis(i * 0.01f, glm::vec3(0.0f, 0.0f, 1.0f)), glm::vec3(0.9f));
+		}
+
+		/* Same workload from 1 to N threads */
+		const unsigned int maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned int threadCount = 1; threadCount <= maxThreadCount; threadCount++)
+		{
+			JobSystem::Get().Initialize(threadCount);
+			m_Results.push_back({ threadCount, TimeWorkload() });
+		}
+
+		JobSystem::Get().Initialize();
+	}
+
+	void TestJobSystem::OnImGuiRender(ImGuiIO& io)
+	{
+		ImGui::Text("Job system threads: %u", JobSystem::Get().GetThreadCount());
+
+		ImGui::RadioButton("Sombrero grid generation", &m_Workload, 0);
+		ImGui::RadioButton("Transform updates", &m_Workload, 1);
+		ImGui::RadioButton("Transform hierarchy", &m_Workload, 2);
+
+		if (m_Workload == 0)
+			ImGui::SliderInt("Vertices per side", &m_GridSize, 64, 4096);
+		else
+			ImGui::SliderInt("Transforms", &m_TransformCount, 1000, 1000000);
+
+		ImGui::SliderInt(m_Workload == 0 ? "Grain size (rows)" : "Grain size (transforms)", &m_GrainSize, 1, 4096);
+		ImGui::SliderInt("Repetitions", &m_Repetitions, 1, 20);
+
+		if (ImGui::Button("Run scaling benchmark"))
+			RunScalingBenchmark();
+
+		if (m_Results.empty())
+			return;
+
+		const float singleThreadMilliseconds = m_Results[0].milliseconds;
+		for (const ScalingResult& result : m_Results)
+		{
+			const float speedup = singleThreadMilliseconds / result.milliseconds;
+			ImGui::Text("%2u threads: %8.3f ms - speedup %.2fx - efficiency %3.0f%%", result.threadCount, result.milliseconds, speedup, 100.0f * speedup / result.threadCount);
+		}
+	}
+}
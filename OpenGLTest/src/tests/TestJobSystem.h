@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Test.h"
+#include "TransformSystem.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class TestJobSystem : public Test
+	{
+	public:
+		TestJobSystem();
+		~TestJobSystem();
+
+		void OnImGuiRender(ImGuiIO& io) override;
+
+		// Builds a model matrix per transform, `grainSize` transforms per job
+		static void UpdateTransforms(const std::vector<glm::vec3>& positions, const std::vector<float>& angles, std::vector<glm::mat4>& modelMatrices, std::size_t grainSize);
+
+	private:
+		struct ScalingResult
+		{
+			unsigned int threadCount;
+			float milliseconds; // Median of the repetitions
+		};
+
+		void RunScalingBenchmark();
+		float TimeWorkload();
+
+		int m_Workload = 0; // 0: grid generation - 1: transform updates - 2: transform hierarchy
+		int m_GridSize = 1024;
+		int m_TransformCount = 100000;
+		int m_GrainSize = 64;
+		int m_Repetitions = 5;
+
+		std::vector<glm::vec3> m_Positions;
+		std::vector<float> m_Angles;
+		std::vector<glm::mat4> m_ModelMatrices;
+		TransformSystem m_Transforms;
+
+		std::vector<ScalingResult> m_Results;
+	};
+}
@@ -0,0 +1,173 @@
+#include "TestMeshImport.h"
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+
+namespace test
+{
+	TestMeshImport::TestMeshImport()
+	{
+		m_Shader->Bind();
+		m_Shader->SetUniform4f("u_Color", 0.9f, 0.7f, 0.4f, 1.0f);
+		m_Shader->SetUniform3f("u_LightDirection", -0.4f, -0.7f, -0.6f);
+		m_Shader->Unbind();
+
+		/* No production meshes ship with the repository, so start with a generated one */
+		if (!std::filesystem::exists(m_Filepath))
+		{
+			std::filesystem::create_directories(std::filesystem::path(m_Filepath).parent_path());
+			WriteTorus(m_Filepath, m_TorusResolution);
+		}
+
+		Load(true);
+	}
+
+	bool TestMeshImport::WriteTorus(const std::string& filepath, int resolution)
+	{
+		std::FILE* file = std::fopen(filepath.c_str(), "w");
+		if (!file)
+		{
+			Log("Failed to open " + filepath + " for writing");
+			return false;
+		}
+
+		std::fprintf(file, "# Torus, %d x %d quads\n", resolution, resolution);
+
+		for (int ring = 0; ring < resolution; ring++)
+		{
+			for (int side = 0; side < resolution; side++)
+			{
+				const float u = 6.2831853f * ring / resolution;
+				const float v = 6.2831853f * side / resolution;
+				const glm::vec3 normal(std::cos(v) * std::cos(u), std::sin(v), std::cos(v) * std::sin(u));
+				const glm::vec3 position = glm::vec3(std::cos(u), 0.0f, std::sin(u)) + 0.3f * normal;
+
+				std::fprintf(file, "v %f %f %f\nvn %f %f %f\nvt %f %f\n", position.x, position.y, position.z, normal.x, normal.y, normal.z, (float)ring / resolution, (float)side / resolution);
+			}
+		}
+
+		/* Position, normal and texture coordinate of a vertex share its (1-based) index */
+		for (int ring = 0; ring < resolution; ring++)
+		{
+			for (int side = 0; side < resolution; side++)
+			{
+				const int a = ring * resolution + side + 1;
+				const int b = ((ring + 1) % resolution) * resolution + side + 1;
+				const int c = ((ring + 1) % resolution) * resolution + (side + 1) % resolution + 1;
+				const int d = ring * resolution + (side + 1) % resolution + 1;
+				std::fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+			}
+		}
+
+		std::fclose(file);
+		return true;
+	}
+
+	void TestMeshImport::Load(bool isCacheEnabled)
+	{
+		MeshImportOptions options;
+		options.isCacheEnabled = isCacheEnabled;
+
+		auto mesh = MeshImporter::Load(m_Filepath, options, &m_Stats);
+		m_IsLoaded = mesh != nullptr;
+		if (!mesh)
+			return;
+
+		/* Straight from the importer's interleaved buffer (or the mapped cache) to the GPU */
+		const auto start = std::chrono::steady_clock::now();
+
+		m_VertexArray = std::make_unique<VertexArray>();
+		m_VertexBuffer = std::make_unique<VertexBuffer>(mesh->GetVertices(), mesh->GetVertexCount() * mesh->GetLayout().GetStride());
+		m_VertexArray->AddBuffer(*m_VertexBuffer, mesh->GetLayout());
+		m_IndexBuffer = std::make_unique<IndexBuffer>(mesh->GetIndices(), mesh->GetIndexCount());
+
+		m_VertexArray->Unbind();
+		m_VertexBuffer->Unbind();
+		m_IndexBuffer->Unbind();
+
+		m_UploadMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		const AABB& bounds = mesh->GetBounds();
+		const glm::vec3 extent = bounds.max - bounds.min;
+		const float size = std::max(extent.x, std::max(extent.y, extent.z));
+		m_FitMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f / std::max(size, 1e-6f)));
+		m_FitMatrix = glm::translate(m_FitMatrix, -(bounds.min + bounds.max) * 0.5f);
+
+		m_VertexCount = mesh->GetVertexCount();
+		m_TriangleCount = mesh->GetIndexCount() / 3;
+	}
+
+	void TestMeshImport::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+	}
+
+	void TestMeshImport::OnPublishRenderState()
+	{
+		m_RenderTime = m_Time;
+	}
+
+	void TestMeshImport::OnRender(Renderer& renderer)
+	{
+		if (!m_IsLoaded)
+			return;
+
+		const glm::mat4 projectionMatrix = glm::perspective(glm::radians(45.0f), (float)WindowWidth / WindowHeight, 0.1f, 100.0f);
+		const glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f, 1.5f, 3.5f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(m_RenderTime * m_RotationSpeed), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 modelMatrix = rotation * m_FitMatrix;
+
+		m_Shader->Bind();
+		m_Shader->SetUniformMat4f("u_MVP", projectionMatrix * viewMatrix * modelMatrix);
+		m_Shader->SetUniformMat4f("u_Model", rotation);
+
+		/* The only scene with overlapping opaque triangles, so it owns its depth test */
+		GL_CALL(glEnable(GL_DEPTH_TEST));
+		GL_CALL(glClear(GL_DEPTH_BUFFER_BIT));
+		renderer.Draw(*m_VertexArray, *m_IndexBuffer, *m_Shader);
+		GL_CALL(glDisable(GL_DEPTH_TEST));
+	}
+
+	void TestMeshImport::OnImGuiRender(ImGuiIO& io)
+	{
+		ImGui::InputText("File (.obj, .glb)", m_Filepath, sizeof(m_Filepath));
+
+		if (ImGui::Button("Load"))
+			Load(true);
+		ImGui::SameLine();
+		if (ImGui::Button("Load without cache"))
+			Load(false);
+		ImGui::SameLine();
+		if (ImGui::Button("Delete cache"))
+			std::filesystem::remove(MeshImporter::GetCachePath(m_Filepath));
+
+		ImGui::SliderInt("Torus resolution", &m_TorusResolution, 16, 2048);
+		if (ImGui::Button("Write torus to file"))
+			WriteTorus(m_Filepath, m_TorusResolution);
+
+		ImGui::SliderFloat("Rotation speed (deg/s)", &m_RotationSpeed, -180.0f, 180.0f);
+
+		if (!m_IsLoaded)
+		{
+			ImGui::Text("Failed to load the mesh (see the log)");
+			return;
+		}
+
+		ImGui::Text("%u vertices, %u triangles", m_VertexCount, m_TriangleCount);
+		if (m_Stats.isFromCache)
+		{
+			ImGui::Text("Mapped from the cache in %.3f ms", m_Stats.totalMilliseconds);
+		}
+		else
+		{
+			ImGui::Text("Parsed in %.3f ms (%zu chunks), welded %zu corners in %.3f ms", m_Stats.parseMilliseconds, m_Stats.chunkCount, m_Stats.cornerCount, m_Stats.weldMilliseconds);
+			ImGui::Text("Cache written in %.3f ms - total %.3f ms", m_Stats.cacheWriteMilliseconds, m_Stats.totalMilliseconds);
+		}
+		ImGui::Text("Upload %.3f ms", m_UploadMilliseconds);
+	}
+}
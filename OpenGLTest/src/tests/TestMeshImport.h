@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Test.h"
+#include "AppWindow.h"
+#include "ResourceManager.h"
+#include "MeshImporter.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <memory>
+
+namespace test
+{
+	class TestMeshImport : public Test
+	{
+	public:
+		TestMeshImport();
+
+		void OnUpdate(float deltaTime) override;
+		void OnPublishRenderState() override;
+		void OnRender(Renderer& renderer) override;
+		void OnImGuiRender(ImGuiIO& io) override;
+		bool IsAnimating() const override { return m_IsLoaded && m_RotationSpeed != 0.0f; }
+
+		// Writes a torus as an OBJ (quads, with normals and texture coordinates), to have something large to import
+		static bool WriteTorus(const std::string& filepath, int resolution);
+
+	private:
+		void Load(bool isCacheEnabled);
+
+		ResourceHandle<Shader> m_Shader = ResourceManager::Get().GetShader("res/shaders/Mesh.shader");
+		std::unique_ptr<VertexArray> m_VertexArray;
+		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		glm::mat4 m_FitMatrix = glm::mat4(1.0f); // Centers the mesh and scales it to a unit size
+
+		char m_Filepath[256] = "res/meshes/torus.obj";
+		int m_TorusResolution = 256;
+		bool m_IsLoaded = false;
+		MeshImportStats m_Stats;
+		uint32_t m_VertexCount = 0;
+		uint32_t m_TriangleCount = 0;
+		float m_UploadMilliseconds = 0.0f;
+
+		float m_RotationSpeed = 20.0f; // Degrees per second
+
+		/* Simulated state */
+		float m_Time = 0.0f;
+
+		/* Render state */
+		float m_RenderTime = 0.0f;
+	};
+}
@@ -0,0 +1,292 @@
+#include "TestParticles.h"
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace test
+{
+	TestParticles::TestParticles()
+		: m_IsComputeSupported(GLEW_VERSION_4_3), m_Backend(ParticleBackend::TRANSFORM_FEEDBACK), m_IsQueryPending()
+	{
+		if (m_IsComputeSupported)
+		{
+			m_ComputeShader = ResourceManager::Get().GetShader("res/shaders/ParticlesCompute.shader");
+			m_Backend = ParticleBackend::COMPUTE;
+		}
+
+		/* Every particle is the same quad, expanded in the vertex shader */
+		const float corners[] = {
+			-1.0f, -1.0f,
+			 1.0f, -1.0f,
+			-1.0f,  1.0f,
+			 1.0f,  1.0f
+		};
+		m_QuadBuffer = std::make_unique<VertexBuffer>(corners, (unsigned int)sizeof(corners));
+
+		/* DynamicResolution keeps a GL_TIME_ELAPSED query open around the scene and those don't nest, timestamps do */
+		GL_CALL(glGenQueries(QueryCount * 3, &m_Queries[0][0]));
+
+		Resize();
+	}
+
+	TestParticles::~TestParticles()
+	{
+		GL_CALL(glDeleteQueries(QueryCount * 3, &m_Queries[0][0]));
+	}
+
+	void TestParticles::Resize()
+	{
+		m_ParticleCount = (uint32_t)m_RequestedCount;
+		m_EmitCursor = 0;
+		m_EmitRemainder = 0.0f;
+
+		/* All zeros: an age of 0 reaching a lifetime of 0, so every particle starts out dead */
+		const std::vector<float> deadParticles((std::size_t)m_ParticleCount * ParticleSize / sizeof(float), 0.0f);
+
+		VertexBufferLayout quadLayout;
+		quadLayout.Push(GL_FLOAT, 2);
+
+		VertexBufferLayout particleLayout;
+		particleLayout.Push(GL_FLOAT, 4);
+		particleLayout.Push(GL_FLOAT, 4);
+
+		VertexBufferLayout instanceLayout = particleLayout;
+		instanceLayout.SetDivisor(1);
+
+		for (int i = 0; i < 2; i++)
+		{
+			m_ParticleBuffers[i] = std::make_unique<VertexBuffer>(deadParticles.data(), m_ParticleCount * ParticleSize, GL_DYNAMIC_COPY);
+
+			m_UpdateVertexArrays[i] = std::make_unique<VertexArray>();
+			m_UpdateVertexArrays[i]->AddBuffer(*m_ParticleBuffers[i], particleLayout);
+
+			m_RenderVertexArrays[i] = std::make_unique<VertexArray>();
+			m_RenderVertexArrays[i]->AddBuffer(*m_QuadBuffer, quadLayout);
+			m_RenderVertexArrays[i]->AddBuffer(*m_ParticleBuffers[i], instanceLayout, 1);
+		}
+
+		m_RenderVertexArrays[1]->Unbind();
+		m_QuadBuffer->Unbind();
+		m_Current = 0;
+	}
+
+	void TestParticles::OnUpdate(float deltaTime)
+	{
+		/* The camera keeps going while the particles are paused */
+		m_Time += deltaTime;
+		if (!m_IsPaused)
+			m_PendingTime += deltaTime;
+	}
+
+	void TestParticles::OnPublishRenderState()
+	{
+		m_RenderTime = m_Time;
+		m_RenderDeltaTime = m_PendingTime;
+		m_PendingTime = 0.0f;
+	}
+
+	void TestParticles::SetSimulationUniforms(Shader& shader, float deltaTime, uint32_t emitCount)
+	{
+		const glm::vec3 direction = glm::length(m_EmitterDirection) > 0.0f ? glm::normalize(m_EmitterDirection) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+		shader.SetUniform1f("u_DeltaTime", deltaTime);
+		shader.SetUniform1ui("u_Seed", m_Seed);
+		shader.SetUniform1ui("u_ParticleCount", m_ParticleCount);
+		shader.SetUniform1ui("u_EmitBegin", m_EmitCursor);
+		shader.SetUniform1ui("u_EmitCount", emitCount);
+
+		shader.SetUniform1i("u_EmitterShape", m_EmitterShape);
+		shader.SetUniform3f("u_EmitterPosition", m_EmitterPosition.x, m_EmitterPosition.y, m_EmitterPosition.z);
+		shader.SetUniform1f("u_EmitterSize", m_EmitterSize);
+		shader.SetUniform3f("u_EmitterDirection", direction.x, direction.y, direction.z);
+		shader.SetUniform1f("u_Spread", glm::radians(m_Spread));
+		shader.SetUniform1f("u_Speed", m_Speed);
+		shader.SetUniform2f("u_Lifetime", m_Lifetime[0], std::max(m_Lifetime[0], m_Lifetime[1]));
+
+		shader.SetUniform3f("u_Gravity", m_Gravity.x, m_Gravity.y, m_Gravity.z);
+		shader.SetUniform1f("u_DragFactor", std::exp(-m_Drag * deltaTime));
+		shader.SetUniform3f("u_AttractorPosition", m_AttractorPosition.x, m_AttractorPosition.y, m_AttractorPosition.z);
+		shader.SetUniform1f("u_AttractorStrength", m_AttractorStrength);
+		shader.SetUniform1f("u_VortexStrength", m_VortexStrength);
+	}
+
+	void TestParticles::Simulate(float deltaTime)
+	{
+		/* Dead particles respawn in a window sliding around the pool, which gives the rate without any counter on the GPU */
+		const float emission = m_EmissionRate * deltaTime + m_EmitRemainder;
+		const uint32_t emitCount = (uint32_t)std::min(std::floor(emission), (float)m_ParticleCount);
+		m_EmitRemainder = emission - std::floor(emission);
+
+		const int source = m_Current;
+		const int destination = 1 - m_Current;
+
+		if (m_Backend == ParticleBackend::COMPUTE)
+		{
+			m_ComputeShader->Bind();
+			SetSimulationUniforms(*m_ComputeShader, deltaTime, emitCount);
+
+			GL_CALL(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_ParticleBuffers[source]->GetRendererID()));
+			GL_CALL(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_ParticleBuffers[destination]->GetRendererID()));
+			GL_CALL(glDispatchCompute((m_ParticleCount + 255) / 256, 1, 1));
+			RenderStats::Get().Add(RenderCounter::COMPUTE_DISPATCHES);
+
+			/* The draw reads what was just written as vertex attributes */
+			GL_CALL(glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+			GL_CALL(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0));
+			GL_CALL(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0));
+		}
+		else
+		{
+			m_UpdateShader->Bind();
+			SetSimulationUniforms(*m_UpdateShader, deltaTime, emitCount);
+
+			/* One point per particle, nothing rasterized: the vertex outputs go straight into the other buffer */
+			GL_CALL(glEnable(GL_RASTERIZER_DISCARD));
+			m_UpdateVertexArrays[source]->Bind();
+			GL_CALL(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_ParticleBuffers[destination]->GetRendererID()));
+
+			GL_CALL(glBeginTransformFeedback(GL_POINTS));
+			GL_CALL(glDrawArrays(GL_POINTS, 0, m_ParticleCount));
+			RenderStats::Get().AddDraw(GL_POINTS, m_ParticleCount);
+			GL_CALL(glEndTransformFeedback());
+
+			GL_CALL(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0));
+			GL_CALL(glDisable(GL_RASTERIZER_DISCARD));
+		}
+
+		m_Current = destination;
+		m_EmitCursor = (uint32_t)(((uint64_t)m_EmitCursor + emitCount) % m_ParticleCount);
+		m_Seed++;
+	}
+
+	void TestParticles::OnRender(Renderer& renderer)
+	{
+		ReadBackQueries();
+
+		/* Skip timing this frame rather than wait when the oldest results haven't come back yet */
+		const bool isTimed = !m_IsQueryPending[m_QueryIndex];
+		if (isTimed)
+		{
+			GL_CALL(glQueryCounter(m_Queries[m_QueryIndex][0], GL_TIMESTAMP));
+		}
+
+		if (m_RenderDeltaTime > 0.0f)
+			Simulate(std::min(m_RenderDeltaTime, MaxStep));
+
+		if (isTimed)
+		{
+			GL_CALL(glQueryCounter(m_Queries[m_QueryIndex][1], GL_TIMESTAMP));
+		}
+
+		const float yaw = glm::radians(m_RenderTime * m_CameraSpeed);
+		const glm::vec3 eye = glm::vec3(std::sin(yaw), 0.3f, std::cos(yaw)) * m_CameraDistance;
+		const glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), (float)WindowWidth / WindowHeight, 0.1f, 100.0f);
+		const glm::mat4 viewMatrix = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		m_RenderShader->Bind();
+		m_RenderShader->SetUniformMat4f("u_View", viewMatrix);
+		m_RenderShader->SetUniformMat4f("u_Projection", projectionMatrix);
+		m_RenderShader->SetUniform1f("u_Size", m_Size);
+		m_RenderShader->SetUniform4f("u_StartColor", m_StartColor.r, m_StartColor.g, m_StartColor.b, m_StartColor.a);
+		m_RenderShader->SetUniform4f("u_EndColor", m_EndColor.r, m_EndColor.g, m_EndColor.b, m_EndColor.a);
+
+		/* Additive, so the draw order of a million overlapping sprites doesn't matter */
+		GL_CALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE));
+		renderer.DrawInstanced(*m_RenderVertexArrays[m_Current], 4, m_ParticleCount, *m_RenderShader);
+		GL_CALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+		if (isTimed)
+		{
+			GL_CALL(glQueryCounter(m_Queries[m_QueryIndex][2], GL_TIMESTAMP));
+			m_IsQueryPending[m_QueryIndex] = true;
+			m_QueryIndex = (m_QueryIndex + 1) % QueryCount;
+		}
+	}
+
+	void TestParticles::ReadBackQueries()
+	{
+		/* Oldest first, stopping at the first one not ready since they complete in order */
+		for (int i = 0; i < QueryCount; i++)
+		{
+			const int index = (m_QueryIndex + i) % QueryCount;
+			if (!m_IsQueryPending[index])
+				continue;
+
+			int isAvailable = 0;
+			GL_CALL(glGetQueryObjectiv(m_Queries[index][2], GL_QUERY_RESULT_AVAILABLE, &isAvailable));
+			if (!isAvailable)
+				break;
+
+			GLuint64 timestamps[3];
+			for (int j = 0; j < 3; j++)
+			{
+				GL_CALL(glGetQueryObjectui64v(m_Queries[index][j], GL_QUERY_RESULT, &timestamps[j]));
+			}
+			m_IsQueryPending[index] = false;
+
+			const float simulateMilliseconds = (timestamps[1] - timestamps[0]) / 1000000.0f;
+			const float renderMilliseconds = (timestamps[2] - timestamps[1]) / 1000000.0f;
+			m_SimulateMilliseconds = m_SimulateMilliseconds * 0.9f + simulateMilliseconds * 0.1f;
+			m_RenderMilliseconds = m_RenderMilliseconds * 0.9f + renderMilliseconds * 0.1f;
+		}
+	}
+
+	void TestParticles::OnImGuiRender(ImGuiIO& io)
+	{
+		ImGui::SliderInt("Particles (on resize)", &m_RequestedCount, 1000, 4000000, "%d", ImGuiSliderFlags_Logarithmic);
+		if (ImGui::Button("Resize"))
+			Resize();
+		ImGui::SameLine();
+		ImGui::Checkbox("Paused", &m_IsPaused);
+
+		int backend = (int)m_Backend;
+		ImGui::RadioButton("Transform feedback", &backend, (int)ParticleBackend::TRANSFORM_FEEDBACK);
+		ImGui::SameLine();
+		if (m_IsComputeSupported)
+			ImGui::RadioButton("Compute", &backend, (int)ParticleBackend::COMPUTE);
+		else
+			ImGui::TextDisabled("Compute (needs OpenGL 4.3)");
+		m_Backend = (ParticleBackend)backend;
+
+		/* Both numbers are GPU time: the CPU only submits one update and one instanced draw per frame */
+		ImGui::Text("GPU simulate %.3f ms - render %.3f ms", m_SimulateMilliseconds, m_RenderMilliseconds);
+		const float averageLifetime = (m_Lifetime[0] + std::max(m_Lifetime[0], m_Lifetime[1])) * 0.5f;
+		ImGui::Text("Pool %u particles (%.1f MB x 2) - about %.0f alive", m_ParticleCount, m_ParticleCount * ParticleSize / (1024.0f * 1024.0f),
+			std::min(m_EmissionRate * averageLifetime, (float)m_ParticleCount));
+
+		if (ImGui::CollapsingHeader("Emitter", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			ImGui::Combo("Shape", &m_EmitterShape, "Point\0Sphere\0Disc\0Box\0");
+			ImGui::DragFloat3("Position", &m_EmitterPosition.x, 0.05f);
+			ImGui::SliderFloat("Size", &m_EmitterSize, 0.0f, 5.0f);
+			ImGui::DragFloat3("Direction", &m_EmitterDirection.x, 0.01f, -1.0f, 1.0f);
+			ImGui::SliderFloat("Spread (deg)", &m_Spread, 0.0f, 180.0f);
+			ImGui::SliderFloat("Speed", &m_Speed, 0.0f, 20.0f);
+			ImGui::DragFloatRange2("Lifetime (s)", &m_Lifetime[0], &m_Lifetime[1], 0.05f, 0.1f, 20.0f);
+			ImGui::SliderFloat("Rate (particles/s)", &m_EmissionRate, 0.0f, 5000000.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+		}
+
+		if (ImGui::CollapsingHeader("Forces", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			ImGui::DragFloat3("Gravity", &m_Gravity.x, 0.05f);
+			ImGui::SliderFloat("Drag", &m_Drag, 0.0f, 5.0f);
+			ImGui::DragFloat3("Attractor", &m_AttractorPosition.x, 0.05f);
+			ImGui::SliderFloat("Attractor strength", &m_AttractorStrength, -50.0f, 50.0f);
+			ImGui::SliderFloat("Vortex strength", &m_VortexStrength, -20.0f, 20.0f);
+		}
+
+		if (ImGui::CollapsingHeader("Look"))
+		{
+			ImGui::SliderFloat("Sprite size", &m_Size, 0.001f, 0.1f, "%.3f", ImGuiSliderFlags_Logarithmic);
+			ImGui::ColorEdit4("Start color", &m_StartColor.r);
+			ImGui::ColorEdit4("End color", &m_EndColor.r);
+			ImGui::SliderFloat("Camera speed (deg/s)", &m_CameraSpeed, -90.0f, 90.0f);
+			ImGui::SliderFloat("Camera distance", &m_CameraDistance, 1.0f, 30.0f);
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Test.h"
+#include "AppWindow.h"
+#include "ResourceManager.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <cstdint>
+#include <memory>
+
+namespace test
+{
+	enum class ParticleBackend
+	{
+		TRANSFORM_FEEDBACK = 0, // GL 3.3: the update is a vertex shader whose outputs are captured into the other buffer
+		COMPUTE = 1 // GL 4.3: the same update as a compute shader, the buffers bound as storage
+	};
+
+	enum class EmitterShape
+	{
+		POINT = 0,
+		SPHERE = 1,
+		DISC = 2,
+		BOX = 3
+	};
+
+	/* Particles that never leave the GPU: their state ping-pongs between two vertex buffers, each step reads one and
+	writes the other, and the one just written is drawn as instanced camera-facing quads */
+	class TestParticles : public Test
+	{
+	public:
+		TestParticles();
+		~TestParticles();
+
+		void OnUpdate(float deltaTime) override;
+		void OnPublishRenderState() override;
+		void OnRender(Renderer& renderer) override;
+		void OnImGuiRender(ImGuiIO& io) override;
+		bool IsAnimating() const override { return !m_IsPaused || m_CameraSpeed != 0.0f; }
+
+	private:
+		// Position + age, velocity + lifetime (see res/shaders/ParticlesUpdate.shader)
+		static constexpr unsigned int ParticleSize = 8 * sizeof(float);
+		static constexpr float MaxStep = 0.1f; // Longer frames slow the simulation down rather than blow it up
+		// Timestamps come back a few frames late, one set per frame in flight avoids stalling on them
+		static constexpr int QueryCount = 4;
+
+		// New buffers of `m_RequestedCount` particles, all dead (emission brings them in)
+		void Resize();
+		void Simulate(float deltaTime);
+		void SetSimulationUniforms(Shader& shader, float deltaTime, uint32_t emitCount);
+		void ReadBackQueries();
+
+		bool m_IsComputeSupported;
+		ParticleBackend m_Backend;
+
+		ResourceHandle<Shader> m_UpdateShader = ResourceManager::Get().GetShader("res/shaders/ParticlesUpdate.shader");
+		ResourceHandle<Shader> m_ComputeShader; // Only loaded on GL 4.3+
+		ResourceHandle<Shader> m_RenderShader = ResourceManager::Get().GetShader("res/shaders/Particles.shader");
+
+		std::unique_ptr<VertexBuffer> m_QuadBuffer;
+		std::unique_ptr<VertexBuffer> m_ParticleBuffers[2];
+		std::unique_ptr<VertexArray> m_UpdateVertexArrays[2]; // Reads buffer i as per-vertex attributes (transform feedback)
+		std::unique_ptr<VertexArray> m_RenderVertexArrays[2]; // The quad per vertex, buffer i per instance
+		int m_Current = 0; // The buffer holding the latest state
+
+		uint32_t m_ParticleCount = 0;
+		int m_RequestedCount = 1000000; // Applied on `Resize`
+
+		/* Emitter */
+		int m_EmitterShape = (int)EmitterShape::DISC;
+		glm::vec3 m_EmitterPosition = glm::vec3(0.0f, -2.0f, 0.0f);
+		float m_EmitterSize = 0.5f;
+		glm::vec3 m_EmitterDirection = glm::vec3(0.0f, 1.0f, 0.0f);
+		float m_Spread = 20.0f; // Degrees
+		float m_Speed = 6.0f;
+		float m_Lifetime[2] = { 2.0f, 4.0f };
+		float m_EmissionRate = 300000.0f; // Particles per second (the pool caps it at count / lifetime)
+		uint32_t m_EmitCursor = 0; // Where the next respawns start in the pool
+		float m_EmitRemainder = 0.0f; // Fraction of a particle left over from the last step
+		uint32_t m_Seed = 0;
+
+		/* Forces */
+		glm::vec3 m_Gravity = glm::vec3(0.0f, -4.0f, 0.0f);
+		float m_Drag = 0.2f;
+		glm::vec3 m_AttractorPosition = glm::vec3(0.0f, 2.0f, 0.0f);
+		float m_AttractorStrength = 8.0f;
+		float m_VortexStrength = 3.0f;
+
+		/* Look */
+		float m_Size = 0.01f;
+		glm::vec4 m_StartColor = glm::vec4(1.0f, 0.6f, 0.2f, 0.6f);
+		glm::vec4 m_EndColor = glm::vec4(0.2f, 0.3f, 1.0f, 0.0f);
+		float m_CameraSpeed = 10.0f; // Degrees per second
+		float m_CameraDistance = 9.0f;
+		bool m_IsPaused = false;
+
+		/* Simulated state: OnUpdate only adds up time, the GPU steps once per frame over all of it (no per-particle CPU work) */
+		float m_Time = 0.0f;
+		float m_PendingTime = 0.0f;
+
+		/* Render state */
+		float m_RenderTime = 0.0f;
+		float m_RenderDeltaTime = 0.0f;
+
+		unsigned int m_Queries[QueryCount][3]; // Timestamps: before simulating, before drawing, after drawing
+		bool m_IsQueryPending[QueryCount];
+		int m_QueryIndex = 0;
+		float m_SimulateMilliseconds = 0.0f; // Smoothed GPU times
+		float m_RenderMilliseconds = 0.0f;
+	};
+}
@@ -0,0 +1,166 @@
+#include "TestRenderGraph.h"
+#include "GLHandleError.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+
+namespace test
+{
+	// Passes and their targets, the graph keeps the pointers
+	static const char* BlurNames[] = { "Blur H 1", "Blur V 1", "Blur H 2", "Blur V 2", "Blur H 3", "Blur V 3", "Blur H 4", "Blur V 4" };
+
+	test::TestRenderGraph::TestRenderGraph()
+	{
+	}
+
+	void test::TestRenderGraph::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+	}
+
+	void test::TestRenderGraph::OnPublishRenderState()
+	{
+		m_RenderTime = m_Time;
+	}
+
+	void test::TestRenderGraph::OnRender(Renderer& renderer)
+	{
+		/* The graph writes into whatever the frame renders to (the off-screen target with dynamic resolution) */
+		GLint framebuffer = 0;
+		GLint viewport[4] = {};
+		GL_CALL(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer));
+		GL_CALL(glGetIntegerv(GL_VIEWPORT, viewport));
+
+		m_Renderer = &renderer;
+		BuildGraph(framebuffer, viewport[2], viewport[3]);
+		m_IsCompiled = m_Graph.Compile();
+		m_Graph.Execute();
+		m_Renderer = nullptr;
+	}
+
+	void test::TestRenderGraph::BuildGraph(int framebuffer, int width, int height)
+	{
+		m_Graph.Reset();
+		m_Graph.SetAliasing(m_IsAliasing);
+
+		const RenderResource output = m_Graph.ImportFramebuffer("Output", framebuffer, width, height);
+
+		/* Window-sized rather than viewport-sized, so dynamic resolution doesn't reallocate them as the scale moves */
+		RenderTargetDescription sceneDescription;
+		sceneDescription.width = WindowWidth;
+		sceneDescription.height = WindowHeight;
+		sceneDescription.format = RenderTargetFormat::RGBA16F;
+
+		RenderTargetDescription bloomDescription = sceneDescription;
+		bloomDescription.width = std::max(1, WindowWidth / m_BloomDownscale);
+		bloomDescription.height = std::max(1, WindowHeight / m_BloomDownscale);
+
+		RenderTargetDescription luminanceDescription;
+		luminanceDescription.width = std::max(1, WindowWidth / 4);
+		luminanceDescription.height = std::max(1, WindowHeight / 4);
+
+		/* Every pass draws a triangle over the whole target, so none needs a clear */
+		RenderResource scene = InvalidRenderResource;
+		m_Graph.AddPass("Scene", [&](RenderPassBuilder& builder)
+		{
+			scene = builder.Create("Scene HDR", sceneDescription);
+		}, [this](const RenderPassContext&)
+		{
+			m_Shader->Bind();
+			m_Shader->SetUniform1i("u_Pass", 0);
+			m_Shader->SetUniform1f("u_Time", m_RenderTime);
+			m_Shader->SetUniform1f("u_Aspect", (float)WindowWidth / WindowHeight);
+			DrawFullscreen();
+		});
+
+		RenderResource bloom = InvalidRenderResource;
+		m_Graph.AddPass("Bright pass", [&](RenderPassBuilder& builder)
+		{
+			builder.Read(scene);
+			bloom = builder.Create("Bright", bloomDescription);
+		}, [this](const RenderPassContext&)
+		{
+			m_Shader->Bind();
+			m_Shader->SetUniform1i("u_Pass", 1);
+			m_Shader->SetUniform1i("u_Source", 0);
+			m_Shader->SetUniform1f("u_Threshold", m_Threshold);
+			DrawFullscreen();
+		});
+
+		for (int i = 0; i < m_BlurIterations * 2; i++)
+		{
+			m_Graph.AddPass(BlurNames[i], [&](RenderPassBuilder& builder)
+			{
+				builder.Read(bloom);
+				bloom = builder.Create(BlurNames[i], bloomDescription);
+			}, [this, i](const RenderPassContext&)
+			{
+				const float width = (float)std::max(1, WindowWidth / m_BloomDownscale);
+				const float height = (float)std::max(1, WindowHeight / m_BloomDownscale);
+				m_Shader->Bind();
+				m_Shader->SetUniform1i("u_Pass", 2);
+				m_Shader->SetUniform1i("u_Source", 0);
+				m_Shader->SetUniform2f("u_Direction", i % 2 == 0 ? 1.0f / width : 0.0f, i % 2 == 0 ? 0.0f : 1.0f / height);
+				DrawFullscreen();
+			});
+		}
+
+		RenderResource luminance = InvalidRenderResource;
+		m_Graph.AddPass("Luminance", [&](RenderPassBuilder& builder)
+		{
+			builder.Read(scene);
+			luminance = builder.Create("Luminance", luminanceDescription);
+		}, [this](const RenderPassContext&)
+		{
+			m_Shader->Bind();
+			m_Shader->SetUniform1i("u_Pass", 3);
+			m_Shader->SetUniform1i("u_Source", 0);
+			DrawFullscreen();
+		});
+
+		/* Only what the composite reads (and what that reads, and so on) runs */
+		m_Graph.AddPass("Composite", [&](RenderPassBuilder& builder)
+		{
+			builder.Read(scene);
+			if (m_IsBloom)
+				builder.Read(bloom);
+			if (m_IsLuminanceShown)
+				builder.Read(luminance);
+			builder.Write(output);
+		}, [this](const RenderPassContext&)
+		{
+			m_Shader->Bind();
+			m_Shader->SetUniform1i("u_Pass", 4);
+			m_Shader->SetUniform1i("u_Source", 0);
+			m_Shader->SetUniform1i("u_Bloom", 1);
+			m_Shader->SetUniform1i("u_Luminance", m_IsBloom ? 2 : 1);
+			m_Shader->SetUniform1i("u_HasBloom", m_IsBloom);
+			m_Shader->SetUniform1i("u_HasLuminance", m_IsLuminanceShown);
+			m_Shader->SetUniform1f("u_BloomStrength", m_BloomStrength);
+			DrawFullscreen();
+		});
+	}
+
+	void test::TestRenderGraph::DrawFullscreen()
+	{
+		m_Renderer->DrawInstanced(m_VertexArray, 3, 1, *m_Shader, GL_TRIANGLES);
+	}
+
+	void test::TestRenderGraph::OnImGuiRender(ImGuiIO& io)
+	{
+		ImGui::Checkbox("Bloom", &m_IsBloom);
+		ImGui::SameLine();
+		ImGui::Checkbox("Luminance view", &m_IsLuminanceShown);
+		ImGui::SameLine();
+		ImGui::Checkbox("Aliasing", &m_IsAliasing);
+		ImGui::SliderInt("Blur iterations", &m_BlurIterations, 1, MaxBlurIterations);
+		ImGui::SliderInt("Bloom downscale", &m_BloomDownscale, 1, 8);
+		ImGui::SliderFloat("Threshold", &m_Threshold, 0.0f, 4.0f);
+		ImGui::SliderFloat("Bloom strength", &m_BloomStrength, 0.0f, 2.0f);
+
+		if (!m_IsCompiled)
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "The graph didn't compile, see the log");
+		m_Graph.OnImGuiRender();
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Test.h"
+#include "AppWindow.h"
+#include "RenderGraph.h"
+#include "ResourceManager.h"
+#include "VertexArray.h"
+
+namespace test
+{
+	/* Bloom built as a render graph: an HDR scene, a bright pass and blur passes at a lower resolution, then a composite
+	into whatever framebuffer the frame renders to. Turning bloom off leaves the bloom passes unread, so they get culled,
+	and the blur passes' targets share textures once their lifetimes are over */
+	class TestRenderGraph : public Test
+	{
+	public:
+		TestRenderGraph();
+
+		void OnUpdate(float deltaTime) override;
+		void OnPublishRenderState() override;
+		void OnRender(Renderer& renderer) override;
+		void OnImGuiRender(ImGuiIO& io) override;
+
+	private:
+		static constexpr int MaxBlurIterations = 4; // Each one a horizontal and a vertical pass
+
+		void BuildGraph(int framebuffer, int width, int height);
+		void DrawFullscreen();
+
+		ResourceHandle<Shader> m_Shader = ResourceManager::Get().GetShader("res/shaders/RenderGraph.shader");
+		VertexArray m_VertexArray; // Empty, the triangle comes from gl_VertexID
+
+		RenderGraph m_Graph;
+		Renderer* m_Renderer = nullptr; // For the passes, while the graph executes
+		bool m_IsCompiled = false;
+
+		float m_Time = 0.0f; // Simulated
+		float m_RenderTime = 0.0f; // Published
+
+		bool m_IsAliasing = true;
+		bool m_IsBloom = true;
+		bool m_IsLuminanceShown = false;
+		int m_BlurIterations = 2;
+		int m_BloomDownscale = 2;
+		float m_Threshold = 1.0f;
+		float m_BloomStrength = 0.8f;
+	};
+}
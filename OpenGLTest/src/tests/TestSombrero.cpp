@@ -2,17 +2,88 @@
 #include "VertexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 
 namespace test
 {
+	/* The GPU path: same shader as Sombrero.shader, with the height computed per vertex by the generated function */
+	static const char* const PlotVertexShaderHeader =
+		"#version 330 core\n"
+		"\n"
+		"layout(location = 0) in vec3 aPos;\n"
+		"\n"
+		"uniform mat4 u_MVP;\n"
+		"\n";
+
+	static const char* const PlotVertexShaderMain =
+		"\n"
+		"void main()\n"
+		"{\n"
+		"    gl_Position = u_MVP * vec4(aPos.x, aPos.y, plotFunction(aPos.x, aPos.y), 1.0);\n"
+		"}\n";
+
+	static const char* const PlotFragmentShader =
+		"#version 330 core\n"
+		"\n"
+		"out vec4 color;\n"
+		"\n"
+		"uniform vec4 u_Color;\n"
+		"\n"
+		"void main()\n"
+		"{\n"
+		"    color = u_Color;\n"
+		"}\n";
+
 	TestSombrero::TestSombrero()
-		: m_Color { 1.0f, 1.0f, 1.0f, 1.0f }
+		: m_FunctionSource(), m_Color { 1.0f, 1.0f, 1.0f, 1.0f }
 	{
-		std::vector<float> vertices;
-		std::vector<unsigned int> lineEndpointIndices;
+		m_Function.GetSource().copy(m_FunctionSource, sizeof(m_FunctionSource) - 1);
 
-		const std::size_t vertexCountPerSide = 60;
-		
+		Remesh();
+
+		/* MVP matrices */
+		//m_ProjectionMatrix = glm::mat4(glm::ortho(0.0f, 900.0f, 0.0f, 900.0f, -1.0f, 1.0f));
+		//m_ViewMatrix = glm::mat4(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)));
+
+		m_Shader->Bind();
+		m_Shader->SetUniform4f("u_Color", m_Color[0], m_Color[1], m_Color[2], m_Color[3]);
+		m_Shader->Unbind();
+	}
+
+	const Expression& TestSombrero::GetSombrero()
+	{
+		/* sin(r) / r with r = 10 * sqrt(x^2 + y^2), 1 at the origin */
+		static const Expression sombrero("sinc(10 * sqrt(x^2 + y^2))");
+		return sombrero;
+	}
+
+	/* Heights of one row, a batch of points at a time (x in one array, y in the other) */
+	static void EvaluateRow(const Expression& function, float y, std::size_t vertexCountPerSide, float vertexStep, float* rowVertices)
+	{
+		float xs[Expression::BatchSize];
+		float ys[Expression::BatchSize];
+		float zs[Expression::BatchSize];
+		std::fill(ys, ys + Expression::BatchSize, y);
+
+		for (std::size_t first = 0; first < vertexCountPerSide; first += Expression::BatchSize)
+		{
+			const std::size_t count = std::min(Expression::BatchSize, vertexCountPerSide - first);
+			for (std::size_t i = 0; i < count; i++)
+				xs[i] = -1.0f + (first + i) * vertexStep;
+
+			function.Evaluate(xs, ys, zs, count);
+
+			for (std::size_t i = 0; i < count; i++)
+				rowVertices[(first + i) * 3 + 2] = zs[i];
+		}
+	}
+
+	void TestSombrero::GenerateGrid(std::size_t vertexCountPerSide, std::vector<float>& vertices, std::vector<unsigned int>& lineEndpointIndices, std::size_t rowsPerJob, const Expression& function)
+	{
 		const std::size_t coordinateCount = vertexCountPerSide * vertexCountPerSide * 3;
 		const std::size_t lineEndpointCount = vertexCountPerSide * (vertexCountPerSide - 1) * 4;
 		
@@ -21,104 +92,169 @@ namespace test
 		vertices.resize(coordinateCount);
 		lineEndpointIndices.resize(lineEndpointCount);
 
-		for (std::size_t row = 0; row < vertexCountPerSide; ++row)
+		/* Rows are independent, so they're spread across the job system */
+		JobSystem::Get().ParallelFor(0, vertexCountPerSide, rowsPerJob, [&](std::size_t firstRow, std::size_t lastRow)
 		{
-			for (std::size_t col = 0; col < vertexCountPerSide; ++col)
+			for (std::size_t row = firstRow; row < lastRow; ++row)
 			{
-				const float x = -1.0f + col * vertexStep;
 				const float y = -1.0f + row * vertexStep;
-				const float z = m_F(x, y);
 
-				const int vertexStartIndex = (row * vertexCountPerSide + col) * 3;
+				for (std::size_t col = 0; col < vertexCountPerSide; ++col)
+				{
+					const std::size_t vertexStartIndex = (row * vertexCountPerSide + col) * 3;
 
-				vertices[vertexStartIndex + 0] = x;
-				vertices[vertexStartIndex + 1] = y;
-				vertices[vertexStartIndex + 2] = z;
-			}
-		}
+					vertices[vertexStartIndex + 0] = -1.0f + col * vertexStep;
+					vertices[vertexStartIndex + 1] = y;
+				}
 
-		std::size_t lineEndpointIndex = 0;
+				EvaluateRow(function, y, vertexCountPerSide, vertexStep, &vertices[row * vertexCountPerSide * 3]);
 
-		for (std::size_t row = 0; row < vertexCountPerSide; ++row)
-		{
-			for (std::size_t col = 0; col < vertexCountPerSide - 1; ++col)
-			{
-				lineEndpointIndices[lineEndpointIndex++] = row * vertexCountPerSide + col;
-				lineEndpointIndices[lineEndpointIndex++] = row * vertexCountPerSide + col + 1;
+				/* Horizontal lines come first, then vertical ones, so each row knows where its endpoints go */
+				std::size_t lineEndpointIndex = row * (vertexCountPerSide - 1) * 2;
+
+				for (std::size_t col = 0; col < vertexCountPerSide - 1; ++col)
+				{
+					lineEndpointIndices[lineEndpointIndex++] = row * vertexCountPerSide + col;
+					lineEndpointIndices[lineEndpointIndex++] = row * vertexCountPerSide + col + 1;
+				}
+
+				if (row == vertexCountPerSide - 1)
+					continue;
+
+				lineEndpointIndex = vertexCountPerSide * (vertexCountPerSide - 1) * 2 + row * vertexCountPerSide * 2;
+
+				for (std::size_t col = 0; col < vertexCountPerSide; ++col)
+				{
+					lineEndpointIndices[lineEndpointIndex++] = row * vertexCountPerSide + col;
+					lineEndpointIndices[lineEndpointIndex++] = (row + 1) * vertexCountPerSide + col;
+				}
 			}
-		}
+		});
+	}
+
+	void TestSombrero::EvaluateGrid(std::size_t vertexCountPerSide, std::vector<float>& vertices, const Expression& function, std::size_t rowsPerJob)
+	{
+		const float vertexStep = 2.0 / (vertexCountPerSide - 1);
 
-		for (std::size_t row = 0; row < vertexCountPerSide - 1; ++row)
+		JobSystem::Get().ParallelFor(0, vertexCountPerSide, rowsPerJob, [&](std::size_t firstRow, std::size_t lastRow)
 		{
-			for (std::size_t col = 0; col < vertexCountPerSide; ++col)
-			{
-				lineEndpointIndices[lineEndpointIndex++] = row * vertexCountPerSide + col;
-				lineEndpointIndices[lineEndpointIndex++] = (row + 1) * vertexCountPerSide + col;
-			}
-		}
+			for (std::size_t row = firstRow; row < lastRow; ++row)
+				EvaluateRow(function, -1.0f + row * vertexStep, vertexCountPerSide, vertexStep, &vertices[row * vertexCountPerSide * 3]);
+		});
+	}
+
+	void TestSombrero::Remesh()
+	{
+		std::vector<unsigned int> lineEndpointIndices;
+
+		auto start = std::chrono::steady_clock::now();
+		GenerateGrid(m_Resolution, m_Vertices, lineEndpointIndices, 16, m_Function);
+		m_EvaluateMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_MeshResolution = m_Resolution;
+		m_AreHeightsStale = false;
+
+		start = std::chrono::steady_clock::now();
 
 		/* Create a new vertex buffer */
-		VertexBuffer vb(vertices.data(), vertices.size() * sizeof(float));
+		m_VertexBuffer = std::make_unique<VertexBuffer>(m_Vertices.data(), (unsigned int)(m_Vertices.size() * sizeof(float)));
 
 		/* Create vertex buffer layout */
 		VertexBufferLayout layout;
 		layout.Push(GL_FLOAT, 3);
 
 		/* Add vertex buffer to VAO */
-		m_VertexArray.AddBuffer(vb, layout);
+		m_VertexArray = std::make_unique<VertexArray>();
+		m_VertexArray->AddBuffer(*m_VertexBuffer, layout);
 
 		/* Create IBO */
-		m_IndexBuffer = new IndexBuffer(lineEndpointIndices.data(), lineEndpointIndices.size());
-
-		/* MVP matrices */
-		//m_ProjectionMatrix = glm::mat4(glm::ortho(0.0f, 900.0f, 0.0f, 900.0f, -1.0f, 1.0f));
-		//m_ViewMatrix = glm::mat4(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)));
-
-		m_Shader.Bind();
-		m_Shader.SetUniform4f("u_Color", m_Color[0], m_Color[1], m_Color[2], m_Color[3]);
+		m_IndexBuffer = std::make_unique<IndexBuffer>(lineEndpointIndices.data(), (unsigned int)lineEndpointIndices.size());
 
 		/* Unbind everything */
-		m_VertexArray.Unbind();
-		m_Shader.Unbind();
-		vb.Unbind();
+		m_VertexArray->Unbind();
+		m_VertexBuffer->Unbind();
 		m_IndexBuffer->Unbind();
+
+		m_UploadMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void TestSombrero::Replot()
+	{
+		if (m_IsGpuEvaluated)
+		{
+			/* Only the shader changes, the grid's heights are ignored */
+			const auto start = std::chrono::steady_clock::now();
+			const std::string vertexSource = PlotVertexShaderHeader + m_Function.GenerateGlsl() + PlotVertexShaderMain;
+			m_GpuShader = std::make_unique<Shader>("plot:" + m_Function.GetSource(), vertexSource.c_str(), (int)vertexSource.size(), PlotFragmentShader, (int)std::strlen(PlotFragmentShader));
+			m_ShaderMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			m_AreHeightsStale = true;
+			return;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		EvaluateGrid(m_MeshResolution, m_Vertices, m_Function);
+		m_EvaluateMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		m_VertexBuffer->SetData(m_Vertices.data(), (unsigned int)(m_Vertices.size() * sizeof(float)));
+		m_UploadMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_AreHeightsStale = false;
 	}
 
 	TestSombrero::~TestSombrero()
 	{
-		delete m_IndexBuffer;
-		m_IndexBuffer = nullptr;
 	}
 
-	void TestSombrero::OnRender(Renderer renderer)
+	void TestSombrero::OnUpdate(float deltaTime)
 	{
-		m_Shader.Bind();
+		m_PreviousAngleZ = m_AngleZ;
 
-		m_Shader.SetUniform4f("u_Color", m_Color[0], m_Color[1], m_Color[2], m_Color[3]);
+		if (!m_IsAnimationOn)
+			return;
 
-		glm::mat4 modelMatrix = glm::mat4(1.0f);
+		m_AngleZ += m_AngularSpeed * deltaTime;
 
-		if (m_IsAnimationOn)
-		{
-			if (m_AngleZ >= 180.0f)
-				m_AngleZ = -180.0f;
-			
-			m_AngleZ += m_Diff;
-		}
-		
+		if (m_AngleZ >= 180.0f)
+			m_AngleZ -= 360.0f;
+		else if (m_AngleZ < -180.0f)
+			m_AngleZ += 360.0f;
+	}
+
+	void TestSombrero::OnPublishRenderState()
+	{
+		m_RenderPreviousAngleZ = m_PreviousAngleZ;
+		m_RenderAngleZ = m_AngleZ;
+	}
+
+	void TestSombrero::OnRender(Renderer& renderer)
+	{
+		Shader& shader = m_IsGpuEvaluated ? *m_GpuShader : *m_Shader;
+		shader.Bind();
+
+		shader.SetUniform4f("u_Color", m_Color[0], m_Color[1], m_Color[2], m_Color[3]);
+
+		/* Interpolate between the last two simulated angles (the short way around when it wrapped around) */
+		float angleDelta = m_RenderAngleZ - m_RenderPreviousAngleZ;
+		if (angleDelta < -180.0f)
+			angleDelta += 360.0f;
+		else if (angleDelta > 180.0f)
+			angleDelta -= 360.0f;
+		const float angleZ = m_RenderPreviousAngleZ + angleDelta * m_InterpolationAlpha;
+
+		glm::mat4 modelMatrix = glm::mat4(1.0f);
 		modelMatrix = glm::rotate(modelMatrix, glm::radians(m_AngleX), glm::vec3(1.0f, 0.0f, 0.0f));
-		modelMatrix = glm::rotate(modelMatrix, glm::radians(m_AngleZ), glm::vec3(0.0f, 0.0f, 1.0f));
+		modelMatrix = glm::rotate(modelMatrix, glm::radians(angleZ), glm::vec3(0.0f, 0.0f, 1.0f));
 
 		//glm::mat4 mvp = m_ProjectionMatrix * m_ViewMatrix * modelMatrix;
-		m_Shader.SetUniformMat4f("u_MVP", modelMatrix);
+		shader.SetUniformMat4f("u_MVP", modelMatrix);
 
-		renderer.Draw(m_VertexArray, m_IndexBuffer, m_Shader, GL_LINES);
+		renderer.Draw(*m_VertexArray, *m_IndexBuffer, shader, GL_LINES);
 	}
 
 	void test::TestSombrero::OnImGuiRender(ImGuiIO& io)
 	{
 		ImGui::SliderFloat("Rotation X", &m_AngleX, -90.0f, 90.0f);
-		ImGui::SliderFloat("Rotation Z", &m_AngleZ, -180.0f, 180.0f);
+		if (ImGui::SliderFloat("Rotation Z", &m_AngleZ, -180.0f, 180.0f))
+			m_PreviousAngleZ = m_AngleZ; // Jump there instead of interpolating from the old angle
 
 		if (ImGui::Button("Start/stop animation"))
 		{
@@ -132,7 +268,44 @@ namespace test
 			m_AngleX = -60.0f;
 
 		if (ImGui::Button("Reset rotation Z"))
-			m_AngleZ = 0.0f;
+			m_AngleZ = m_PreviousAngleZ = 0.0f;
+
+		ImGui::SliderFloat("Angular speed (deg/s)", &m_AngularSpeed, -90.0f, 90.0f);
+
+		if (ImGui::CollapsingHeader("Function", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			/* Replotted on every edit that compiles, the last valid function stays up otherwise */
+			if (ImGui::InputText("z = f(x, y)", m_FunctionSource, sizeof(m_FunctionSource)) && m_Function.Compile(m_FunctionSource))
+				Replot();
+			if (!m_Function.GetError().empty())
+				ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_Function.GetError().c_str());
+			ImGui::TextDisabled("x, y, pi, e, + - * / ^, abs sqrt floor sin cos tan asin acos atan exp log sinc pow min max atan2");
+
+			if (ImGui::Button("Sombrero"))
+			{
+				m_Function = GetSombrero();
+				std::fill(m_FunctionSource, m_FunctionSource + sizeof(m_FunctionSource), '\0');
+				m_Function.GetSource().copy(m_FunctionSource, sizeof(m_FunctionSource) - 1);
+				Replot();
+			}
+
+			ImGui::SliderInt("Vertices per side", &m_Resolution, 16, 2048);
+			if (ImGui::IsItemDeactivatedAfterEdit())
+				Remesh();
+
+			if (ImGui::Checkbox("Evaluate on the GPU (vertex shader)", &m_IsGpuEvaluated))
+			{
+				if (m_IsGpuEvaluated || m_AreHeightsStale)
+					Replot();
+			}
+
+			ImGui::Text("%zu nodes parsed, %zu after folding, %zu instructions over %d registers", m_Function.GetParsedNodeCount(), m_Function.GetNodeCount(), m_Function.GetInstructionCount(), m_Function.GetRegisterCount());
+			ImGui::Text("%d samples", m_MeshResolution * m_MeshResolution);
+			if (m_IsGpuEvaluated)
+				ImGui::Text("Shader generated and built in %.3f ms", m_ShaderMilliseconds);
+			else
+				ImGui::Text("Evaluated in %.3f ms, uploaded in %.3f ms", m_EvaluateMilliseconds, m_UploadMilliseconds);
+		}
 
 		ImGui::ColorPicker4("Color", m_Color);
 	}
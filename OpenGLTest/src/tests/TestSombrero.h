@@ -1,10 +1,14 @@
 #pragma once
 
 #include "Test.h"
+#include "ResourceManager.h"
+#include "Expression.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
+#include <memory>
+
 namespace test
 {
 	class TestSombrero : public Test
@@ -13,29 +17,55 @@ namespace test
 		TestSombrero();
 		~TestSombrero();
 
-		void OnRender(Renderer renderer);
+		void OnUpdate(float deltaTime) override;
+		void OnPublishRenderState() override;
+		void OnRender(Renderer& renderer);
 		void OnImGuiRender(ImGuiIO& io);
+		bool IsAnimating() const override { return m_IsAnimationOn && m_AngularSpeed != 0.0f; }
+
+		// Vertices of a (vertexCountPerSide x vertexCountPerSide) grid over [-1; 1] lifted by `function`, plus GL_LINES indices
+		static void GenerateGrid(std::size_t vertexCountPerSide, std::vector<float>& vertices, std::vector<unsigned int>& lineEndpointIndices, std::size_t rowsPerJob = 16, const Expression& function = GetSombrero());
+		// Only recomputes the heights of a grid made by `GenerateGrid` (x and y stay where they are)
+		static void EvaluateGrid(std::size_t vertexCountPerSide, std::vector<float>& vertices, const Expression& function, std::size_t rowsPerJob = 16);
+
+		static const Expression& GetSombrero();
 
 	private:
-		Shader m_Shader = Shader("res/shaders/Sombrero.shader");
-		VertexArray m_VertexArray;
-		IndexBuffer* m_IndexBuffer = nullptr;
+		// New buffers for a grid of `m_Resolution` vertices per side
+		void Remesh();
+		// Plots `m_Function` on the current grid: evaluated into the vertex buffer, or compiled into the vertex shader
+		void Replot();
+
+		ResourceHandle<Shader> m_Shader = ResourceManager::Get().GetShader("res/shaders/Sombrero.shader");
+		std::unique_ptr<VertexArray> m_VertexArray;
+		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::vector<float> m_Vertices; // Kept around so a new function only rewrites the heights
+
+		/* Plotted function */
+		Expression m_Function = GetSombrero();
+		char m_FunctionSource[256];
+		int m_Resolution = 60; // Vertices per side
+		int m_MeshResolution = 0;
+		bool m_IsGpuEvaluated = false;
+		bool m_AreHeightsStale = false; // The function changed while the GPU evaluated it, `m_Vertices` still has the old heights
+		std::unique_ptr<Shader> m_GpuShader; // Sombrero.shader with z = plotFunction(x, y) in the vertex shader
+		float m_EvaluateMilliseconds = 0.0f;
+		float m_UploadMilliseconds = 0.0f;
+		float m_ShaderMilliseconds = 0.0f;
 
 		float m_AngleX = -60.0f;
-		float m_AngleZ = 0.0f;
 		float m_Color[4];
 		bool m_IsAnimationOn = true;
-		float m_Diff = 0.07f;
-
-		static float m_F(float x, float y)
-		{
-			constexpr float epsilon = 0.0001f;
-			constexpr float k = 10.0f;
-			if (std::abs(x) < epsilon && std::abs(y) < epsilon)
-				return 1.0f;
-			else
-				return sin(sqrt(pow(x * k, 2) + pow(y * k, 2))) / sqrt(pow(x * k, 2) + pow(y * k, 2)); // sombrero equation
-		}
+		float m_AngularSpeed = 4.2f; // Degrees per second (used to be 0.07 degrees per frame at 60 FPS)
+
+		/* Simulated state (written by `OnUpdate`) */
+		float m_AngleZ = 0.0f;
+		float m_PreviousAngleZ = 0.0f;
+
+		/* Render state (what `OnRender` draws, published between simulation steps) */
+		float m_RenderAngleZ = 0.0f;
+		float m_RenderPreviousAngleZ = 0.0f;
 
 		glm::mat4 m_ProjectionMatrix;
 		glm::mat4 m_ViewMatrix;
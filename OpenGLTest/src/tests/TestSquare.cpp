@@ -31,41 +31,46 @@ namespace test
 		/* Add vertex buffer to VAO */
 		m_VertexArray.AddBuffer(vb, layout);
 
+		/* Load both textures at once so they get decoded in parallel */
+		std::vector<ResourceHandle<Texture>> textures = ResourceManager::Get().GetTextures({ "res/textures/cat.png", "res/textures/opengl-logo.png" });
+		m_CatTexture = textures[0];
+		m_LogoTexture = textures[1];
+
 		/* MVP matrices */
 		m_ProjectionMatrix = glm::mat4(glm::ortho(0.0f, (float)WindowWidth, 0.0f, (float)WindowHeight, -1.0f, 1.0f)); // Maps what the "camera" sees to NDC (Normalized device coordinate), taking care of aspect ratio and perspective
 		m_ViewMatrix = glm::mat4(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0))); // Defines position and orientation of the "camera"
 
-		m_Shader.Bind();
+		m_Shader->Bind();
 
 		/* Bind it and set a 1-integer uniform to the shader for the texture */
-		m_LogoTexture.Bind();
-		m_Shader.SetUniform1i("u_Texture", 0);
+		m_LogoTexture->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
 
 		/* Unbind everything */
 		m_VertexArray.Unbind();
-		m_Shader.Unbind();
+		m_Shader->Unbind();
 		vb.Unbind();
 		m_IndexBuffer.Unbind();
 	}
 
-	void test::TestSquare::OnRender(Renderer renderer)
+	void test::TestSquare::OnRender(Renderer& renderer)
 	{
-		m_Shader.Bind();
+		m_Shader->Bind();
 		// To make these two draw calls more robust, makes sense to bind the shader right before setting the uniform, just if it's not bound yet
 		// This validation could be made in a more complex solution for managing shaders, but for this example doesn't make much sense to do it now
 
 		{
 			glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), m_TranslationA); // Defines position, rotation and scale of the vertices of the model in the world
 			glm::mat4 mvp = m_ProjectionMatrix * m_ViewMatrix * modelMatrix;
-			m_Shader.SetUniformMat4f("u_MVP", mvp);
-			renderer.Draw(m_VertexArray, m_IndexBuffer, m_Shader);
+			m_Shader->SetUniformMat4f("u_MVP", mvp);
+			renderer.Draw(m_VertexArray, m_IndexBuffer, *m_Shader);
 		}
 
 		{
 			glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), m_TranslationB);
 			glm::mat4 mvp = m_ProjectionMatrix * m_ViewMatrix * modelMatrix;
-			m_Shader.SetUniformMat4f("u_MVP", mvp);
-			renderer.Draw(m_VertexArray, m_IndexBuffer, m_Shader);
+			m_Shader->SetUniformMat4f("u_MVP", mvp);
+			renderer.Draw(m_VertexArray, m_IndexBuffer, *m_Shader);
 		}
 	}
 
@@ -86,15 +91,15 @@ namespace test
 			{
 			case 0: // cat
 			{
-				m_LogoTexture.Bind();
-				m_Shader.SetUniform1i("u_Texture", 0);
+				m_LogoTexture->Bind();
+				m_Shader->SetUniform1i("u_Texture", 0);
 				m_ActiveTexture = 1;
 				break;
 			}
 			case 1: // logo
 			{
-				m_CatTexture.Bind();
-				m_Shader.SetUniform1i("u_Texture", 0);
+				m_CatTexture->Bind();
+				m_Shader->SetUniform1i("u_Texture", 0);
 				m_ActiveTexture = 0;
 				break;
 			}
@@ -5,6 +5,7 @@
 #include "AppWindow.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "ResourceManager.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -20,8 +21,9 @@ namespace test
 	public:
 		TestSquare();
 		
-		void OnRender(Renderer renderer);
+		void OnRender(Renderer& renderer);
 		void OnImGuiRender(ImGuiIO& io);
+		bool IsAnimating() const override { return false; }
 
 	private:
 		float m_Size;
@@ -30,13 +32,13 @@ namespace test
 			2, 3, 0
 		};
 
-		Shader m_Shader = Shader("res/shaders/BasicWithTexture.shader");
+		ResourceHandle<Shader> m_Shader = ResourceManager::Get().GetShader("res/shaders/BasicWithTexture.shader");
 		VertexArray m_VertexArray;
 		IndexBuffer m_IndexBuffer = IndexBuffer(m_Indices, 6);
 
 		int m_ActiveTexture = 1; // Save the state to switch from one to another - 0: cat - 1: logo
-		Texture m_CatTexture = Texture("res/textures/cat.png");
-		Texture m_LogoTexture = Texture("res/textures/opengl-logo.png");
+		ResourceHandle<Texture> m_CatTexture;
+		ResourceHandle<Texture> m_LogoTexture;
 
 		glm::mat4 m_ProjectionMatrix;
 		glm::mat4 m_ViewMatrix;